@@ -46,12 +46,13 @@
 using namespace std;
 
 int fd;
+int dist_fd;
 pid_t pid = 0;
 vector <char*> file_name;
 int file_num;
 bool sockets, datagrams;
 
-void recvInput(bool initial)
+void recvInput()
 {
   int net_fd, length, namelength;
   if (sockets || datagrams)
@@ -61,14 +62,9 @@ void recvInput(bool initial)
   }
   for (int j = 0; j < file_num; j ++)
   {
-    if (initial && !sockets && !datagrams)
+    if (!sockets && !datagrams)
     {
       readFromSocket(fd, &namelength, sizeof(int));
-      if (namelength == -1)
-      {
-        writeToSocket(fd, &namelength, sizeof(int));
-        throw "main Avalanche agent is finished";
-      }
       char* filename = new char[namelength + 1];
       readFromSocket(fd, filename, namelength);
       filename[namelength] = '\0';
@@ -80,11 +76,6 @@ void recvInput(bool initial)
       file_name.push_back(filename);
     }
     readFromSocket(fd, &length, sizeof(int));
-    if (length == -1)
-    {
-      writeToSocket(fd, &length, sizeof(int));
-      throw "main Avalanche agent is finished";
-    }
     char* file = new char[length];
     readFromSocket(fd, file, length);
     if (sockets || datagrams)
@@ -112,26 +103,65 @@ void recvInput(bool initial)
   }
 }
 
-void sig_hndlr(int signo)
+/* Ask av-dist where main Avalanche is, then ask main Avalanche for the
+   options and the first input. Main Avalanche answers 0 while it has no
+   input to spare. Leaves fd connected to main Avalanche, dist_fd connected
+   to av-dist and returns the number of input files. */
+
+int joinAnalysis(const char* host, int port)
 {
-  int startdepth = 0;
-  int descr = open("startdepth.log", O_WRONLY | O_CREAT, PERM_R_W);
-  writeToSocket(fd, "g", 1);
-  try
+  struct sockaddr_in stSockAddr;
+  memset(&stSockAddr, 0, sizeof(struct sockaddr_in));
+  stSockAddr.sin_family = AF_INET;
+  stSockAddr.sin_port = htons(port);
+  inet_pton(AF_INET, host, &stSockAddr.sin_addr);
+
+  dist_fd = socket(PF_INET, SOCK_STREAM, IPPROTO_TCP);
+  if (dist_fd == -1)
   {
-    recvInput(false);
-    readFromSocket(fd, &startdepth, sizeof(int));
+    perror("cannot create socket");
+    exit(EXIT_FAILURE);
   }
-  catch (const char* msg)
+  if (connect(dist_fd, (const struct sockaddr*)&stSockAddr, sizeof(struct sockaddr_in)) < 0)
   {
-    shutdown(fd, O_WRONLY);
+    perror("error connect failed");
+    close(dist_fd);
+    exit(EXIT_FAILURE);
+  }
+  printf("connected to distribution server\n");
+
+  struct sockaddr_in mainAddr;
+  int mainPort;
+  memset(&mainAddr, 0, sizeof(struct sockaddr_in));
+  mainAddr.sin_family = AF_INET;
+  writeToSocket(dist_fd, "a", 1);
+  readFromSocket(dist_fd, &mainAddr.sin_addr, sizeof(mainAddr.sin_addr));
+  readFromSocket(dist_fd, &mainPort, sizeof(int));
+  mainAddr.sin_port = htons(mainPort);
+
+  for (;;)
+  {
+    fd = socket(PF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if (fd == -1)
+    {
+      perror("cannot create socket");
+      exit(EXIT_FAILURE);
+    }
+    if (connect(fd, (const struct sockaddr*)&mainAddr, sizeof(struct sockaddr_in)) < 0)
+    {
+      close(fd);
+      throw "main Avalanche agent is finished";
+    }
+    int filenum;
+    writeToSocket(fd, "c", 1);
+    readFromSocket(fd, &filenum, sizeof(int));
+    if (filenum > 0)
+    {
+      return filenum;
+    }
     close(fd);
-    printf("coudln't receive non zero scored input: %s\n", msg);
+    sleep(1);
   }
-  write(descr, &startdepth, sizeof(int));
-  close(descr);
-  
-  kill(pid, SIGUSR2);
 }
 
 void int_handler(int signo)
@@ -177,56 +207,30 @@ int main(int argc, char** argv)
     exit(EXIT_FAILURE);
   }
  
-  struct sockaddr_in stSockAddr;
-  memset(&stSockAddr, 0, sizeof(struct sockaddr_in));
-  stSockAddr.sin_family = AF_INET;
-  stSockAddr.sin_port = htons(port);
-  int res = inet_pton(AF_INET, argv[1], &stSockAddr.sin_addr);
- 
-  if (res <= 0)
+  struct in_addr distAddr;
+  if (inet_pton(AF_INET, argv[1], &distAddr) <= 0)
   {
     perror("wrong network address");
     printf("usage: av-agent <host address> <port number> [--request-non-zero]\n");
     exit(EXIT_FAILURE);
   }
 
-  fd = socket(PF_INET, SOCK_STREAM, IPPROTO_TCP);
-  if (fd == -1)
-  {
-    perror("cannot create socket");
-    exit(EXIT_FAILURE);
-  }
-    
-  res = connect(fd, (const struct sockaddr*)&stSockAddr, sizeof(struct sockaddr_in));
-  if (res < 0)
-  {
-    perror("error connect failed");
-    close(fd);
-    exit(EXIT_FAILURE);
-  }  
-
-  printf("connected to distribution server\n");
   int runs = 0;
 
   try
   {
     signal(SIGINT, int_handler);
-    writeToSocket(fd, "a", 1);
+    signal(SIGPIPE, SIG_IGN);
 
     int namelength, length, startdepth, invertdepth, alarm, tracegrindAlarm, pluginlength;
     int threads, argsnum, masklength, filtersNum, flength, received, net_fd;
     bool useMemcheck, leaks, traceChildren, checkDanger, verbose, debug, programOutput, networkLog, suppressSubcalls, STPThreadsAuto;
     string plugin_name;
   
-    readFromSocket(fd, &file_num, sizeof(int));
-    if (file_num == -1)
-    {
-      writeToSocket(fd, &file_num, sizeof(int));
-      throw "main Avalanche agent is finished";
-    }
+    file_num = joinAnalysis(argv[1], port);
     readFromSocket(fd, &sockets, sizeof(bool));
     readFromSocket(fd, &datagrams, sizeof(bool));
-    recvInput(true);
+    recvInput();
 
     readFromSocket(fd, &startdepth, sizeof(int));
     readFromSocket(fd, &invertdepth, sizeof(int));
@@ -303,6 +307,16 @@ int main(int argc, char** argv)
       av_argc++;
     }
 
+    avalanche_argv[av_argc++] = "--peer";
+    char dhost[128], dport[128];
+    sprintf(dhost, "--dist-host=%s", argv[1]);
+    avalanche_argv[av_argc++] = dhost;
+    sprintf(dport, "--dist-port=%d", port);
+    avalanche_argv[av_argc++] = dport;
+    char dfd[128];
+    sprintf(dfd, "--dist-fd=%d", dist_fd);
+    avalanche_argv[av_argc++] = dfd;
+
     if (tracegrindAlarm != 0)
     {
       char alrm[128];
@@ -442,36 +456,26 @@ int main(int argc, char** argv)
       avalanche_argv[av_argc++] = arg;
     }
     avalanche_argv[av_argc] = NULL;
-    
-    for (;;)
-    {
-      signal(SIGUSR1, sig_hndlr);
-      pid = fork();
-      if (pid == 0)
-      {
-        printf("starting child avalanche...\n");
-        execvp(avalanche_argv[0], avalanche_argv);
-      }
-      wait(NULL);
-
-      writeToSocket(fd, "g", 1);
-      recvInput(false);
-    
-      int startdepth;
-      readFromSocket(fd, &startdepth, sizeof(int));
-
-      char sdepth[128];
-      sprintf(sdepth, "--startdepth=%d", startdepth);
-      avalanche_argv[2 + argv_delta] = sdepth;
+    shutdown(fd, SHUT_RDWR);
+    close(fd);
 
-      char prefix[128];
-      sprintf(prefix, "--prefix=branch%d_", ++runs);
-      avalanche_argv[4 + argv_delta] = prefix; 
+    /* The input is counted as received on the connection to av-dist, and
+       the child avalanche registers on the same connection: if the child
+       fails before that, av-dist sees the connection closed and settles
+       the input main Avalanche counted as sent. */
+    writeToSocket(dist_fd, "h", 1);
 
-      char report[128];
-      sprintf(report, "--report-log=report%d.log", runs);
-      avalanche_argv[6 + argv_delta] = report; 
+    /* The child avalanche takes the rest of its inputs from the other
+       peers itself, and finishes when main Avalanche does. */
+    pid = fork();
+    if (pid == 0)
+    {
+      printf("starting child avalanche...\n");
+      execvp(avalanche_argv[0], avalanche_argv);
+      exit(EXIT_FAILURE);
     }
+    close(dist_fd);
+    wait(NULL);
   }
   catch (const char* msg)
   {
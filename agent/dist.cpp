@@ -1,6 +1,6 @@
 /*----------------------------------------------------------------------------------------*/
 /*------------------------------------- AVALANCHE ----------------------------------------*/
-/*---------------------- Simple server for distributed Avalanche. ------------------------*/
+/*--------------------- Membership server for distributed Avalanche. ---------------------*/
 /*-------------------------------------- dist.cpp ----------------------------------------*/
 /*----------------------------------------------------------------------------------------*/
 
@@ -35,169 +35,298 @@
 #include <signal.h>
 
 #include <algorithm>
-#include <vector>
 #include <set>
+#include <vector>
 
 #include "util.h"
 
 //#define DEBUG
 
+// the most basic blocks a peer may send in one 'b' command
+#define MAX_BLOCKS (1 << 24)
+
 using namespace std;
 
-vector<int> fds;
+/* av-dist only keeps track of who takes part in the analysis. Inputs go
+   directly between the peers (main Avalanche and the Avalanches run by
+   av-agents), each of which serves the others on its own steal port.
+
+   Commands (one byte):
+     'm' <int port> - main Avalanche registers its steal port;
+     'p' <int port> - a peer registers its steal port;
+     'a'            - a new av-agent asks for the address of main
+                      Avalanche (answered as soon as it registers);
+     'h'            - the av-agent got an input from main Avalanche: the
+                      peer it starts registers on the same connection;
+     'l'            - a peer asks for the list of the other peers;
+     'b' <int num> <num unsigned long long>
+                    - a peer sends the basic blocks it covered first
+                      since its last 'b', and gets back (in the same
+                      form) the blocks the other peers sent meanwhile;
+     'i' <int sent> <int received>
+                    - a peer (or main Avalanche) is out of work; sent
+                      and received count the inputs it gave to the
+                      other peers and got from them so far;
+     'w'            - a peer that was out of work got an input;
+     'q'            - main Avalanche finished work.
+   Addresses are sent as struct in_addr followed by <int port>.
+
+   The analysis is over when every registered peer is out of work and
+   every input given away has been received: an input on its way to a
+   peer that has not sent 'w' yet is counted by its sender only. A peer
+   that goes away while working takes its unreported inputs with it,
+   so after that only the first condition is checked. An av-agent that
+   got an input counts as a peer at work until its peer registers; if
+   the connection is closed before that, the input counts as received
+   and gone. When the analysis is over or main Avalanche is gone, av-dist
+   closes all connections: this tells the peers to finish. */
+
+struct Peer
+{
+  int fd;
+  struct in_addr addr;
+  int port;
+  bool registered;
+  size_t coverage_sent;
+  bool idle;
+  int sent;
+  int received;
+};
+
+vector<Peer> peers;
+// every basic block covered by some peer, in the order they were sent
+vector<unsigned long long> coverage;
+set<unsigned long long> covered;
+vector<int> waiting;
 int sfd;
 int mainfd = -1;
-
-set<int> starvating_a;
-set<int> starvating_g;
+// inputs given minus inputs received by the peers that went away
+int departed_balance = 0;
+// false once a peer went away while working
+bool exact_balance = true;
 
 void finalize_and_exit()
 {
-  fds.erase(find(fds.begin(), fds.end(), mainfd));
-
-  for (set<int>::iterator fd = starvating_a.begin(); fd != starvating_a.end(); fd++)
+  for (vector<Peer>::iterator peer = peers.begin(); peer != peers.end(); peer++)
   {
-    int tosend = -1;
-    try
-    {
-      writeToSocket(*fd, &tosend, sizeof(int));
-      readFromSocket(*fd, &tosend, sizeof(int));
-    }
-    catch (...)
-    {  
-      printf("connection with %d is down\n", *fd); 
-    }    
-    shutdown(*fd, SHUT_RDWR);
-    close(*fd);
-    fds.erase(find(fds.begin(), fds.end(), *fd));
+    shutdown(peer->fd, SHUT_RDWR);
+    close(peer->fd);
   }
-  for (set<int>::iterator fd = starvating_g.begin(); fd != starvating_g.end(); fd++)
+  shutdown(sfd, SHUT_RDWR);
+  close(sfd);
+  exit(0);
+}
+
+/* The address of peer as seen from the connection fd: peers that
+   connected through the loopback interface are on this host. */
+
+struct in_addr visibleAddr(const Peer& peer, int fd)
+{
+  if (ntohl(peer.addr.s_addr) >> 24 != 127)
   {
-    int tosend = -1;
-    try
-    {
-      writeToSocket(*fd, &tosend, sizeof(int));
-      readFromSocket(*fd, &tosend, sizeof(int));
-    }
-    catch (...)
-    { 
-      printf("connection with %d is down\n", *fd); 
-    }  
-    shutdown(*fd, SHUT_RDWR);
-    close(*fd);
-    fds.erase(find(fds.begin(), fds.end(), *fd));
+    return peer.addr;
   }
-  while (fds.size() > 0)
+  struct sockaddr_in local;
+  socklen_t len = sizeof(struct sockaddr_in);
+  if (getsockname(fd, (struct sockaddr*)&local, &len) < 0)
   {
-    fd_set readfds;
-    int max_d = 0;
-    FD_ZERO(&readfds);
+    return peer.addr;
+  }
+  return local.sin_addr;
+}
 
-    for (vector<int>::iterator fd = fds.begin(); fd != fds.end(); fd++)
+void sendAddr(int fd, const Peer& peer)
+{
+  struct in_addr addr = visibleAddr(peer, fd);
+  writeToSocket(fd, &addr, sizeof(struct in_addr));
+  writeToSocket(fd, &peer.port, sizeof(int));
+}
+
+Peer* findPeer(int fd)
+{
+  for (vector<Peer>::iterator peer = peers.begin(); peer != peers.end(); peer++)
+  {
+    if (peer->fd == fd)
     {
-      FD_SET(*fd, &readfds);
-      if (*fd > max_d) 
-      {
-        max_d = *fd;
-      }
+      return &(*peer);
     }
+  }
+  return NULL;
+}
 
-    select(max_d + 1, &readfds, NULL, NULL, NULL);
-
-    for (vector<int>::iterator fd = fds.begin(); fd != fds.end();)
+void removePeer(int fd)
+{
+  for (vector<Peer>::iterator peer = peers.begin(); peer != peers.end(); peer++)
+  {
+    if (peer->fd == fd)
     {
-      if (FD_ISSET(*fd, &readfds)) 
+      if (peer->registered)
       {
-        try
-        {
-          int tosend = -1;
-          writeToSocket(*fd, &tosend, sizeof(int));
-          readFromSocket(*fd, &tosend, sizeof(int));
-        }
-        catch (...) 
-        { 
-     
-        }
-        shutdown(*fd, SHUT_RDWR);
-        close(*fd);
-        vector<int>::iterator to_erase = fd; 
-        fd++;
-        if (fd == fds.end())
+        departed_balance += peer->sent - peer->received;
+        if (!peer->idle)
         {
-          fds.erase(to_erase);
-          break;
+          exact_balance = false;
         }
-        fds.erase(to_erase);
       }
       else
       {
-        fd++;
+        departed_balance -= peer->received;
       }
+      peers.erase(peer);
+      break;
     }
   }
-
-  shutdown(mainfd, SHUT_RDWR);
-  close(mainfd);
-  shutdown(sfd, SHUT_RDWR);
-  close(sfd);
-  exit(0);
+  vector<int>::iterator w = find(waiting.begin(), waiting.end(), fd);
+  if (w != waiting.end())
+  {
+    waiting.erase(w);
+  }
+  shutdown(fd, SHUT_RDWR);
+  close(fd);
 }
 
-void pass(int fd, void* valaddr, size_t size)
+/* Finish the analysis if no peer has work left. */
+
+void checkFinished()
 {
-  try
+  if (mainfd == -1)
   {
-    readFromSocket(mainfd, valaddr, size);
+    return;
   }
-  catch (const char* msg) 
-  { 
-    printf("connection with main avalanche is down\n"); 
-    finalize_and_exit(); 
-  } 
-  try
-  { 
-    writeToSocket(fd, valaddr, size);
+  int balance = departed_balance;
+  for (vector<Peer>::iterator peer = peers.begin(); peer != peers.end(); peer++)
+  {
+    if (!peer->registered && (peer->received == 0))
+    {
+      continue;
+    }
+    if (!peer->idle)
+    {
+      return;
+    }
+    balance += peer->sent - peer->received;
   }
-  catch (const char* msg) 
-  { 
-    printf("connection with %d is down\n", fd); 
-    fds.erase(find(fds.begin(), fds.end(), fd)); 
+  if (exact_balance && (balance != 0))
+  {
+    return;
   }
+  printf("all peers are out of work\n");
+  finalize_and_exit();
 }
 
-void pass(int fd, int length)
+void handleCommand(Peer& peer, char command)
 {
-  char* buf = new char[length];
-  try
+  if ((command == 'm') || (command == 'p'))
+  {
+    readFromSocket(peer.fd, &peer.port, sizeof(int));
+    peer.registered = true;
+    printf("%s %d is registered at port %d\n", (command == 'm') ? "main avalanche" : "peer",
+                                               peer.fd, peer.port);
+    if (command == 'm')
+    {
+      mainfd = peer.fd;
+      for (vector<int>::iterator w = waiting.begin(); w != waiting.end(); w++)
+      {
+        try
+        {
+          sendAddr(*w, peer);
+        }
+        catch (const char* msg)
+        {
+          printf("connection with %d is down\n", *w);
+        }
+      }
+      waiting.clear();
+    }
+  }
+  else if (command == 'a')
   {
-    readFromSocket(mainfd, buf, length);
+    Peer* main_peer = findPeer(mainfd);
+    if (main_peer != NULL)
+    {
+      sendAddr(peer.fd, *main_peer);
+    }
+    else
+    {
+      waiting.push_back(peer.fd);
+    }
   }
-  catch (const char* msg) 
-  { 
-    printf("connection with main avalanche is down\n"); 
-    finalize_and_exit(); 
-  } 
-  try
-  { 
-    writeToSocket(fd, buf, length);
+  else if (command == 'h')
+  {
+    peer.received = 1;
   }
-  catch (const char* msg) 
-  { 
-    printf("connection with %d is down\n", fd); 
-    fds.erase(find(fds.begin(), fds.end(), fd)); 
+  else if (command == 'l')
+  {
+    int num = 0;
+    for (vector<Peer>::iterator p = peers.begin(); p != peers.end(); p++)
+    {
+      if (p->registered && (p->fd != peer.fd))
+      {
+        num++;
+      }
+    }
+    writeToSocket(peer.fd, &num, sizeof(int));
+    for (vector<Peer>::iterator p = peers.begin(); p != peers.end(); p++)
+    {
+      if (p->registered && (p->fd != peer.fd))
+      {
+        sendAddr(peer.fd, *p);
+      }
+    }
+  }
+  else if (command == 'b')
+  {
+    int num = 0;
+    readFromSocket(peer.fd, &num, sizeof(int));
+    if ((num < 0) || (num > MAX_BLOCKS))
+    {
+      throw "bad number of basic blocks";
+    }
+    vector<unsigned long long> blocks(num);
+    if (num > 0)
+    {
+      readFromSocket(peer.fd, &blocks[0], num * sizeof(unsigned long long));
+    }
+    int unsent = coverage.size() - peer.coverage_sent;
+    writeToSocket(peer.fd, &unsent, sizeof(int));
+    if (unsent > 0)
+    {
+      writeToSocket(peer.fd, &coverage[peer.coverage_sent], unsent * sizeof(unsigned long long));
+    }
+    for (vector<unsigned long long>::iterator bb = blocks.begin(); bb != blocks.end(); bb++)
+    {
+      if (covered.insert(*bb).second)
+      {
+        coverage.push_back(*bb);
+      }
+    }
+    peer.coverage_sent = coverage.size();
+  }
+  else if (command == 'i')
+  {
+    readFromSocket(peer.fd, &peer.sent, sizeof(int));
+    readFromSocket(peer.fd, &peer.received, sizeof(int));
+    peer.idle = true;
+#ifdef DEBUG
+    printf("%d is out of work: %d inputs sent, %d received\n", peer.fd, 
+                                                              peer.sent, peer.received);
+#endif
+    checkFinished();
+  }
+  else if (command == 'w')
+  {
+    peer.idle = false;
+  }
+  else if (command == 'q')
+  {
+    printf("main avalanche finished work\n");
+    finalize_and_exit();
   }
-  delete[] buf;
 }
 
 void sig_handler(int signo)
 {
-  shutdown(sfd, SHUT_RDWR);
-  close(sfd);
-  for (int i = 0; i < fds.size() && fds.at(i) != mainfd; i ++)
-  {
-    close(fds.at(i));
-  }
-  exit(0);
+  finalize_and_exit();
 }
  
 int main(int argc, char** argv)
@@ -225,6 +354,7 @@ int main(int argc, char** argv)
   int on = 1;
   setsockopt(sfd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
   signal(SIGINT, sig_handler);
+  signal(SIGPIPE, SIG_IGN);
  
   memset(&stSockAddr, 0, sizeof(struct sockaddr_in));
   stSockAddr.sin_family = AF_INET;  
@@ -247,10 +377,6 @@ int main(int argc, char** argv)
     exit(EXIT_FAILURE);
   }
 
-  bool gameBegan = false;
-  int filenum;
-  bool sockets, datagrams;
- 
   for(;;)
   {
     fd_set readfds;
@@ -258,348 +384,80 @@ int main(int argc, char** argv)
     FD_ZERO(&readfds);
     FD_SET(sfd, &readfds);
 
-    for (vector<int>::iterator fd = fds.begin(); fd != fds.end(); fd++)
+    for (vector<Peer>::iterator peer = peers.begin(); peer != peers.end(); peer++)
     {
-      FD_SET(*fd, &readfds);
-      if (*fd > max_d) 
+      FD_SET(peer->fd, &readfds);
+      if (peer->fd > max_d) 
       {
-        max_d = *fd;
+        max_d = peer->fd;
       }
     }
 
-    if (gameBegan)
+    if (select(max_d + 1, &readfds, NULL, NULL, NULL) == -1)
     {
-#ifdef DEBUG 
-      printf("iterating through starvated\n");
-#endif
-      int size = starvating_a.size();
-      if (size > 0)
-      {
-        char c = 'q';
-        try
-        {
-          writeToSocket(mainfd, "a", 1);
-          writeToSocket(mainfd, &size, sizeof(int));
-          readFromSocket(mainfd, &c, 1);
-        }
-        catch (...)
-        { 
-          printf("connection with main avalanche is down\n"); 
-          finalize_and_exit();
-        }          
-        //first read 1 byte - either "r" or "q"
-        if (c == 'q')
-        {
-          printf("main avalanche finished work\n");
-          finalize_and_exit();
-        }
-        for (set<int>::iterator fd = starvating_a.begin(); fd != starvating_a.end();)
-        {
-          int namelength, length, startdepth, invertdepth, alarm, tracegrindAlarm, threads, dirLength, pluginlength;
-          int argsnum, filtersNum, filterlength, masklength;
-          bool useMemcheck, leaks, traceChildren, checkDanger, verbose, debug, programOutput, networkLog, suppressSubcalls, STPThreadsAuto;
-          filenum = 0;
-          try 
-          { 
-            readFromSocket(mainfd, &filenum, sizeof(int)); 
-          } 
-          catch (const char* msg) 
-          { 
-            printf("connection with main avalanche is down\n"); 
-            finalize_and_exit(); 
-          }
-#ifdef DEBUG 
-          printf("filenum=%d\n", filenum);
-#endif
-          if (filenum > 0)
-          {
-            try
-            {
-              writeToSocket(*fd, &filenum, sizeof(int));
-            }
-            catch (...)
-            {
-              printf("connection with %d is down\n", *fd);
-              fds.erase(find(fds.begin(), fds.end(), *fd));
-            }  
-            pass(*fd, &sockets, sizeof(bool));
-            pass(*fd, &datagrams, sizeof(bool));
-            for (int j = 0; j < filenum; j ++)
-            {
-              if (!sockets && !datagrams)
-              {
-                pass(*fd, &namelength, sizeof(int));
-                pass(*fd, namelength);
-              }
-              pass(*fd, &length, sizeof(int));
-              pass(*fd, length);
-            }
-            pass(*fd, &startdepth, sizeof(int));
-            pass(*fd, &invertdepth, sizeof(int));
-            pass(*fd, &alarm, sizeof(int));
-            pass(*fd, &tracegrindAlarm, sizeof(int));
-            pass(*fd, &threads, sizeof(int));
-            pass(*fd, &argsnum, sizeof(int));
-            pass(*fd, &leaks, sizeof(bool));
-            pass(*fd, &traceChildren, sizeof(bool));
-            pass(*fd, &checkDanger, sizeof(bool));
-            pass(*fd, &debug, sizeof(bool));
-            pass(*fd, &verbose, sizeof(bool));
-            pass(*fd, &programOutput, sizeof(bool));
-            pass(*fd, &networkLog, sizeof(bool));
-            pass(*fd, &suppressSubcalls, sizeof(bool));
-            pass(*fd, &STPThreadsAuto, sizeof(bool));
-
-            if (sockets)
-            {
-              int length, port;
-              pass(*fd, &length, sizeof(int));
-              pass(*fd, length);
-              pass(*fd, &port, sizeof(int));
-            }
-            pass(*fd, &pluginlength, sizeof(int));
-            printf("%d\n", pluginlength);
-            pass(*fd, pluginlength);
-
-            pass(*fd, &masklength, sizeof(int));
-            if (masklength != 0)
-            {
-              pass(*fd, masklength);
-            }
-
-            pass(*fd, &filtersNum, sizeof(int));
-            for (int i = 0; i < filtersNum; i++)
-            {
-              int length; 
-              pass(*fd, &length, sizeof(int));
-              pass(*fd, length);
-            }
-
-            pass(*fd, &filterlength, sizeof(int));
-            if (filterlength != 0)
-            {
-              pass(*fd, filterlength);
-            }
- 
-            pass(*fd, &dirLength, sizeof(int));
-            if (dirLength != 0)
-            {
-              pass(*fd, dirLength);
-            }
-
-            for (int i = 0; i < argsnum; i++)
-            {
-              int arglength;
-              pass(*fd, &arglength, sizeof(int));
-              pass(*fd, arglength);
-            }
-            set<int>::iterator to_erase = fd;
-            fd++;
-            if (fd == starvating_a.end())
-            {
-              starvating_a.erase(to_erase);
-              break;
-            }
-            starvating_a.erase(to_erase);
-          }
-          else
-          {
-            fd++;
-          }
-        }
-      }
-
-      size = starvating_g.size();
-      if (size > 0)
-      {
-        int length, startdepth;
-        char c = 'q';
-        try
-        {
-          writeToSocket(mainfd, "g", 1);
-          writeToSocket(mainfd, &size, sizeof(int));
-          readFromSocket(mainfd, &c, 1);
-        }
-        catch (...)
-        { 
-          printf("connection with main avalanche is down\n"); 
-          finalize_and_exit();
-        } 
-        //first read 1 byte - either "r" or "q"
-        if (c == 'q')
-        {
-          printf("main avalanche finished work\n");
-          finalize_and_exit();
-        }
-        for (set<int>::iterator fd = starvating_g.begin(); fd != starvating_g.end();)
-        {
-          for (int j = 0; j < filenum; j ++)
-          {
-            try 
-            { 
-              readFromSocket(mainfd, &length, sizeof(int)); 
-            } 
-            catch (const char* msg) 
-            { 
-              printf("connection with main avalanche is down\n"); 
-              finalize_and_exit(); 
-            }
-            if (length > 0)
-            {
-              try
-              {
-                writeToSocket(*fd, &length, sizeof(int));
-              }
-              catch (...)
-              {
-                printf("connection with %d is down\n", *fd);
-                fds.erase(find(fds.begin(), fds.end(), *fd));
-              }                
-              pass(*fd, length);
-            }
-            else 
-            {
-              break;
-            }
-          }
-          if (length > 0)
-          {
-            pass(*fd, &startdepth, sizeof(int));
-            set<int>::iterator to_erase = fd;
-            fd++;
-            if (fd == starvating_g.end())
-            {
-              starvating_g.erase(to_erase);
-              break;
-            }
-            starvating_g.erase(to_erase);
-          }
-          else
-          {
-            fd++;
-          }
-        }
-      }
-    }
-
-#ifdef DEBUG 
-    printf("selecting...\n");
-#endif
-    int res;
-    if ((starvating_a.size() == 0) && (starvating_g.size() == 0) || !gameBegan)
-    {
-      res = select(max_d + 1, &readfds, NULL, NULL, NULL);
-    }
-    else
-    {
-      struct timeval timer;
-      timer.tv_sec = 0;
-      timer.tv_usec = 0;
-      res = select(max_d + 1, &readfds, NULL, NULL, &timer);
-    }
-#ifdef DEBUG 
-    printf("done\n");
-#endif
-    if (res == -1) 
-    {
-      FD_ZERO(&readfds);
       perror("select failed");
+      continue;
     }
 
     if (FD_ISSET(sfd, &readfds)) 
     {
-      int cfd = accept(sfd, NULL, NULL);
+      struct sockaddr_in addr;
+      socklen_t len = sizeof(struct sockaddr_in);
+      int cfd = accept(sfd, (struct sockaddr*)&addr, &len);
       if (cfd < 0)
       {
         perror("error accept failed");
         close(sfd);
         exit(EXIT_FAILURE);
       }
-      fds.push_back(cfd); 
+      Peer peer;
+      peer.fd = cfd;
+      peer.addr = addr.sin_addr;
+      peer.port = 0;
+      peer.registered = false;
+      peer.coverage_sent = 0;
+      peer.idle = false;
+      peer.sent = 0;
+      peer.received = 0;
+      peers.push_back(peer);
       printf("connection with %d is set up\n", cfd);
     }
 
-#ifdef DEBUG 
-    printf("iterating through sockets...\n");
-#endif
     vector<int> to_erase;
-    for (vector<int>::iterator fd = fds.begin(); fd != fds.end(); fd++)
+    for (vector<Peer>::iterator peer = peers.begin(); peer != peers.end(); peer++)
     {
-      //printf("103\n");
-      if (FD_ISSET(*fd, &readfds)) 
+      if (!FD_ISSET(peer->fd, &readfds)) 
       {
-        //printf("106\n");
+        continue;
+      }
+      try 
+      { 
         char command;
-        try 
-        { 
-          readFromSocket(*fd, &command, 1); 
-        } 
-        catch (const char* msg) 
-        { 
-          if (*fd == mainfd)
-          {
-            printf("connection with main avalanche is down\n"); 
-            finalize_and_exit(); 
-          }
-          else
-          {
-            printf("connection with %d is down\n", *fd);
-            to_erase.push_back(*fd);
-            continue;
-          }
-        }
-        if (command == 'm') 
-        {
-#ifdef DEBUG 
-          printf("received m\n");
-#endif
-          mainfd = *fd;
-          gameBegan = true;
-          int size = fds.size();
-          try 
-          { 
-            writeToSocket(mainfd, &size, sizeof(int)); 
-          } 
-          catch (const char* msg) 
-          { 
-            printf("connection with main avalanche is down\n"); 
-            finalize_and_exit(); 
-          }
-        }
-        else if (command == 'q')
-        {
-          printf("main avalanche finished work\n");
-          finalize_and_exit();
-        }
-        else if (command == 'g')
-        {
+        readFromSocket(peer->fd, &command, 1); 
 #ifdef DEBUG 
-          printf("added %d to starvated_g\n", *fd);
+        printf("received %c from %d\n", command, peer->fd);
 #endif
-          starvating_g.insert(*fd);
-        }         
-        else //game not began
+        handleCommand(*peer, command);
+      } 
+      catch (const char* msg) 
+      { 
+        if (peer->fd == mainfd)
         {
-#ifdef DEBUG 
-          printf("added %d to starvated_a\n", *fd);
-#endif
-          starvating_a.insert(*fd);
+          printf("connection with main avalanche is down\n"); 
+          finalize_and_exit(); 
         }
+        printf("connection with %d is down\n", peer->fd);
+        to_erase.push_back(peer->fd);
       }
     }
     for (vector<int>::iterator fd = to_erase.begin(); fd != to_erase.end(); fd ++)
     {
-      fds.erase(find(fds.begin(), fds.end(), *fd));
-      starvating_a.erase(*fd);
-      starvating_g.erase(*fd);
+      removePeer(*fd);
+    }
+    if (!to_erase.empty())
+    {
+      checkFinished();
     }
   }
-  for (int i = 0; i < fds.size() && fds.at(i) != mainfd; i ++)
-  {
-    close(fds.at(i));
-  }
-  close(mainfd);
-  close(sfd);
   return 0;
 }
-
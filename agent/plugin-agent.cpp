@@ -25,6 +25,9 @@
 #include <sys/socket.h>
 #include <sys/stat.h>
 #include <sys/wait.h>
+#ifdef __linux__
+#include <sys/sendfile.h>
+#endif
 #include <netinet/in.h>
 #include <arpa/inet.h>
 #include <iostream>
@@ -35,6 +38,8 @@
 #include <cstdio>
 #include <cstdlib>
 #include <vector>
+#include <map>
+#include <list>
 #include <unistd.h>
 #include <cerrno>
 
@@ -50,6 +55,26 @@ enum Kind
 
 #define DEBUG
 
+#define BUF_SIZE 65536
+
+/* Files avalanche sends are described first (size and content hash),
+   and avalanche sends the contents of only those that the agent does not
+   hold in its cache. The cache keeps the last CACHE_SIZE contents. */
+
+#define CACHE_SIZE 32
+
+struct FileDescr
+{
+    int size;
+    unsigned long long hash;
+};
+
+struct PendingFile
+{
+    string name;
+    FileDescr descr;
+};
+
 int avalanche_fd;
 pid_t pid = 0;
 Kind kind;
@@ -62,6 +87,9 @@ bool network;
 bool check_argv;
 string temp_dir;
 bool killed = false;
+vector<PendingFile> pending_files;
+map<unsigned long long, string> cache;
+list<unsigned long long> cache_order;
 
 static bool parseArg(char **p_arg)
 {
@@ -94,6 +122,13 @@ static bool parseArg(char **p_arg)
     {
         check_argv = true;
     }
+    else if (strstr(arg, "--replace=") && strcmp(arg, "--replace=yes"))
+    {
+        /* The data to replace network input with is kept in temp_dir */
+        free(arg);
+        string new_arg = string("--replace=") + temp_dir + string("replace_data");
+        *p_arg = strdup(new_arg.c_str());
+    }
     else if (strstr(arg, "--tool=tracegrind"))
     {
         kind = TG;
@@ -128,11 +163,10 @@ void sigalarm_handler(int signo)
     }
 }    
 
-static void readToFile(string file_name)
+static void readToFile(string file_name, int length)
 {
-    int length, i = 0;
-    char c;
-    readFromSocket(avalanche_fd, &length, sizeof(int));
+    int i = 0;
+    char buf[BUF_SIZE];
     int file_d = 
            open(file_name.c_str(), O_CREAT | O_TRUNC | O_WRONLY, 
                 S_IRUSR | S_IROTH | S_IRGRP | S_IWUSR | S_IWOTH | S_IWGRP);
@@ -142,16 +176,158 @@ static void readToFile(string file_name)
     }
     while (i < length)
     {
-        readFromSocket(avalanche_fd, &c, 1);
-        if (write(file_d, &c, 1) < 1)
+        int chunk = (length - i > BUF_SIZE) ? BUF_SIZE : length - i;
+        try
+        {
+            readFromSocket(avalanche_fd, buf, chunk);
+        }
+        catch (const char*)
+        {
+            close(file_d);
+            throw;
+        }
+        if (write(file_d, buf, chunk) < chunk)
         {
             close(file_d);
             throw "error writing to file";
         }
-        i ++;
+        i += chunk;
     }
     close(file_d);
 }
+
+/* Send size bytes of file_d to out_fd, in the kernel where possible. */
+
+static bool copyData(int file_d, int out_fd, int size)
+{
+    char buf[BUF_SIZE];
+    int done = 0;
+#ifdef __linux__
+    while (done < size)
+    {
+        ssize_t s = sendfile(out_fd, file_d, NULL, size - done);
+        if ((s < 0) && (errno == EINTR))
+        {
+            continue;
+        }
+        if (s <= 0)
+        {
+            break;
+        }
+        done += s;
+    }
+#endif
+    while (done < size)
+    {
+        ssize_t r = read(file_d, buf, (size - done > BUF_SIZE) ? BUF_SIZE : size - done);
+        if (r <= 0)
+        {
+            return false;
+        }
+        for (ssize_t w = 0; w < r; )
+        {
+            ssize_t s = write(out_fd, buf + w, r - w);
+            if ((s < 0) && (errno == EINTR))
+            {
+                continue;
+            }
+            if (s <= 0)
+            {
+                return false;
+            }
+            w += s;
+        }
+        done += r;
+    }
+    return true;
+}
+
+static bool copyFile(string from, string to, int size)
+{
+    int from_d = open(from.c_str(), O_RDONLY);
+    if (from_d < 0)
+    {
+        return false;
+    }
+    int to_d = open(to.c_str(), O_CREAT | O_TRUNC | O_WRONLY, 
+                    S_IRUSR | S_IROTH | S_IRGRP | S_IWUSR | S_IWOTH | S_IWGRP);
+    if (to_d < 0)
+    {
+        close(from_d);
+        return false;
+    }
+    bool res = copyData(from_d, to_d, size);
+    close(from_d);
+    close(to_d);
+    return res;
+}
+
+static bool restoreFromCache(const PendingFile &file)
+{
+    map<unsigned long long, string>::iterator c = cache.find(file.descr.hash);
+    if ((c == cache.end()) || !copyFile(c->second, file.name, file.descr.size))
+    {
+        return false;
+    }
+    cache_order.remove(file.descr.hash);
+    cache_order.push_back(file.descr.hash);
+    return true;
+}
+
+static void addToCache(const PendingFile &file)
+{
+    if (cache.find(file.descr.hash) != cache.end())
+    {
+        return;
+    }
+    if (cache.size() >= CACHE_SIZE)
+    {
+        unlink(cache[cache_order.front()].c_str());
+        cache.erase(cache_order.front());
+        cache_order.pop_front();
+    }
+    ostringstream ss;
+    ss << temp_dir << "cache_" << hex << file.descr.hash;
+    if (copyFile(file.name, ss.str(), file.descr.size))
+    {
+        cache[file.descr.hash] = ss.str();
+        cache_order.push_back(file.descr.hash);
+    }
+}
+
+static void describeFile(string file_name)
+{
+    PendingFile file;
+    file.name = file_name;
+    readFromSocket(avalanche_fd, &file.descr, sizeof(FileDescr));
+    pending_files.push_back(file);
+}
+
+/* Tell avalanche which of the described files it has to send, and
+   receive them. */
+
+static void receiveFiles()
+{
+    if (pending_files.empty())
+    {
+        return;
+    }
+    vector<char> need(pending_files.size());
+    for (int i = 0; i < pending_files.size(); i ++)
+    {
+        need[i] = restoreFromCache(pending_files[i]) ? 0 : 1;
+    }
+    writeToSocket(avalanche_fd, &need[0], need.size());
+    for (int i = 0; i < pending_files.size(); i ++)
+    {
+        if (need[i])
+        {
+            readToFile(pending_files[i].name, pending_files[i].descr.size);
+            addToCache(pending_files[i]);
+        }
+    }
+    pending_files.clear();
+}
             
 
 static int readAndExec(const string &prog_dir, int argc, char** argv)
@@ -208,21 +384,22 @@ static int readAndExec(const string &prog_dir, int argc, char** argv)
             {
                 file_name ++;
             }
-            readToFile(file_name);
+            describeFile(file_name);
         }
     }
     if (check_prediction)
     {
-        readToFile(temp_dir + string("prediction.log"));
+        describeFile(temp_dir + string("prediction.log"));
     }
     if (network)
     {
-        readToFile(temp_dir + string("replace_data"));
+        describeFile(temp_dir + string("replace_data"));
     }
     if (check_argv)
     {
-        readToFile(temp_dir + string("arg_lengths"));
+        describeFile(temp_dir + string("arg_lengths"));
     }
+    receiveFiles();
     args[args_num + extra_args] = NULL;
     pid = fork();
     if (pid == 0)
@@ -236,10 +413,10 @@ static int readAndExec(const string &prog_dir, int argc, char** argv)
         cout << endl;
 #endif
         int tmpout_fd = 
-               open("tmp_stdout", O_CREAT | O_TRUNC | O_WRONLY,
+               open((temp_dir + string("tmp_stdout")).c_str(), O_CREAT | O_TRUNC | O_WRONLY,
                     S_IRUSR | S_IROTH | S_IRGRP | S_IWUSR | S_IWOTH | S_IWGRP);
         int tmperr_fd = 
-               open("tmp_stderr", O_CREAT | O_TRUNC | O_WRONLY,
+               open((temp_dir + string("tmp_stderr")).c_str(), O_CREAT | O_TRUNC | O_WRONLY,
                     S_IRUSR | S_IROTH | S_IRGRP | S_IWUSR | S_IWOTH | S_IWGRP);
         dup2(tmpout_fd, STDOUT_FILENO);
         dup2(tmperr_fd, STDERR_FILENO);
@@ -272,7 +449,7 @@ static int readAndExec(const string &prog_dir, int argc, char** argv)
     if ((WEXITSTATUS(status) == 126) ||
         (WEXITSTATUS(status) == 127)) //Problem with executable
     {
-        int fd = open("tmp_stderr", O_RDONLY, S_IRUSR);
+        int fd = open((temp_dir + string("tmp_stderr")).c_str(), O_RDONLY, S_IRUSR);
         lseek(fd, SEEK_SET, 0);
         struct stat f_stat;
         fstat(fd, &f_stat);
@@ -290,73 +467,88 @@ static int readAndExec(const string &prog_dir, int argc, char** argv)
     return ((WIFEXITED(status)) ? 0 : -1);
 }
 
-static void writeFromFile(string file_name)
-{
-    int file_d = open(file_name.c_str(), O_RDONLY, S_IRUSR);
-    if (file_d < 0)
-    {
-        throw file_name.c_str();
-    }
-    struct stat file_info;
-    if (fstat(file_d, &file_info) < 0)
-    {
-        close(file_d);
-        throw "fstat failed";
-    }
-    int size = file_info.st_size;
-    char c;
-    int i = 0;
-    writeToSocket(avalanche_fd, &size, sizeof(int));
-    while(i < size)
-    {
-        if (read(file_d, &c, 1) < 1)
-        {
-            close(file_d);
-            throw "error reading from file";
-        }
-        writeToSocket(avalanche_fd, &c, 1);
-        i ++;
-    }
-    close(file_d);
-}
+/* Send the result of a run as one message: the return code, the number
+   of files, their sizes and then their contents. */
 
 static int passResult(int ret_code)
 {
-    writeToSocket(avalanche_fd, &ret_code, sizeof(int));
     if (ret_code == 1)
     {
+        writeToSocket(avalanche_fd, &ret_code, sizeof(int));
         return -1;
     }
+    vector<string> files;
     switch(kind)
     {
         case TG: 
-            writeFromFile(temp_dir + string("offsets.log"));
+            files.push_back(temp_dir + string("offsets.log"));
             if (dump_prediction)
             {
-                writeFromFile(temp_dir + string("actual.log"));
+                files.push_back(temp_dir + string("actual.log"));
             }
             if (dump_calls)
             {
-                writeFromFile("calldump.log");
+                files.push_back("calldump.log");
             }
             if (network)
             {
-                writeFromFile(temp_dir + string("replace_data"));
+                files.push_back(temp_dir + string("replace_data"));
             }
             if (check_argv)
             {
-                writeFromFile(temp_dir + string("argv.log"));
+                files.push_back(temp_dir + string("argv.log"));
             }
             break;
         case OTHER:
             if (!no_coverage)
             {
-                writeFromFile(temp_dir + string("basic_blocks.log"));
+                files.push_back(temp_dir + string("basic_blocks.log"));
             }
-            writeFromFile(temp_dir + string("execution.log"));
+            files.push_back(temp_dir + string("execution.log"));
             break;
         default: break;
     }
+    int count = files.size();
+    vector<int> file_d(count), sizes(count);
+    for (int i = 0; i < count; i ++)
+    {
+        file_d[i] = open(files[i].c_str(), O_RDONLY, S_IRUSR);
+        struct stat file_info;
+        if ((file_d[i] < 0) || (fstat(file_d[i], &file_info) < 0))
+        {
+            for (int j = 0; j <= i; j ++)
+            {
+                close(file_d[j]);
+            }
+            throw files[i].c_str();
+        }
+        sizes[i] = file_info.st_size;
+    }
+    vector<int> header;
+    header.push_back(ret_code);
+    header.push_back(count);
+    header.insert(header.end(), sizes.begin(), sizes.end());
+    bool sent = true;
+    try
+    {
+        writeToSocket(avalanche_fd, &header[0], header.size() * sizeof(int));
+    }
+    catch (const char*)
+    {
+        sent = false;
+    }
+    for (int i = 0; i < count; i ++)
+    {
+        if (sent && !copyData(file_d[i], avalanche_fd, sizes[i]))
+        {
+            sent = false;
+        }
+        close(file_d[i]);
+    }
+    if (!sent)
+    {
+        throw "error writing to socket";
+    }
     return 0;
 }
 
@@ -380,12 +572,121 @@ static string findInPath(const string &name)
     return string();
 }
 
+/* Sessions share the directory plugin-agent was started in, so each of
+   several sessions gets a directory of its own. */
+
+static void makeTempDir(string base_dir, bool separate)
+{
+    temp_dir = base_dir;
+    if ((temp_dir != "./") || separate)
+    {
+        if (*(temp_dir.end() - 1) != '/')
+        {
+            temp_dir += string("/");
+        }
+        temp_dir += string("avalanche-XXXXXX");
+        vector <char> dir_name(temp_dir.begin(), temp_dir.end());
+        dir_name.push_back('\0');
+        if (mkdtemp(&dir_name[0]) == NULL)
+        {
+            perror("mkdtemp failed");
+            temp_dir = string("");
+            return;
+        }
+        temp_dir = string(&dir_name[0]) + '/';
+        return;
+    }
+    if (mkdir(temp_dir.c_str(), S_IRWXU) == -1)
+    {
+        if (errno != EEXIST)
+        {
+            perror("mkdir failed");
+            temp_dir = string("");
+        }
+    }
+}
+
+static void serveSession(const string &prog_dir, int argc, char** argv)
+{
+    signal(SIGALRM, sigalarm_handler);
+
+    try {
+        writeToSocket(avalanche_fd, "avalanche", strlen("avalanche"));
+        int size = sizeof(long);
+        writeToSocket(avalanche_fd, &size, sizeof(int));
+        while(1)
+        {
+            no_coverage = false;
+            dump_prediction = false;
+            check_prediction = false;
+            check_danger = false;
+            dump_calls = false;
+            network = false;
+            check_argv = false;
+            int res = readAndExec(prog_dir, argc, argv);
+            if (res == -2)
+            {
+                cout << "end of communication: no more requests" << endl;
+                break;
+            }
+            if (passResult(res) < 0)
+            {
+                break;
+            }
+        }
+    }
+    catch(const char * error_msg)
+    {
+        cout << "end of communication: " << error_msg << endl;
+    }
+    shutdown(avalanche_fd, SHUT_RDWR);
+    unlink((temp_dir + string("tmp_stdout")).c_str());
+    unlink((temp_dir + string("tmp_stderr")).c_str());
+    unlink((temp_dir + string("trace.log")).c_str());
+    unlink((temp_dir + string("dangertrace.log")).c_str());
+    unlink((temp_dir + string("actual.log")).c_str());
+    unlink((temp_dir + string("arg_lengths")).c_str());
+    unlink((temp_dir + string("replace_data")).c_str());
+    unlink((temp_dir + string("prediction.log")).c_str());
+    unlink((temp_dir + string("basic_blocks.log")).c_str());
+    unlink((temp_dir + string("execution.log")).c_str());
+    unlink((temp_dir + string("argv.log")).c_str());
+    unlink((temp_dir + string("divergence.log")).c_str());
+    unlink((temp_dir + string("offsets.log")).c_str());
+    for (map<unsigned long long, string>::iterator c = cache.begin(); c != cache.end(); c ++)
+    {
+        unlink(c->second.c_str());
+    }
+
+    /* We don't pass thread number with options so we don't know which
+             files were created and have to use exec */
+             
+    //system((string("rm ") + temp_dir + string("replace_data*")).c_str());
+    
+    /* We have argv.log_i with multiple threads for STP since argv.log
+             is treated like an input file specified by '--filename=' */
+             
+    //system((string("rm ") + temp_dir + string("argv.log*")).c_str());
+    //system((string("rm ") + temp_dir + string("basic_blocks*.log")).c_str());
+    if ((temp_dir != "") && (temp_dir != "./"))
+    {
+        if (rmdir(temp_dir.c_str()) < 0)
+        {
+            if (errno != ENOENT)
+            {
+                perror((string("cannot delete ") + temp_dir).c_str());
+            }
+        }
+    }
+}
+
 int main(int argc, char** argv)
 {
     bool opt_error = false;
     int port = 0;
+    int sessions = 1;
     string host = string("");
-    temp_dir = string("./");
+    string base_dir = string("./");
     for (int i = 1; i < argc; i ++)
     {
         if (strstr(argv[i], "--port=") == argv[i])
@@ -403,39 +704,22 @@ int main(int argc, char** argv)
         }
         else if (strstr(argv[i], "--temp-dir=") == argv[i])
         {
-            temp_dir = string(argv[i] + strlen("--temp-dir="));
+            base_dir = string(argv[i] + strlen("--temp-dir="));
         }
-    }
-    if (opt_error || (port == 0))
-    {
-        cout << "Usage: plugin-agent --port=<port> [--host=<host>] [--temp-dir=<dir>]\n";
-        exit(EXIT_FAILURE);
-    }
-    if (temp_dir != "./")
-    {
-        if (*(temp_dir.end() - 1) != '/')
-        {
-            temp_dir += string("/");
-        }
-#define TMP_DIR_TEMPLATE_SIZE 6
-        temp_dir += string("avalanche-");
-        srand(time(NULL));
-        for (int i = 0; i < TMP_DIR_TEMPLATE_SIZE; i ++)
+        else if (strstr(argv[i], "--sessions=") == argv[i])
         {
-            ostringstream ss;
-            ss << (char)('a' + rand() % ('z' - 'a'));
-            temp_dir += ss.str();
+            sessions = atoi(argv[i] + strlen("--sessions="));
+            if (sessions <= 0)
+            {
+                opt_error = true;
+                break;
+            }
         }
-        temp_dir += '/';
-#undef TMP_DIR_TEMPLATE_SIZE
     }
-    if (mkdir(temp_dir.c_str(), S_IRWXU) == -1)
+    if (opt_error || (port == 0))
     {
-        if (errno != EEXIST)
-        {
-            perror("mkdir failed");
-            temp_dir = string("");
-        }
+        cout << "Usage: plugin-agent --port=<port> [--host=<host>] [--temp-dir=<dir>] [--sessions=<number>]\n";
+        exit(EXIT_FAILURE);
     }
     string prog_name = argv[0];
     size_t slash_pos = prog_name.find_last_of('/');
@@ -445,14 +729,12 @@ int main(int argc, char** argv)
     }
     string prog_dir = prog_name.substr(0, slash_pos + 1);
 
+    /* With several sessions (one connection each), every session is
+       served by a child process of its own. */
+
+    vector<int> fds;
     int socket_fd;
     struct sockaddr_in st_socket_addr;
-    socket_fd = socket(PF_INET, SOCK_STREAM, IPPROTO_TCP);
-    if(socket_fd == -1)
-    {
-        perror("can not create socket");
-        exit(EXIT_FAILURE);
-    }
     if (host != "")
     {
         memset(&st_socket_addr, 0, sizeof(struct sockaddr_in));
@@ -466,16 +748,31 @@ int main(int argc, char** argv)
             exit(EXIT_FAILURE);
         }
 
-        if (connect(socket_fd, (const struct sockaddr*)&st_socket_addr, sizeof(struct sockaddr_in)) < 0)
+        for (int i = 0; i < sessions; i ++)
         {
-            perror("connect failed");
-            close(socket_fd);
-            exit(EXIT_FAILURE);
+            socket_fd = socket(PF_INET, SOCK_STREAM, IPPROTO_TCP);
+            if(socket_fd == -1)
+            {
+                perror("can not create socket");
+                exit(EXIT_FAILURE);
+            }
+            if (connect(socket_fd, (const struct sockaddr*)&st_socket_addr, sizeof(struct sockaddr_in)) < 0)
+            {
+                perror("connect failed");
+                close(socket_fd);
+                exit(EXIT_FAILURE);
+            }
+            fds.push_back(socket_fd);
         }
-        avalanche_fd = socket_fd;
     }
     else
     {
+        socket_fd = socket(PF_INET, SOCK_STREAM, IPPROTO_TCP);
+        if(socket_fd == -1)
+        {
+            perror("can not create socket");
+            exit(EXIT_FAILURE);
+        }
         int on = 1;
         setsockopt(socket_fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
 
@@ -498,84 +795,48 @@ int main(int argc, char** argv)
             exit(EXIT_FAILURE);
         }
 
-        avalanche_fd = accept(socket_fd, NULL, NULL);
-        if (avalanche_fd < 0)
-        {
-            perror("accept failed");
-            close(socket_fd);
-            exit(EXIT_FAILURE);
-        }
-        close(socket_fd);
-    }
-
-    signal(SIGALRM, sigalarm_handler);
-
-    try {
-        writeToSocket(avalanche_fd, "avalanche", strlen("avalanche"));
-        int size = sizeof(long);
-        writeToSocket(avalanche_fd, &size, sizeof(int));
-        while(1)
+        for (int i = 0; i < sessions; i ++)
         {
-            no_coverage = false;
-            dump_prediction = false;
-            check_prediction = false;
-            check_danger = false;
-            dump_calls = false;
-            network = false;
-            check_argv = false;
-            int res = readAndExec(prog_dir, argc, argv);
-            if (res == -2)
+            int fd = accept(socket_fd, NULL, NULL);
+            if (fd < 0)
             {
-                cout << "end of communication: no more requests" << endl;
-                break;
-            }
-            if (passResult(res) < 0)
-            {
-                break;
+                perror("accept failed");
+                close(socket_fd);
+                exit(EXIT_FAILURE);
             }
+            fds.push_back(fd);
         }
+        close(socket_fd);
     }
-    catch(const char * error_msg)
+
+    if (sessions == 1)
     {
-        cout << "end of communication: " << error_msg << endl;
+        makeTempDir(base_dir, false);
+        avalanche_fd = fds[0];
+        serveSession(prog_dir, argc, argv);
+        return 0;
     }
-    shutdown(avalanche_fd, SHUT_RDWR);
-    unlink("tmp_stdout");
-    unlink("tmp_stderr");
-    unlink((temp_dir + string("trace.log")).c_str());
-    unlink((temp_dir + string("dangertrace.log")).c_str());
-    unlink((temp_dir + string("actual.log")).c_str());
-    unlink((temp_dir + string("arg_lengths")).c_str());
-    unlink((temp_dir + string("replace_data")).c_str());
-    unlink((temp_dir + string("prediction.log")).c_str());
-    unlink((temp_dir + string("basic_blocks.log")).c_str());
-    unlink((temp_dir + string("execution.log")).c_str());
-    unlink((temp_dir + string("argv.log")).c_str());
-    unlink((temp_dir + string("divergence.log")).c_str());
-    unlink((temp_dir + string("offsets.log")).c_str());
-
-    /* STP multi-threading currently cannot be used in split mode */
-    
-    /* We don't pass thread number with options so we don't know which
-             files were created and have to use exec */
-             
-    //system((string("rm ") + temp_dir + string("replace_data*")).c_str());
-    
-    /* We have argv.log_i with multiple threads for STP since argv.log
-             is treated like an input file specified by '--filename=' */
-             
-    //system((string("rm ") + temp_dir + string("argv.log*")).c_str());
-    //system((string("rm ") + temp_dir + string("basic_blocks*.log")).c_str());
-    if ((temp_dir != "") && (temp_dir != "./"))
+    for (int i = 0; i < sessions; i ++)
     {
-        if (rmdir(temp_dir.c_str()) < 0)
+        if (fork() == 0)
         {
-            if (errno != ENOENT)
+            for (int j = 0; j < sessions; j ++)
             {
-                perror((string("cannot delete ") + temp_dir).c_str());
+                if (j != i)
+                {
+                    close(fds[j]);
+                }
             }
+            makeTempDir(base_dir, true);
+            avalanche_fd = fds[i];
+            serveSession(prog_dir, argc, argv);
+            exit(0);
         }
     }
+    for (int i = 0; i < sessions; i ++)
+    {
+        close(fds[i]);
+    }
+    while (wait(NULL) > 0);
     return 0;
 }
-        
@@ -92,33 +92,56 @@ public:
 
     void run();
 
-    int processQuery(Input* first_input, bool* actual, unsigned long first_depth, unsigned long cur_depth, unsigned int thread_index = 0);
+    int runTracegrind(Input* fi, int runs, int tracer = 0);
+    int processTracedInput(Input* fi, unsigned int score, unsigned int depth, int exit_code, int runs);
+
+    int processQuery(Input* first_input, bool* actual, unsigned long first_depth, unsigned long cur_depth, unsigned int thread_index = 0, std::string branch_site = "");
 
     int processTraceSequental(Input* first_input, unsigned long first_depth);
     int processTraceParallel(Input* first_input, unsigned long first_depth);
 
-    int requestNonZeroInput();
+    void requestNonZeroInput();
 
-    void getTracegrindOptions(std::vector <std::string> &plugin_opts);
-    void getCovgrindOptions(std::vector <std::string> &plugin_opts, std::string fileNameModifier, bool addNoCoverage);
+    void getTracegrindOptions(std::vector <std::string> &plugin_opts, int tracer = 0);
+    void getCovgrindOptions(std::vector <std::string> &plugin_opts, std::string fileNameModifier, bool addNoCoverage, std::string plugin);
 
     int calculateScore(std::string filaNameModifier = "");
-    int checkAndScore(Input* input, bool addNoCoverage, bool first_run, std::string fileNameModifier = "");
+    bool coverBasicBlock(unsigned long bb);
+    void shareCoverage();
+    int checkAndScore(Input* input, bool addNoCoverage, bool first_run, std::string fileNameModifier = "", std::string plugin = "", int remote_session = 0);
+    int checkAndScoreTiered(Input* input, bool addNoCoverage, std::string fileNameModifier = "");
+    int runNative(Input* input, std::string fileNameModifier = "");
 
     int dumpError(Input *input, Error* error);
     
     bool updateArgv(Input* input);
 
     int checkDivergence(Input* first_input, int score);
+    bool abortOnDivergence(Input* input);
+    int getDivergenceDepth();
 
     void updateInput(Input* input);
 
-    void talkToServer();
+    int startStealServer();
+    void stopStealServer();
+    void serveRequest(int fd);
+    Input* takeSpareInput(int peers, unsigned int min_score, unsigned int &depth);
+    void sendOptions(int fd, Input* input);
+    void sendInput(int fd, Input* input, unsigned int depth);
+    Input* recvInput(int fd, unsigned int &depth);
+    bool stealInput(unsigned int min_score);
     
     int parseOffsetLog(std::vector<FileOffsetSet> &used_offsets);
+
+    int dumpPhaseHints(Input* input);
     
     void addInput(Input* input, unsigned int depth, unsigned int score);
 
+    bool markInvertedBranch(std::string branch_site, bool direction);
+    bool isAttemptedQuery(std::string branch_site, unsigned long long prefix_hash, bool direction);
+    unsigned int estimateScore(Input* input);
+    int scoreTopInputs();
+
     OptionConfig* getConfig() { return config; }
     static std::string getTempDir();
 
@@ -130,7 +153,12 @@ private:
     std::vector <std::string> cur_argv;
     std::set<unsigned long> delta_basicBlocksCovered;
     std::set<unsigned long> basicBlocksCovered;
+    std::vector<unsigned long> unshared_basicBlocks;
+    std::set<std::string> invertedBranches;
     int divergences;
+    std::set<std::string> attemptedQueries;
+    unsigned long skippedQueries;
+    unsigned long abortedTraces;
 };
 
 
@@ -51,14 +51,24 @@ public:
     FileBuffer(char* buf);
 
     virtual FileBuffer* forkInput(FileBuffer *stp_file, 
-                                  std::vector<FileOffsetSet> &used_offsets);
+                                  std::vector<FileOffsetSet> &used_offsets,
+                                  std::string name_modifier = "");
 
     virtual int dumpFile(std::string file_name = "");
 
     int cutQueryAndDump(std::string file_name, bool do_invert = false);
 
+    FileBuffer* cutQuery(bool do_invert = false);
+
+    int skipQuery();
+
+    std::string getQueryBranchSite();
+
+    virtual std::string getArrayName(std::string name_modifier = "") const;
+
     virtual int applySTPSolution(char* buf, 
-                                 std::vector<FileOffsetSet> &used_offsets);
+                                 std::vector<FileOffsetSet> &used_offsets,
+                                 std::string name_modifier = "");
     
     std::string getName() const
     { return name; }
@@ -77,6 +87,8 @@ protected:
   
     FileBuffer() {}
 
+    void dropQuery(char* query, bool do_invert);
+
 };
 
 #define PERM_R_W   S_IRUSR | S_IROTH | S_IRGRP | \
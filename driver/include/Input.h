@@ -35,7 +35,7 @@ public:
     Input();
     ~Input();
 
-    int dumpFiles(std::string name_modifier = "");
+    int dumpFiles(std::string name_modifier = "", std::string temp_dir = "");
     int dumpExploit(std::string file_name, bool predict,
                     std::string name_modifier = "");
 
@@ -44,6 +44,10 @@ public:
     Input* parent;
     bool* prediction;
     int prediction_size;
+    unsigned int score;
+    bool estimated;
+    bool new_target;
+    bool diverged;
 };
 
 #endif
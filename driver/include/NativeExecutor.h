@@ -0,0 +1,54 @@
+/*----------------------------------------------------------------------------------------*/
+/*------------------------------------- AVALANCHE ----------------------------------------*/
+/*------ Driver. Coordinates other processes, traverses conditional jumps tree.  ---------*/
+/*----------------------------------- NativeExecutor.h -----------------------------------*/
+/*----------------------------------------------------------------------------------------*/
+
+/*
+   Copyright (C) 2026 Avalanche contributors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef __NATIVE_EXECUTOR__H__
+#define __NATIVE_EXECUTOR__H__
+
+#include "LocalExecutor.h"
+
+#include <vector>
+#include <string>
+
+/* Runs the analyzed program without Valgrind (tier 0 of --tiered-check).
+   Only tells whether the program has finished normally, has been killed
+   by a signal or has not finished within the timeout. */
+
+class NativeExecutor : public LocalExecutor
+{
+public:
+    enum Status {FINISHED = 0, CRASHED = 1, TIMEOUT = 2};
+
+    NativeExecutor(const std::vector<std::string> &cmd, unsigned int timeout);
+
+    int run(int thread_index = 0);
+    ~NativeExecutor();
+
+    int getSignal() const
+    { return term_signal; }
+
+private:
+    unsigned int timeout;
+    int term_signal;
+};
+
+
+#endif //__NATIVE_EXECUTOR__H__
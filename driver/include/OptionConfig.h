@@ -39,6 +39,10 @@ public:
                     protectMainAgent(false),
                     STPThreadsAuto(false),
                     checkDanger(false),
+                    lazyScoring(false),
+                    tieredCheck(false),
+                    divergencePolicy(std::string("")),
+                    parentPhase(false),
                     verbose (false),
                     programOutput (false),
                     networkLog (false),
@@ -48,6 +52,7 @@ public:
                     datagrams(false),
                     distributed(false), 
                     agent(false), 
+                    peer(false), 
                     suppressSubcalls(false),
                     dumpCalls(false),
                     leaks(false),
@@ -66,8 +71,11 @@ public:
                     remoteValgrind(std::string("")),
                     port(65536),
                     distPort(65536),
+                    distFd(-1),
                     remotePort(65536),
+                    remoteSessions(1),
                     STPThreads(0),
+                    tracers(1),
                     checkArgv(std::string("")),
                     resultDir(std::string("")),
                     agentDir(std::string("")),
@@ -82,7 +90,12 @@ public:
         protectMainAgent= opt_config->protectMainAgent;
         distributed     = opt_config->distributed;
         agent           = opt_config->agent;
+        peer            = opt_config->peer;
         checkDanger     = opt_config->checkDanger;
+        lazyScoring     = opt_config->lazyScoring;
+        tieredCheck     = opt_config->tieredCheck;
+        divergencePolicy= opt_config->divergencePolicy;
+        parentPhase     = opt_config->parentPhase;
         verbose         = opt_config->verbose;
         programOutput   = opt_config->programOutput;
         networkLog      = opt_config->networkLog;
@@ -99,8 +112,10 @@ public:
         port            = opt_config->port;
         distHost        = opt_config->distHost;
         distPort        = opt_config->distPort;
+        distFd          = opt_config->distFd;
         remoteHost      = opt_config->remoteHost;
         remotePort      = opt_config->remotePort;
+        remoteSessions  = opt_config->remoteSessions;
         remoteValgrind  = opt_config->remoteValgrind;
         leaks           = opt_config->leaks;
         funcFilterFile  = opt_config->funcFilterFile;
@@ -109,6 +124,7 @@ public:
         dumpCalls       = opt_config->dumpCalls;
         inputFilterFile = opt_config->inputFilterFile;
         STPThreads      = opt_config->STPThreads;
+        tracers         = opt_config->tracers;
         STPThreadsAuto	= opt_config->STPThreadsAuto;
         plugin          = opt_config->plugin;
         prefix          = opt_config->prefix;
@@ -265,12 +281,24 @@ public:
     bool getAgent() const
     { return agent; }
 
+    void setPeer()
+    { peer = true; }
+
+    bool getPeer() const
+    { return peer; }
+
     void setSTPThreads(int num)
     { STPThreads = num; }
     
     int getSTPThreads() const
     { return STPThreads; }
 
+    void setTracers(unsigned int num)
+    { tracers = num; }
+    
+    unsigned int getTracers() const
+    { return tracers; }
+
     void setStartdepth(int startdepth)
     { this->startdepth = startdepth; }
     
@@ -282,6 +310,30 @@ public:
     
     bool getCheckDanger() const
     { return checkDanger; }
+
+    void setLazyScoring()
+    { lazyScoring = true; }
+    
+    bool getLazyScoring() const
+    { return lazyScoring; }
+
+    void setTieredCheck()
+    { tieredCheck = true; }
+    
+    bool getTieredCheck() const
+    { return tieredCheck; }
+
+    void setDivergencePolicy(const std::string &policy)
+    { divergencePolicy = policy; }
+    
+    const std::string &getDivergencePolicy() const
+    { return divergencePolicy; }
+
+    void setParentPhase()
+    { parentPhase = true; }
+    
+    bool getParentPhase() const
+    { return parentPhase; }
     
     void disableCleanUp()
     { cleanUp = false; }
@@ -349,12 +401,24 @@ public:
     unsigned int getDistPort() const
     { return distPort; }
 
+    void setDistFd(int fd)
+    { distFd = fd; }
+
+    int getDistFd() const
+    { return distFd; }
+
     void setRemotePort(unsigned int port) 
     { remotePort = port; }
 
     unsigned int getRemotePort() const
     { return remotePort; }
 
+    void setRemoteSessions(unsigned int sessions) 
+    { remoteSessions = sessions; }
+
+    unsigned int getRemoteSessions() const
+    { return remoteSessions; }
+
     void addProgAndArg(const std::string &arg)
     { prog_and_arg.push_back(arg); }
 
@@ -430,6 +494,29 @@ private:
        Disabled by default (false). */
     bool                     checkDanger;
 
+    /* Enable deferred scoring of new inputs: inputs are queued with
+         an estimated score and checked only when they reach the top
+         of the queue.
+       Disabled by default (false). */
+    bool                     lazyScoring;
+
+    /* Enable tiered checking of new inputs: run the program natively
+         first, covgrind only for new branch targets and memcheck/helgrind
+         only for inputs with new coverage or crashes.
+       Disabled by default (false). */
+    bool                     tieredCheck;
+
+    /* Stop tracegrind as soon as the input diverges from its prediction.
+         Use 'drop' to discard divergent inputs;
+         use 'reschedule' to trace them again later without the check.
+       Not set by default (""). */
+    std::string              divergencePolicy;
+
+    /* Pass the bytes of the input being traced to STP as the initial
+         SAT phase, so that solutions stay close to the parent input.
+       Disabled by default (false). */
+    bool                     parentPhase;
+
     /* Add --check-leak=yes in memcheck options.
        Not used by default (false). */
     bool                     leaks;
@@ -465,6 +552,12 @@ private:
        Not set by defualt (false). */
     bool                     agent;
 
+    /* Set avalanche to run as a peer of distributed Avalanche (av-agent
+         sets it): register at the distribution server, give inputs to
+         the other peers and steal inputs from them when out of work.
+       Not set by default (false). */
+    bool                     peer;
+
     /* Enable automatic detection of STP threads number.
        Not set by default (false). */
     bool                     STPThreadsAuto;
@@ -545,10 +638,19 @@ private:
        Set to 65536 by default. */
     unsigned int             distPort;
 
+    /* Connection to av-dist opened by av-agent for the peer it starts.
+       Set to -1 by default (the peer connects to av-dist itself). */
+    int                      distFd;
+
     /* plugin-agent port number.
        Set to 65536 by default. */
     unsigned int             remotePort;
 
+    /* Number of plugin-agent sessions to run checkers on concurrently
+         (with STP threads).
+       Set to 1 by default. */
+    unsigned int             remoteSessions;
+
     /* Function names to be used for separate function analysis.
        Not set by default. */
     std::vector<std::string> funcFilterUnits;
@@ -569,6 +671,10 @@ private:
        Not set by default (0). */
     unsigned int             STPThreads;
 
+    /* Number of top inputs traced by tracegrind simultaneously.
+       Set to 1 by default. */
+    unsigned int             tracers;
+
     /* String containing argument numbers (1,2,...) to be checked 
          as a source of tainted data.
        Not set by default (""). */
@@ -31,7 +31,7 @@
 class RemotePluginExecutor : public Executor
 {
 public:
-    RemotePluginExecutor(std::vector<std::string> &_args, int fd, std::vector<char> &to_send, std::string _result_dir);
+    RemotePluginExecutor(std::vector<std::string> &_args, int fd, std::vector<char> &to_send, std::string _result_dir, std::string _file_name_modifier = "");
     bool checkFlag(const char *flg_name);
     ~RemotePluginExecutor() {}
     int run(int thread_index = 0);
@@ -40,6 +40,7 @@ private:
     int remote_fd;
     std::vector<char> files_to_send;
     std::string result_dir;
+    std::string file_name_modifier;
 };
 
 
@@ -31,13 +31,15 @@
 class STP_Executor : public LocalExecutor
 {
 public:
-    STP_Executor(bool debug_full_enable, const std::string &install_dir);
+    STP_Executor(bool debug_full_enable, const std::string &install_dir,
+                 const std::string &phase_hints = "");
     ~STP_Executor();
     
     std::string run(const char *file_name, int thread_index = 0);
 
 private:
     bool debug_full;
+    int file_index;
 };
 
 
@@ -37,12 +37,16 @@ public:
   SocketBuffer(const SocketBuffer& other);
 
   virtual FileBuffer* forkInput(FileBuffer *stp_file, 
-                                std::vector<FileOffsetSet> &used_offsets);
+                                std::vector<FileOffsetSet> &used_offsets,
+                                std::string name_modifier = "");
 
   virtual int dumpFile(std::string file_name);
   
   virtual int applySTPSolution(char* buf, 
-                               std::vector<FileOffsetSet> &used_offsets);
+                               std::vector<FileOffsetSet> &used_offsets,
+                               std::string name_modifier = "");
+
+  virtual std::string getArrayName(std::string name_modifier = "") const;
 
   ~SocketBuffer();
 
@@ -26,6 +26,7 @@
 
 #include <pthread.h>
 #include <iostream>
+#include <deque>
 #include <map>
 #include <string>
 
@@ -47,7 +48,6 @@ class Thread
 {
   protected:
            std::map <std::string, void*> private_data;
-           static std::map <std::string, void*> shared_data;
            pthread_t tid;
            int user_tid;
   public:
@@ -74,19 +74,6 @@ class Thread
            { 
              return private_data[name]; 
            }
-              
-           static void addSharedData(void* _data_unit, std::string name)
-           { 
-             shared_data[name] = _data_unit;
-           }
-           static void clearSharedData() 
-           { 
-             shared_data.clear(); 
-           }
-           static void* getSharedData(std::string name) 
-           { 
-             return shared_data[name];
-           }
 
            void printMessage(const char* message, bool show_real_tid = false);
 
@@ -106,45 +93,57 @@ class Thread
            }
 };
 
-class PoolThread : public Thread
+/* A job for the threads of a WorkerPool. worker is the number of the
+   thread that runs it, from 1. */
+
+class Job
 {
   public:
-           enum Status {UNINIT = -1, BUSY = 0, FREE = 1};
+           virtual ~Job() {}
+           virtual void run(int worker) = 0;
+};
+
+/* Long-lived threads taking jobs from a bounded queue. Any thread may
+   add jobs: add() blocks while the queue is full. The pool deletes a job
+   when it is done; wait() returns when all the jobs added so far are
+   done. */
+
+class WorkerPool
+{
   private:
-           pthread_mutex_t* work_finish_mutex;
-           pthread_cond_t* work_finish_cond;
-           int thread_status;
-           int* active_threads;
+           pthread_t* tids;
+           int worker_num;
+           std::deque<Job*> jobs;
+           unsigned int capacity;
+           unsigned int unfinished;
+           bool stopping;
+           bool stopped;
+           pthread_mutex_t mutex;
+           pthread_cond_t job_available;
+           pthread_cond_t space_available;
+           pthread_cond_t all_done;
+
+           struct worker_wrapper
+           {
+             WorkerPool* pool;
+             int worker;
+           };
+
+           static void* workerLoop(void* data);
   public:
-           PoolThread() : work_finish_mutex(NULL), work_finish_cond(NULL), thread_status(-1), active_threads(NULL) {}
-           ~PoolThread() {}
+           WorkerPool(int _worker_num, unsigned int _capacity);
+           ~WorkerPool();
 
-           void waitForThread()
-           {
-             if (thread_status != UNINIT)
-             {
-               Thread::waitForThread();
-               thread_status = UNINIT;
-             }
-           }
-           
-           void setPoolSync(pthread_mutex_t* _mutex, pthread_cond_t* _cond, int* _active_threads)
-           {
-             work_finish_mutex = _mutex;
-             work_finish_cond = _cond;
-             active_threads = _active_threads;
-           }
- 
-           int setStatus(int _status)
+           void add(Job* job);
+           void wait();
+
+           // Jobs that are running are finished, those in the queue are dropped
+           void stop();
+
+           int getWorkerNum()
            {
-             thread_status = _status;
-           }
-           
-           int getStatus() 
-           { 
-             return thread_status;
+             return worker_num;
            }
-           void doWork(void* data);
 };
 
 #endif
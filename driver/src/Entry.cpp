@@ -57,13 +57,13 @@ Monitor* monitor;
 ExecutionManager* em;
 OptionParser *op;
 
-extern Thread remote_thread;
-extern PoolThread *threads;
+extern Thread *remote_threads;
+extern Thread *tracer_threads;
+extern int tracer_num;
+extern WorkerPool *stp_pool;
 extern Input* initial;
 extern vector<Error*> report;
 
-extern int in_thread_creation;
-
 int thread_num;
 extern int dist_fd;
 
@@ -75,6 +75,7 @@ void cleanUp()
     string dir_name = ExecutionManager::getTempDir();
     if (thread_num > 0)
     {
+        delete stp_pool;
         for (int i = 1; i < thread_num + 1; i ++)
         {
             ostringstream file_modifier;
@@ -90,7 +91,32 @@ void cleanUp()
                 unlink((opt_config->getFile(j) + file_modifier.str()).c_str());
             }
         }
-        delete []threads;
+    }
+    if (tracer_num > 1)
+    {
+        for (int i = 1; i < tracer_num + 1; i ++)
+        {
+            ostringstream tracer_dir, file_modifier;
+            tracer_dir << dir_name << "tracer_" << i << "/";
+            file_modifier << "_t" << i;
+            for (int j = 0; j < opt_config->getNumberOfFiles(); j ++)
+            {
+                unlink((opt_config->getFile(j) + file_modifier.str()).c_str());
+            }
+            if (opt_config->enabledCleanUp())
+            {
+                string tracer_dir_name = tracer_dir.str();
+                unlink((tracer_dir_name + string("execution.log")).c_str());
+                unlink((tracer_dir_name + string("prediction.log")).c_str());
+                unlink((tracer_dir_name + string("dangertrace.log")).c_str());
+                unlink((tracer_dir_name + string("trace.log")).c_str());
+                unlink((tracer_dir_name + string("actual.log")).c_str());
+                unlink((tracer_dir_name + string("divergence.log")).c_str());
+                unlink((tracer_dir_name + string("offsets.log")).c_str());
+                rmdir(tracer_dir_name.c_str());
+            }
+        }
+        delete []tracer_threads;
     }
     if (opt_config->enabledCleanUp()) {
         unlink((dir_name + string("basic_blocks.log")).c_str());
@@ -102,6 +128,7 @@ void cleanUp()
         unlink((dir_name + string("trace.log")).c_str());
         unlink((dir_name + string("actual.log")).c_str());
         unlink((dir_name + string("divergence.log")).c_str());
+        unlink((dir_name + string("phase_hints.log")).c_str());
         unlink((dir_name + string("replace_data")).c_str());
         unlink((dir_name + string("offsets.log")).c_str());
         if (opt_config->getCheckArgv() != "")
@@ -200,43 +227,40 @@ void reportResults()
     LOG(Logger::REPORT, "");
 }
 
-void sig_hndlr(int signo)
+static pthread_mutex_t interrupt_mutex = PTHREAD_MUTEX_INITIALIZER;
+static bool finishing = false;
+
+/* SIGINT is blocked in every thread and taken here, so the analysis is
+   interrupted in a normal thread context: the programs that run are
+   killed and the STP pool drops its queue. The main thread sees the
+   killed status, leaves the analysis and reports the results as usual. */
+
+void* interrupt_handler(void* data)
 {
-    if (opt_config->getDistributed())
-    {
-        write(dist_fd, "q", 1);
-        shutdown(dist_fd, SHUT_RDWR);
-        close(dist_fd);
-    }
-    if (!(opt_config->usingSockets()) && 
-        !(opt_config->usingDatagrams()) &&
-        (initial != NULL))
+    int signo;
+    sigwait((sigset_t*) data, &signo);
+    pthread_mutex_lock(&interrupt_mutex);
+    if (!finishing)
     {
-        initial->dumpFiles();
-    }
-    monitor->setKilledStatus(true);
-    monitor->handleSIGKILL();
-    for (int i = 0; i < thread_num; i ++)
-    {
-        if (in_thread_creation != i)
+        LOG(Logger::JOURNAL, "Interrupted.");
+        monitor->setKilledStatus(true);
+        monitor->handleSIGKILL();
+        if (thread_num > 0)
         {
-            threads[i].waitForThread();
+            stp_pool->stop();
         }
     }
-/*    if ((thread_num > 0) && opt_config->getRemoteValgrind())
-    {
-        pthread_cancel(remote_thread.getTID());
-        remote_thread.waitForThread();
-    }*/
-    reportResults();
-    cleanUp();
-    exit(0);
+    pthread_mutex_unlock(&interrupt_mutex);
+    return NULL;
 }
 
 int main(int argc, char *argv[])
 {
     time_t start_time = time(NULL); 
-    signal(SIGINT, sig_hndlr);
+    sigset_t sigmask;
+    sigemptyset(&sigmask);
+    sigaddset(&sigmask, SIGINT);
+    pthread_sigmask(SIG_BLOCK, &sigmask, NULL);
     signal(SIGPIPE, SIG_IGN);
     op = new OptionParser(argc, argv);
     opt_config = op->run();
@@ -260,13 +284,18 @@ int main(int argc, char *argv[])
         monitor = new ParallelMonitor(checker_name, start_time, thread_num);
         ((ParallelMonitor*)monitor)->setAlarm(opt_config->getAlarm(), 
                                               opt_config->getTracegrindAlarm());
-        threads = new PoolThread[thread_num];
+        stp_pool = new WorkerPool(thread_num, thread_num);
     }
     else
     {
         monitor = new SimpleMonitor(checker_name, start_time);
     }
     checker_name.clear();
+    Thread interrupt_thread;
+    job_wrapper interrupt_data;
+    interrupt_data.work_func = interrupt_handler;
+    interrupt_data.data = &sigmask;
+    interrupt_thread.createThread(&interrupt_data, false);
     Error::initCounters();
     LOG_TIME (Logger :: VERBOSE, "Avalanche, a dynamic analysis tool.");
 
@@ -294,6 +323,10 @@ int main(int argc, char *argv[])
     catch (char *msg)
     {
     }
+    // Wait for an interruption that has begun, and ignore later ones
+    pthread_mutex_lock(&interrupt_mutex);
+    finishing = true;
+    pthread_mutex_unlock(&interrupt_mutex);
     /* We need 2 separate try-catch blocks so that an attempt to restore
        initial input files is made. */
     try
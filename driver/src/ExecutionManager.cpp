@@ -25,17 +25,21 @@
 
 
 #include <sys/socket.h>
+#include <sys/uio.h>
 #include <netinet/in.h>
 #include <arpa/inet.h>
 #include <sys/wait.h>
 #include <signal.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <errno.h>
+#include <limits.h>
 #include <string>
 #include <vector>
 #include <set>
 #include <cstring>
 #include <stack>
+#include <iomanip>
 
 #include "av_config.h" //for TMPDIR
 
@@ -44,6 +48,7 @@
 #include "Error.h"
 #include "OptionConfig.h"
 #include "PluginExecutor.h"
+#include "NativeExecutor.h"
 #include "RemotePluginExecutor.h"
 #include "STP_Executor.h"
 #include "FileBuffer.h"
@@ -59,20 +64,38 @@ using namespace std;
 
 extern Monitor* monitor;
 
-PoolThread *threads;
-Thread remote_thread;
+WorkerPool *stp_pool;
+Thread *remote_threads;
+Thread *tracer_threads;
+Thread steal_thread;
 extern int thread_num;
 
 bool killed = false;
-bool nokill = false;
+// Tracers running without an alarm (under nokill_mutex): the alarm
+// handler kills nothing until the last of them finishes
+int nokill_tracers = 0;
+volatile bool nokill = false;
+pthread_mutex_t nokill_mutex;
 bool f_error = false;
 
 bool trace_kind;
 
+/* With --tracers=K the top K inputs are traced at once. Tracer i (from 1)
+   runs the program on copies of the input files with suffix _t<i> and
+   gets the logs of tracegrind in <temp_dir>tracer_<i>/. The traces are
+   then processed one by one: trace_dir and trace_file_modifier describe
+   the current one. */
+
+int tracer_num = 1;
+string trace_dir;
+string trace_file_modifier;
+
 static Logger *logger = Logger::getLogger();
 Input* initial;
 Kind kind;
 bool is_distributed = false;
+bool is_peer = false;
+bool share_coverage = false;
 
 vector<Error*> report;
 
@@ -80,19 +103,137 @@ pthread_mutex_t add_inputs_mutex;
 pthread_mutex_t add_exploits_mutex;
 pthread_mutex_t add_bb_mutex;
 pthread_mutex_t add_remote_mutex;
-pthread_mutex_t finish_mutex;
-pthread_cond_t finish_cond;
 pthread_cond_t input_available_cond;
-
-int in_thread_creation = -1;
+pthread_cond_t remote_space_cond;
 
 int dist_fd;
-int remote_fd;
-int agents;
+// Inputs given to the other peers and received from them (under
+// add_inputs_mutex): the distribution server ends the analysis when
+// every input given away has been received
+int inputs_sent = 0;
+int inputs_received = 0;
+vector<int> remote_fds;
+int remote_sessions = 0;
+int active_remote_sessions;
+int steal_fd = -1;
+
+// STP threads wait while remote_inputs holds this many inputs per session
+#define REMOTE_QUEUE_PER_SESSION 2
 
 stack<pair<Input*, unsigned int> > remote_inputs;
 bool launch_cv_stop;
 
+static void writeToSocket(int fd, const void* b, size_t count)
+{
+  char* buf = (char*) b;
+  size_t sent = 0;
+  while (sent < count)
+  {
+    // a peer that went away must not kill us with SIGPIPE
+    size_t s = send(fd, buf + sent, count - sent, MSG_NOSIGNAL);
+    if (s == -1)
+    {
+      throw "error writing to socket";
+    }
+    sent += s;
+  }
+}
+
+static void readFromSocket(int fd, void* b, size_t count)
+{
+  char* buf = (char*) b;
+  size_t received = 0;
+  while (received < count)
+  {
+    size_t r = read(fd, buf + received, count - received);
+    if (r == 0)
+    {
+      throw "connection is down";
+    }
+    if (r == -1)
+    {
+      throw "error reading from socket";
+    }
+    received += r;
+  }
+}
+
+/* Write all the buffers of iov with as few system calls as possible. */
+
+static void writevToSocket(int fd, struct iovec* iov, int iovcnt)
+{
+  while (iovcnt > 0)
+  {
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(struct msghdr));
+    msg.msg_iov = iov;
+    msg.msg_iovlen = (iovcnt < IOV_MAX) ? iovcnt : IOV_MAX;
+    ssize_t s = sendmsg(fd, &msg, MSG_NOSIGNAL);
+    if (s == -1)
+    {
+      // a signal (e.g. the Tracegrind alarm) came before anything was sent
+      if (errno == EINTR)
+      {
+        continue;
+      }
+      throw "error writing to socket";
+    }
+    while ((iovcnt > 0) && (s >= iov->iov_len))
+    {
+      s -= iov->iov_len;
+      iov ++;
+      iovcnt --;
+    }
+    if (iovcnt > 0)
+    {
+      iov->iov_base = (char*) iov->iov_base + s;
+      iov->iov_len -= s;
+    }
+  }
+}
+
+/* Tell the distribution server that this peer is out of work, with the
+   numbers of inputs it has given away and received. */
+
+static void reportIdle()
+{
+  int counts[2];
+  pthread_mutex_lock(&add_inputs_mutex);
+  counts[0] = inputs_sent;
+  counts[1] = inputs_received;
+  pthread_mutex_unlock(&add_inputs_mutex);
+  char report[1 + sizeof(counts)];
+  report[0] = 'i';
+  memcpy(report + 1, counts, sizeof(counts));
+  writeToSocket(dist_fd, report, sizeof(report));
+}
+
+static void appendToMessage(string& msg, const void* b, size_t count)
+{
+  msg.append((const char*) b, count);
+}
+
+/* Requests between peers and the inputs they give each other carry the
+   version of the protocol: peers of different versions do not exchange
+   inputs. An input goes as one message (a header, then the fields in the
+   order recvInput reads them); a header with zero length means that the
+   peer has no input to give. */
+
+#define PROTOCOL_VERSION 1
+
+struct StealRequest
+{
+  int version;
+  int peers;
+  unsigned int min_score;
+};
+
+struct MessageHeader
+{
+  int version;
+  int length;
+};
+
 static int connectTo(string host, unsigned int port)
 {
   struct sockaddr_in st_socket_addr;
@@ -138,8 +279,6 @@ static string temp_dir = string(TMPDIR);
 static string temp_dir = string("/tmp");
 #endif
 
-#define TMP_DIR_TEMPLATE_SIZE 6
-
 static bool init_temp = false;
 
 string ExecutionManager::getTempDir()
@@ -150,26 +289,46 @@ string ExecutionManager::getTempDir()
     {
       temp_dir = temp_dir + string("/");
     }
-    temp_dir = temp_dir + string("avalanche-");
-    srand(time(NULL));
-    for (int i = 0; i < TMP_DIR_TEMPLATE_SIZE; i ++)
-    {
-        ostringstream ss;
-        ss << (char)('a' + rand() % ('z' - 'a'));
-        temp_dir = temp_dir + ss.str();
-    }
-    temp_dir += '/';
-    int res = mkdir(temp_dir.c_str(), S_IRWXU);
-    if ((res == -1) && (errno != EEXIST))
+    /* mkdtemp picks a name no other process on this host uses */
+    string dir_template = temp_dir + string("avalanche-XXXXXX");
+    vector <char> dir_name(dir_template.begin(), dir_template.end());
+    dir_name.push_back('\0');
+    if (mkdtemp(&dir_name[0]) == NULL)
     {
       LOG(Logger::ERROR, "Cannot create temp directory : " << strerror(errno));
       temp_dir = "";
     }
+    else
+    {
+      temp_dir = string(&dir_name[0]) + '/';
+    }
     init_temp = true;
   }
   return temp_dir;
 }
 
+static string tracerDir(int tracer)
+{
+  if (!tracer)
+  {
+    return temp_dir;
+  }
+  ostringstream dir;
+  dir << temp_dir << "tracer_" << tracer << "/";
+  return dir.str();
+}
+
+static string tracerModifier(int tracer)
+{
+  if (!tracer)
+  {
+    return string("");
+  }
+  ostringstream modifier;
+  modifier << "_t" << tracer;
+  return modifier.str();
+}
+
 ExecutionManager::ExecutionManager(OptionConfig *opt_config)
 {
     config      = new OptionConfig(opt_config);
@@ -180,30 +339,57 @@ ExecutionManager::ExecutionManager(OptionConfig *opt_config)
     }
     args_length += cur_argv.size() - 2;
     divergences = 0;
+    skippedQueries = 0;
+    abortedTraces = 0;
     is_distributed = opt_config->getDistributed();
+    /* peers to steal inputs from are picked at random */
+    srand(time(NULL) ^ getpid());
+    is_peer = opt_config->getPeer();
+
+    pthread_mutex_init(&add_inputs_mutex, NULL);
+    pthread_mutex_init(&nokill_mutex, NULL);
     if (thread_num > 0)
     {
-        pthread_mutex_init(&add_inputs_mutex, NULL);
         pthread_mutex_init(&add_exploits_mutex, NULL);
         pthread_mutex_init(&add_bb_mutex, NULL);
-        pthread_mutex_init(&finish_mutex, NULL);
         pthread_mutex_init(&add_remote_mutex, NULL);
-        pthread_cond_init(&finish_cond, NULL);
         pthread_cond_init(&input_available_cond, NULL);
+        pthread_cond_init(&remote_space_cond, NULL);
     }
 
-    if (is_distributed)
+    if (is_distributed || is_peer)
     {
-        dist_fd = connectTo(opt_config->getDistHost(), opt_config->getDistPort());
+        // The distribution server only tracks who takes part: inputs go
+        // directly between the peers, through their steal servers
+        int port = startStealServer();
+        // av-agent may pass its own connection: av-dist settles the input
+        // it got for this peer if the connection is closed early
+        dist_fd = (opt_config->getDistFd() != -1) ? opt_config->getDistFd() :
+                  connectTo(opt_config->getDistHost(), opt_config->getDistPort());
         LOG(Logger::NETWORK_LOG, "Connected to server.");
-        write(dist_fd, "m", 1);
-        read(dist_fd, &agents, sizeof(int));
+        write(dist_fd, is_distributed ? "m" : "p", 1);
+        write(dist_fd, &port, sizeof(int));
+        share_coverage = true;
+        if (is_peer)
+        {
+            // av-agent got the first input of this peer from main Avalanche
+            inputs_received = 1;
+        }
     }
     if (opt_config->getRemoteValgrind() != "")
     {
+        // Checkers run concurrently on several sessions only for STP threads
+        remote_sessions = (thread_num > 0) ? opt_config->getRemoteSessions() : 1;
+        if ((thread_num > 0) && (remote_sessions > thread_num))
+        {
+            remote_sessions = thread_num;
+        }
         if (opt_config->getRemoteValgrind() == "host")
         {
-            remote_fd = connectTo(opt_config->getRemoteHost(), opt_config->getRemotePort());
+            for (int i = 0; i < remote_sessions; i ++)
+            {
+                remote_fds.push_back(connectTo(opt_config->getRemoteHost(), opt_config->getRemotePort()));
+            }
         }
         else
         {
@@ -232,31 +418,78 @@ ExecutionManager::ExecutionManager(OptionConfig *opt_config)
                 exit(EXIT_FAILURE);
             }
 
-            remote_fd = accept(socket_fd, NULL, NULL);
-            if (remote_fd < 0)
+            for (int i = 0; i < remote_sessions; i ++)
             {
-                perror("accept failed");
-                close(socket_fd);
-                exit(EXIT_FAILURE);
+                int remote_fd = accept(socket_fd, NULL, NULL);
+                if (remote_fd < 0)
+                {
+                    perror("accept failed");
+                    close(socket_fd);
+                    exit(EXIT_FAILURE);
+                }
+                remote_fds.push_back(remote_fd);
             }
             close(socket_fd);
         }
 
-        char buf[32];
-        read(remote_fd, buf, strlen("avalanche"));
-        buf[strlen("avalanche")] = '\0';
-        if (strcmp(buf, "avalanche"))
+        for (int i = 0; i < remote_sessions; i ++)
+        {
+            char buf[32];
+            int size;
+            try
+            {
+                readFromSocket(remote_fds[i], buf, strlen("avalanche"));
+                buf[strlen("avalanche")] = '\0';
+                readFromSocket(remote_fds[i], &size, sizeof(int));
+            }
+            catch (const char*)
+            {
+                buf[0] = '\0';
+            }
+            if (strcmp(buf, "avalanche"))
+            {
+                LOG(Logger::ERROR, "Invalid authentication message from plugin-agent");
+                throw "authentication";
+            }
+            config->setSizeOfLong(size);
+        }
+        remote_threads = new Thread[remote_sessions];
+    }
+
+    // Tracers take the slots of STP threads in the monitor, so there are
+    // no more of them than STP threads
+    tracer_num = opt_config->getTracers();
+    if ((tracer_num > 1) && ((thread_num == 0) || (getTempDir() == "") ||
+        config->usingSockets() || config->usingDatagrams() ||
+        (config->getRemoteValgrind() != "") ||
+        (config->getCheckArgv() != "") || config->getDumpCalls()))
+    {
+        tracer_num = 1;
+    }
+    if (tracer_num > thread_num)
+    {
+        tracer_num = (thread_num > 0) ? thread_num : 1;
+    }
+    for (int i = 1; (tracer_num > 1) && (i <= tracer_num); i ++)
+    {
+        if ((mkdir(tracerDir(i).c_str(), S_IRWXU) == -1) && (errno != EEXIST))
         {
-            LOG(Logger::ERROR, "Invalid authentication message from plugin-agent");
-            throw "authentication";
+            LOG(Logger::ERROR, "Cannot create directory " << tracerDir(i) <<
+                               ": " << strerror(errno));
+            for (int j = 1; j < i; j ++)
+            {
+                rmdir(tracerDir(j).c_str());
+            }
+            tracer_num = 1;
         }
-        int size;
-        read(remote_fd, &size, sizeof(int));
-        config->setSizeOfLong(size);
+    }
+    if (tracer_num > 1)
+    {
+        tracer_threads = new Thread[tracer_num];
     }
 }
 
-void ExecutionManager::getTracegrindOptions(vector <string> &plugin_opts)
+void ExecutionManager::getTracegrindOptions(vector <string> &plugin_opts, int tracer)
 {
   ostringstream tg_invert_depth;
   if (temp_dir != "") 
@@ -267,7 +500,7 @@ void ExecutionManager::getTracegrindOptions(vector <string> &plugin_opts)
     }
     else
     {
-      plugin_opts.push_back(string("--temp-dir=") + temp_dir);
+      plugin_opts.push_back(string("--temp-dir=") + tracerDir(tracer));
     }
   }
   tg_invert_depth << "--invertdepth=" << config->getDepth();
@@ -343,7 +576,8 @@ void ExecutionManager::getTracegrindOptions(vector <string> &plugin_opts)
   {
     for (int i = 0; i < config->getNumberOfFiles(); i++)
     {
-      plugin_opts.push_back(string("--file=") + config->getFile(i));
+      plugin_opts.push_back(string("--file=") + config->getFile(i) + 
+                            tracerModifier(tracer));
     }
   }
   if (config->getCheckArgv() != "")
@@ -352,7 +586,7 @@ void ExecutionManager::getTracegrindOptions(vector <string> &plugin_opts)
   }
 }
 
-void ExecutionManager::getCovgrindOptions(vector <string> &plugin_opts, string fileNameModifier, bool addNoCoverage)
+void ExecutionManager::getCovgrindOptions(vector <string> &plugin_opts, string fileNameModifier, bool addNoCoverage, string plugin)
 {
   string cur_temp_dir = temp_dir;
   if (config->getRemoteValgrind() != "")
@@ -399,7 +633,7 @@ void ExecutionManager::getCovgrindOptions(vector <string> &plugin_opts, string f
     plugin_opts.push_back(string("--log-file=") + cv_exec_file);
   }
 
-  if (config->checkForLeaks())
+  if (config->checkForLeaks() && (plugin == "memcheck"))
   {
     plugin_opts.push_back("--leak-check=full");
   }
@@ -625,18 +859,10 @@ int ExecutionManager::calculateScore(string fileNameModifier)
         if (enable_mutexes) pthread_mutex_lock(&add_bb_mutex);
         for (int i = 0; i < size; i++)
         {
-          if (basicBlocksCovered.find(basicBlockAddrs[i]) == basicBlocksCovered.end())
+          if (coverBasicBlock(basicBlockAddrs[i]))
           {
             res++;
           }
-          if(thread_num < 1)
-          {
-            basicBlocksCovered.insert(basicBlockAddrs[i]);
-          }
-          else
-          {
-            delta_basicBlocksCovered.insert(basicBlockAddrs[i]);
-          }
         }
       }
       else if (config->getSizeOfLong() == 8)
@@ -647,18 +873,10 @@ int ExecutionManager::calculateScore(string fileNameModifier)
         if (enable_mutexes) pthread_mutex_lock(&add_bb_mutex);
         for (int i = 0; i < size; i++)
         {
-          if (basicBlocksCovered.find(basicBlockAddrs[i]) == basicBlocksCovered.end())
+          if (coverBasicBlock(basicBlockAddrs[i]))
           {
             res++;
           }
-          if(thread_num < 1)
-          {
-            basicBlocksCovered.insert(basicBlockAddrs[i]);
-          }
-          else
-          {
-            delta_basicBlocksCovered.insert(basicBlockAddrs[i]);
-          }
         }
       }
       if (enable_mutexes) pthread_mutex_unlock(&add_bb_mutex);
@@ -673,9 +891,74 @@ int ExecutionManager::calculateScore(string fileNameModifier)
   return res;
 }
 
+/* Record a basic block covered by the last run. Returns true if no run
+   had covered it before, here or (in distributed mode) on another peer. */
+
+bool ExecutionManager::coverBasicBlock(unsigned long bb)
+{
+  bool is_new = (basicBlocksCovered.find(bb) == basicBlocksCovered.end());
+  bool inserted = (thread_num < 1) ? basicBlocksCovered.insert(bb).second :
+                                     delta_basicBlocksCovered.insert(bb).second;
+  if (is_new && inserted && share_coverage)
+  {
+    unshared_basicBlocks.push_back(bb);
+  }
+  return is_new;
+}
+
+/* Send the basic blocks first covered here since the last call to the
+   distribution server, and merge the blocks the other peers covered in
+   the meantime, so that inputs are not scored for coverage found
+   elsewhere. */
+
+void ExecutionManager::shareCoverage()
+{
+  if (!share_coverage)
+  {
+    return;
+  }
+  if (thread_num > 0) pthread_mutex_lock(&add_bb_mutex);
+  vector<unsigned long long> blocks(unshared_basicBlocks.begin(), 
+                                    unshared_basicBlocks.end());
+  unshared_basicBlocks.clear();
+  if (thread_num > 0) pthread_mutex_unlock(&add_bb_mutex);
+  try
+  {
+    int num = blocks.size();
+    struct iovec iov[3];
+    iov[0].iov_base = (void*) "b";
+    iov[0].iov_len = 1;
+    iov[1].iov_base = &num;
+    iov[1].iov_len = sizeof(int);
+    iov[2].iov_base = (num > 0) ? &blocks[0] : NULL;
+    iov[2].iov_len = num * sizeof(unsigned long long);
+    writevToSocket(dist_fd, iov, 3);
+    readFromSocket(dist_fd, &num, sizeof(int));
+    blocks.resize(num);
+    if (num > 0)
+    {
+      readFromSocket(dist_fd, &blocks[0], num * sizeof(unsigned long long));
+    }
+  }
+  catch (const char* msg)
+  {
+    LOG(Logger::NETWORK_LOG, "Connection with server lost: coverage is not shared.");
+    share_coverage = false;
+    return;
+  }
+  if (thread_num > 0) pthread_mutex_lock(&add_bb_mutex);
+  basicBlocksCovered.insert(blocks.begin(), blocks.end());
+  if (thread_num > 0) pthread_mutex_unlock(&add_bb_mutex);
+  if (!blocks.empty())
+  {
+    LOG(Logger::NETWORK_LOG, "Received " << blocks.size() << 
+                             " basic blocks covered by other peers.");
+  }
+}
+
 // Run Valgrind or Memcheck on 'input'
 
-int ExecutionManager::checkAndScore(Input* input, bool addNoCoverage, bool first_run, string fileNameModifier)
+int ExecutionManager::checkAndScore(Input* input, bool addNoCoverage, bool first_run, string fileNameModifier, string plugin, int remote_session)
 {
   if (config->usingSockets() || config->usingDatagrams())
   {
@@ -692,8 +975,21 @@ int ExecutionManager::checkAndScore(Input* input, bool addNoCoverage, bool first
       return -1;
     }
   }
+  string tool;
+  if (plugin != "")
+  {
+    tool = plugin;
+  }
+  else if (addNoCoverage)
+  {
+    tool = "covgrind";
+  }
+  else
+  {
+    tool = config->getPlugin();
+  }
   vector<string> plugin_opts;
-  getCovgrindOptions(plugin_opts, fileNameModifier, addNoCoverage);
+  getCovgrindOptions(plugin_opts, fileNameModifier, addNoCoverage, tool);
 
   string cv_exec_file = temp_dir + string("execution") + fileNameModifier + string(".log");
   
@@ -724,16 +1020,7 @@ int ExecutionManager::checkAndScore(Input* input, bool addNoCoverage, bool first
     }
   }
 
-  string plugin_name;
-  if (addNoCoverage)
-  {
-    plugin_name = "--tool=covgrind";
-  }
-  else
-  {
-    plugin_name = string("--tool=") + config->getPlugin();
-  }
-  plugin_opts.insert(plugin_opts.begin(), plugin_name);
+  plugin_opts.insert(plugin_opts.begin(), string("--tool=") + tool);
 
   Executor* plugin_exe;
   if (config->getRemoteValgrind() == "")
@@ -751,8 +1038,9 @@ int ExecutionManager::checkAndScore(Input* input, bool addNoCoverage, bool first
       plug_args.push_back(new_prog_and_args[i]);
     }
     to_send.insert(to_send.begin(), 0);
-    plugin_exe = new RemotePluginExecutor(plug_args, remote_fd, to_send, 
-                                          config->getResultDir());
+    plugin_exe = new RemotePluginExecutor(plug_args, remote_fds.at(remote_session), 
+                                          to_send, config->getResultDir(),
+                                          fileNameModifier);
   }
   new_prog_and_args.clear();
   plugin_opts.clear();
@@ -794,7 +1082,7 @@ int ExecutionManager::checkAndScore(Input* input, bool addNoCoverage, bool first
     pthread_mutex_lock(&add_exploits_mutex);
   }
   int res;
-  vector<Error*> error_list = plugin_log->getErrors(config->getPlugin());
+  vector<Error*> error_list = plugin_log->getErrors(tool);
   for (vector<Error*>::iterator it = error_list.begin(); 
                                 it != error_list.end(); 
                                 it ++)
@@ -843,9 +1131,88 @@ int ExecutionManager::checkAndScore(Input* input, bool addNoCoverage, bool first
   return result;
 }
 
+// Run 'input' natively (tier 0 of --tiered-check)
+
+int ExecutionManager::runNative(Input* input, string fileNameModifier)
+{
+  if (input->dumpFiles(fileNameModifier.c_str()) < 0)
+  {
+    return -1;
+  }
+  if (config->getCheckArgv() != "")
+  {
+    if (!updateArgv(input))
+    {
+      return -1;
+    }
+  }
+  vector <string> new_prog_and_args = cur_argv;
+  if (fileNameModifier != string(""))
+  {
+    for (int i = 0; i < new_prog_and_args.size(); i ++)
+    {
+      for (int j = 0; j < input->files.size(); j ++)
+      {
+        if (new_prog_and_args[i] == input->files.at(j)->getName())
+        {
+          new_prog_and_args[i].append(fileNameModifier);
+        }
+      }
+    }
+  }
+  int thread_index = (fileNameModifier == string("")) ? 0 : atoi(fileNameModifier.substr(1).c_str());
+  NativeExecutor native_exe(new_prog_and_args, config->getAlarm());
+  monitor->setState(CHECKER, time(NULL), thread_index);
+  int status = native_exe.run(thread_index);
+  monitor->addTime(time(NULL), thread_index);
+  return status;
+}
+
+// Tiered checking: native run first, Valgrind checkers only when warranted.
+//   tier 0 - native run, catches crashes and timeouts;
+//   tier 1 - covgrind, only for new branch targets or crashed inputs;
+//   tier 2 - memcheck/helgrind, only for new coverage or crashed inputs.
+// Crashes found in tier 0 are reproduced under Valgrind, so that they
+// are reported through ExecutionLogBuffer and dumpError as usual.
+
+int ExecutionManager::checkAndScoreTiered(Input* input, bool addNoCoverage, string fileNameModifier)
+{
+  // Inputs from dangerous traces are run only to be checked
+  if (addNoCoverage || config->usingSockets() || config->usingDatagrams() ||
+      (config->getRemoteValgrind() != ""))
+  {
+    return checkAndScore(input, addNoCoverage, false, fileNameModifier);
+  }
+  int status = runNative(input, fileNameModifier);
+  if (status < 0)
+  {
+    return -1;
+  }
+  bool near_crash = (status != NativeExecutor::FINISHED);
+  if (!near_crash && !input->new_target)
+  {
+    LOG(Logger::DEBUG, "Tier 0 passed, skipping Valgrind checks.");
+    return 0;
+  }
+  if (near_crash || (config->getPlugin() == "covgrind"))
+  {
+    return checkAndScore(input, false, false, fileNameModifier);
+  }
+  int score = checkAndScore(input, false, false, fileNameModifier, "covgrind");
+  if (score <= 0)
+  {
+    return score;
+  }
+  if (checkAndScore(input, true, false, fileNameModifier, config->getPlugin()) < 0)
+  {
+    return -1;
+  }
+  return score;
+}
+
 int ExecutionManager::checkDivergence(Input* first_input, int score)
 {
-  string div_file = temp_dir + string("divergence.log");
+  string div_file = trace_dir + string("divergence.log");
   int divfd = open(div_file.c_str(), O_RDONLY);
   if (divfd != -1)
   {
@@ -885,10 +1252,6 @@ int ExecutionManager::checkDivergence(Input* first_input, int score)
       close(divfd);
       if (score == 0) 
       {
-        if (is_distributed)
-        {
-          talkToServer();
-        }
         return 1;
       }
     }
@@ -896,6 +1259,76 @@ int ExecutionManager::checkDivergence(Input* first_input, int score)
   return 0;
 }
 
+// Early divergence check is not available with remote plugin-agent since
+// divergence.log stays on the remote side
+
+bool ExecutionManager::abortOnDivergence(Input* input)
+{
+  return (config->getDivergencePolicy() != "") && 
+         (config->getRemoteValgrind() == "") && !input->diverged;
+}
+
+/* Dump bytes of the input files in phase_hints.log, one file per line:
+   the name of its array in traces and the bytes in hex. STP uses them
+   as the initial SAT phase for every query of the current trace. */
+
+int ExecutionManager::dumpPhaseHints(Input* input)
+{
+  string hints_file = temp_dir + string("phase_hints.log");
+  ostringstream hints;
+  hints << hex << setfill('0');
+  for (int i = 0; i < input->files.size(); i++)
+  {
+    FileBuffer* fb = input->files.at(i);
+    hints << fb->getArrayName(trace_file_modifier) << " ";
+    for (int j = 0; j < fb->getSize(); j++)
+    {
+      hints << setw(2) << (unsigned int) (unsigned char) fb->buf[j];
+    }
+    hints << "\n";
+  }
+  int fd = open(hints_file.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 
+                S_IRUSR | S_IWUSR);
+  if (fd == -1)
+  {
+    LOG(Logger::ERROR, "Cannot open file " << hints_file << 
+                       ": " << strerror(errno));
+    return -1;
+  }
+  string res = hints.str();
+  if (write(fd, res.c_str(), res.size()) != (ssize_t) res.size())
+  {
+    LOG(Logger::ERROR, "Cannot write to file " << hints_file << 
+                       ": " << strerror(errno));
+    close(fd);
+    unlink(hints_file.c_str());
+    return -1;
+  }
+  close(fd);
+  return 0;
+}
+
+// Depth of divergence reported by tracegrind or -1 if there was none
+
+int ExecutionManager::getDivergenceDepth()
+{
+  string div_file = trace_dir + string("divergence.log");
+  int divfd = open(div_file.c_str(), O_RDONLY);
+  if (divfd == -1)
+  {
+    return -1;
+  }
+  bool divergence = false;
+  int depth = -1;
+  if ((read(divfd, &divergence, sizeof(bool)) < 1) || !divergence ||
+      (read(divfd, &depth, sizeof(int)) < 1))
+  {
+    depth = -1;
+  }
+  close(divfd);
+  return depth;
+}
+
 // Read new input from sockets
 
 void ExecutionManager::updateInput(Input* input)
@@ -935,46 +1368,98 @@ void alarmHandler(int signo)
   signal(SIGALRM, alarmHandler);
 }
 
-void* process_query(void* data)
-{
-  PoolThread* actor = (PoolThread*) data;
-  ExecutionManager* this_pointer = 
-             (ExecutionManager*) (Thread::getSharedData("this_pointer"));
-  multimap<Key, Input*, cmp>* inputs = 
-             (multimap <Key, Input*, cmp> *) (Thread::getSharedData("inputs"));
-  Input* first_input = (Input*) (Thread::getSharedData("first_input"));
-  bool* actual = (bool*) (Thread::getSharedData("actual"));
-  long first_depth = (long) (Thread::getSharedData("first_depth"));
-  long depth = (long) (actor->getPrivateData("depth"));
-  int cur_tid = actor->getCustomTID();
-  if (this_pointer->processQuery(first_input, actual,
-                                 first_depth, depth, cur_tid) < 0)
-  {
-    f_error = true;
-  }
-  return NULL;
-}
+/* Solving a query of the current trace on an STP thread. The query
+   (the trace up to it) goes to curtrace_<worker>.log first. */
 
-int ExecutionManager::parseOffsetLog(vector<FileOffsetSet> &used_offsets)
+class QueryJob : public Job
 {
-  FileOffsetSet cur_offset_set;
-  string cur_file_name;
-  bool read_file_name = true;
-  bool saved_name = false;
-  char value;
-  unsigned long count = 0;
-  int fd = open((temp_dir + "offsets.log").c_str(), O_RDONLY,
-                 S_IRUSR | S_IROTH | S_IRGRP | S_IWUSR | S_IWOTH | S_IWGRP);
-  if (fd < 0)
+public:
+  QueryJob(ExecutionManager* _manager, Input* _first_input, bool* _actual,
+           unsigned long _first_depth, unsigned long _depth,
+           string _branch_site, FileBuffer* _query) :
+             manager(_manager), first_input(_first_input), actual(_actual),
+             first_depth(_first_depth), depth(_depth), 
+             branch_site(_branch_site), query(_query) {}
+
+  ~QueryJob()
   {
-    LOG(Logger::ERROR, 
-            "Cannot open file " << temp_dir << 
-            "offsets.log: " << strerror(errno));                    
-    return 0;
+    delete query;
   }
-  while (read(fd, &value, 1) > 0)
+
+  void run(int worker)
   {
-    if (value == '\1')
+    ostringstream cur_trace;
+    cur_trace << temp_dir << ((trace_kind) ? "curtrace_" : "curdtrace_") <<
+                 worker << ".log";
+    if (query->dumpFile(cur_trace.str()) < 0)
+    {
+      f_error = true;
+      return;
+    }
+    delete query;
+    query = NULL;
+    if (manager->processQuery(first_input, actual, first_depth, depth,
+                              worker, branch_site) < 0)
+    {
+      f_error = true;
+    }
+  }
+
+private:
+  ExecutionManager* manager;
+  Input* first_input;
+  bool* actual;
+  unsigned long first_depth;
+  unsigned long depth;
+  string branch_site;
+  FileBuffer* query;
+};
+
+/* Running the checker on an input of the deferred scoring. */
+
+class ScoreJob : public Job
+{
+public:
+  ScoreJob(ExecutionManager* _manager, Input* _input, int* _score) :
+             manager(_manager), input(_input), score(_score) {}
+
+  void run(int worker)
+  {
+    ostringstream input_modifier;
+    input_modifier << "_" << worker;
+    *score = (manager->getConfig()->getTieredCheck()) ?
+              manager->checkAndScoreTiered(input, false,
+                                           input_modifier.str()) :
+              manager->checkAndScore(input, false, false,
+                                     input_modifier.str());
+  }
+
+private:
+  ExecutionManager* manager;
+  Input* input;
+  int* score;
+};
+
+int ExecutionManager::parseOffsetLog(vector<FileOffsetSet> &used_offsets)
+{
+  FileOffsetSet cur_offset_set;
+  string cur_file_name;
+  bool read_file_name = true;
+  bool saved_name = false;
+  char value;
+  unsigned long count = 0;
+  int fd = open((trace_dir + "offsets.log").c_str(), O_RDONLY,
+                 S_IRUSR | S_IROTH | S_IRGRP | S_IWUSR | S_IWOTH | S_IWGRP);
+  if (fd < 0)
+  {
+    LOG(Logger::ERROR, 
+            "Cannot open file " << trace_dir << 
+            "offsets.log: " << strerror(errno));                    
+    return 0;
+  }
+  while (read(fd, &value, 1) > 0)
+  {
+    if (value == '\1')
     {
       cur_offset_set.offset_set.insert(count);
       read_file_name = false;
@@ -1007,10 +1492,56 @@ int ExecutionManager::parseOffsetLog(vector<FileOffsetSet> &used_offsets)
   return 1;
 }
 
+/* FNV-1a over the prediction bits, used to identify path prefixes. */
+
+static unsigned long long hashPrediction(unsigned long long hash, bool value)
+{
+  hash ^= (value) ? 1 : 0;
+  return hash * 1099511628211ULL;
+}
+
+static unsigned long long hashPrediction(bool* prediction, int length)
+{
+  unsigned long long hash = 14695981039346656037ULL;
+  for (int i = 0; i < length; i ++)
+  {
+    hash = hashPrediction(hash, prediction[i]);
+  }
+  return hash;
+}
+
+/* Check whether inverting 'branch_site' to 'direction' after the path
+   prefix with hash 'prefix_hash' has already been attempted in this or
+   any previous iteration, and remember the query otherwise. */
+
+bool ExecutionManager::isAttemptedQuery(string branch_site, 
+                                        unsigned long long prefix_hash,
+                                        bool direction)
+{
+  if (branch_site == "")
+  {
+    return false;
+  }
+  ostringstream query;
+  query << branch_site << ":" << hex << prefix_hash << ":" << direction;
+  if (attemptedQueries.insert(query.str()).second)
+  {
+    return false;
+  }
+  skippedQueries ++;
+  LOG(Logger::DEBUG, "Skipping already attempted query for " << 
+                     branch_site << ".");
+  return true;
+}
+
 // Run STP
 
-int ExecutionManager::processQuery(Input* first_input, bool* actual, unsigned long first_depth, unsigned long cur_depth, unsigned int thread_index)
+int ExecutionManager::processQuery(Input* first_input, bool* actual, unsigned long first_depth, unsigned long cur_depth, unsigned int thread_index, string branch_site)
 {
+    if (monitor->getKilledStatus())
+    {
+        return -1;
+    }
     string cur_trace_log = temp_dir;
     cur_trace_log += (trace_kind) ? string("curtrace") : string("curdtrace");
     string input_modifier = string("");
@@ -1021,7 +1552,10 @@ int ExecutionManager::processQuery(Input* first_input, bool* actual, unsigned lo
         input_modifier = input_modifier_s.str();
     }
     cur_trace_log += input_modifier + string(".log");
-    STP_Executor stp_exe(getConfig()->getDebug(), getConfig()->getValgrind());        
+    string phase_hints = (getConfig()->getParentPhase()) ? 
+                          temp_dir + string("phase_hints.log") : string("");
+    STP_Executor stp_exe(getConfig()->getDebug(), getConfig()->getValgrind(),
+                         phase_hints);
     monitor->setState(STP, time(NULL), thread_index);
     string stp_out = stp_exe.run(cur_trace_log.c_str(), thread_index);
     monitor->addTime(time(NULL), thread_index);
@@ -1060,7 +1594,8 @@ int ExecutionManager::processQuery(Input* first_input, bool* actual, unsigned lo
         for (int k = 0; k < first_input->files.size(); k++)
         { 
             FileBuffer* fb = first_input->files.at(k);
-            fb = fb->forkInput(stp_out_file, used_offsets);
+            fb = fb->forkInput(stp_out_file, used_offsets,
+                               trace_file_modifier);
             if (fb == NULL)
             {
                 delete next;
@@ -1085,17 +1620,53 @@ int ExecutionManager::processQuery(Input* first_input, bool* actual, unsigned lo
                                   !actual[st_depth + cur_depth - 1];
             next->prediction_size = st_depth + cur_depth;
             next->parent = first_input;
-            if ((thread_index > 0) && (config->getRemoteValgrind() != ""))
+            // Only lazy scoring and tiered checks look at new targets
+            if (trace_kind && (config->getLazyScoring() || config->getTieredCheck()))
+            {
+                if (thread_index)
+                {
+                    pthread_mutex_lock(&add_inputs_mutex);
+                }
+                next->new_target = markInvertedBranch(branch_site,
+                                      next->prediction[st_depth + cur_depth - 1]);
+                if (thread_index)
+                {
+                    pthread_mutex_unlock(&add_inputs_mutex);
+                }
+            }
+            if (config->getLazyScoring() && trace_kind)
+            {
+                int score = estimateScore(next);
+                next->estimated = true;
+                LOG(Logger::DEBUG, "Estimated score = " << score << ".");
+                addInput(next, first_depth + cur_depth + 1, score);
+            }
+            else if ((thread_index > 0) && (config->getRemoteValgrind() != ""))
             {
                 pthread_mutex_lock(&add_remote_mutex);
+                while ((remote_inputs.size() >= 
+                        REMOTE_QUEUE_PER_SESSION * remote_sessions) &&
+                       (active_remote_sessions > 0))
+                {
+                    pthread_cond_wait(&remote_space_cond, &add_remote_mutex);
+                }
+                if (active_remote_sessions == 0)
+                {
+                    // Every session has failed: nobody would check the input
+                    pthread_mutex_unlock(&add_remote_mutex);
+                    delete next;
+                    return -1;
+                }
                 remote_inputs.push(make_pair(next, first_depth + cur_depth + 1));
                 pthread_mutex_unlock(&add_remote_mutex);
                 pthread_cond_signal(&input_available_cond);
             }
             else
             {
-                int score = checkAndScore(next, !trace_kind, false,  
-                                          input_modifier);
+                int score = (config->getTieredCheck()) ?
+                             checkAndScoreTiered(next, !trace_kind, input_modifier) :
+                             checkAndScore(next, !trace_kind, false,  
+                                           input_modifier);
                 if (score == -1)
                 {
                     return -1;
@@ -1106,17 +1677,12 @@ int ExecutionManager::processQuery(Input* first_input, bool* actual, unsigned lo
                     {
                         LOG(Logger::DEBUG, "Thread #" << thread_index << 
                                            ": Score = " << score << ".");
-                        pthread_mutex_lock(&add_inputs_mutex);
                     }
                     else
                     {
                         LOG(Logger::DEBUG, "Score = " << score << ".");
                     }
-                    inputs.insert(make_pair(Key(score, first_depth + cur_depth + 1), next));
-                    if (thread_index) 
-                    {
-                        pthread_mutex_unlock(&add_inputs_mutex);
-                    }
+                    addInput(next, first_depth + cur_depth + 1, score);
                 }
             }
         }
@@ -1127,50 +1693,165 @@ int ExecutionManager::processQuery(Input* first_input, bool* actual, unsigned lo
 void ExecutionManager::addInput(Input* input, unsigned int depth, 
                                 unsigned int score)
 {
+    input->score = score;
+    pthread_mutex_lock(&add_inputs_mutex);
     inputs.insert(make_pair(Key(score, depth), input));
+    pthread_mutex_unlock(&add_inputs_mutex);
+}
+
+/* Remember that a branch direction has been inverted. Loop iterations of
+   the same branch share the target, so the visit counter is dropped.
+   Returns true if the direction has not been inverted before. */
+
+bool ExecutionManager::markInvertedBranch(string branch_site, bool direction)
+{
+    if (branch_site == "")
+    {
+        return true;
+    }
+    string branch = branch_site.substr(0, branch_site.rfind('_'));
+    branch += (direction) ? ":1" : ":0";
+    return invertedBranches.insert(branch).second;
+}
+
+/* Score estimate for inputs queued with --lazy-scoring: the parent score
+   plus a bonus for a branch direction that has not been inverted before. */
+
+unsigned int ExecutionManager::estimateScore(Input* input)
+{
+    unsigned int score = (input->parent != NULL) ? input->parent->score : 0;
+    if (input->new_target)
+    {
+        score ++;
+    }
+    return score;
+}
+
+/* Run the checker on estimated inputs that reached the top of the queue
+   until the best input has a real score. In parallel mode up to
+   thread_num estimated inputs are checked at a time. */
+
+int ExecutionManager::scoreTopInputs()
+{
+    int slots = ((thread_num > 0) && (config->getRemoteValgrind() == "")) ? 
+                                                          thread_num : 1;
+    while (!inputs.empty() && !monitor->getKilledStatus())
+    {
+        vector<pair<Input*, unsigned int> > batch;
+        pthread_mutex_lock(&add_inputs_mutex);
+        while ((batch.size() < slots) && !inputs.empty())
+        {
+            multimap<Key, Input*, cmp>::iterator it = --(inputs.end());
+            if (!it->second->estimated)
+            {
+                break;
+            }
+            batch.push_back(make_pair(it->second, it->first.depth));
+            inputs.erase(it);
+        }
+        pthread_mutex_unlock(&add_inputs_mutex);
+        if (batch.empty())
+        {
+            break;
+        }
+        vector<int> scores(batch.size(), -1);
+        if (slots == 1)
+        {
+            scores[0] = (config->getTieredCheck()) ?
+                        checkAndScoreTiered(batch[0].first, false, "") :
+                        checkAndScore(batch[0].first, false, false, "");
+        }
+        else
+        {
+            for (int i = 0; i < batch.size(); i ++)
+            {
+                stp_pool->add(new ScoreJob(this, batch[i].first, 
+                                           &(scores[i])));
+            }
+            stp_pool->wait();
+        }
+        basicBlocksCovered.insert(delta_basicBlocksCovered.begin(), 
+                                  delta_basicBlocksCovered.end());
+        delta_basicBlocksCovered.clear();
+        bool failed = false;
+        for (int i = 0; i < batch.size(); i ++)
+        {
+            if (scores[i] < 0)
+            {
+                failed = true;
+                if (batch[i].first != initial)
+                {
+                    delete batch[i].first;
+                }
+                continue;
+            }
+            LOG(Logger::DEBUG, "Deferred score = " << scores[i] << ".");
+            batch[i].first->estimated = false;
+            addInput(batch[i].first, batch[i].second, scores[i]);
+        }
+        if (failed)
+        {
+            return -1;
+        }
+    }
+    return 0;
 }
 
+/* Each plugin-agent session has a thread that takes inputs produced by
+   STP threads from remote_inputs and checks them. The local files of
+   session i have suffix _<i + 1>, as those of STP thread i + 1. */
+
 void* launch_cv(void* data)
 {
+    Thread* session_thread = (Thread*) data;
+    ExecutionManager* this_pointer = 
+             (ExecutionManager*) (session_thread->getPrivateData("this_pointer"));
+    int session = (long) (session_thread->getPrivateData("session"));
+    ostringstream file_name_modifier;
+    file_name_modifier << "_" << session + 1;
     while(true)
     {
         pthread_mutex_lock(&add_remote_mutex);
-        if ((remote_inputs.size() == 0) && !launch_cv_stop)
+        while ((remote_inputs.size() == 0) && !launch_cv_stop)
         {
             pthread_cond_wait(&input_available_cond, &add_remote_mutex);
         }
-        if (launch_cv_stop && (remote_inputs.size() == 0))
+        if (remote_inputs.size() == 0)
         {
             pthread_mutex_unlock(&add_remote_mutex);
             break;
         }
-        if (remote_inputs.size() > 0)
+        pair<Input*, unsigned int> remote_input = remote_inputs.top();
+        remote_inputs.pop();
+        pthread_mutex_unlock(&add_remote_mutex);
+        pthread_cond_signal(&remote_space_cond);
+
+        int score = 
+              this_pointer->checkAndScore(remote_input.first, !trace_kind,
+                                          false, file_name_modifier.str(),
+                                          "", session);
+        if (score == -1)
         {
-            pair<Input*, unsigned int> remote_input = remote_inputs.top();
-            remote_inputs.pop();
-            ExecutionManager* this_pointer = (ExecutionManager*) data;
-            int score = 
-                  this_pointer->checkAndScore(remote_input.first, !trace_kind,
-                                              false, "");
-            if (score == -1)
-            {
-                return (void*) (-1);
-            }
-            LOG(Logger::REPORT, "Score = " << score << ".");
-            pthread_mutex_lock(&add_inputs_mutex);
-            this_pointer->addInput(remote_input.first, 
-                                   remote_input.second, score);
-            pthread_mutex_unlock(&add_inputs_mutex);
+            delete remote_input.first;
+            f_error = true;
+            break;
         }
-        pthread_mutex_unlock(&add_remote_mutex);
-    }
+        LOG(Logger::REPORT, "Score = " << score << ".");
+        this_pointer->addInput(remote_input.first, 
+                               remote_input.second, score);
+    }
+    // Do not leave STP threads waiting for a session that has failed
+    pthread_mutex_lock(&add_remote_mutex);
+    active_remote_sessions --;
+    pthread_mutex_unlock(&add_remote_mutex);
+    pthread_cond_broadcast(&remote_space_cond);
     return NULL;
 }
 
 int ExecutionManager::processTraceParallel(Input * first_input, 
                                            unsigned long first_depth)
 {
-    string actual_file_name = temp_dir + string("actual.log");
+    string actual_file_name = trace_dir + string("actual.log");
     int actual_fd = open(actual_file_name.c_str(), O_RDONLY, S_IRUSR);
     if (actual_fd == -1)
     {
@@ -1202,9 +1883,8 @@ int ExecutionManager::processTraceParallel(Input * first_input,
         return -1;
     }
     close(actual_fd);
-    int active_threads = thread_num;
     long depth = 0;
-    string trace_file = temp_dir + ((trace_kind) ? string("trace.log") 
+    string trace_file = trace_dir + ((trace_kind) ? string("trace.log") 
                                                  : string("dangertrace.log"));
     FileBuffer *trace;
     try
@@ -1220,88 +1900,69 @@ int ExecutionManager::processTraceParallel(Input * first_input,
         LOG(Logger::ERROR, strerror(errno));
         return -1;
     }
-    Thread::clearSharedData();
-    Thread::addSharedData((void*) &inputs, string("inputs"));
-    Thread::addSharedData((void*) first_input, string("first_input"));
-    Thread::addSharedData((void*) first_depth, string("first_depth"));
-    Thread::addSharedData((void*) actual, string("actual"));
-    Thread::addSharedData((void*) this, string("this_pointer"));
     char* query = trace->buf;
     while((query = strstr(query, "QUERY(FALSE);")) != NULL)
     {
         depth ++;
         query ++;
     }
-    for (int j = 0; j < ((depth < thread_num) ? depth : thread_num); j ++)
-    {
-        threads[j].setCustomTID(j + 1);
-        threads[j].setPoolSync(&finish_mutex, &finish_cond, &active_threads);
-    }
-    int thread_counter;
-    job_wrapper external_data[depth];
+    job_wrapper remote_external_data[remote_sessions];
     if (config->getRemoteValgrind() != "")
     {
-        job_wrapper remote_external_data;
-        remote_external_data.work_func = launch_cv;
-        remote_external_data.data = this;
         launch_cv_stop = false;
-        remote_thread.createThread(&remote_external_data);
+        active_remote_sessions = remote_sessions;
+        for (int i = 0; i < remote_sessions; i ++)
+        {
+            remote_threads[i].addPrivateData((void*) this, string("this_pointer"));
+            remote_threads[i].addPrivateData((void*) i, string("session"));
+            remote_external_data[i].work_func = launch_cv;
+            remote_external_data[i].data = &(remote_threads[i]);
+            remote_threads[i].createThread(&(remote_external_data[i]));
+        }
     }
+    unsigned long long prefix_hash = 
+                      hashPrediction(actual, first_input->startdepth - 1);
     for (int i = 0; i < depth; i ++)
     {
-        pthread_mutex_lock(&finish_mutex);
-        if (active_threads == 0) 
-        {
-            pthread_cond_wait(&finish_cond, &finish_mutex);
-        }
-        for (thread_counter = 0; thread_counter < thread_num; thread_counter ++) 
+        string branch_site = trace->getQueryBranchSite();
+        if (trace_kind)
         {
-            if (threads[thread_counter].getStatus())
+            bool branch = actual[first_input->startdepth + i - 1];
+            bool attempted = isAttemptedQuery(branch_site, prefix_hash,
+                                              !branch);
+            prefix_hash = hashPrediction(prefix_hash, branch);
+            if (attempted)
             {
-                break;
+                trace->skipQuery();
+                continue;
             }
         }
-        if (threads[thread_counter].getStatus() == PoolThread::FREE)
-        {
-            threads[thread_counter].waitForThread();
-        }
-        active_threads --;
-        threads[thread_counter].addPrivateData((void*) i, string("depth"));
-        external_data[i].work_func = process_query;
-        external_data[i].data = &(threads[thread_counter]);
-        ostringstream cur_trace;
-        if (trace_kind)
-        {
-            cur_trace << temp_dir << "curtrace_";
-        }
-        else
+        FileBuffer* cur_query = trace->cutQuery(trace_kind);
+        if (cur_query == NULL)
         {
-            cur_trace << temp_dir << "curdtrace_";
-        } 
-        cur_trace << thread_counter + 1 << ".log";
-        if (trace->cutQueryAndDump(cur_trace.str().c_str(), trace_kind) < 0)
-        {
-            pthread_mutex_unlock(&finish_mutex);
             f_error = true;
             break;
         }
-        in_thread_creation = thread_counter;
-        threads[thread_counter].setStatus(PoolThread::BUSY);
-        threads[thread_counter].createThread(&(external_data[i]));
-        in_thread_creation = -1;
-        pthread_mutex_unlock(&finish_mutex);
-    }
-    for (int i = 0; i < ((depth < thread_num) ? depth : thread_num); i ++)
-    {
-        threads[i].waitForThread();
+        stp_pool->add(new QueryJob(this, first_input, actual, first_depth, i,
+                                   branch_site, cur_query));
     }
+    stp_pool->wait();
     if (config->getRemoteValgrind() != "")
     {
         pthread_mutex_lock(&add_remote_mutex);
         launch_cv_stop = true;
         pthread_mutex_unlock(&add_remote_mutex);
-        pthread_cond_signal(&input_available_cond);
-        remote_thread.waitForThread();
+        pthread_cond_broadcast(&input_available_cond);
+        for (int i = 0; i < remote_sessions; i ++)
+        {
+            remote_threads[i].waitForThread();
+        }
+        // Inputs left when every session has failed are never checked
+        while (!remote_inputs.empty())
+        {
+            delete remote_inputs.top().first;
+            remote_inputs.pop();
+        }
     }
     delete trace;
     if (f_error)
@@ -1316,7 +1977,7 @@ int ExecutionManager::processTraceParallel(Input * first_input,
 int ExecutionManager::processTraceSequental(Input* first_input, 
                                             unsigned long first_depth)
 {
-    string actual_file_name = temp_dir + string("actual.log");
+    string actual_file_name = trace_dir + string("actual.log");
     int actual_fd = open(actual_file_name.c_str(), O_RDONLY, S_IRUSR);
     char *query;
     int actual_length, depth = 0;
@@ -1356,7 +2017,7 @@ int ExecutionManager::processTraceSequental(Input* first_input,
             int cur_depth = 0;
             trace_kind= false;
 
-            FileBuffer dtrace(temp_dir + string("dangertrace.log"));
+            FileBuffer dtrace(trace_dir + string("dangertrace.log"));
             while ((query = strstr(dtrace.buf, "QUERY(FALSE)")) != NULL)
             {
                 dtrace.cutQueryAndDump(temp_dir + string("curdtrace.log"));
@@ -1368,14 +2029,26 @@ int ExecutionManager::processTraceSequental(Input* first_input,
             }
         }
         trace_kind = true;
-        FileBuffer trace(temp_dir + string("trace.log"));
+        FileBuffer trace(trace_dir + string("trace.log"));
+        unsigned long long prefix_hash = 
+                      hashPrediction(actual, first_input->startdepth - 1);
         while((query = strstr(trace.buf, "QUERY(FALSE)")) != NULL)
         {
             depth++;
+            string branch_site = trace.getQueryBranchSite();
+            bool branch = actual[first_input->startdepth + depth - 2];
+            bool attempted = isAttemptedQuery(branch_site, prefix_hash, 
+                                              !branch);
+            prefix_hash = hashPrediction(prefix_hash, branch);
+            if (attempted)
+            {
+                trace.skipQuery();
+                continue;
+            }
             trace.cutQueryAndDump(temp_dir + string("curtrace.log"),
                                   true);
             if (processQuery(first_input, actual, 
-                             first_depth, depth - 1) < 0)
+                             first_depth, depth - 1, 0, branch_site) < 0)
             {
                 return -1;
             }
@@ -1388,39 +2061,27 @@ int ExecutionManager::processTraceSequental(Input* first_input,
     return depth;
 }
 
-void dummy_handler(int signo)
-{
-
-}
+/* In agent mode, when all inputs have zero score, steal a scored input
+   from a peer. If no peer can give one, continue with the zero scored
+   inputs. */
 
-int ExecutionManager::requestNonZeroInput()
+void ExecutionManager::requestNonZeroInput()
 {
-  multimap<Key, Input*, cmp>::iterator it = --(inputs.end());
-  int best_score = it->first.score;
-  if ((best_score == 0) && config->getAgent())
+  if (!config->getAgent())
   {
-    LOG(Logger::VERBOSE, "All inputs have zero score: requesting new input.");
-    signal(SIGUSR2, dummy_handler);
-    kill(getppid(), SIGUSR1);
-    pause();
-    string startdepth_file = temp_dir + string("startdepth.log");
-    int descr = open(startdepth_file.c_str(), O_RDONLY | O_CREAT, 
-                     S_IRUSR | S_IROTH | S_IRGRP | S_IWUSR | S_IWOTH | S_IWGRP);
-    int startdepth = 0;
-    read(descr, &startdepth, sizeof(int));
-    close(descr);
-    if (startdepth > 0)
-    {
-      return startdepth;
-    }
-    config->setNotAgent();
-    inputs.erase(it);
+    return;
   }
-  else
+  pthread_mutex_lock(&add_inputs_mutex);
+  unsigned int best_score = (--(inputs.end()))->first.score;
+  pthread_mutex_unlock(&add_inputs_mutex);
+  if (best_score == 0)
   {
-    inputs.erase(it);
+    LOG(Logger::VERBOSE, "All inputs have zero score: requesting new input.");
+    if (!stealInput(1))
+    {
+      config->setNotAgent();
+    }
   }
-  return 0;
 }
 
 bool ExecutionManager::updateArgv(Input* input)
@@ -1488,272 +2149,426 @@ bool ExecutionManager::updateArgv(Input* input)
   return true;
 }  
 
-void ExecutionManager::run()
+/* An input traced by a tracer of --tracers (0 if it is traced alone). */
+
+struct TracerJob
 {
-//    LOG(Logger::DEBUG, "Running execution manager.");
-    if (config->getCheckArgv() != "")
+  Input* input;
+  unsigned int score;
+  unsigned int depth;
+  int runs;
+  int tracer;
+  int exit_code;
+};
+
+void* trace_input(void* data)
+{
+  Thread* tracer_thread = (Thread*) data;
+  ExecutionManager* this_pointer = 
+           (ExecutionManager*) (tracer_thread->getPrivateData("this_pointer"));
+  TracerJob* job = (TracerJob*) (tracer_thread->getPrivateData("job"));
+  job->exit_code = this_pointer->runTracegrind(job->input, job->runs, 
+                                               job->tracer);
+  return NULL;
+}
+
+// Run Tracegrind on 'fi'. Returns 1 if the analysis should stop.
+
+int ExecutionManager::runTracegrind(Input* fi, int runs, int tracer)
+{
+  string tracer_dir = tracerDir(tracer);
+  string file_modifier = tracerModifier(tracer);
+  if (config->usingSockets() || config->usingDatagrams())
+  {
+    fi->dumpExploit((temp_dir + string("replace_data")).c_str(), true);
+  }
+  else
+  {
+    fi->dumpFiles(file_modifier, tracer_dir);
+  }
+
+  // Options for Tracegrind
+
+  ostringstream tg_depth;
+  vector<string> plugin_opts;
+
+  tg_depth << "--startdepth=" << fi->startdepth;
+  plugin_opts.push_back(tg_depth.str());
+  if (runs > 0)
+  {
+    plugin_opts.push_back("--check-prediction=yes");
+    if (abortOnDivergence(fi))
     {
-      string arg_lengths = temp_dir + string("arg_lengths");
-      int fd = open(arg_lengths.c_str(), O_CREAT | O_TRUNC | O_WRONLY, 
-                    S_IRUSR | S_IROTH | S_IRGRP | S_IWUSR | S_IWOTH | S_IWGRP);
-      int length;
-      for (int i = 1; i < cur_argv.size(); i ++)
-      {
-        length = cur_argv[i].size();
-        write(fd, &length, sizeof(int));
-      }
-      close(fd);
+      unlink((tracer_dir + string("divergence.log")).c_str());
+      plugin_opts.push_back("--abort-on-divergence=yes");
     }
-    int runs = 0;
+  }
 
-    // Reading files into initial input
+  getTracegrindOptions(plugin_opts, tracer);
 
-    initial = new Input();
-    if (!config->usingSockets() && !config->usingDatagrams())
+  if (config->getRemoteValgrind() == "")
+  {
+    plugin_opts.push_back(string("--log-file=") + 
+                          tracer_dir + string("execution.log"));
+  }
+
+  if (runs && (config->getCheckArgv() != ""))
+  {
+    updateArgv(fi);
+  }
+
+  vector <string> prog_and_args = cur_argv;
+  vector <string> plug_args = plugin_opts;
+  vector <char> to_send(plugin_opts.size() + cur_argv.size(), '\0');
+  if (!(config->usingSockets()) && !(config->usingDatagrams()))
+  {
+    for (int i = 0; i < cur_argv.size(); i ++)
     {
-      for (int i = 0; i < config->getNumberOfFiles(); i++)
+      for (int j = 0; j < fi->files.size(); j ++)
       {
-        try
-        {
-          initial->files.push_back(new FileBuffer(config->getFile(i)));
-        }
-        catch (const char *)
-        {
-          return;
-        }
-        catch (std::bad_alloc)
+        if (cur_argv[i] == fi->files.at(j)->getName())
         {
-          LOG(Logger::ERROR, strerror(errno));
-          return;
+          prog_and_args[i].append(file_modifier);
+          to_send[plugin_opts.size() + i] = 1;
         }
       }
     }
-    else 
+  }
+  for (int i = 0; i < prog_and_args.size(); i ++)
+  {
+    plug_args.push_back(prog_and_args[i]);
+  }
+  if (runs == 0)
+  {
+    for (int i = 0; i < plug_args.size(); i ++)
     {
-      if (config->getAgent())
+      if ((plug_args[i].find("--mask") != string::npos) ||
+          (plug_args[i].find("--func-filter") != string::npos))
       {
-        updateInput(initial);
+        to_send[i] = 1;
       }
-      signal(SIGALRM, alarmHandler);
     }
-    initial->startdepth = config->getStartdepth();
-    int score = checkAndScore(initial, false, true, "");
-    if (score < 0)
-    {
-      return;
-    }
-    basicBlocksCovered.insert(delta_basicBlocksCovered.begin(), delta_basicBlocksCovered.end());
-    LOG(Logger::DEBUG, "First score = " << score << ".");
-    inputs.insert(make_pair(Key(score, 0), initial));
-    bool delete_fi;
-    
-    while (!inputs.empty()) 
-    {
-      delete_fi = false;
-      LOG_TIME(Logger::JOURNAL, "Iteration " << (runs + 1) << ".");
-
-      monitor->removeTmpFiles();
-      delta_basicBlocksCovered.clear();
-      multimap<Key, Input*, cmp>::iterator it = --(inputs.end());
-      Input* fi = it->second; // first input
-      unsigned int scr = it->first.score;
-      unsigned int dpth = it->first.depth;
-      LOG(Logger::VERBOSE, "Inputs size = " << inputs.size() << ".");
-      LOG(Logger::VERBOSE, "Selected next input with score " << scr << ".");
+  }
+  Executor * plugin_exe;
+  if (config->getRemoteValgrind() != "")
+  {
+    plug_args.insert(plug_args.begin(), "--tool=tracegrind");
+    to_send.insert(to_send.begin(), 0);
+    plugin_exe = new RemotePluginExecutor(plug_args, remote_fds[0], to_send, 
+                                          config->getResultDir());
+  }
+  else
+  {
+    plugin_opts.insert(plugin_opts.begin(), "--tool=tracegrind");
+    plugin_exe = new PluginExecutor(config->getDebug(), 
+                                     config->getTraceChildren(), 
+                                     config->getValgrind() + config->getValgrindPath(), prog_and_args, 
+                                     plugin_opts);
+  }
+        
+  plugin_opts.clear();
+  if (config->getTracegrindAlarm() == 0)
+  {
+    pthread_mutex_lock(&nokill_mutex);
+    nokill_tracers ++;
+    nokill = true;
+    pthread_mutex_unlock(&nokill_mutex);
+  }
+  time_t start_time = time(NULL);
+  monitor->setState(TRACER, start_time, tracer);
 
-      if (config->usingSockets() || config->usingDatagrams())
+  int exitCode;
+  exitCode = plugin_exe->run(tracer); 
+  if (config->getTracegrindAlarm() == 0)
+  {
+    pthread_mutex_lock(&nokill_mutex);
+    nokill_tracers --;
+    nokill = (nokill_tracers > 0);
+    pthread_mutex_unlock(&nokill_mutex);
+  }
+  if (exitCode == 1)
+  {
+    delete plugin_exe;
+    return 1;
+  }
+
+  if (config->getCheckArgv() != "")
+  {
+    if (!runs)
+    {
+      string argv_log = temp_dir + string("argv.log");
+      config->addFile(argv_log);
+      try
       {
-        fi->dumpExploit((temp_dir + string("replace_data")).c_str(), true);
+        fi->files.push_back(new FileBuffer(argv_log));
       }
-      else
+      catch (const char *)
+      {
+        delete plugin_exe;
+        return 1;
+      }
+      catch (std::bad_alloc)
       {
-        fi->dumpFiles();
+        LOG(Logger::ERROR, strerror(errno));
+        delete plugin_exe;
+        return 1;
       }
+    }
+  }
+  monitor->addTime(time(NULL), tracer);
+
+  delete plugin_exe;
+  if (config->usingSockets() || config->usingDatagrams())
+  {
+    updateInput(fi);
+  }
+  return exitCode;
+}
+
+// Process the trace of 'fi'. Returns -1 if the analysis should stop.
 
-      // Options for Tracegrind
+int ExecutionManager::processTracedInput(Input* fi, unsigned int scr, 
+                                         unsigned int dpth, int exitCode, 
+                                         int runs)
+{
+  if (exitCode == -1)
+  {
+    LOG(Logger::DEBUG, "Failure in Tracegrind.");
+  }
 
-      ostringstream tg_depth;
-      vector<string> plugin_opts;
-      bool newInput = false;
+  if (config->getDebug() && (runs > 0))
+  {
+    if (checkDivergence(fi, scr))
+    {
+      return 0;
+    }
+  }
 
-      int startdepth = requestNonZeroInput();
-      if (startdepth)
+  if ((runs > 0) && abortOnDivergence(fi))
+  {
+    int divergence_depth = getDivergenceDepth();
+    if (divergence_depth >= 0)
+    {
+      LOG(Logger::DEBUG, "Tracegrind stopped on divergence at depth " <<
+                         divergence_depth << ".");
+      abortedTraces ++;
+      if (config->getDivergencePolicy() == "reschedule")
       {
-        tg_depth << "--startdepth=" << startdepth;
-        newInput = true;
+        fi->diverged = true;
+        addInput(fi, dpth, 0);
       }
-      else
+      else if (initial != fi)
       {
-        tg_depth << "--startdepth=" << fi->startdepth;
-        plugin_opts.push_back(tg_depth.str());
-        if (runs > 0)
-        {
-          plugin_opts.push_back("--check-prediction=yes");
-        }
+        delete fi;
       }
-  
-      getTracegrindOptions(plugin_opts);
+      return 0;
+    }
+  }
 
-      if (config->getRemoteValgrind() == "")
-      {
-        plugin_opts.push_back(string("--log-file=") + 
-                              temp_dir + string("execution.log"));
-      }
+  if (config->getDumpCalls())
+  {
+    return -1;
+  }
+  if (config->getParentPhase())
+  {
+    dumpPhaseHints(fi);
+  }
+  int depth = 0;
+  if (thread_num)
+  {
+    if (config->getCheckDanger())
+    {
+      trace_kind = false;
+      depth = processTraceParallel(fi, dpth);
+    }
+    trace_kind = true;
+    depth = processTraceParallel(fi, dpth);
+  }
+  else
+  {
+    depth = processTraceSequental(fi, dpth);
+  }
+    
+  if (depth == 0)
+  {
+    LOG(Logger::DEBUG, "No QUERY's found.");
+  }
+  if (depth == -1)
+  {
+    return -1;
+  }
+  if (initial != fi)
+  {
+    delete fi;
+  }
+  basicBlocksCovered.insert(delta_basicBlocksCovered.begin(), delta_basicBlocksCovered.end());
+  return 0;
+}
 
-      if (runs && (config->getCheckArgv() != ""))
+void ExecutionManager::run()
+{
+//    LOG(Logger::DEBUG, "Running execution manager.");
+    if (config->getCheckArgv() != "")
+    {
+      string arg_lengths = temp_dir + string("arg_lengths");
+      int fd = open(arg_lengths.c_str(), O_CREAT | O_TRUNC | O_WRONLY, 
+                    S_IRUSR | S_IROTH | S_IRGRP | S_IWUSR | S_IWOTH | S_IWGRP);
+      int length;
+      for (int i = 1; i < cur_argv.size(); i ++)
       {
-        updateArgv(fi);
+        length = cur_argv[i].size();
+        write(fd, &length, sizeof(int));
       }
+      close(fd);
+    }
+    int runs = 0;
 
-      vector <string> plug_args = plugin_opts;
-      for (int i = 0; i < cur_argv.size(); i ++)
-      {
-        plug_args.push_back(cur_argv[i]);
-      }
-      vector <char> to_send(plug_args.size(), '\0');
-      if (!(config->usingSockets()) && !(config->usingDatagrams()))
+    // Reading files into initial input
+
+    initial = new Input();
+    if (!config->usingSockets() && !config->usingDatagrams())
+    {
+      for (int i = 0; i < config->getNumberOfFiles(); i++)
       {
-        for (int i = 0; i < cur_argv.size(); i ++)
+        try
         {
-          for (int j = 0; j < fi->files.size(); j ++)
-          {
-            if (cur_argv[i] == fi->files.at(j)->getName())
-            {
-              to_send[plugin_opts.size() + i] = 1;
-            }
-          }
+          initial->files.push_back(new FileBuffer(config->getFile(i)));
         }
-      }
-      if (runs == 0)
-      {
-        for (int i = 0; i < plug_args.size(); i ++)
+        catch (const char *)
         {
-          if ((plug_args[i].find("--mask") != string::npos) ||
-              (plug_args[i].find("--func-filter") != string::npos))
-          {
-            to_send[i] = 1;
-          }
+          return;
+        }
+        catch (std::bad_alloc)
+        {
+          LOG(Logger::ERROR, strerror(errno));
+          return;
         }
       }
-      Executor * plugin_exe;
-      if (config->getRemoteValgrind() != "")
-      {
-        plug_args.insert(plug_args.begin(), "--tool=tracegrind");
-        to_send.insert(to_send.begin(), 0);
-        plugin_exe = new RemotePluginExecutor(plug_args, remote_fd, to_send, 
-                                              config->getResultDir());
-      }
-      else
-      {
-        plugin_opts.insert(plugin_opts.begin(), "--tool=tracegrind");
-        plugin_exe = new PluginExecutor(config->getDebug(), 
-                                         config->getTraceChildren(), 
-                                         config->getValgrind() + config->getValgrindPath(), cur_argv, 
-                                         plugin_opts);
-      }
-            
-      plugin_opts.clear();
-      if (config->getTracegrindAlarm() == 0)
+    }
+    else 
+    {
+      if (config->getAgent())
       {
-        nokill = true;
+        updateInput(initial);
       }
-      time_t start_time = time(NULL);
-      monitor->setState(TRACER, start_time);
-
-      // Tracegrind running
+      signal(SIGALRM, alarmHandler);
+    }
+    initial->startdepth = config->getStartdepth();
+    int score = checkAndScore(initial, false, true, "");
+    if (score < 0)
+    {
+      return;
+    }
+    basicBlocksCovered.insert(delta_basicBlocksCovered.begin(), delta_basicBlocksCovered.end());
+    LOG(Logger::DEBUG, "First score = " << score << ".");
+    addInput(initial, 0, score);
+    bool delete_fi;
+    
+    // On SIGINT the analysis ends with the iteration that runs
+    while (!monitor->getKilledStatus() && (!inputs.empty() || stealInput(0))) 
+    {
+      delete_fi = false;
+      LOG_TIME(Logger::JOURNAL, "Iteration " << (runs + 1) << ".");
 
-      int exitCode;
-      exitCode = plugin_exe->run(); 
-      if (exitCode == 1)
+      monitor->removeTmpFiles();
+      delta_basicBlocksCovered.clear();
+      shareCoverage();
+      if (config->getLazyScoring() && (scoreTopInputs() < 0))
       {
         break;
       }
+      requestNonZeroInput();
 
-      if (config->getCheckArgv() != "")
+      // The steal server may take inputs from the queue at any time.
+      // With several tracers, only the top inputs that have their real
+      // score are traced together.
+      vector<TracerJob> jobs;
+      pthread_mutex_lock(&add_inputs_mutex);
+      LOG(Logger::VERBOSE, "Inputs size = " << inputs.size() << ".");
+      while ((jobs.size() < tracer_num) && !inputs.empty())
       {
-        if (!runs)
+        multimap<Key, Input*, cmp>::iterator it = --(inputs.end());
+        if (!jobs.empty() && it->second->estimated)
         {
-          string argv_log = temp_dir + string("argv.log");
-          config->addFile(argv_log);
-          try
-          {
-            fi->files.push_back(new FileBuffer(argv_log));
-          }
-          catch (const char *)
-          {
-            return;
-          }
-          catch (std::bad_alloc)
-          {
-            LOG(Logger::ERROR, strerror(errno));
-            return;
-          }
+          break;
         }
+        TracerJob job;
+        job.input = it->second;
+        job.score = it->first.score;
+        job.depth = it->first.depth;
+        job.runs = runs;
+        job.exit_code = 0;
+        jobs.push_back(job);
+        inputs.erase(it);
       }
-      monitor->addTime(time(NULL));
-
-      delete plugin_exe;
-      if (config->getTracegrindAlarm() == 0)
-      {      
-        nokill = false;
+      pthread_mutex_unlock(&add_inputs_mutex);
+      if (jobs.empty())
+      {
+        continue;
       }
-      if (config->usingSockets() || config->usingDatagrams())
+      for (int i = 0; i < jobs.size(); i ++)
       {
-        updateInput(fi);
+        LOG(Logger::VERBOSE, "Selected next input with score " << 
+                             jobs[i].score << ".");
+        jobs[i].tracer = (jobs.size() > 1) ? i + 1 : 0;
       }
 
-      if (exitCode == -1)
+      // Tracegrind running
+
+      if (jobs.size() == 1)
       {
-        LOG(Logger::DEBUG, "Failure in Tracegrind.");
+        jobs[0].exit_code = runTracegrind(jobs[0].input, runs);
       }
-
-      if (config->getDebug() && (runs > 0) && !newInput)
+      else
       {
-        if (checkDivergence(fi, scr))
+        // The time of the whole stage goes to tracegrind in the monitor
+        monitor->setState(TRACER, time(NULL));
+        job_wrapper tracer_data[jobs.size()];
+        for (int i = 0; i < jobs.size(); i ++)
         {
-          runs ++;
-          continue;
+          tracer_threads[i].addPrivateData((void*) this, string("this_pointer"));
+          tracer_threads[i].addPrivateData((void*) &(jobs[i]), string("job"));
+          tracer_data[i].work_func = trace_input;
+          tracer_data[i].data = &(tracer_threads[i]);
+          tracer_threads[i].createThread(&(tracer_data[i]));
         }
-      }
- 
-      if (config->getDumpCalls())
-      {
-        break;
-      }
-      int depth = 0;
-      if (thread_num)
-      {
-        if (config->getCheckDanger())
+        for (int i = 0; i < jobs.size(); i ++)
         {
-          trace_kind = false;
-          depth = processTraceParallel(fi, dpth);
+          tracer_threads[i].waitForThread();
         }
-        trace_kind = true;
-        depth = processTraceParallel(fi, dpth);
+        monitor->addTime(time(NULL));
       }
-      else
-      {
-        depth = processTraceSequental(fi, dpth);
-      }
-        
-      if (depth == 0)
+
+      // The traces go to STP threads one by one
+
+      bool stop = false;
+      for (int i = 0; (i < jobs.size()) && !stop; i ++)
       {
-        LOG(Logger::DEBUG, "No QUERY's found.");
+        trace_dir = tracerDir(jobs[i].tracer);
+        trace_file_modifier = tracerModifier(jobs[i].tracer);
+        stop = (jobs[i].exit_code == 1) || 
+               (processTracedInput(jobs[i].input, jobs[i].score, 
+                                   jobs[i].depth, jobs[i].exit_code, 
+                                   runs) < 0);
+        if (!stop)
+        {
+          runs ++;
+        }
       }
-      if (depth == -1)
+      if (stop)
       {
         break;
       }
-      runs++;
-      if (initial != fi)
-      {
-        delete fi;
-      }
-      basicBlocksCovered.insert(delta_basicBlocksCovered.begin(), delta_basicBlocksCovered.end());
-      if (is_distributed)
-      {
-        talkToServer();
-      }
+    }
+    if (abortedTraces > 0)
+    {
+      LOG(Logger::VERBOSE, "Stopped " << abortedTraces << 
+                           " traces on divergence.");
+    }
+    if (skippedQueries > 0)
+    {
+      LOG(Logger::VERBOSE, "Skipped " << skippedQueries << 
+                           " already attempted queries.");
     }
     if (!(config->usingSockets()) && !(config->usingDatagrams()))
     {
@@ -1761,294 +2576,601 @@ void ExecutionManager::run()
     }
 }
 
-static void writeToSocket(int fd, const void* b, size_t count)
+/* Steal server: every peer of distributed Avalanche serves the requests
+   of the other peers on its own port, so that inputs go directly from a
+   busy peer to an idle one. Requests are one byte:
+     'c' - options and an input for a new av-agent (main Avalanche only);
+     's' - an input for a peer that is out of work. */
+
+void* serve_steals(void* data)
 {
-  char* buf = (char*) b;
-  size_t sent = 0;
-  while (sent < count)
+  ExecutionManager* this_pointer = (ExecutionManager*) data;
+  for (;;)
   {
-    size_t s = write(fd, buf + sent, count - sent);
-    if (s == -1)
+    int fd = accept(steal_fd, NULL, NULL);
+    if (fd < 0)
     {
-      throw "error writing to socket";
+      if (errno == EINTR)
+      {
+        continue;
+      }
+      break;
     }
-    sent += s;
+    try
+    {
+      this_pointer->serveRequest(fd);
+    }
+    catch (const char* msg)
+    {
+      LOG(Logger::NETWORK_LOG, "Connection with peer lost.");
+    }
+    close(fd);
   }
+  return NULL;
 }
 
-static void readFromSocket(int fd, const void* b, size_t count)
+int ExecutionManager::startStealServer()
 {
-  char* buf = (char*) b;
-  size_t received = 0;
-  while (received < count)
+  struct sockaddr_in st_socket_addr;
+  socklen_t addr_len = sizeof(struct sockaddr_in);
+  steal_fd = socket(PF_INET, SOCK_STREAM, IPPROTO_TCP);
+  if (steal_fd == -1)
   {
-    size_t r = read(fd, buf + received, count - received);
-    if (r == 0)
+    perror("cannot create socket");
+    exit(EXIT_FAILURE);
+  }
+  memset(&st_socket_addr, 0, sizeof(struct sockaddr_in));
+  st_socket_addr.sin_family = AF_INET;
+  st_socket_addr.sin_port = 0;
+  st_socket_addr.sin_addr.s_addr = INADDR_ANY;
+  if ((bind(steal_fd, (const struct sockaddr*)&st_socket_addr, sizeof(struct sockaddr_in)) < 0) ||
+      (listen(steal_fd, 10) < 0) ||
+      (getsockname(steal_fd, (struct sockaddr*)&st_socket_addr, &addr_len) < 0))
+  {
+    perror("cannot start steal server");
+    close(steal_fd);
+    exit(EXIT_FAILURE);
+  }
+
+  static job_wrapper steal_data;
+  steal_data.work_func = serve_steals;
+  steal_data.data = this;
+  steal_thread.createThread(&steal_data);
+  return ntohs(st_socket_addr.sin_port);
+}
+
+void ExecutionManager::stopStealServer()
+{
+  shutdown(steal_fd, SHUT_RDWR);
+  close(steal_fd);
+  steal_thread.waitForThread();
+  steal_fd = -1;
+}
+
+void ExecutionManager::serveRequest(int fd)
+{
+  char c;
+  readFromSocket(fd, &c, 1);
+  if ((c == 'c') && is_distributed)
+  {
+    unsigned int depth;
+    Input* input = takeSpareInput(0, 0, depth);
+    if (input == NULL)
     {
-      throw "connection is down";
+      int tosend = 0;
+      writeToSocket(fd, &tosend, sizeof(int));
+      return;
     }
-    if (r == -1)
+    LOG(Logger::NETWORK_LOG, "Sending options and data.");
+    try
     {
-      throw "error reading from socket";
+      sendOptions(fd, input);
     }
-    received += r;
+    catch (const char* msg)
+    {
+      addInput(input, depth, input->score);
+      throw;
+    }
+    pthread_mutex_lock(&add_inputs_mutex);
+    inputs_sent ++;
+    pthread_mutex_unlock(&add_inputs_mutex);
+    if (input != initial)
+    {
+      delete input;
+    }
+  }
+  else if (c == 's')
+  {
+    StealRequest request;
+    unsigned int depth;
+    readFromSocket(fd, &request, sizeof(StealRequest));
+    Input* input = NULL;
+    if (request.version == PROTOCOL_VERSION)
+    {
+      input = takeSpareInput(request.peers, request.min_score, depth);
+    }
+    else
+    {
+      LOG(Logger::NETWORK_LOG, "Peer uses protocol version " << 
+                               request.version << ": not giving inputs.");
+    }
+    if (input == NULL)
+    {
+      MessageHeader header = { PROTOCOL_VERSION, 0 };
+      writeToSocket(fd, &header, sizeof(MessageHeader));
+      return;
+    }
+    LOG(Logger::NETWORK_LOG, "Sending input.");
+    try
+    {
+      sendInput(fd, input, depth);
+    }
+    catch (const char* msg)
+    {
+      addInput(input, depth, input->score);
+      throw;
+    }
+    pthread_mutex_lock(&add_inputs_mutex);
+    inputs_sent ++;
+    pthread_mutex_unlock(&add_inputs_mutex);
+    if (input != initial)
+    {
+      delete input;
+    }
+  }
+}
+
+/* Take an input to give away. The best input always stays with this
+   peer; with --protect-main-agent main Avalanche keeps 5 inputs per
+   peer. */
+
+Input* ExecutionManager::takeSpareInput(int peers, unsigned int min_score, 
+                                        unsigned int &depth)
+{
+  Input* input = NULL;
+  unsigned int limit = config->getProtectMainAgent() ? N * peers : 1;
+  pthread_mutex_lock(&add_inputs_mutex);
+  if (inputs.size() > limit)
+  {
+    multimap<Key, Input*, cmp>::iterator it = --inputs.end();
+    it--;
+    if (it->first.score >= min_score)
+    {
+      input = it->second;
+      depth = it->first.depth;
+      inputs.erase(it);
+    }
+  }
+  pthread_mutex_unlock(&add_inputs_mutex);
+  return input;
+}
+
+void ExecutionManager::sendOptions(int fd, Input* input)
+{
+  // Sent once per av-agent: collected in one buffer, sent at once
+  string msg;
+  int size;
+  int filenum = input->files.size();
+  appendToMessage(msg, &filenum, sizeof(int));
+  bool sockets = config->usingSockets();
+  appendToMessage(msg, &sockets, sizeof(bool));
+  bool datagrams = config->usingDatagrams();
+  appendToMessage(msg, &datagrams, sizeof(bool));
+  for (int j = 0; j < input->files.size(); j ++)
+  {
+    FileBuffer* fb = input->files.at(j);
+    if (!config->usingDatagrams() && ! config->usingSockets())
+    {
+      int namelength = config->getFile(j).length();
+      appendToMessage(msg, &namelength, sizeof(int));
+      appendToMessage(msg, config->getFile(j).c_str(), namelength);
+    }
+    size = fb->getSize();
+    appendToMessage(msg, &size, sizeof(int));
+    appendToMessage(msg, fb->buf, size);
+  }
+  appendToMessage(msg, &input->startdepth, sizeof(int));
+  int depth = config->getDepth();
+  appendToMessage(msg, &depth, sizeof(int));
+  unsigned int alarm = config->getAlarm();
+  appendToMessage(msg, &alarm, sizeof(int));
+  unsigned int tracegrindAlarm = config->getTracegrindAlarm();
+  appendToMessage(msg, &tracegrindAlarm, sizeof(int));
+  int threads = config->getSTPThreads();
+  appendToMessage(msg, &threads, sizeof(int));
+
+  int progArgsNum = config->getProgAndArg().size();
+  appendToMessage(msg, &progArgsNum, sizeof(int));
+
+  bool leaks = config->checkForLeaks();
+  appendToMessage(msg, &leaks, sizeof(bool));
+  bool traceChildren = config->getTraceChildren();
+  appendToMessage(msg, &traceChildren, sizeof(bool));
+  bool checkDanger = config->getCheckDanger();
+  appendToMessage(msg, &checkDanger, sizeof(bool));
+  bool debug = config->getDebug();
+  appendToMessage(msg, &debug, sizeof(bool));
+  bool verbose = config->getVerbose();
+  appendToMessage(msg, &verbose, sizeof(bool));
+  bool programOutput = config->getProgramOutput();
+  appendToMessage(msg, &programOutput, sizeof(bool));
+  bool networkLog = config->getNetworkLog();
+  appendToMessage(msg, &networkLog, sizeof(bool));
+  bool suppressSubcalls = config->getSuppressSubcalls();
+  appendToMessage(msg, &suppressSubcalls, sizeof(bool));
+  bool STPThreadsAuto = config->getSTPThreadsAuto();
+  appendToMessage(msg, &STPThreadsAuto, sizeof(bool));
+
+  if (sockets)
+  {
+    string host = config->getHost();
+    int length = host.length();
+    appendToMessage(msg, &length, sizeof(int));
+    appendToMessage(msg, host.c_str(), length);
+    unsigned int port = config->getPort();
+    appendToMessage(msg, &port, sizeof(int));
+  }
+  
+  {
+    string plugin_name = config->getPlugin();
+    int length = plugin_name.length();
+    appendToMessage(msg, &length, sizeof(int));
+    appendToMessage(msg, plugin_name.c_str(), length);
+  }
+
+  if (config->getInputFilterFile() != "")
+  {
+    FileBuffer *mask = NULL;
+    try
+    {
+      mask = new FileBuffer(config->getInputFilterFile());
+      size = mask->getSize();
+    }
+    catch (const char*)
+    {
+      size = 0;
+    }
+    appendToMessage(msg, &size, sizeof(int));
+    if (size > 0)
+    {
+      appendToMessage(msg, mask->buf, size);
+    }
+    delete mask;
+  }
+  else
+  {
+    int z = 0;
+    appendToMessage(msg, &z, sizeof(int));
   }
+
+  int funcFilters = config->getFuncFilterUnitsNum();
+  appendToMessage(msg, &funcFilters, sizeof(int));
+  for (int i = 0; i < config->getFuncFilterUnitsNum(); i++)
+  {
+    string f = config->getFuncFilterUnit(i);
+    int length = f.length();
+    appendToMessage(msg, &length, sizeof(int));
+    appendToMessage(msg, f.c_str(), length);
+  }
+  if (config->getFuncFilterFile() != "")
+  {
+    FileBuffer *filter = NULL;
+    try
+    {
+      filter = new FileBuffer(config->getFuncFilterFile());
+      size = filter->getSize();
+    }
+    catch (const char*)
+    {
+      size = 0;
+    }
+    appendToMessage(msg, &size, sizeof(int));
+    if (size > 0)
+    {
+      appendToMessage(msg, filter->buf, size);
+    }
+    delete filter;
+  }
+  else
+  {
+    int z = 0;
+    appendToMessage(msg, &z, sizeof(int));
+  }
+  if (config->getAgentDir() != string(""))
+  {
+    string agentDir = config->getAgentDir();
+    int length = agentDir.length();
+    appendToMessage(msg, &length, sizeof(int));
+    appendToMessage(msg, agentDir.c_str(), length);
+  }
+  else
+  {
+    int length = 0;
+    appendToMessage(msg, &length, sizeof(int));
+  }
+  for (vector<string>::const_iterator it = config->getProgAndArg().begin(); it != config->getProgAndArg().end(); it++)
+  {
+    int argsSize = it->length();
+    appendToMessage(msg, &argsSize, sizeof(int));
+    appendToMessage(msg, it->c_str(), argsSize);
+  }
+  writeToSocket(fd, msg.data(), msg.size());
 }
 
-void ExecutionManager::talkToServer()
+void ExecutionManager::sendInput(int fd, Input* input, unsigned int depth)
 {
+  int filenum = input->files.size();
+  string head, tail;
+  for (int j = 0; j < filenum; j ++)
+  {
+    int size = input->files.at(j)->getSize();
+    appendToMessage(head, &size, sizeof(int));
+  }
+  appendToMessage(tail, &input->startdepth, sizeof(int));
+  appendToMessage(tail, &input->score, sizeof(int));
+  appendToMessage(tail, &depth, sizeof(int));
+  appendToMessage(tail, &input->prediction_size, sizeof(int));
+  if (input->prediction_size > 0)
+  {
+    appendToMessage(tail, input->prediction, input->prediction_size * sizeof(bool));
+  }
+  appendToMessage(tail, &input->estimated, sizeof(bool));
+  appendToMessage(tail, &input->diverged, sizeof(bool));
+
+  MessageHeader header;
+  header.version = PROTOCOL_VERSION;
+  header.length = sizeof(int) + head.size() + tail.size();
+  vector<struct iovec> iov(3);
+  iov[0].iov_base = &header;
+  iov[0].iov_len = sizeof(MessageHeader);
+  iov[1].iov_base = &filenum;
+  iov[1].iov_len = sizeof(int);
+  iov[2].iov_base = (void*) head.data();
+  iov[2].iov_len = head.size();
+  for (int j = 0; j < filenum; j ++)
+  {
+    struct iovec file;
+    file.iov_base = input->files.at(j)->buf;
+    file.iov_len = input->files.at(j)->getSize();
+    iov.push_back(file);
+    header.length += file.iov_len;
+  }
+  struct iovec fields;
+  fields.iov_base = (void*) tail.data();
+  fields.iov_len = tail.size();
+  iov.push_back(fields);
+  writevToSocket(fd, &iov[0], iov.size());
+}
+
+/* Read an input sent by sendInput. Returns NULL if the peer had no
+   input to give. */
+
+Input* ExecutionManager::recvInput(int fd, unsigned int &depth)
+{
+  MessageHeader header;
+  readFromSocket(fd, &header, sizeof(MessageHeader));
+  if (header.version != PROTOCOL_VERSION)
+  {
+    throw "unsupported protocol version";
+  }
+  if (header.length <= 0)
+  {
+    return NULL;
+  }
+  vector<char> msg(header.length);
+  readFromSocket(fd, &msg[0], header.length);
+  const char* cur = &msg[0];
+  const char* end = cur + header.length;
+
+  int filenum;
+  if (end - cur < sizeof(int))
+  {
+    throw "malformed input message";
+  }
+  memcpy(&filenum, cur, sizeof(int));
+  cur += sizeof(int);
+  bool network = config->usingSockets() || config->usingDatagrams();
+  if ((filenum <= 0) || (!network && (filenum != initial->files.size())))
+  {
+    throw "wrong number of files";
+  }
+  if (end - cur < filenum * sizeof(int))
+  {
+    throw "malformed input message";
+  }
+  vector<int> sizes(filenum);
+  memcpy(&sizes[0], cur, filenum * sizeof(int));
+  cur += filenum * sizeof(int);
+
+  Input* input = new Input();
   try
   {
-    int size;
-    int response_num;
-    LOG(Logger::NETWORK_LOG, "Communicating with server.");
-    fd_set readfds;
-    FD_ZERO(&readfds);
-    FD_SET(dist_fd, &readfds);
-    struct timeval timer;
-    timer.tv_sec = 0;
-    timer.tv_usec = 0;
-    select(dist_fd + 1, &readfds, NULL, NULL, &timer);
-    int limit = config->getProtectMainAgent() ? N * agents : 1;
-    while (FD_ISSET(dist_fd, &readfds)) 
-    {
-      char c = '\0';
-      readFromSocket(dist_fd, &c, 1);
-      if (c == 'a')
+    for (int j = 0; j < filenum; j ++)
+    {
+      int size = sizes[j];
+      if ((size < 0) || (end - cur < size))
       {
-        LOG(Logger::NETWORK_LOG, "Sending options and data.");
-        writeToSocket(dist_fd, "r", 1); 
-        //sending "r"(responding) before data - this is to have something different from "q", so that server
-        //can understand that main avalanche finished normally
-        readFromSocket(dist_fd, &response_num, sizeof(int));
-        while (response_num > 0)
-        {
-          if (inputs.size() <= limit)
-          {
-            break;
-          }
-          multimap<Key, Input*, cmp>::iterator it = --inputs.end();
-          it--;
-          Input* fi = it->second;
-          int filenum = fi->files.size();
-          writeToSocket(dist_fd, &filenum, sizeof(int));
-          bool sockets = config->usingSockets();
-          writeToSocket(dist_fd, &sockets, sizeof(bool));
-          bool datagrams = config->usingDatagrams();
-          writeToSocket(dist_fd, &datagrams, sizeof(bool));
-          for (int j = 0; j < fi->files.size(); j ++)
-          {
-            FileBuffer* fb = fi->files.at(j);
-            if (!config->usingDatagrams() && ! config->usingSockets())
-            {
-              int namelength = config->getFile(j).length();
-              writeToSocket(dist_fd, &namelength, sizeof(int));
-              writeToSocket(dist_fd, config->getFile(j).c_str(), namelength);
-            }
-            size = fb->getSize();
-            writeToSocket(dist_fd, &size, sizeof(int));
-            writeToSocket(dist_fd, fb->buf, size);
-          }
-          writeToSocket(dist_fd, &fi->startdepth, sizeof(int));
-          int depth = config->getDepth();
-          writeToSocket(dist_fd, &depth, sizeof(int));
-          unsigned int alarm = config->getAlarm();
-          writeToSocket(dist_fd, &alarm, sizeof(int));
-          unsigned int tracegrindAlarm = config->getTracegrindAlarm();
-          writeToSocket(dist_fd, &tracegrindAlarm, sizeof(int));
-          int threads = config->getSTPThreads();
-          writeToSocket(dist_fd, &threads, sizeof(int));
-
-          int progArgsNum = config->getProgAndArg().size();
-          writeToSocket(dist_fd, &progArgsNum, sizeof(int));
-
-          bool leaks = config->checkForLeaks();
-          writeToSocket(dist_fd, &leaks, sizeof(bool));
-          bool traceChildren = config->getTraceChildren();
-          writeToSocket(dist_fd, &traceChildren, sizeof(bool));
-          bool checkDanger = config->getCheckDanger();
-          writeToSocket(dist_fd, &checkDanger, sizeof(bool));
-          bool debug = config->getDebug();
-          writeToSocket(dist_fd, &debug, sizeof(bool));
-          bool verbose = config->getVerbose();
-          writeToSocket(dist_fd, &verbose, sizeof(bool));
-          bool programOutput = config->getProgramOutput();
-          writeToSocket(dist_fd, &programOutput, sizeof(bool));
-          bool networkLog = config->getNetworkLog();
-          writeToSocket(dist_fd, &networkLog, sizeof(bool));
-          bool suppressSubcalls = config->getSuppressSubcalls();
-          writeToSocket(dist_fd, &suppressSubcalls, sizeof(bool));
-          bool STPThreadsAuto = config->getSTPThreadsAuto();
-          writeToSocket(dist_fd, &STPThreadsAuto, sizeof(bool));
-
-          if (sockets)
-          {
-            string host = config->getHost();
-            int length = host.length();
-            writeToSocket(dist_fd, &length, sizeof(int));
-            writeToSocket(dist_fd, host.c_str(), length);
-            unsigned int port = config->getPort();
-            writeToSocket(dist_fd, &port, sizeof(int));
-          }
-          
-          {
-            string plugin_name = config->getPlugin();
-            int length = plugin_name.length();
-            writeToSocket(dist_fd, &length, sizeof(int));
-            writeToSocket(dist_fd, plugin_name.c_str(), length);
-          }
+        throw "malformed input message";
+      }
+      FileBuffer* fb;
+      if (network)
+      {
+        fb = new SocketBuffer(j, size);
+      }
+      else
+      {
+        fb = new FileBuffer(*(initial->files.at(j)));
+        fb->buf = (char*) realloc(fb->buf, size + 1);
+        fb->buf[size] = '\0';
+        fb->setSize(size);
+      }
+      input->files.push_back(fb);
+      memcpy(fb->buf, cur, size);
+      cur += size;
+    }
+    if (end - cur < 4 * sizeof(int))
+    {
+      throw "malformed input message";
+    }
+    memcpy(&input->startdepth, cur, sizeof(int));
+    memcpy(&input->score, cur + sizeof(int), sizeof(int));
+    memcpy(&depth, cur + 2 * sizeof(int), sizeof(int));
+    memcpy(&input->prediction_size, cur + 3 * sizeof(int), sizeof(int));
+    cur += 4 * sizeof(int);
+    if ((input->prediction_size < 0) || 
+        (end - cur != input->prediction_size * sizeof(bool) + 2 * sizeof(bool)))
+    {
+      throw "malformed input message";
+    }
+    if (input->prediction_size > 0)
+    {
+      input->prediction = new bool[input->prediction_size];
+      memcpy(input->prediction, cur, input->prediction_size * sizeof(bool));
+      cur += input->prediction_size * sizeof(bool);
+    }
+    memcpy(&input->estimated, cur, sizeof(bool));
+    memcpy(&input->diverged, cur + sizeof(bool), sizeof(bool));
+  }
+  catch (const char* msg)
+  {
+    delete input;
+    throw;
+  }
+  return input;
+}
 
-          if (config->getInputFilterFile() != "")
-          {
-            FileBuffer *mask;
-            try
-            {
-              mask = new FileBuffer(config->getInputFilterFile());
-              size = mask->getSize();
-            }
-            catch (const char*)
-            {
-              size = 0;
-            }
-            writeToSocket(dist_fd, &size, sizeof(int));
-            if (size > 0)
-            {
-              writeToSocket(dist_fd, mask->buf, size);
-            }
-          }
-          else
-          {
-            int z = 0;
-            writeToSocket(dist_fd, &z, sizeof(int));
-          }
+/* Steal an input with at least min_score from another peer: ask the
+   distribution server who takes part, then ask the peers one by one,
+   starting from a random one. With min_score 0 this peer (or main
+   Avalanche) is out of work: it tells the distribution server so, and
+   waits until some peer can give an input; returns false when the
+   analysis is over. With a higher min_score every peer is asked once. */
 
-          int funcFilters = config->getFuncFilterUnitsNum();
-          writeToSocket(dist_fd, &funcFilters, sizeof(int));
-          for (int i = 0; i < config->getFuncFilterUnitsNum(); i++)
-          {
-            string f = config->getFuncFilterUnit(i);
-            int length = f.length();
-            writeToSocket(dist_fd, &length, sizeof(int));
-            writeToSocket(dist_fd, f.c_str(), length);
-          }
-          if (config->getFuncFilterFile() != "")
-          {
-            FileBuffer *filter;
-            try
-            {
-              filter = new FileBuffer(config->getFuncFilterFile());
-              size = filter->getSize();
-            }
-            catch (const char*)
-            {
-              size = 0;
-            }
-            writeToSocket(dist_fd, &size, sizeof(int));
-            if (size > 0)
-            {
-              writeToSocket(dist_fd, filter->buf, size);
-            }
-          }
-          else
-          {
-            int z = 0;
-            writeToSocket(dist_fd, &z, sizeof(int));
-          }
-          if (config->getAgentDir() != string(""))
-          {
-             string agentDir = config->getAgentDir();
-             int length = agentDir.length();
-             writeToSocket(dist_fd, &length, sizeof(int));
-             writeToSocket(dist_fd, agentDir.c_str(), length);
-          }
-          else
-          {
-            int length = 0;
-            writeToSocket(dist_fd, &length, sizeof(int));
-          }
-          for (vector<string>::const_iterator it = config->getProgAndArg().begin(); it != config->getProgAndArg().end(); it++)
-          {
-            int argsSize = it->length();
-            writeToSocket(dist_fd, &argsSize, sizeof(int));
-            writeToSocket(dist_fd, it->c_str(), argsSize);
-          }
-          if (it->second != initial)
-          {
-            delete it->second;
-          }
-          inputs.erase(it);
-          response_num--;
-        }
-        while (response_num > 0)
-        {
-          int tosend = 0;
-          writeToSocket(dist_fd, &tosend, sizeof(int));
-          response_num--;
-        }
+bool ExecutionManager::stealInput(unsigned int min_score)
+{
+  while ((is_distributed || is_peer) && !monitor->getKilledStatus())
+  {
+    vector<struct sockaddr_in> peers;
+    try
+    {
+      if (min_score == 0)
+      {
+        reportIdle();
+      }
+      int peers_num;
+      writeToSocket(dist_fd, "l", 1);
+      readFromSocket(dist_fd, &peers_num, sizeof(int));
+      for (int i = 0; i < peers_num; i ++)
+      {
+        struct sockaddr_in peer;
+        int port;
+        memset(&peer, 0, sizeof(struct sockaddr_in));
+        peer.sin_family = AF_INET;
+        readFromSocket(dist_fd, &peer.sin_addr, sizeof(peer.sin_addr));
+        readFromSocket(dist_fd, &port, sizeof(int));
+        peer.sin_port = htons(port);
+        peers.push_back(peer);
+      }
+    }
+    catch (const char* msg)
+    {
+      LOG(Logger::NETWORK_LOG, "Connection with server lost: analysis is over.");
+      shutdown(dist_fd, SHUT_RDWR);
+      close(dist_fd);
+      is_distributed = false;
+      is_peer = false;
+      break;
+    }
+
+    int start = peers.empty() ? 0 : rand() % peers.size();
+    for (int i = 0; i < peers.size(); i ++)
+    {
+      struct sockaddr_in &peer = peers[(start + i) % peers.size()];
+      int fd = socket(PF_INET, SOCK_STREAM, IPPROTO_TCP);
+      if (fd == -1)
+      {
+        break;
       }
-      else if (c == 'g')
+      if (connect(fd, (const struct sockaddr*)&peer, sizeof(struct sockaddr_in)) < 0)
       {
-        writeToSocket(dist_fd, "r", 1);
-        //sending "r"(responding) before data - this is to have something different from "q", so that server
-        //can understand that main avalanche finished normally
-        readFromSocket(dist_fd, &response_num, sizeof(int));
-        while (response_num > 0)
+        close(fd);
+        continue;
+      }
+      Input* input = NULL;
+      unsigned int depth;
+      try
+      {
+        StealRequest r;
+        r.version = PROTOCOL_VERSION;
+        r.peers = peers.size();
+        r.min_score = min_score;
+        char request[1 + sizeof(StealRequest)];
+        request[0] = 's';
+        memcpy(request + 1, &r, sizeof(StealRequest));
+        writeToSocket(fd, request, sizeof(request));
+        input = recvInput(fd, depth);
+      }
+      catch (const char* msg)
+      {
+        LOG(Logger::NETWORK_LOG, "Connection with peer lost.");
+      }
+      close(fd);
+      if (input != NULL)
+      {
+        LOG(Logger::NETWORK_LOG, "Received input with score " << 
+                                 input->score << ".");
+        if (min_score == 0)
         {
-          if (inputs.size() <= limit)
-          { 
-            break;
-          }
-          LOG(Logger::NETWORK_LOG, "Sending input.");
-          multimap<Key, Input*, cmp>::iterator it = --inputs.end();
-          it--;
-          Input* fi = it->second;
-          for (int j = 0; j < fi->files.size(); j ++)
+          try
           {
-            FileBuffer* fb = fi->files.at(j);
-            size = fb->getSize();
-            writeToSocket(dist_fd, &size, sizeof(int));
-            writeToSocket(dist_fd, fb->buf, size);
+            writeToSocket(dist_fd, "w", 1);
           }
-          writeToSocket(dist_fd, &fi->startdepth, sizeof(int));
-          if (it->second != initial)
+          catch (const char* msg)
           {
-            delete it->second;
           }
-          inputs.erase(it);
-          response_num--;
         }
-        while (response_num > 0)
-        {
-          int tosend = 0;
-          writeToSocket(dist_fd, &tosend, sizeof(int));
-          response_num--;
-        }
-      }
-      else
-      {
-        int tosend = 0;
-        writeToSocket(dist_fd, &tosend, sizeof(int));
+        pthread_mutex_lock(&add_inputs_mutex);
+        inputs_received ++;
+        pthread_mutex_unlock(&add_inputs_mutex);
+        addInput(input, depth, input->score);
+        return true;
       }
-      FD_ZERO(&readfds);
-      FD_SET(dist_fd, &readfds);
-      select(dist_fd + 1, &readfds, NULL, NULL, &timer);      
     }
+    if (min_score > 0)
+    {
+      break;
+    }
+    sleep(1);
   }
-  catch (const char* msg)
-  {
-    LOG(Logger::NETWORK_LOG, "Connection with server lost.");
-    LOG(Logger::NETWORK_LOG, "Continuing work in local mode.");
-    is_distributed = false;
-  }
+  return false;
 }
 
 ExecutionManager::~ExecutionManager()
 {
 //    LOG(Logger::DEBUG, "Destructing plugin manager.");
 
+    if (steal_fd != -1)
+    {
+        stopStealServer();
+    }
     if (is_distributed)
     {
         write(dist_fd, "q", 1);
+    }
+    else if (is_peer)
+    {
+        // The inputs this peer still has are lost: it leaves as if it
+        // were out of work, with the final counts
+        try
+        {
+            reportIdle();
+        }
+        catch (const char* msg)
+        {
+        }
+    }
+    if (is_distributed || is_peer)
+    {
         shutdown(dist_fd, SHUT_RDWR);
         close(dist_fd);
     }
@@ -2056,18 +3178,23 @@ ExecutionManager::~ExecutionManager()
     if (config->getRemoteValgrind() != "")
     {
         kind = UNID;
-        write(remote_fd, &kind, sizeof(int));
-        close(remote_fd);
+        for (int i = 0; i < remote_fds.size(); i ++)
+        {
+            write(remote_fds[i], &kind, sizeof(int));
+            close(remote_fds[i]);
+        }
+        delete []remote_threads;
     }
 
+    pthread_mutex_destroy(&add_inputs_mutex);
+    pthread_mutex_destroy(&nokill_mutex);
     if (thread_num > 0)
     {
-        pthread_mutex_destroy(&add_inputs_mutex);
         pthread_mutex_destroy(&add_exploits_mutex);
         pthread_mutex_destroy(&add_bb_mutex);
-        pthread_mutex_destroy(&finish_mutex);
         pthread_mutex_destroy(&add_remote_mutex);
         pthread_cond_destroy(&input_available_cond);
+        pthread_cond_destroy(&remote_space_cond);
     }
 
     delete config;
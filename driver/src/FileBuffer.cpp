@@ -107,7 +107,8 @@ FileBuffer::FileBuffer(char* _buf) // it is not file_name!
 }
 
 FileBuffer* FileBuffer::forkInput(FileBuffer *stp_file, 
-                                  vector<FileOffsetSet> &used_offsets)
+                                  vector<FileOffsetSet> &used_offsets,
+                                  string name_modifier)
 {
     if (stp_file->getSize() > strlen("Valid"))
     {
@@ -134,7 +135,7 @@ FileBuffer* FileBuffer::forkInput(FileBuffer *stp_file,
         LOG(Logger::ERROR, strerror(errno));
         return NULL;
     }
-    if (res->applySTPSolution(stp_file->buf, used_offsets) < 0)
+    if (res->applySTPSolution(stp_file->buf, used_offsets, name_modifier) < 0)
     {
         return NULL;
     }
@@ -167,6 +168,55 @@ int FileBuffer::dumpFile(std::string file_name)
     return 0;
 }
 
+/* Name of the variable in the condition asserted right before the next
+   QUERY, i.e. t_<block>_<tmp>_<visit> of the branch to be inverted. */
+
+string FileBuffer::getQueryBranchSite()
+{
+    char* query = strstr(buf, "QUERY(FALSE);");
+    if (query == NULL)
+    {
+        return string("");
+    }
+    char* line = query - 1;
+    while ((line > buf) && (*(line - 1) != '\n'))
+    {
+        line--;
+    }
+    if (strncmp(line, "ASSERT(", 7))
+    {
+        return string("");
+    }
+    char* site = line + 7;
+    char* site_end = strchr(site, '=');
+    if ((site_end == NULL) || (site_end > query))
+    {
+        return string("");
+    }
+    return string(site, site_end - site);
+}
+
+/* Name of the array holding the file contents in traces
+   (mangled the same way as in tracegrind). name_modifier is the suffix
+   of the copy of the file the trace was taken on. */
+
+string FileBuffer::getArrayName(string name_modifier) const
+{
+    string res("file_");
+    string traced_name = name + name_modifier;
+    for (size_t i = 0; i < traced_name.size(); i++)
+    {
+        switch (traced_name[i])
+        {
+          case '/': res += "_slash_"; break;
+          case '.': res += "_dot_"; break;
+          case '-': res += "_hyphen_"; break;
+          default: res += traced_name[i];
+        }
+    }
+    return res;
+}
+
 int FileBuffer::cutQueryAndDump(std::string file_name, bool do_invert)
 {
     char* query = strstr(buf, "QUERY(FALSE);");
@@ -185,6 +235,57 @@ int FileBuffer::cutQueryAndDump(std::string file_name, bool do_invert)
         *(query - 4) = (*(query - 4) == '0') ? '1' : '0';
         return -1;
     }
+    dropQuery(query, do_invert);
+    size = old_size;
+    return 0;
+}
+
+/* Same as cutQueryAndDump, but the query is returned in a new buffer
+   (NULL if there is no query or on error). */
+
+FileBuffer* FileBuffer::cutQuery(bool do_invert)
+{
+    char* query = strstr(buf, "QUERY(FALSE);");
+    if (query == NULL)
+    {
+        return NULL;
+    }
+    if (do_invert)
+    {
+        *(query - 4) = (*(query - 4) == '0') ? '1' : '0';
+    }
+    unsigned int old_size = size;
+    size = (query - buf) + 13;
+    FileBuffer* res = NULL;
+    try
+    {
+        res = new FileBuffer(*this);
+    }
+    catch (const char*)
+    {
+    }
+    catch (std::bad_alloc)
+    {
+        LOG(Logger::ERROR, strerror(errno));
+    }
+    size = old_size;
+    if (res == NULL)
+    {
+        if (do_invert)
+        {
+            *(query - 4) = (*(query - 4) == '0') ? '1' : '0';
+        }
+        return NULL;
+    }
+    dropQuery(query, do_invert);
+    return res;
+}
+
+/* Remove the QUERY that has been cut. If it was inverted, the condition
+   before it is restored, else it is removed as well. */
+
+void FileBuffer::dropQuery(char* query, bool do_invert)
+{
     if (do_invert)
     {
         for (int k = 0; k < 13; k++)
@@ -207,8 +308,23 @@ int FileBuffer::cutQueryAndDump(std::string file_name, bool do_invert)
             k--;
         }
     }
-    size = old_size;
-    return 0;
+}
+
+/* Drop the next QUERY without dumping it. The condition before it stays
+   asserted for the following queries. */
+
+int FileBuffer::skipQuery()
+{
+    char* query = strstr(buf, "QUERY(FALSE);");
+    if (query == NULL)
+    {
+        return 0;
+    }
+    for (int k = 0; k < 13; k++)
+    {
+        query[k] = '\n';
+    }
+    return 1;
 }
 
 static 
@@ -232,7 +348,8 @@ bool checkOffset(vector<FileOffsetSet> &used_offsets,
 
 
 int FileBuffer::applySTPSolution(char* buf, 
-                                 vector<FileOffsetSet> &used_offsets)
+                                 vector<FileOffsetSet> &used_offsets,
+                                 string name_modifier)
 {
     char* pointer = buf;
     char* byte_value;
@@ -266,7 +383,7 @@ int FileBuffer::applySTPSolution(char* buf,
             file_name.replace(found, strlen("_hyphen_"), "-");
             found = file_name.find("_hyphen_");
         }
-        if (name == file_name)
+        if (name + name_modifier == file_name)
         {
             char* pos_begin = brack + 5;
             char* posend;
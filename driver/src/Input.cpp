@@ -42,6 +42,10 @@ Input::Input()
     prediction = NULL;
     prediction_size = 0;
     parent = NULL;
+    score = 0;
+    estimated = false;
+    new_target = true;
+    diverged = false;
 }
 
 Input::~Input()
@@ -117,7 +121,7 @@ int Input::dumpExploit(string file_name, bool predict, string name_modifier)
     return 0; 
 }
 
-int Input::dumpFiles(string name_modifier)
+int Input::dumpFiles(string name_modifier, string temp_dir)
 {
     for (int i = 0; i < files.size(); i++)
     {
@@ -129,8 +133,11 @@ int Input::dumpFiles(string name_modifier)
     }
     if (prediction != NULL)
     {
-        string prediction_file = ExecutionManager::getTempDir() +
-                                                         string("prediction.log");
+        if (temp_dir == "")
+        {
+            temp_dir = ExecutionManager::getTempDir();
+        }
+        string prediction_file = temp_dir + string("prediction.log");
         int fd = open(prediction_file.c_str(), O_WRONLY | O_TRUNC | O_CREAT,
                                     S_IRUSR | S_IROTH | S_IRGRP | S_IWUSR | S_IWOTH | S_IWGRP);
         write(fd, prediction, prediction_size * sizeof(bool));
@@ -32,6 +32,7 @@
 #include <sys/wait.h>
 #include <fcntl.h>
 #include <unistd.h>
+#include <signal.h>
 #include <sys/time.h>
 #include <sys/resource.h>
 
@@ -64,6 +65,13 @@ int LocalExecutor::exec(bool setlimit)
     do_redirect(STDOUT_FILENO, file_out); file_out = -1;
     do_redirect(STDERR_FILENO, file_err); file_err = -1;
 
+    // Avalanche takes SIGINT on a thread of its own (see Entry.cpp):
+    // the programs it runs get the signal as usual
+    sigset_t sigmask;
+    sigemptyset(&sigmask);
+    sigaddset(&sigmask, SIGINT);
+    sigprocmask(SIG_UNBLOCK, &sigmask, NULL);
+
     if (setlimit) {
         struct rlimit r;
         r.rlim_cur = RLIM_INFINITY;
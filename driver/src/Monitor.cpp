@@ -168,8 +168,10 @@ void ParallelMonitor::setState(state _state, time_t _start_time,
         checker_start_time[thread_index - 1] = _start_time;
         alarm_killed[thread_index - 1] = false;
     }
-    else if (_state == TRACER)
+    else if ((_state == TRACER) && !thread_index)
     {
+        // Tracers of --tracers run in the slots of STP threads:
+        // the time of the whole tracing stage is taken in slot 0
         tracer_start_time = _start_time;
     }
 }
@@ -198,7 +200,11 @@ void ParallelMonitor::removeTmpFiles()
 void ParallelMonitor::addTime(time_t end_time, unsigned int thread_index)
 {
     pthread_mutex_lock(&add_time_mutex);
-    if (current_state[thread_index] == TRACER)
+    if ((current_state[thread_index] == TRACER) && thread_index)
+    {
+        current_state[thread_index] = OUT;
+    }
+    else if (current_state[thread_index] == TRACER)
     {
         if (tracer_start_time != 0)
         {
@@ -0,0 +1,140 @@
+/*----------------------------------------------------------------------------------------*/
+/*------------------------------------- AVALANCHE ----------------------------------------*/
+/*------ Driver. Coordinates other processes, traverses conditional jumps tree.  ---------*/
+/*---------------------------------- NativeExecutor.cpp ----------------------------------*/
+/*----------------------------------------------------------------------------------------*/
+
+/*
+   Copyright (C) 2026 Avalanche contributors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include <cerrno>
+#include <cstring>
+#include <cstdlib>
+#include <ctime>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+#include "Logger.h"
+#include "NativeExecutor.h"
+#include "TmpFile.h"
+#include "Monitor.h"
+
+using namespace std;
+
+extern int thread_num;
+extern Monitor* monitor;
+
+static Logger *logger = Logger::getLogger();
+
+
+NativeExecutor::NativeExecutor(const vector<string> &cmd,
+                               unsigned int timeout) : timeout(timeout),
+                                                       term_signal(0)
+{
+    if (cmd.size() < 1) {
+        LOG(Logger :: ERROR, "No program name");
+        return;
+    }
+    prog = strdup(cmd[0].c_str());
+
+    // last NULL element is needed by execvp()
+    argsnum = cmd.size() + 1;
+    args = (char **)calloc(argsnum, sizeof(char *));
+
+    for (size_t i = 0; i < cmd.size(); i++)
+    {
+        args[i] = strdup(cmd[i].c_str());
+    }
+}
+
+int NativeExecutor::run(int thread_index)
+{
+    if (prog == NULL)
+        return -1;
+
+    if (!thread_num)
+    {
+        LOG(Logger::DEBUG, "Running program natively.");
+    }
+    else
+    {
+        LOG(Logger::DEBUG, "Thread #" << thread_index <<
+                           ": Running program natively.");
+    }
+
+    TmpFile* file_out = new TmpFile();
+    if (!file_out->good())
+    {
+        return -1;
+    }
+    TmpFile* file_err = new TmpFile();
+    if (!file_err->good())
+    {
+        return -1;
+    }
+    monitor->setTmpFiles(file_out, file_err);
+
+    redirect_stdout(file_out->getName());
+    redirect_stderr(file_err->getName());
+
+    time_t start_time = time(NULL);
+    int ret = exec(false);
+    monitor->setPID(child_pid, thread_index);
+    if (ret == -1)
+    {
+      LOG(Logger :: ERROR, "Problem in execution: " << strerror(errno));
+      return -1;
+    }
+
+    // Poll instead of alarm(): SIGALRM is process-wide and is already
+    // used for covgrind/memcheck timeouts in socket mode.
+
+    int status;
+    pid_t ret_proc;
+    while ((ret_proc = waitpid(child_pid, &status, WNOHANG)) == 0)
+    {
+        if (timeout && (time(NULL) - start_time >= timeout))
+        {
+            kill(child_pid, SIGKILL);
+            waitpid(child_pid, &status, 0);
+            LOG(Logger::DEBUG, "Program has not finished in " << timeout <<
+                               " seconds.");
+            return TIMEOUT;
+        }
+        usleep(1000);
+    }
+    if (ret_proc == (pid_t)(-1))
+    {
+        if (monitor->getKilledStatus())
+        {
+            return FINISHED;
+        }
+        LOG(Logger :: ERROR, "Problem in waiting: " << strerror(errno));
+        return -1;
+    }
+    if (WIFSIGNALED(status))
+    {
+        term_signal = WTERMSIG(status);
+        LOG(Logger::DEBUG, "Program exited on signal " << term_signal << ".");
+        return CRASHED;
+    }
+    return FINISHED;
+}
+
+NativeExecutor::~NativeExecutor()
+{
+}
@@ -80,6 +80,19 @@ static void printHelpBanner()
         "    --suppress-subcalls          Ignore conditions in a nested function calls during separate analysis\n"
         "    --stp-threads=<number>       The number of STP queries handled simultaneously. May be used in the form\n"
         "                                 '--stp-threads=auto'. In this case the number of CPU cores is taken.\n"
+        "    --tracers=<number>           The number of top inputs traced by tracegrind simultaneously (default is 1,\n"
+        "                                 at most the number of STP threads). Used only with '--stp-threads',\n"
+        "                                 ignored with sockets, datagrams, remote valgrind, '--check-argv'\n"
+        "                                 and '--dump-calls'\n"
+        "    --lazy-scoring               Queue new inputs with an estimated score and run covgrind/memcheck\n"
+        "                                 on them only when they are selected for the next iteration\n"
+        "    --tiered-check               Run new inputs natively first and use Valgrind checkers only for inputs\n"
+        "                                 with new branch targets, new coverage or crashes\n"
+        "                                 (ignored with sockets, datagrams and remote valgrind)\n"
+        "    --abort-on-divergence=<drop|reschedule>\n"
+        "                                 Stop tracegrind as soon as the input diverges from the predicted path\n"
+        "                                 and drop the input or trace it again later without the check\n"
+        "    --parent-phase               Make STP prefer the bytes of the parent input when solving queries\n"
         "    --report-log=<filename>      Dump exploits report to the specified file\n"
         "    --result-dir=<dirname>       Store exploits and error list in directory <dirname>\n"
         "\n"
@@ -99,12 +112,18 @@ static void printHelpBanner()
         "    --dist-port=<number>         Port number of the distribution server (default is 12200)\n"
         "    --protect-main-agent         Do not send inputs to the remore agents, if the overall number\n"
         "                                 of inputs in the main agent do not exceed 5 * <number_of_agents>\n"
+        "    --peer                       Run as a peer of distributed Avalanche: give inputs to the other\n"
+        "                                 peers and steal inputs from them (used by av-agent)\n"
+        "    --dist-fd=<number>           Connection to the distribution server opened by av-agent\n"
+        "                                 (used by av-agent)\n"
         "\n"
         " using remote valgrind agent:\n"
         "    --remote-valgrind=server     Connect to remote valgrind agent (host name is necessary in this case)\n"
         "    --remote-valgrind=client     Await incoming connection from valgrind agent (do not specify host name)\n"
         "    --remote-host=<IPv4 address> IP address of the remote agent\n"
-        "    --remote-port=<number>       Port number for connection wit remote agent\n";
+        "    --remote-port=<number>       Port number for connection wit remote agent\n"
+        "    --remote-sessions=<number>   Number of sessions with remote agent to run checkers on\n"
+        "                                 concurrently with STP threads (default is 1)\n";
 
 
     LOG(Logger::JOURNAL, banner);
@@ -246,6 +265,15 @@ OptionConfig *OptionParser::run() const
             }
             config->setDistPort(atoi(port.c_str()));
         }
+        else if (args[i].find("--dist-fd=") != string::npos) {
+            string fd = args[i].substr(strlen("--dist-fd="));
+            if (isNumber(fd) == -1) {
+                delete config;
+                LOG(Logger::ERROR, "invalid '--dist-fd' parameter.");
+                return NULL;
+            }
+            config->setDistFd(atoi(fd.c_str()));
+        }
         else if (args[i].find("--valgrind-path=") != string::npos) {
             config->setValgrindPath(args[i].substr(strlen("--valgrind-path=")));
         }
@@ -258,6 +286,24 @@ OptionConfig *OptionParser::run() const
             }
             config->setRemotePort(atoi(port.c_str()));
         }
+        else if (args[i].find("--remote-sessions=") != string::npos) {
+            string sessions = args[i].substr(strlen("--remote-sessions="));
+            if (isNumber(sessions) < 1) {
+                delete config;
+                LOG(Logger::ERROR, "invalid '--remote-sessions' parameter.");
+                return NULL;
+            }
+            config->setRemoteSessions(atoi(sessions.c_str()));
+        }
+        else if (args[i].find("--tracers=") != string::npos) {
+            string tracers = args[i].substr(strlen("--tracers="));
+            if (isNumber(tracers) < 1) {
+                delete config;
+                LOG(Logger::ERROR, "invalid '--tracers' parameter.");
+                return NULL;
+            }
+            config->setTracers(atoi(tracers.c_str()));
+        }
         else if (args[i].find("--stp-threads=") != string::npos) {
             string thread_num = args[i].substr(strlen("--stp-threads="));
             if (thread_num == string("auto")) {
@@ -278,6 +324,16 @@ OptionConfig *OptionParser::run() const
                 config->disableCleanUp();
             }
         }
+        else if (args[i].find("--abort-on-divergence=") != string::npos) {
+            string policy = args[i].substr(strlen("--abort-on-divergence="));
+            if ((policy != "drop") && (policy != "reschedule"))
+            {
+                LOG(Logger::ERROR, "Only 'drop' and 'reschedule' options"
+                                    " are available for --abort-on-divergence");
+                return NULL;
+            }
+            config->setDivergencePolicy(policy);
+        }
         else if (args[i].find("--remote-valgrind=") != string::npos) {
             string remote_vg_role = args[i].substr(strlen("--remote-valgrind="));
             if ((remote_vg_role != "host") && (remote_vg_role != "client"))
@@ -334,9 +390,21 @@ OptionConfig *OptionParser::run() const
         else if (args[i] == "--agent") {
             config->setAgent();
         }
+        else if (args[i] == "--peer") {
+            config->setPeer();
+        }
         else if (args[i] == "--check-danger") {
             config->setCheckDanger();
         }
+        else if (args[i] == "--lazy-scoring") {
+            config->setLazyScoring();
+        }
+        else if (args[i] == "--tiered-check") {
+            config->setTieredCheck();
+        }
+        else if (args[i] == "--parent-phase") {
+            config->setParentPhase();
+        }
         else if (args[i] == "--trace-children") {
             config->setTraceChildren();
         }
@@ -393,6 +461,12 @@ OptionConfig *OptionParser::run() const
         LOG(Logger::ERROR, "you cannot specify '--agent' and '--distributed' at the same time");
     }
 
+    if (config->getPeer() && config->getDistributed()) {
+        delete config;
+        LOG(Logger::ERROR, "you cannot specify '--peer' and '--distributed' at the same time");
+        return NULL;
+    }
+
     if ((config->getPlugin() != "covgrind") && config->getDumpCalls()) {
         delete config;
         LOG(Logger::ERROR, "'--dump-calls' can only be used with covgrind");
@@ -484,15 +558,26 @@ void OptionParser::reportDummyOptions(OptionConfig* config) const
     if (config->checkForLeaks() && (config->getPlugin() != "memcheck")) {
         dummy_opts.push_back(string("'--leaks' (use '--tool=memcheck')"));
     }
-    if ((distPortSpecified || distHostSpecified || config->getProtectMainAgent()) && !config->getDistributed()) {
+    if ((config->getRemoteSessions() > 1) && ((config->getRemoteValgrind() == "") || (config->getSTPThreads() == 0))) {
+        dummy_opts.push_back(string("'--remote-sessions' (use '--remote-valgrind' and '--stp-threads')"));
+    }
+    if ((config->getTracers() > 1) && ((config->getSTPThreads() == 0) || config->usingSockets() || config->usingDatagrams() ||
+                                       (config->getRemoteValgrind() != "") || (config->getCheckArgv() != "") || config->getDumpCalls())) {
+        dummy_opts.push_back(string("'--tracers' (use '--stp-threads', and do not use sockets, datagrams, remote valgrind, '--check-argv' or '--dump-calls')"));
+    }
+    if ((config->getDistFd() != -1) && !config->getPeer()) {
+        dummy_opts.push_back(string("'--dist-fd' (use '--peer')"));
+    }
+    bool distHostUnused = (distPortSpecified || distHostSpecified) && !config->getDistributed() && !config->getPeer();
+    if (distHostUnused || (config->getProtectMainAgent() && !config->getDistributed())) {
         string opt;
-        if (distPortSpecified) {
+        if (distHostUnused && distPortSpecified) {
             opt.append(string("'--dist-port' "));
         }
-        if (distHostSpecified) {
+        if (distHostUnused && distHostSpecified) {
             opt.append(string("'--dist-host' "));
         }
-        if (config->getProtectMainAgent()) {
+        if (config->getProtectMainAgent() && !config->getDistributed()) {
             opt.append(string("'--protect-main-agent' "));
         }
         dummy_opts.push_back(opt.append("(use '--distributed')"));
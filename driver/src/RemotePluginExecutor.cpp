@@ -24,8 +24,10 @@
 #include <cerrno>
 #include <cstring>
 #include <cstdlib>
+#include <climits>
 #include <unistd.h>
 #include <fcntl.h>
+#include <sys/uio.h>
 
 #include "Logger.h"
 #include "RemotePluginExecutor.h"
@@ -68,15 +70,88 @@ void readFromSocket(int fd, const void* b, size_t count)
     }
 }
 
-#define CHUNK_SIZE 32
+#define BUF_SIZE 65536
+
+/* Files for plugin-agent are described first by their size and content
+   hash; plugin-agent answers which of them are not in its cache, and only
+   those are sent. */
+
+struct FileDescr
+{
+    int size;
+    unsigned long long hash;
+};
 
 static
-void readFileFromSocket(int fd, string file_name)
+unsigned long long hashContent(const char* buf, int size)
 {
-    int file_fd, length;
-    size_t received = 0, r;
-    char buf[CHUNK_SIZE];
-    readFromSocket(fd, &length, sizeof(int));
+    unsigned long long hash = 14695981039346656037ULL; // FNV-1a
+    for (int i = 0; i < size; i ++)
+    {
+        hash = (hash ^ (unsigned char) buf[i]) * 1099511628211ULL;
+    }
+    return hash;
+}
+
+static
+void describeFile(string &request, FileBuffer* file)
+{
+    FileDescr descr;
+    descr.size = file->getSize();
+    descr.hash = hashContent(file->buf, descr.size);
+    request.append((const char*) &descr, sizeof(FileDescr));
+}
+
+static
+void sendFiles(int fd, vector<FileBuffer*> &files)
+{
+    if (files.empty())
+    {
+        return;
+    }
+    vector<char> need(files.size());
+    readFromSocket(fd, &need[0], need.size());
+    vector<struct iovec> iov;
+    for (int i = 0; i < files.size(); i ++)
+    {
+        if (need[i] && (files[i]->getSize() > 0))
+        {
+            struct iovec v;
+            v.iov_base = files[i]->buf;
+            v.iov_len = files[i]->getSize();
+            iov.push_back(v);
+        }
+    }
+    for (int i = 0; i < iov.size(); )
+    {
+        int cnt = (iov.size() - i < IOV_MAX) ? iov.size() - i : IOV_MAX;
+        ssize_t s = writev(fd, &iov[i], cnt);
+        if ((s == -1) && (errno == EINTR))
+        {
+            continue;
+        }
+        if (s < 1)
+        {
+            throw "net";
+        }
+        while ((i < iov.size()) && (s >= iov[i].iov_len))
+        {
+            s -= iov[i].iov_len;
+            i ++;
+        }
+        if (s > 0)
+        {
+            iov[i].iov_base = (char*) iov[i].iov_base + s;
+            iov[i].iov_len -= s;
+        }
+    }
+}
+
+static
+void readToFile(int fd, string file_name, int length)
+{
+    int file_fd, received = 0;
+    char buf[BUF_SIZE];
     file_fd = open(file_name.c_str(), O_CREAT | O_TRUNC | O_WRONLY, PERM_R_W);
     if (file_fd == -1)
     {
@@ -86,22 +161,15 @@ void readFileFromSocket(int fd, string file_name)
     }
     while(received < length)
     {
-        if (length - received > CHUNK_SIZE)
-        {
-            r = read(fd, buf, CHUNK_SIZE);
-        }
-        else
-        {
-            r = read(fd, buf, length - received);
-        }
+        size_t r = read(fd, buf, (length - received > BUF_SIZE) ? 
+                                 BUF_SIZE : length - received);
         if (r < 1)
         {
             close(file_fd);
             throw "net";
         }
         received += r;
-        r = write(file_fd, buf, r);
-        if (r < 1)
+        if (write(file_fd, buf, r) < r)
         {
             LOG(Logger::ERROR, "Cannot write to file " << file_name <<
                                ": " << strerror(errno));
@@ -112,52 +180,32 @@ void readFileFromSocket(int fd, string file_name)
     close(file_fd);
 }
 
+/* Read the files plugin-agent returns after a run: their number and
+   sizes come first, then their contents. */
+
 static
-void writeFileToSocket(int fd, string file_name)
+void readResultFiles(int fd, vector<string> &file_names)
 {
-    int file_fd;
-    size_t sent = 0, r;
-    char buf[CHUNK_SIZE];
-    file_fd = open(file_name.c_str(), O_RDONLY, S_IRUSR);
-    if (file_fd == -1)
+    int count;
+    readFromSocket(fd, &count, sizeof(int));
+    if (count != file_names.size())
     {
-        LOG(Logger::ERROR, "Cannot open file " << file_name <<
-                           ": " << strerror(errno));
-        throw "local";
+        LOG(Logger::ERROR, "Plugin-agent returned " << count << 
+                           " files instead of " << file_names.size());
+        throw "net";
     }
-    struct stat f_stat;
-    if (fstat(file_fd, &f_stat) == -1)
+    vector<int> sizes(count);
+    if (count > 0)
     {
-        LOG(Logger::ERROR, strerror(errno));
-        throw "local";
+        readFromSocket(fd, &sizes[0], count * sizeof(int));
     }
-    writeToSocket(fd, &(f_stat.st_size), sizeof(int));
-    while(sent < f_stat.st_size)
+    for (int i = 0; i < count; i ++)
     {
-        if (f_stat.st_size - sent > CHUNK_SIZE)
-        {
-            r = read(file_fd, buf, CHUNK_SIZE);
-        }
-        else
-        {
-            r = read(file_fd, buf, f_stat.st_size - sent);
-        }
-        if (r < 1)
-        {
-            LOG(Logger::ERROR, "Cannot read from file " << file_name <<
-                               ": " << strerror(errno));
-            throw "local";
-        }
-        sent += r;
-        r = write(fd, buf, r);
-        if (r < 1)
-        {
-            throw "net";
-        }
+        readToFile(fd, file_names[i], sizes[i]);
     }
 }
 
-#undef CHUNK_SIZE
+#undef BUF_SIZE
 
 static
 void readTraceOnTheRun(int fd, string temp_dir)
@@ -216,10 +264,12 @@ bool RemotePluginExecutor::checkFlag(const char *flg_name)
 
 RemotePluginExecutor::RemotePluginExecutor(vector<string> &_args, 
                                            int _remote_fd, vector<char> &to_send,
-                                           string _result_dir)
+                                           string _result_dir,
+                                           string _file_name_modifier)
 {
     remote_fd = _remote_fd;
     result_dir = _result_dir;
+    file_name_modifier = _file_name_modifier;
     argsnum = _args.size();
     args = (char **)calloc (argsnum, sizeof(char *));
     files_to_send = to_send;
@@ -231,54 +281,74 @@ RemotePluginExecutor::RemotePluginExecutor(vector<string> &_args,
 
 int RemotePluginExecutor::run(int thread_index)
 {
-    int res, size;
+    int res;
     try
     {
         char util_c;
         char *file_name;
-        int i, arg_length, file_length;
-        writeToSocket(remote_fd, &argsnum, sizeof(int));
-        for (i = 0; i < argsnum; i ++)
+        int i, arg_length;
+        string request;
+        vector<FileBuffer*> files;
+        string temp_dir = ExecutionManager::getTempDir();
+        try
         {
-            arg_length = strlen(args[i]);
-            writeToSocket(remote_fd, &arg_length, sizeof(int));
-            writeToSocket(remote_fd, args[i], arg_length);
-            util_c = files_to_send[i] ? '1' : '\0';
-            writeToSocket(remote_fd, &util_c, 1);
-            if (util_c)
+            request.append((const char*) &argsnum, sizeof(int));
+            for (i = 0; i < argsnum; i ++)
             {
-                char *eq_sign = strchr(args[i], '=');
-                if (eq_sign != NULL)
-                {
-                    eq_sign ++;
-                    file_name = eq_sign;
-                }
-                else
+                arg_length = strlen(args[i]);
+                request.append((const char*) &arg_length, sizeof(int));
+                request.append(args[i], arg_length);
+                util_c = files_to_send[i] ? '1' : '\0';
+                request.append(&util_c, 1);
+                if (util_c)
                 {
-                    file_name = args[i];
+                    char *eq_sign = strchr(args[i], '=');
+                    if (eq_sign != NULL)
+                    {
+                        eq_sign ++;
+                        file_name = eq_sign;
+                    }
+                    else
+                    {
+                        file_name = args[i];
+                    }
+                    files.push_back(new FileBuffer(string(file_name)));
+                    describeFile(request, files.back());
                 }
-                string s_file_name = file_name;
-                FileBuffer f(s_file_name);
-                size = f.getSize();
-                writeToSocket(remote_fd, &size, sizeof(int));
-                writeToSocket(remote_fd, f.buf, size);
             }
+            if (checkFlag("--check-prediction=yes"))
+            {
+                files.push_back(new FileBuffer(temp_dir + string("prediction.log")));
+                describeFile(request, files.back());
+            }
+            if (checkFlag("--replace=yes") || checkFlag("--replace=replace_data"))
+            {
+                files.push_back(new FileBuffer(temp_dir + string("replace_data") +
+                                               file_name_modifier));
+                describeFile(request, files.back());
+            }
+            if (checkFlag("--check-argv="))
+            {
+                files.push_back(new FileBuffer(temp_dir + string("arg_lengths")));
+                describeFile(request, files.back());
+            }
+            writeToSocket(remote_fd, request.data(), request.size());
+            sendFiles(remote_fd, files);
         }
-        string temp_dir = ExecutionManager::getTempDir();
-        if (checkFlag("--check-prediction=yes"))
-        {
-            writeFileToSocket(remote_fd, temp_dir + string("prediction.log"));
-        }
-        if (checkFlag("--replace=yes") || checkFlag("--replace=replace_data"))
+        catch (const char*)
         {
-            writeFileToSocket(remote_fd, temp_dir + string("replace_data"));
+            for (i = 0; i < files.size(); i ++)
+            {
+                delete files[i];
+            }
+            throw;
         }
-        if (checkFlag("--check-argv="))
+        for (i = 0; i < files.size(); i ++)
         {
-            writeFileToSocket(remote_fd, temp_dir + string("arg_lengths"));
+            delete files[i];
         }
-      //  readFromSocket(remote_fd, &res, sizeof(int));
 
+        vector<string> results;
         if (checkFlag("--tool=tracegrind"))
         { 
             readTraceOnTheRun(remote_fd, temp_dir);
@@ -288,36 +358,42 @@ int RemotePluginExecutor::run(int thread_index)
                 LOG(Logger::ERROR, "Plugin-agent ended abnormally");
                 return 1;
             }
-            readFileFromSocket(remote_fd, temp_dir + string("offsets.log"));
+            results.push_back(temp_dir + string("offsets.log"));
             if (checkFlag("--dump-prediction=yes"))
             {
-               readFileFromSocket(remote_fd, temp_dir + string("actual.log"));
+               results.push_back(temp_dir + string("actual.log"));
             }
             if (checkFlag("--dump-file=calldump.log"))
             {
-               readFileFromSocket(remote_fd, 
-                                      result_dir + string("calldump.log"));
+               results.push_back(result_dir + string("calldump.log"));
             }
             if (checkFlag("--sockets=yes") || checkFlag("--datagrams=yes"))
             {
-               readFileFromSocket(remote_fd, 
-                                      temp_dir + string("replace_data"));
+               results.push_back(temp_dir + string("replace_data") + 
+                                 file_name_modifier);
             }
             if (checkFlag("--check-argv="))
             {
-               readFileFromSocket(remote_fd, temp_dir + string("argv.log"));
+               results.push_back(temp_dir + string("argv.log"));
             }
         }
         else
         {
             readFromSocket(remote_fd, &res, sizeof(int));
+            if (res == 1)
+            {
+                LOG(Logger::ERROR, "Plugin-agent ended abnormally");
+                return 1;
+            }
             if (!checkFlag("--no-coverage=yes"))
             {
-                readFileFromSocket(remote_fd, 
-                                       temp_dir + string("basic_blocks.log"));
+                results.push_back(temp_dir + string("basic_blocks") + 
+                                  file_name_modifier + string(".log"));
             }
-            readFileFromSocket(remote_fd, temp_dir + string("execution.log"));
+            results.push_back(temp_dir + string("execution") + 
+                              file_name_modifier + string(".log"));
         }
+        readResultFiles(remote_fd, results);
     }
     catch(const char *msg)
     {
@@ -41,17 +41,25 @@ static Logger *logger = Logger::getLogger();
 
 
 STP_Executor::STP_Executor(bool debug_full_enable,
-                           const string &install_dir):
+                           const string &install_dir,
+                           const string &phase_hints):
                                debug_full(debug_full_enable)
 {
     prog = strdup((install_dir + "../lib/avalanche/stp").c_str());
 
-    argsnum = 4;
+    argsnum = (phase_hints == "") ? 4 : 6;
 
     args = (char **)calloc(argsnum, sizeof(char *));
 
     args[0] = strdup(prog);
     args[1] = strdup("-p");
+    file_index = 2;
+    if (phase_hints != "")
+    {
+        args[2] = strdup("-i");
+        args[3] = strdup(phase_hints.c_str());
+        file_index = 4;
+    }
 }
 
 string STP_Executor::run(const char *file_name, int thread_index)
@@ -65,7 +73,7 @@ string STP_Executor::run(const char *file_name, int thread_index)
       LOG(Logger :: DEBUG, "Thread #" << thread_index << ": Running STP.");
     }
     
-    args[2] = strdup(file_name);
+    args[file_index] = strdup(file_name);
 
     TmpFile* file_out = new TmpFile();
     TmpFile* file_err = new TmpFile();
@@ -27,6 +27,7 @@
 #include <string.h>
 #include <fcntl.h>
 #include <cerrno>
+#include <sstream>
 
 #include "SocketBuffer.h"
 #include "Logger.h"
@@ -62,7 +63,8 @@ SocketBuffer::SocketBuffer(const SocketBuffer& other)
 }
 
 FileBuffer* SocketBuffer::forkInput(FileBuffer *stp_file,
-                                    vector<FileOffsetSet> &used_offsets)
+                                    vector<FileOffsetSet> &used_offsets,
+                                    string name_modifier)
 {
     if (stp_file->getSize() > strlen("Valid"))
     {
@@ -97,7 +99,8 @@ int SocketBuffer::dumpFile(string file_name)
 }
     
 int SocketBuffer::applySTPSolution(char* buf,
-                                   vector<FileOffsetSet> &used_offsets)
+                                   vector<FileOffsetSet> &used_offsets,
+                                   string name_modifier)
 {
     char* pointer = buf;
     char* byte_value;
@@ -132,6 +135,13 @@ int SocketBuffer::applySTPSolution(char* buf,
     return 0;
 }
 
+string SocketBuffer::getArrayName(string name_modifier) const
+{
+    ostringstream res;
+    res << "socket_" << num;
+    return res.str();
+}
+
 SocketBuffer::~SocketBuffer()
 {
     free(buf);
@@ -28,8 +28,6 @@
 
 using namespace std;
 
-map <string, void*> Thread::shared_data;
-
 int Thread::createThread(void* data, bool is_joinable)
 {
     int ret_code;
@@ -84,17 +82,119 @@ void Thread::doWork(void* data)
     pthread_exit(NULL);
 }
 
-void PoolThread::doWork(void* data)
+WorkerPool::WorkerPool(int _worker_num, unsigned int _capacity) : 
+                       worker_num(_worker_num), capacity(_capacity),
+                       unfinished(0), stopping(false), stopped(false)
 {
+    pthread_mutex_init(&mutex, NULL);
+    pthread_cond_init(&job_available, NULL);
+    pthread_cond_init(&space_available, NULL);
+    pthread_cond_init(&all_done, NULL);
+    tids = new pthread_t[worker_num];
+    for (int i = 0; i < worker_num; i ++)
+    {
+        worker_wrapper* input = new worker_wrapper;
+        input->pool = this;
+        input->worker = i + 1;
+        pthread_create(&(tids[i]), NULL, WorkerPool::workerLoop, input);
+    }
+}
+
+void* WorkerPool::workerLoop(void* data)
+{
+    WorkerPool* pool = ((worker_wrapper*) data)->pool;
+    int worker = ((worker_wrapper*) data)->worker;
+    delete ((worker_wrapper*) data);
     sigset_t sigmask;
     sigemptyset(&sigmask);
     sigaddset(&sigmask, SIGINT);
     pthread_sigmask(SIG_BLOCK, &sigmask, NULL);
-    (((job_wrapper*) data)->work_func) (((job_wrapper*) data)->data);
-    pthread_mutex_lock(work_finish_mutex);
-    thread_status = FREE;
-    (*active_threads) ++;
-    pthread_cond_signal(work_finish_cond);
-    pthread_mutex_unlock(work_finish_mutex);
-    pthread_exit(NULL);
+    pthread_mutex_lock(&(pool->mutex));
+    while (true)
+    {
+        while (pool->jobs.empty() && !pool->stopping)
+        {
+            pthread_cond_wait(&(pool->job_available), &(pool->mutex));
+        }
+        if (pool->stopping)
+        {
+            break;
+        }
+        Job* job = pool->jobs.front();
+        pool->jobs.pop_front();
+        pthread_cond_signal(&(pool->space_available));
+        pthread_mutex_unlock(&(pool->mutex));
+        job->run(worker);
+        delete job;
+        pthread_mutex_lock(&(pool->mutex));
+        if (--(pool->unfinished) == 0)
+        {
+            pthread_cond_broadcast(&(pool->all_done));
+        }
+    }
+    pthread_mutex_unlock(&(pool->mutex));
+    return NULL;
+}
+
+void WorkerPool::add(Job* job)
+{
+    pthread_mutex_lock(&mutex);
+    while ((jobs.size() >= capacity) && !stopping)
+    {
+        pthread_cond_wait(&space_available, &mutex);
+    }
+    if (stopping)
+    {
+        pthread_mutex_unlock(&mutex);
+        delete job;
+        return;
+    }
+    jobs.push_back(job);
+    unfinished ++;
+    pthread_cond_signal(&job_available);
+    pthread_mutex_unlock(&mutex);
+}
+
+void WorkerPool::wait()
+{
+    pthread_mutex_lock(&mutex);
+    while ((unfinished > 0) && !stopping)
+    {
+        pthread_cond_wait(&all_done, &mutex);
+    }
+    pthread_mutex_unlock(&mutex);
+}
+
+void WorkerPool::stop()
+{
+    if (stopped)
+    {
+        return;
+    }
+    stopped = true;
+    pthread_mutex_lock(&mutex);
+    stopping = true;
+    pthread_cond_broadcast(&job_available);
+    pthread_cond_broadcast(&space_available);
+    pthread_cond_broadcast(&all_done);
+    pthread_mutex_unlock(&mutex);
+    for (int i = 0; i < worker_num; i ++)
+    {
+        pthread_join(tids[i], NULL);
+    }
+    while (!jobs.empty())
+    {
+        delete jobs.front();
+        jobs.pop_front();
+    }
+}
+
+WorkerPool::~WorkerPool()
+{
+    stop();
+    delete []tids;
+    pthread_mutex_destroy(&mutex);
+    pthread_cond_destroy(&job_available);
+    pthread_cond_destroy(&space_available);
+    pthread_cond_destroy(&all_done);
 }
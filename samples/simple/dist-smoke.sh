@@ -0,0 +1,83 @@
+#!/bin/sh
+#
+# Smoke test of distributed analysis: av-dist, main Avalanche and two
+# av-agents analyse the dist sample on this host. The test passes when
+# every process finishes by itself: av-dist must find that all peers
+# are out of work (inputs are stolen between the peers, and coverage is
+# shared through av-dist meanwhile).
+#
+# Avalanche must be installed: the programs are taken from $AVALANCHE_BIN,
+# or from the directory of the avalanche found in PATH. The test is
+# skipped if they are not there.
+#
+# Usage: dist-smoke.sh [<port>]
+
+PORT=${1:-$((20000 + $$ % 10000))}
+TIMEOUT=${TIMEOUT:-600}
+
+if [ -z "$AVALANCHE_BIN" ]; then
+  AVALANCHE=`command -v avalanche`
+  if [ -z "$AVALANCHE" ]; then
+    echo "avalanche is not installed: skipped"
+    exit 77
+  fi
+  AVALANCHE_BIN=`dirname "$AVALANCHE"`
+fi
+for p in avalanche av-dist av-agent; do
+  if [ ! -x "$AVALANCHE_BIN/$p" ]; then
+    echo "$AVALANCHE_BIN/$p is not found: skipped"
+    exit 77
+  fi
+done
+
+SRCDIR=${srcdir:-`dirname $0`}
+PROG=${PROG:-`pwd`/dist}
+if [ ! -x "$PROG" ]; then
+  echo "$PROG is not built"
+  exit 1
+fi
+
+WORK=`mktemp -d /tmp/avalanche-dist-smoke.XXXXXX` || exit 1
+trap 'rm -rf "$WORK"' EXIT
+mkdir "$WORK/main" "$WORK/agent1" "$WORK/agent2"
+cp "$SRCDIR/seed" "$WORK/main/seed" || exit 1
+
+"$AVALANCHE_BIN/av-dist" $PORT > "$WORK/dist.log" 2>&1 &
+DIST_PID=$!
+sleep 1
+
+(cd "$WORK/main" &&
+ timeout $TIMEOUT "$AVALANCHE_BIN/avalanche" --distributed \
+   --dist-host=127.0.0.1 --dist-port=$PORT --filename=seed "$PROG" seed \
+   > "$WORK/main.log" 2>&1; echo $? > "$WORK/main.status") &
+PIDS=$!
+sleep 1
+
+for i in 1 2; do
+  (cd "$WORK/agent$i" &&
+   timeout $TIMEOUT "$AVALANCHE_BIN/av-agent" 127.0.0.1 $PORT \
+     > "$WORK/agent$i.log" 2>&1; echo $? > "$WORK/agent$i.status") &
+  PIDS="$PIDS $!"
+done
+wait $PIDS
+# av-dist closes the connections when it finds the end of the analysis,
+# so it is gone by now
+STATUS=0
+sleep 1
+if kill $DIST_PID 2>/dev/null; then
+  echo "av-dist is still running"
+  STATUS=1
+fi
+for p in main agent1 agent2; do
+  if [ "`cat $WORK/$p.status`" != "0" ]; then
+    echo "$p exited with status `cat $WORK/$p.status`:"
+    cat "$WORK/$p.log"
+    STATUS=1
+  fi
+done
+if ! grep -q "all peers are out of work" "$WORK/dist.log"; then
+  echo "av-dist did not find the end of the analysis:"
+  cat "$WORK/dist.log"
+  STATUS=1
+fi
+exit $STATUS
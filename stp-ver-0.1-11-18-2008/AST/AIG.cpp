@@ -0,0 +1,173 @@
+/********************************************************************
+ * AUTHORS: Avalanche contributors
+ *
+ * BEGIN DATE: October, 2026
+ *
+ * LICENSE: Please view LICENSE file in the home dir of this Program
+ ********************************************************************/
+// -*- c++ -*-
+
+#include <stdlib.h>
+#include "AIG.h"
+
+namespace BEEV {
+  static const unsigned int INITIAL_AIG_TABLE_SIZE = 1024;
+
+  AIGMgr::AIGMgr() : _mask(INITIAL_AIG_TABLE_SIZE - 1),
+		     _num_ands(0), _num_inputs(0) {
+    _table = (unsigned int *) calloc(INITIAL_AIG_TABLE_SIZE, sizeof(unsigned int));
+    AIGNode constant = {AIG_FALSE, AIG_FALSE};
+    _nodes.push_back(constant);
+  }
+
+  AIGMgr::~AIGMgr() {
+    free(_table);
+  }
+
+  void AIGMgr::Clear() {
+    free(_table);
+    _mask = INITIAL_AIG_TABLE_SIZE - 1;
+    _table = (unsigned int *) calloc(INITIAL_AIG_TABLE_SIZE, sizeof(unsigned int));
+    //release the memory of the node vector too
+    std::vector<AIGNode>(1, _nodes[0]).swap(_nodes);
+    _num_ands = 0;
+    _num_inputs = 0;
+  }
+
+  void AIGMgr::Grow() {
+    unsigned int * old = _table;
+    unsigned int old_capacity = _mask + 1;
+    _mask = (old_capacity << 1) - 1;
+    _table = (unsigned int *) calloc(_mask + 1, sizeof(unsigned int));
+    for(unsigned int i = 0; i < old_capacity; i++) {
+      if(!old[i])
+	continue;
+      const AIGNode& n = _nodes[old[i]];
+      unsigned int j = Hash(n.left, n.right) & _mask;
+      while(_table[j])
+	j = (j + 1) & _mask;
+      _table[j] = old[i];
+    }
+    free(old);
+  }
+
+  AIGLit AIGMgr::CreateInput() {
+    AIGNode n = {AIG_FALSE, _num_inputs++};
+    _nodes.push_back(n);
+    return (_nodes.size() - 1) << 1;
+  }
+
+  //left < right
+  AIGLit AIGMgr::LookupOrCreateAnd(AIGLit left, AIGLit right) {
+    unsigned int i = Hash(left, right) & _mask;
+    for(; _table[i]; i = (i + 1) & _mask) {
+      const AIGNode& n = _nodes[_table[i]];
+      if(n.left == left && n.right == right)
+	return _table[i] << 1;
+    }
+
+    //load factor is kept below 1/2
+    if(((_num_ands + 1) << 1) > _mask + 1) {
+      Grow();
+      i = Hash(left, right) & _mask;
+      while(_table[i])
+	i = (i + 1) & _mask;
+    }
+    AIGNode n = {left, right};
+    _nodes.push_back(n);
+    _table[i] = _nodes.size() - 1;
+    _num_ands++;
+    return _table[i] << 1;
+  }
+
+  AIGLit AIGMgr::And(AIGLit a, AIGLit b) {
+    if(a > b) {
+      AIGLit t = a; a = b; b = t;
+    }
+
+    //one-level rules
+    if(AIG_FALSE == a || Not(b) == a)
+      return AIG_FALSE;
+    if(AIG_TRUE == a || b == a)
+      return b;
+
+    //two-level rules, with one of the operands an AND
+    for(int side = 0; side < 2; side++) {
+      AIGLit x = side ? b : a;
+      AIGLit y = side ? a : b;
+      unsigned int xi = Index(x);
+      if(!IsAnd(xi))
+	continue;
+      AIGLit x0 = Left(xi), x1 = Right(xi);
+      if(!IsNegated(x)) {
+	//contradiction: (x0 & x1) & !x0 = FALSE
+	if(x0 == Not(y) || x1 == Not(y))
+	  return AIG_FALSE;
+	//idempotence: (x0 & x1) & x0 = x0 & x1
+	if(x0 == y || x1 == y)
+	  return x;
+      }
+      else {
+	//subsumption: !(x0 & x1) & !x0 = !x0
+	if(x0 == Not(y) || x1 == Not(y))
+	  return y;
+	//substitution: !(x0 & x1) & x0 = !x1 & x0
+	if(x0 == y)
+	  return And(Not(x1), y);
+	if(x1 == y)
+	  return And(Not(x0), y);
+      }
+    }
+
+    //two-level rules, with both operands ANDs
+    unsigned int ai = Index(a), bi = Index(b);
+    if(IsAnd(ai) && IsAnd(bi)) {
+      AIGLit a0 = Left(ai), a1 = Right(ai);
+      AIGLit b0 = Left(bi), b1 = Right(bi);
+      bool opposite =
+	a0 == Not(b0) || a0 == Not(b1) || a1 == Not(b0) || a1 == Not(b1);
+      if(!IsNegated(a) && !IsNegated(b)) {
+	//contradiction: (x & y) & (!x & z) = FALSE
+	if(opposite)
+	  return AIG_FALSE;
+      }
+      else if(!IsNegated(a) || !IsNegated(b)) {
+	//subsumption: (x & y) & !(!x & z) = x & y
+	if(opposite)
+	  return IsNegated(a) ? b : a;
+      }
+      else {
+	//resolution: !(x & y) & !(x & !y) = !x
+	if((a0 == b0 && a1 == Not(b1)) || (a0 == b1 && a1 == Not(b0)))
+	  return Not(a0);
+	if((a1 == b1 && a0 == Not(b0)) || (a1 == b0 && a0 == Not(b1)))
+	  return Not(a1);
+      }
+    }
+
+    return LookupOrCreateAnd(a, b);
+  }
+
+  AIGLit AIGMgr::Xor(AIGLit a, AIGLit b) {
+    return Not(And(Not(And(a, Not(b))), Not(And(Not(a), b))));
+  }
+
+  AIGLit AIGMgr::Ite(AIGLit c, AIGLit t, AIGLit e) {
+    if(AIG_TRUE == c || t == e)
+      return t;
+    if(AIG_FALSE == c)
+      return e;
+    if(Not(e) == t)
+      return Not(Xor(c, t));
+    return Or(And(c, t), And(Not(c), e));
+  }
+
+  //ITE(a ^ b, c, a) shares a ^ b with the sum bit of a full adder,
+  //and is encoded as a single ITE gate by the Tseitin encoding
+  AIGLit AIGMgr::Majority(AIGLit a, AIGLit b, AIGLit c) {
+    if(AIG_TRUE == a || AIG_TRUE == b || AIG_TRUE == c ||
+       AIG_FALSE == a || AIG_FALSE == b || AIG_FALSE == c)
+      return Or(And(a, b), And(c, Or(a, b)));
+    return Ite(Xor(a, b), c, a);
+  }
+}; // end namespace BEEV
@@ -0,0 +1,103 @@
+// -*- c++ -*-
+/********************************************************************
+ * AUTHORS: Avalanche contributors
+ *
+ * BEGIN DATE: October, 2026
+ *
+ * LICENSE: Please view LICENSE file in the home dir of this Program
+ ********************************************************************/
+
+#ifndef AIG_H
+#define AIG_H
+
+#include <vector>
+
+namespace BEEV {
+  //A literal of the AIG is the index of a node shifted left by one,
+  //with the lowest bit set if the node is complemented. Node 0 is the
+  //constant FALSE, so that AIG_FALSE is 0 and AIG_TRUE is 1.
+  typedef unsigned int AIGLit;
+  const AIGLit AIG_FALSE = 0;
+  const AIGLit AIG_TRUE = 1;
+
+  /***************************************************************************
+   * Class AIGMgr: And-Inverter Graph, the target of the AIG bitblaster
+   * (BitBlastAIG.cpp).
+   *
+   * A node is either an input or the AND of two literals, and takes 8
+   * bytes. Negation is free, since it is the lowest bit of a literal.
+   * AND nodes are structurally hashed, so the AND of two given literals
+   * exists at most once, and are simplified with the two-level rewriting
+   * rules of Brummayer and Biere ("Local Two-Level And-Inverter Graph
+   * Minimization without Blowup") before they are created. The children
+   * of a node always have smaller indices than the node itself.
+   ***************************************************************************/
+  class AIGMgr {
+  private:
+    struct AIGNode {
+      //left < right for AND nodes. Inputs have left == AIG_FALSE and
+      //their input number in right
+      AIGLit left;
+      AIGLit right;
+    };
+
+    std::vector<AIGNode> _nodes;
+
+    //structural hash table of the AND nodes, open addressing with
+    //linear probing. Holds node indices, 0 marks an empty slot
+    unsigned int * _table;
+    unsigned int _mask;
+    unsigned int _num_ands;
+    unsigned int _num_inputs;
+
+    static unsigned int Hash(AIGLit left, AIGLit right) {
+      unsigned int h = left * 0x9e3779b1u ^ (right + 0x7f4a7c15u) * 0x85ebca6bu;
+      return h ^ (h >> 15);
+    }
+
+    void Grow();
+    AIGLit LookupOrCreateAnd(AIGLit left, AIGLit right);
+
+    //not copyable
+    AIGMgr(const AIGMgr &);
+    AIGMgr & operator=(const AIGMgr &);
+
+  public:
+    AIGMgr();
+    ~AIGMgr();
+
+    static AIGLit Not(AIGLit a) { return a ^ 1; }
+    static bool IsNegated(AIGLit a) { return a & 1; }
+    static unsigned int Index(AIGLit a) { return a >> 1; }
+
+    bool IsAnd(unsigned int index) const {
+      return AIG_FALSE != _nodes[index].left;
+    }
+    bool IsInput(unsigned int index) const {
+      return 0 != index && AIG_FALSE == _nodes[index].left;
+    }
+    AIGLit Left(unsigned int index) const { return _nodes[index].left; }
+    AIGLit Right(unsigned int index) const { return _nodes[index].right; }
+    unsigned int InputNumber(unsigned int index) const {
+      return _nodes[index].right;
+    }
+
+    unsigned int NumNodes() const { return _nodes.size(); }
+    unsigned int NumAnds() const { return _num_ands; }
+    unsigned int NumInputs() const { return _num_inputs; }
+
+    //creates a new input. Inputs are numbered from 0 in the order of
+    //creation
+    AIGLit CreateInput();
+
+    AIGLit And(AIGLit a, AIGLit b);
+    AIGLit Or(AIGLit a, AIGLit b) { return Not(And(Not(a), Not(b))); }
+    AIGLit Xor(AIGLit a, AIGLit b);
+    AIGLit Ite(AIGLit c, AIGLit t, AIGLit e);
+    AIGLit Majority(AIGLit a, AIGLit b, AIGLit c);
+
+    //removes all nodes
+    void Clear();
+  }; //End of AIGMgr
+}; // end namespace BEEV
+#endif
@@ -8,6 +8,7 @@
 // -*- c++ -*-
 
 #include "AST.h"
+#include <algorithm>
 namespace BEEV {
   //some global variables that are set through commandline options. it
   //is best that these variables remain global. Default values set
@@ -49,11 +50,74 @@ namespace BEEV {
   bool wordlevel_solve = true;
   //turn off XOR flattening
   bool xor_flatten = false;
+  //bitblast into an AIG instead of ASTNodes
+  bool aig_bitblast = false;
+  //try the propagation pre-solver before bitblasting
+  bool presolve = true;
+  //simplify only the changed cones in the rounds of TopLevelSATAux
+  bool incremental_simplify = true;
+  //no limit on the simplification effort
+  unsigned int simplify_effort = 0;
 
   //the smtlib parser has been turned on
   bool smtlib_parser_enable = false;
   //print the input back
   bool print_STPinput_back = false;
+  //features of the MINISAT solver, all off by default
+  int sat_restart_mode = 0;
+  bool sat_lbd_reduce = false;
+  bool sat_phase_saving = false;
+  bool sat_bin_minimize = false;
+  int sat_inprocess_interval = 0;
+  bool sat_simplify = false;
+  unsigned int sat_simplify_min_size = 10000;
+  int sat_portfolio_threads = 1;
+
+  bool SetSATFeatures(const char * features) {
+    std::string list(features);
+    size_t start = 0;
+    while(start <= list.size()) {
+      size_t end = list.find(',', start);
+      if(end == std::string::npos)
+	end = list.size();
+      std::string f = list.substr(start, end - start);
+      bool all = (f == "all");
+      if(0 == f.compare(0, 5, "simp=")) {
+	char * rest;
+	sat_simplify_min_size = strtoul(f.c_str() + 5, &rest, 10);
+	if(f.size() == 5 || *rest != '\0')
+	  return false;
+	f = "simp";
+      }
+      else if(0 == f.compare(0, 10, "portfolio=")) {
+	char * rest;
+	sat_portfolio_threads = strtol(f.c_str() + 10, &rest, 10);
+	if(f.size() == 10 || *rest != '\0' || sat_portfolio_threads < 1)
+	  return false;
+	start = end + 1;
+	continue;
+      }
+      if(f == "luby")
+	sat_restart_mode = MINISAT::Solver::restart_luby;
+      else if(all || f == "glucose")
+	sat_restart_mode = MINISAT::Solver::restart_glucose;
+      else if(f != "lbd" && f != "phase" && f != "binmin" && 
+	      f != "inprocess" && f != "simp")
+	return false;
+      if(all || f == "lbd")
+	sat_lbd_reduce = true;
+      if(all || f == "phase")
+	sat_phase_saving = true;
+      if(all || f == "binmin")
+	sat_bin_minimize = true;
+      if(all || f == "inprocess")
+	sat_inprocess_interval = 5000;
+      if(all || f == "simp")
+	sat_simplify = true;
+      start = end + 1;
+    }
+    return true;
+  }
   
   //global BEEVMGR for the parser
   BeevMgr * globalBeevMgr_for_parser;
@@ -67,6 +131,45 @@ namespace BEEV {
   /** Trivial but virtual destructor */
   ASTInternal::~ASTInternal() { }
 
+  // Node allocator. Requests are rounded up to NODE_POOL_ALIGN bytes;
+  // each size class has its own free list which is refilled from
+  // NODE_POOL_SLAB-byte slabs. Slabs are never given back, freed nodes
+  // are reused for new nodes of the same size.
+  static const size_t NODE_POOL_ALIGN = 8;
+  static const size_t NODE_POOL_CLASSES = 32;
+  static const size_t NODE_POOL_SLAB = 64 * 1024;
+  static void * node_free_list[NODE_POOL_CLASSES];
+
+  void * ASTInternal::operator new(size_t size) {
+    size_t c = (size + NODE_POOL_ALIGN - 1) / NODE_POOL_ALIGN;
+    if(c >= NODE_POOL_CLASSES)
+      return ::operator new(size);
+
+    if(!node_free_list[c]) {
+      size_t chunk = c * NODE_POOL_ALIGN;
+      char * slab = (char *) ::operator new(NODE_POOL_SLAB);
+      for(size_t off = 0; off + chunk <= NODE_POOL_SLAB; off += chunk) {
+	*(void **) (slab + off) = node_free_list[c];
+	node_free_list[c] = slab + off;
+      }
+    }
+    void * p = node_free_list[c];
+    node_free_list[c] = *(void **) p;
+    return p;
+  }
+
+  void ASTInternal::operator delete(void * p, size_t size) {
+    if(!p)
+      return;
+    size_t c = (size + NODE_POOL_ALIGN - 1) / NODE_POOL_ALIGN;
+    if(c >= NODE_POOL_CLASSES) {
+      ::operator delete(p);
+      return;
+    }
+    *(void **) p = node_free_list[c];
+    node_free_list[c] = p;
+  }
+
   ////////////////////////////////////////////////////////////////
   //  ASTInterior members
   ////////////////////////////////////////////////////////////////
@@ -80,41 +183,27 @@ namespace BEEV {
   /** Trivial but virtual destructor */
   ASTInterior::~ASTInterior() { }
   
-  // FIXME: Darn it! I think this ends up copying the children twice!
   /** Either return an old node or create it if it doesn't exist. 
-      Note that nodes are physically allocated in the hash table. */
-  
-  // There is  an inelegance here that  I don't know how  to solve.  I'd
-  // like to heap allocate and do some other initialization on keys only
-  // if  they aren't  in  the hash  table.   It would  be  great if  the
-  // "insert"  method took a  "creator" class  so that  I could  do that
-  // between  when it  notices that  the key  is not  there and  when it
-  // inserts it.  Alternatively, it would be great if I could insert the
-  // temporary key and replace it  if it actually got inserted.  But STL
-  // hash_set  doesn't have  the creator  feature  and paternalistically
-  // declares that keys are immutable, even though (it seems to me) that
-  // they  could be  mutated if  the hash  value and  eq values  did not
-  // change.
-  
-  ASTInterior *BeevMgr::LookupOrCreateInterior(ASTInterior *n_ptr) {
-    ASTInteriorSet::iterator it;
-    
-    if ((it = _interior_unique_table.find(n_ptr)) == _interior_unique_table.end()) {
-      // Make a new ASTInterior node
-      // We want (NOT alpha) always to have alpha.nodenum + 1.
-      if (n_ptr->GetKind() == NOT) {
-	n_ptr->SetNodeNum(n_ptr->GetChildren()[0].GetNodeNum()+1);
-      }
-      else {
-	n_ptr->SetNodeNum(NewNodeNum());
-      }
-      pair<ASTInteriorSet::const_iterator, bool> p = _interior_unique_table.insert(n_ptr);
-      return *(p.first);
+      The lookup is done with the temporary key, so nothing is
+      allocated for nodes which are already in the unique table. */
+  ASTInterior *BeevMgr::LookupOrCreateInterior(ASTInterior &key) {
+    ASTInterior *n_ptr = _interior_unique_table.find(&key);
+    if(n_ptr)
+      return n_ptr;
+
+    // Make a new ASTInterior node. It takes the children of the key,
+    // so they are not copied.
+    n_ptr = new ASTInterior(key.GetKind(), *this);
+    n_ptr->_children.swap(key._children);
+    // We want (NOT alpha) always to have alpha.nodenum + 1.
+    if (n_ptr->GetKind() == NOT) {
+      n_ptr->SetNodeNum(n_ptr->GetChildren()[0].GetNodeNum()+1);
     }
-    else
-      // Delete the temporary node, and return the found node.
-      delete n_ptr;
-      return *it;
+    else {
+      n_ptr->SetNodeNum(NewNodeNum());
+    }
+    _interior_unique_table.insert(n_ptr);
+    return n_ptr;
   }
   
   size_t ASTInterior::ASTInteriorHasher::operator() (const ASTInterior *int_node_ptr) const {
@@ -685,11 +774,11 @@ namespace BEEV {
   //  BeevMgr members
   ////////////////////////////////////////////////////////////////
   ASTNode BeevMgr::CreateNode(Kind kind, const ASTVec & back_children) {
-    // create a new node.  Children will be modified.
-    ASTInterior *n_ptr = new ASTInterior(kind, *this);
+    // temporary key on the stack.  Children will be modified.
+    ASTInterior key(kind, *this);
 
     // insert all of children at end of new_children.
-    ASTNode n(CreateInteriorNode(kind, n_ptr, back_children));
+    ASTNode n(CreateInteriorNode(kind, key, back_children));
     return n;
   }
 
@@ -697,10 +786,11 @@ namespace BEEV {
 			      const ASTNode& child0,
 			      const ASTVec & back_children) {
 
-    ASTInterior *n_ptr = new ASTInterior(kind, *this);
-    ASTVec &front_children = n_ptr->_children;
+    ASTInterior key(kind, *this);
+    ASTVec &front_children = key._children;
+    front_children.reserve(1 + back_children.size());
     front_children.push_back(child0);
-    ASTNode n(CreateInteriorNode(kind, n_ptr,  back_children));
+    ASTNode n(CreateInteriorNode(kind, key,  back_children));
     return n;
   }
   
@@ -709,11 +799,12 @@ namespace BEEV {
 			      const ASTNode& child1,
 			      const ASTVec & back_children) {
 
-    ASTInterior *n_ptr = new ASTInterior(kind, *this);
-    ASTVec &front_children = n_ptr->_children;
+    ASTInterior key(kind, *this);
+    ASTVec &front_children = key._children;
+    front_children.reserve(2 + back_children.size());
     front_children.push_back(child0);
     front_children.push_back(child1);
-    ASTNode n(CreateInteriorNode(kind, n_ptr, back_children));
+    ASTNode n(CreateInteriorNode(kind, key, back_children));
     return n;
   }
   
@@ -723,23 +814,24 @@ namespace BEEV {
 			      const ASTNode& child1,
 			      const ASTNode& child2,
 			      const ASTVec & back_children) {
-    ASTInterior *n_ptr = new ASTInterior(kind, *this);
-    ASTVec &front_children = n_ptr->_children;
+    ASTInterior key(kind, *this);
+    ASTVec &front_children = key._children;
+    front_children.reserve(3 + back_children.size());
     front_children.push_back(child0);
     front_children.push_back(child1);
     front_children.push_back(child2);
-    ASTNode n(CreateInteriorNode(kind, n_ptr, back_children));
+    ASTNode n(CreateInteriorNode(kind, key, back_children));
     return n;
   }
   
   
   ASTInterior *BeevMgr::CreateInteriorNode(Kind kind,
 					   // children array of this node will be modified.
-					   ASTInterior *n_ptr,
+					   ASTInterior &key,
 					   const ASTVec & back_children) {
 
     // insert back_children at end of front_children
-    ASTVec &front_children = n_ptr->_children;
+    ASTVec &front_children = key._children;
 
     front_children.insert(front_children.end(), back_children.begin(), back_children.end());
 
@@ -750,7 +842,7 @@ namespace BEEV {
 	FatalError("CreateInteriorNode: Undefined childnode in CreateInteriorNode: ", ASTUndefined);      
     }
 
-    return LookupOrCreateInterior(n_ptr);
+    return LookupOrCreateInterior(key);
   }
     
   /** Trivial but virtual destructor */
@@ -782,29 +874,11 @@ namespace BEEV {
 				 unsigned long long int bvconst){ 
     if(width > (sizeof(unsigned long long int)<<3) || width <= 0)
       FatalError("CreateBVConst: trying to create a bvconst of width: ", ASTUndefined, width);
-    
-
-    CBV bv = CONSTANTBV::BitVector_Create(width, true);
-    unsigned long c_val = (0x00000000ffffffffLL) & bvconst;
-    unsigned int copied = 0;
 
-    // sizeof(unsigned long) returns the number of bytes in unsigned
-    // long. In order to convert it to bits, we need to shift left by
-    // 3. Hence, sizeof(unsigned long) << 3
-
-    //The algo below works as follows: It starts by copying the
-    //lower-order bits of the input "bvconst" in chunks of size =
-    //number of bits in unsigned long. The variable "copied" keeps
-    //track of the number of chunks copied so far
-
-    while(copied + sizeof(unsigned long)<<3 < width){
-      CONSTANTBV::BitVector_Chunk_Store(bv, sizeof(unsigned long)<<3,copied,c_val);
-      bvconst = bvconst >> (sizeof(unsigned long) << 3);
-      c_val = (0x00000000ffffffffLL) & bvconst;
-      copied += sizeof(unsigned long) << 3;
-    }
-    CONSTANTBV::BitVector_Chunk_Store(bv,width - copied,copied,c_val);
-    return CreateBVConst(bv,width);
+    if(width < 64)
+      bvconst &= (1ULL << width) - 1;
+    ASTBVConst temp_bvconst(bvconst, width, *this);
+    return ASTNode(LookupOrCreateBVConst(temp_bvconst));
   }
 
   //Create a ASTBVConst node from std::string
@@ -843,20 +917,32 @@ namespace BEEV {
 
   //FIXME Code currently assumes that it will destroy the bitvector passed to it
   ASTNode BeevMgr::CreateBVConst(CBV bv, unsigned width){
-     ASTBVConst temp_bvconst(bv, width, *this);
-     ASTNode n(LookupOrCreateBVConst(temp_bvconst));
-     
-     CONSTANTBV::BitVector_Destroy(bv);
-     
-     return n;
+    if(width <= ASTBVConst::SMALL_WIDTH) {
+      unsigned long long int value = 0;
+      for(unsigned int copied = 0; copied < width; copied += 32) {
+	unsigned int len = (width - copied < 32) ? width - copied : 32;
+	value |= ((unsigned long long int) 
+		  CONSTANTBV::BitVector_Chunk_Read(bv, len, copied)) << copied;
+      }
+      CONSTANTBV::BitVector_Destroy(bv);
+      return CreateBVConst(width, value);
+    }
+
+    //the temporary key frees bv
+    ASTBVConst temp_bvconst(bv, width, *this);
+    return ASTNode(LookupOrCreateBVConst(temp_bvconst));
   }
 
   ASTNode BeevMgr::CreateZeroConst(unsigned width) {
+    if(width <= ASTBVConst::SMALL_WIDTH)
+      return CreateBVConst(width, 0);
     CBV z = CONSTANTBV::BitVector_Create(width, true);
     return CreateBVConst(z, width);
   }
   
   ASTNode BeevMgr::CreateOneConst(unsigned width) {
+    if(width <= ASTBVConst::SMALL_WIDTH)
+      return CreateBVConst(width, 1);
     CBV o = CONSTANTBV::BitVector_Create(width, true);
     CONSTANTBV::BitVector_increment(o);
     
@@ -864,6 +950,8 @@ namespace BEEV {
   }
 
   ASTNode BeevMgr::CreateTwoConst(unsigned width) {
+    if(width <= ASTBVConst::SMALL_WIDTH)
+      return CreateBVConst(width, 2);
     CBV two = CONSTANTBV::BitVector_Create(width, true);
     CONSTANTBV::BitVector_increment(two);
     CONSTANTBV::BitVector_increment(two);
@@ -872,6 +960,8 @@ namespace BEEV {
   }
 
   ASTNode BeevMgr::CreateMaxConst(unsigned width) {
+    if(width <= ASTBVConst::SMALL_WIDTH)
+      return CreateBVConst(width, ~0ULL);
     CBV max = CONSTANTBV::BitVector_Create(width, false);
     CONSTANTBV::BitVector_Fill(max);
 
@@ -884,21 +974,20 @@ namespace BEEV {
     ASTBVConst *s_ptr = &s;  // it's a temporary key.
     
     // Do an explicit lookup to see if we need to create a copy of the string.    
-    ASTBVConstSet::const_iterator it;
-    if ((it = _bvconst_unique_table.find(s_ptr)) == _bvconst_unique_table.end()) {
+    ASTBVConst *found = _bvconst_unique_table.find(s_ptr);
+    if (found == NULL) {
       // Make a new ASTBVConst with duplicated string (can't assign
-      // _name because it's const).  Can cast the iterator to
-      // non-const -- carefully.
+      // _name because it's const).
 
       ASTBVConst * s_copy = new ASTBVConst(s);      
       s_copy->SetNodeNum(NewNodeNum());
       
-      pair<ASTBVConstSet::const_iterator, bool> p = _bvconst_unique_table.insert(s_copy);
-      return *p.first;
+      _bvconst_unique_table.insert(s_copy);
+      return s_copy;
     }
     else{
       // return symbol found in table.
-      return *it;
+      return found;
     }
   }
 
@@ -915,6 +1004,12 @@ namespace BEEV {
       FatalError("GetBVConst: non bitvector-constant: ",*this);
     return ((ASTBVConst *) _int_node_ptr)->GetBVConst();      
   }
+
+  unsigned long long int ASTNode::GetBVConstValue() const {
+    if(GetKind() != BVCONST || GetValueWidth() > 64)
+      FatalError("GetBVConstValue: not a bitvector-constant of at most 64 bits: ",*this);
+    return ((ASTBVConst *) _int_node_ptr)->GetSmallValue();
+  }
 #else
   //Create a ASTBVConst node
   ASTNode BeevMgr::CreateBVConst(const unsigned int width, 
@@ -967,20 +1062,19 @@ namespace BEEV {
 
     // Do an explicit lookup to see if we need to create a copy of the
     // string.
-    ASTBVConstSet::const_iterator it;
-    if ((it = _bvconst_unique_table.find(s_ptr)) == _bvconst_unique_table.end()) {
-      // Make a new ASTBVConst. Can cast the iterator to non-const --
-      // carefully.
+    ASTBVConst *found = _bvconst_unique_table.find(s_ptr);
+    if (found == NULL) {
+      // Make a new ASTBVConst.
       unsigned int width = s_ptr->_value_width;
       ASTBVConst * s_ptr1 = new ASTBVConst(s_ptr->GetBVConst(), *this);
       s_ptr1->SetNodeNum(NewNodeNum());
       s_ptr1->_value_width = width;
-      pair<ASTBVConstSet::const_iterator, bool> p = _bvconst_unique_table.insert(s_ptr1);
-      return *p.first;
+      _bvconst_unique_table.insert(s_ptr1);
+      return s_ptr1;
     }
     else
       // return BVConst found in table.
-      return *it;
+      return found;
   }
 
   // Inline because we need to wait until unique_table is defined
@@ -1033,27 +1127,26 @@ namespace BEEV {
     ASTSymbol *s_ptr = &s;  // it's a temporary key.
     
     // Do an explicit lookup to see if we need to create a copy of the string.    
-    ASTSymbolSet::const_iterator it;
-    if ((it = _symbol_unique_table.find(s_ptr)) == _symbol_unique_table.end()) {
+    ASTSymbol *found = _symbol_unique_table.find(s_ptr);
+    if (found == NULL) {
       // Make a new ASTSymbol with duplicated string (can't assign
-      // _name because it's const).  Can cast the iterator to
-      // non-const -- carefully.
+      // _name because it's const).
       //std::string strname(s_ptr->GetName());
       ASTSymbol * s_ptr1 = new ASTSymbol(strdup(s_ptr->GetName()), *this);
       s_ptr1->SetNodeNum(NewNodeNum());
       s_ptr1->_value_width = s_ptr->_value_width;
-      pair<ASTSymbolSet::const_iterator, bool> p = _symbol_unique_table.insert(s_ptr1);
-      return *p.first;
+      _symbol_unique_table.insert(s_ptr1);
+      return s_ptr1;
     }
     else
       // return symbol found in table.
-      return *it;    
+      return found;    
   }
 
   bool BeevMgr::LookupSymbol(ASTSymbol& s) {
     ASTSymbol* s_ptr = &s;  // it's a temporary key.
 
-    if(_symbol_unique_table.find(s_ptr) == _symbol_unique_table.end()) 
+    if(_symbol_unique_table.find(s_ptr) == NULL) 
       return false;
     else
       return true;
@@ -1467,17 +1560,26 @@ namespace BEEV {
     }*/
     BBTermMemo.clear();
     BBFormMemo.clear();
+    AIGTermMemo.clear();
+    AIGFormMemo.clear();
+    _aig.Clear();
+    _aig_inputs.clear();
+    _aig_satvar.clear();
     NodeLetVarMap.clear();
     NodeLetVarMap1.clear();
     PLPrintNodeSet.clear();
     AlreadyPrintedSet.clear();
     SimplifyMap.clear();
     SimplifyNegMap.clear();
+    SimplifyParentsMap.clear();
+    SimplifyReadOverWrites.clear();
+    Incremental_Simplify_Flag = false;
     SolverMap.clear();
     AlwaysTrueFormMap.clear();
     _arrayread_ite.clear();
     _arrayread_symbol.clear();
     _introduced_symbols.clear();
+    _phase_hint_values.clear();
     TransformMap.clear();
     _letid_expr_map.clear();
     CounterExampleMap.clear();
@@ -1526,17 +1628,26 @@ namespace BEEV {
     }*/
     BBTermMemo.clear();
     BBFormMemo.clear();
+    AIGTermMemo.clear();
+    AIGFormMemo.clear();
+    _aig.Clear();
+    _aig_inputs.clear();
+    _aig_satvar.clear();
     NodeLetVarMap.clear();
     NodeLetVarMap1.clear();
     PLPrintNodeSet.clear();
     AlreadyPrintedSet.clear();
     SimplifyMap.clear();
     SimplifyNegMap.clear();
+    SimplifyParentsMap.clear();
+    SimplifyReadOverWrites.clear();
+    Incremental_Simplify_Flag = false;
     SolverMap.clear();
     AlwaysTrueFormMap.clear();
     _arrayread_ite.clear();
     _arrayread_symbol.clear();
     _introduced_symbols.clear();
+    _phase_hint_values.clear();
     TransformMap.clear();
     _letid_expr_map.clear();
     CounterExampleMap.clear();
@@ -1555,6 +1666,60 @@ namespace BEEV {
     //_bvconst_unique_table.clear();
   }
 
+  void BeevMgr::CollectGarbage(void) {
+    ClearAllCaches();
+    //the tables that ClearAllCaches leaves alone. none of them is
+    //needed after the query that filled it
+    MultInverseMap.clear();
+    RepLitMap.clear();
+    CheckBBandCNFMemo.clear();
+    TermsAlreadySeenMap.clear();
+    NodeLetVarVec.clear();
+    ArrayWrite_RemainingAxioms.clear();
+    ReadOverWrite_NewName_Map.clear();
+    NewName_ReadOverWrite_Map.clear();
+    std::vector<std::vector<MINISAT::Lit> >().swap(_portfolio_clauses);
+    _current_query = ASTUndefined;
+
+    //the nodes that were only kept alive by the tables are gone by
+    //now (unless reference counting is off)
+    _interior_unique_table.shrink();
+    _symbol_unique_table.shrink();
+    _bvconst_unique_table.shrink();
+
+    if(_max_node_num > NODE_NUM_RENUMBER_LIMIT)
+      RenumberNodes();
+  }
+
+  void BeevMgr::RenumberNodes(void) {
+    std::vector<ASTInternal *> nodes;
+    nodes.reserve(_interior_unique_table.size() + 
+		  _symbol_unique_table.size() + 
+		  _bvconst_unique_table.size());
+    _interior_unique_table.elements(nodes);
+    _symbol_unique_table.elements(nodes);
+    _bvconst_unique_table.elements(nodes);
+
+    std::vector<pair<int, ASTInternal *> > order;
+    order.reserve(nodes.size());
+    for(std::vector<ASTInternal *>::iterator it = nodes.begin(), 
+	  itend = nodes.end(); it != itend; it++)
+      order.push_back(make_pair((*it)->GetNodeNum(), *it));
+    std::sort(order.begin(), order.end());
+
+    //the children are numbered before their parents, and (NOT alpha)
+    //keeps alpha.nodenum + 1
+    _max_node_num = 0;
+    for(std::vector<pair<int, ASTInternal *> >::iterator it = order.begin(), 
+	  itend = order.end(); it != itend; it++) {
+      ASTInternal * n = it->second;
+      if(NOT == n->GetKind())
+	n->SetNodeNum(n->GetChildren()[0].GetNodeNum()+1);
+      else
+	n->SetNodeNum(NewNodeNum());
+    }
+  }
+
   void BeevMgr::CopySolverMap_To_CounterExample(void) {
     if(!SolverMap.empty()) {
       CounterExampleMap.insert(SolverMap.begin(),SolverMap.end());
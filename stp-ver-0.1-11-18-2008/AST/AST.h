@@ -32,8 +32,11 @@
 #include <set>
 #include "ASTUtil.h"
 #include "ASTKind.h"
+#include "UniqueTable.h"
+#include "AIG.h"
 #include "../sat/core/Solver.h"
 #include "../sat/core/SolverTypes.h"
+#include "../sat/simp/SimpSolver.h"
 #include <stdlib.h>
 #ifndef NATIVE_C_ARITH
 #include "../constantbv/constantbv.h"
@@ -87,6 +90,7 @@ namespace BEEV {
   class ASTNode {
     friend class BeevMgr;
     friend class CNFMgr;
+    friend class TraceReader;
     friend class ASTInterior;
     friend class vector<ASTNode>;
     //Print the arguments in lisp format.
@@ -241,6 +245,9 @@ namespace BEEV {
     //Get the BVCONST value
 #ifndef NATIVE_C_ARITH
     const CBV GetBVConst() const;
+    //Get the value of a BVCONST of at most 64 bits, without going
+    //through its CBV
+    unsigned long long int GetBVConstValue() const;
 #else
     unsigned long long int GetBVConst() const;
 #endif
@@ -351,6 +358,7 @@ namespace BEEV {
 
     friend class ASTNode;
     friend class CNFMgr;
+    friend class BeevMgr;
 
   protected:    
 
@@ -461,6 +469,12 @@ namespace BEEV {
 
     // Abstract virtual print function for internal node.
     virtual void nodeprint(ostream& os) { os << "*"; };
+
+  public:
+    // Nodes are carved out of large slabs and recycled through
+    // per-size free lists instead of going to malloc one by one.
+    static void * operator new(size_t size);
+    static void operator delete(void * p, size_t size);
   }; //End of Class ASTInternal
 
   // FIXME: Should children be only in interior node type?
@@ -608,13 +622,24 @@ namespace BEEV {
     friend class ASTNodeEqual;
     
   private:
+    //Constants of at most SMALL_WIDTH bits keep their value in
+    //_small, and their CBV is only made when GetBVConst() asks for
+    //it, so that creating and looking up such constants does not
+    //allocate. Wider constants always have _bvconst, and _small is 0.
+    static const unsigned int SMALL_WIDTH = 64;
+    unsigned long long int _small;
+
     //This is the private copy of a bvconst currently
     //This should not be changed at any point
-    CBV _bvconst;
+    mutable CBV _bvconst;
+
+    bool IsSmall() const { return _value_width <= SMALL_WIDTH; }
 
     class ASTBVConstHasher{
     public:
       size_t operator() (const ASTBVConst * bvc) const {
+	if(bvc->IsSmall())
+	  return (size_t) (bvc->_small ^ (bvc->_small >> 32));
         return CONSTANTBV::BitVector_Hash(bvc->_bvconst);
       };
     };
@@ -625,22 +650,29 @@ namespace BEEV {
         if( bvc1->_value_width != bvc2->_value_width){
 	  return false;
 	}  
+	if(bvc1->IsSmall())
+	  return bvc1->_small == bvc2->_small;
 	return (0==CONSTANTBV::BitVector_Compare(bvc1->_bvconst,bvc2->_bvconst));
       }
     };
     
-    //FIXME Keep an eye on this function
+    //Takes over bv, which is freed with the node. bv must be wider
+    //than SMALL_WIDTH
     ASTBVConst(CBV bv, unsigned int width, BeevMgr &bm) :
-      ASTInternal(BVCONST, bm)
+      ASTInternal(BVCONST, bm), _small(0), _bvconst(bv)
+    {
+      _value_width = width;
+    }
+
+    //value must fit in width, which is at most SMALL_WIDTH
+    ASTBVConst(unsigned long long int value, unsigned int width, BeevMgr &bm) :
+      ASTInternal(BVCONST, bm), _small(value), _bvconst(NULL)
     {
-      _bvconst = CONSTANTBV::BitVector_Clone(bv);
       _value_width = width;
     }
 
     friend bool operator==(const ASTBVConst &bvc1, const ASTBVConst &bvc2){
-      if(bvc1._value_width != bvc2._value_width)
-        return false;
-      return (0==CONSTANTBV::BitVector_Compare(bvc1._bvconst,bvc2._bvconst));
+      return ASTBVConstEqual()(&bvc1, &bvc2);
     }
     // Call this when deleting a node that has been stored in the
     // the unique table
@@ -652,10 +684,10 @@ namespace BEEV {
       const char *prefix;
 
       if (_value_width%4 == 0) {
-        res = CONSTANTBV::BitVector_to_Hex(_bvconst);
+        res = CONSTANTBV::BitVector_to_Hex(GetBVConst());
         prefix = "0hex";
       } else {      
-        res = CONSTANTBV::BitVector_to_Bin(_bvconst);
+        res = CONSTANTBV::BitVector_to_Bin(GetBVConst());
         prefix = "0bin";
       }
       if (NULL == res) {
@@ -668,18 +700,31 @@ namespace BEEV {
 
     // Copy constructor.     
     ASTBVConst(const ASTBVConst &sym) : 
-      ASTInternal(sym._kind, sym._children, sym._bm)
+      ASTInternal(sym._kind, sym._children, sym._bm), _small(sym._small)
     {
-      _bvconst = CONSTANTBV::BitVector_Clone(sym._bvconst);
+      _bvconst = sym.IsSmall() ? NULL : CONSTANTBV::BitVector_Clone(sym._bvconst);
       _value_width = sym._value_width;
     }
     
   public:
     virtual ~ASTBVConst(){
-       CONSTANTBV::BitVector_Destroy(_bvconst);
+      if(_bvconst)
+	CONSTANTBV::BitVector_Destroy(_bvconst);
+    }
+
+    CBV GetBVConst() const {
+      if(!_bvconst) {
+	_bvconst = CONSTANTBV::BitVector_Create(_value_width, true);
+	for(unsigned int copied = 0; copied < _value_width; copied += 32) {
+	  unsigned int len = (_value_width - copied < 32) ? _value_width - copied : 32;
+	  CONSTANTBV::BitVector_Chunk_Store(_bvconst, len, copied, 
+					    (unsigned long) ((_small >> copied) & 0xffffffff));
+	}
+      }
+      return _bvconst;
     }
 
-    CBV GetBVConst() const {return _bvconst;}
+    unsigned long long int GetSmallValue() const { return _small; }
   }; //End of ASTBVConst
 
   //FIXME This function is DEPRICATED
@@ -1088,6 +1133,8 @@ namespace BEEV {
     friend class ASTInterior;
     friend class ASTBVConst;
     friend class ASTSymbol;
+    friend class CNFMgr;	// CNFMgr gives its clauses to the SAT
+				// solver
 
     // FIXME: The values appear to be the same regardless of the value of SMTLIB
     // initial hash table sizes, to save time on resizing.
@@ -1116,16 +1163,20 @@ namespace BEEV {
     static const int INITIAL_INTRODUCED_SYMBOLS_SIZE = 100;
 #endif
 
+    // CollectGarbage renumbers the live nodes once the node numbers
+    // get past this, so that they never overflow
+    static const int NODE_NUM_RENUMBER_LIMIT = 1 << 30;
+
   private:
     // Typedef for unique Interior node table. 
-    typedef hash_set<ASTInterior *, 
-		     ASTInterior::ASTInteriorHasher, 
-		     ASTInterior::ASTInteriorEqual> ASTInteriorSet;
+    typedef UniqueTable<ASTInterior, 
+			ASTInterior::ASTInteriorHasher, 
+			ASTInterior::ASTInteriorEqual> ASTInteriorSet;
 
     // Typedef for unique Symbol node (leaf) table.
-    typedef hash_set<ASTSymbol *, 
-		     ASTSymbol::ASTSymbolHasher, 
-		     ASTSymbol::ASTSymbolEqual> ASTSymbolSet;
+    typedef UniqueTable<ASTSymbol, 
+			ASTSymbol::ASTSymbolHasher, 
+			ASTSymbol::ASTSymbolEqual> ASTSymbolSet;
 
     // Unique tables to share nodes whenever possible.
     ASTInteriorSet _interior_unique_table;
@@ -1134,9 +1185,9 @@ namespace BEEV {
     ASTSymbolSet _symbol_unique_table;
     
     //Typedef for unique BVConst node (leaf) table.
-    typedef hash_set<ASTBVConst *, 
-		     ASTBVConst::ASTBVConstHasher,
-		     ASTBVConst::ASTBVConstEqual> ASTBVConstSet;
+    typedef UniqueTable<ASTBVConst, 
+			ASTBVConst::ASTBVConstHasher,
+			ASTBVConst::ASTBVConstEqual> ASTBVConstSet;
 
     //table to uniquefy bvconst
     ASTBVConstSet _bvconst_unique_table;
@@ -1197,6 +1248,16 @@ namespace BEEV {
 		  ASTVec &q,
 		  ASTVec &r,
 		  unsigned int rwidth);
+
+    // Multiply x by the constant c: one adder or subtractor per term
+    // and per subexpression of the plan.
+    ASTVec BBMultConst(const ASTVec& x, const std::vector<bool>& c);
+    // sum += sign * (y << shift)
+    void BBAddShifted(ASTVec& sum, const ASTVec& y, unsigned int shift, int sign);
+    // Unsigned division of y by the nonzero constant c. Powers of two
+    // are a matter of wiring.
+    void BBDivModConst(const ASTVec& y, const std::vector<bool>& c,
+		       ASTVec& q, ASTVec& r);
     
     // Return formula for majority function of three formulas.
     ASTNode Majority(const ASTNode& a, const ASTNode& b, const ASTNode& c);
@@ -1252,6 +1313,71 @@ namespace BEEV {
 
     const ASTNode BBForm(const ASTNode& formula);
 
+    // Multiplication by a constant is the sum of terms sign *
+    // (operand << shift), where operand 0 is the multiplicand and
+    // operand i > 0 is subexprs[i-1].
+    struct MultConstTerm {
+      unsigned int operand;
+      unsigned int shift;
+      int sign;
+    };
+    // The common subexpression operand left + term
+    struct MultConstSubexpr {
+      unsigned int left;
+      MultConstTerm term;
+    };
+    // Plan the multiplication by the constant c (given bit by bit,
+    // low-order first), starting from its canonical signed digit form.
+    // The positive terms come first.
+    static void MultConstPlan(const std::vector<bool>& c,
+			      std::vector<MultConstSubexpr>& subexprs,
+			      std::vector<MultConstTerm>& terms);
+
+    // Declarations of the AIG bitblaster (BitBlastAIG.cpp). Used
+    // instead of BBTerm/BBForm and the CNF conversion if aig_bitblast
+    // is set.
+  public:
+    // A bitblasted term: one AIG literal per bit, low-order bit first
+    typedef std::vector<AIGLit> AIGVec;
+
+    const AIGVec& BBTermAIG(const ASTNode& term);
+    AIGLit BBFormAIG(const ASTNode& form);
+
+  private:
+    // The AIG all formulas are bitblasted into, and the ASTNode of each
+    // of its inputs (a BVGETBIT node or a Boolean SYMBOL), by input
+    // number
+    AIGMgr _aig;
+    ASTVec _aig_inputs;
+
+    // Memo tables for AIG-bitblasted terms and formulas
+    typedef hash_map<ASTNode, AIGVec,
+		     ASTNode::ASTNodeHasher,
+		     ASTNode::ASTNodeEqual> ASTNodeToAIGVecMap;
+    typedef hash_map<ASTNode, AIGLit,
+		     ASTNode::ASTNodeHasher,
+		     ASTNode::ASTNodeEqual> ASTNodeToAIGLitMap;
+    ASTNodeToAIGVecMap AIGTermMemo;
+    ASTNodeToAIGLitMap AIGFormMemo;
+
+    // Same as the BB* functions of BitBlast.cpp, on AIG literals
+    void AIGPlus2(AIGVec& sum, const AIGVec& y, AIGLit cin);
+    void AIGSub(AIGVec& result, const AIGVec& y);
+    AIGVec AIGAddOneBit(const AIGVec& x, AIGLit cin);
+    AIGVec AIGNeg(const AIGVec& x);
+    AIGVec AIGMult(const AIGVec& x, const AIGVec& y);
+    void AIGDivMod(const AIGVec& y, const AIGVec& x, AIGVec& q, AIGVec& r);
+    AIGVec AIGMultConst(const AIGVec& x, const std::vector<bool>& c);
+    void AIGAddShifted(AIGVec& sum, const AIGVec& y, unsigned int shift, int sign);
+    void AIGDivModConst(const AIGVec& y, const std::vector<bool>& c, AIGVec& q, AIGVec& r);
+    AIGVec AIGITE(AIGLit cond, const AIGVec& thn, const AIGVec& els);
+    AIGLit AIGBVLE(const AIGVec& left, const AIGVec& right, bool is_signed);
+    AIGLit AIGEQ(const AIGVec& left, const AIGVec& right);
+
+    // SAT variable of each AIG node in the current SAT solver, -1 if
+    // it has none yet
+    std::vector<int> _aig_satvar;
+
     // Declarations of CNF conversion (ToCNF.cpp)
   public:
     // ToCNF converts a bit-blasted Boolean formula to Conjunctive
@@ -1321,12 +1447,14 @@ namespace BEEV {
     //nodes are not modified.  Then it returns the hashed copy of the
     //node, which is created if necessary.
     ASTInterior *CreateInteriorNode(Kind kind,
-				    ASTInterior *new_node,
+				    ASTInterior &key,
 				    // this is destructively modified.
 				    const ASTVec & back_children = _empty_ASTVec);
 
-    // Create unique ASTInterior node.
-    ASTInterior *LookupOrCreateInterior(ASTInterior *n);
+    // Create unique ASTInterior node. key is a temporary (usually on
+    // the stack); a heap node is made only if key is not in the
+    // unique table, and it takes over the children of key.
+    ASTInterior *LookupOrCreateInterior(ASTInterior &key);
 
     // Create unique ASTSymbol node. 
     ASTSymbol *LookupOrCreateSymbol(ASTSymbol& s);
@@ -1430,6 +1558,18 @@ namespace BEEV {
 
     ASTNode SimplifyFormula_NoRemoveWrites(const ASTNode& a, bool pushNeg);
     ASTNode SimplifyFormula_TopLevel(const ASTNode& a, bool pushNeg);
+    //like SimplifyFormula_TopLevel, but keeps the memo tables between
+    //the calls of an incremental session (see SimplifyParentsMap)
+    ASTNode SimplifyFormula_Incremental(const ASTNode& a, bool pushNeg);
+    //begins (if incremental_simplify is set) and ends an incremental
+    //session, and resets the simplification effort
+    void BeginIncrementalSimplify(void);
+    void EndIncrementalSimplify(void);
+    //drops the memo entries of the READ over WRITE terms, whose
+    //simplification depends on the array write flags
+    void InvalidateReadOverWrites(void);
+    //true if simplify_effort is exhausted for the current query
+    bool SimplifyEffortExhausted(void);
     ASTNode SimplifyFormula(const ASTNode& a, bool pushNeg);
     ASTNode SimplifyTerm_TopLevel(const ASTNode& b);
     ASTNode SimplifyTerm(const ASTNode& a);
@@ -1443,6 +1583,22 @@ namespace BEEV {
     ASTNodeSet AlwaysTrueFormMap;
     ASTNodeMap MultInverseMap;
 
+    //In an incremental session SimplifyMap and SimplifyNegMap are
+    //kept from one round of TopLevelSATAux to the next. Every node of
+    //a memoized key or value is indexed here with the nodes that have
+    //it as a child, and with the keys it is the memoized value of.
+    //When a symbol is solved, or a formula becomes always true, only
+    //the memo entries in its cone of parents are dropped
+    bool Incremental_Simplify_Flag;
+    ASTNodeToVecMap SimplifyParentsMap;
+    //the READ over WRITE nodes of SimplifyParentsMap
+    ASTVec SimplifyReadOverWrites;
+    //number of simplifications memoized for the current query
+    unsigned int SimplifyEffort;
+    void IndexSimplifyNode(const ASTNode& a);
+    void InvalidateSimplifyCones(const ASTVec& a);
+    void InvalidateSimplifyCone(const ASTNode& a);
+
   public:
     ASTNode SimplifyAtomicFormula(const ASTNode& a, bool pushNeg);
     ASTNode CreateSimplifiedEQ(const ASTNode& t1, const ASTNode& t2);
@@ -1466,17 +1622,34 @@ namespace BEEV {
     ASTNode ConvertBVSXToITE(const ASTNode& a);
     //checks if the input constant is odd or not
     bool BVConstIsOdd(const ASTNode& c);
+    bool BVConstIsPowerOfTwo(const ASTNode& c, unsigned int& power);
+    ASTNode CreateDivModByPowerOfTwo(Kind k, const ASTNode& a, unsigned int power);
     //computes the multiplicatve inverse of the input
     ASTNode MultiplicativeInverse(const ASTNode& c);
  
     void ClearAllTables(void);
     void ClearAllCaches(void);
+    //Called between queries by clients that run many queries on one
+    //BeevMgr. Clears every memo table (dropping the last
+    //counterexample), which frees through the reference counts all
+    //the nodes that are not reachable from the asserts or from the
+    //client, and gives back the memory of the unique tables.
+    void CollectGarbage(void);
+  private:
+    //Gives the live nodes new node numbers, in the same order as the
+    //old ones
+    void RenumberNodes(void);
+  public:
     int  BeforeSAT_ResultCheck(const ASTNode& q);
-    int  CallSAT_ResultCheck(MINISAT::Solver& newS, 
+    int  CallSAT_ResultCheck(MINISAT::SimpSolver& newS, 
 			     const ASTNode& q, const ASTNode& orig_input);   
-    int  SATBased_ArrayReadRefinement(MINISAT::Solver& newS, 
+    int  CallPreSolver_ResultCheck(const ASTNode& q, const ASTNode& orig_input);
+    //number of queries given to the PreSolver, and decided by it
+    unsigned int _presolver_queries;
+    unsigned int _presolver_decided;
+    int  SATBased_ArrayReadRefinement(MINISAT::SimpSolver& newS, 
 				      const ASTNode& q, const ASTNode& orig_input);
-    int SATBased_ArrayWriteRefinement(MINISAT::Solver& newS, const ASTNode& orig_input);
+    int SATBased_ArrayWriteRefinement(MINISAT::SimpSolver& newS, const ASTNode& orig_input);
     //creates array write axiom only for the input term or formula, if
     //necessary. If there are no axioms to produce then it simply
     //generates TRUE
@@ -1497,10 +1670,11 @@ namespace BEEV {
   private:
     /* MAP: This is a map from ASTNodes to MINISAT::Vars. 
      *
-     * The map is populated while ASTclauses are read from the AST
-     * ClauseList returned by CNF converter. For every new boolean
-     * variable in ASTClause a new MINISAT::Var is created (these vars
-     * typedefs for ints)
+     * The map is populated while the CNF converter gives its clauses
+     * to the SAT solver. For every new boolean variable in a clause a
+     * new MINISAT::Var is created (these vars typedefs for ints). The
+     * variables of the nodes renamed by the CNF converter have no
+     * ASTNode, and are not in the map.
      */
     typedef hash_map<ASTNode, MINISAT::Var, 
 		     ASTNode::ASTNodeHasher, 
@@ -1510,7 +1684,18 @@ namespace BEEV {
 
   public:  
     //converts the clause to SAT and calls SAT solver
-    bool toSATandSolve(MINISAT::Solver& S, ClauseList& cll);
+    bool toSATandSolve(MINISAT::SimpSolver& S, ClauseList& cll);
+
+    //gives the Tseitin clauses of the AIG cone of root, asserted, to
+    //the SAT solver, and calls it. The clauses of the AIG nodes already
+    //known to S are not given again
+    bool AIGtoSATandSolve(MINISAT::SimpSolver& S, AIGLit root);
+
+    //solves the clauses given to newS so far with newS and
+    //sat_portfolio_threads-1 diversified solvers in parallel. the
+    //result (model, or UNSAT) of the first one to finish is left in
+    //newS
+    void SolvePortfolio(MINISAT::SimpSolver& newS);
 
     ///print SAT solver statistics
     void PrintStats(MINISAT::Solver& stats);
@@ -1538,7 +1723,7 @@ namespace BEEV {
 
     //looksup a MINISAT var from the minisat-var memo-table. if none
     //exists, then creates one.
-    const MINISAT::Var LookupOrCreateSATVar(MINISAT::Solver& S, const ASTNode& n);
+    const MINISAT::Var LookupOrCreateSATVar(MINISAT::SimpSolver& S, const ASTNode& n);
 
     // Memo table for CheckBBandCNF debugging function
     ASTNodeMap CheckBBandCNFMemo;
@@ -1600,6 +1785,19 @@ namespace BEEV {
     ASTNode TransformArray(const ASTNode& term);
     ASTNode TranslateSignedDivMod(const ASTNode& term);
 
+    //Replaces reads at constant indices of (possibly written) array
+    //symbols with fresh variables, before any other simplification
+    ASTNode RemoveConstIndexReads_TopLevel(const ASTNode& form);
+    //Applies the solver substitutions to the symbols introduced by
+    //RemoveConstIndexReads_TopLevel, before TransformFormula
+    void ResolveConstIndexReadSymbols();
+  private:
+    ASTNode RemoveConstIndexReads(const ASTNode& n, ASTNodeMap& memo);
+    ASTNode ConstIndexReadSymbol(const ASTNode& read);
+    //Creates the symbolic constant standing for the array read
+    ASTNode NewArrayReadSymbol(const ASTNode& read);
+  public:
+
     //LET Management
   private:
     // MAP: This map is from bound IDs that occur in LETs to
@@ -1685,6 +1883,10 @@ namespace BEEV {
     //function populates the datastructure CounterExampleMap)
     void ConstructCounterExample(MINISAT::Solver& S);
 
+    //Adds the values of the array reads to CounterExampleMap, from
+    //the values of the symbols in it
+    void ConstructArrayReadCounterExample();
+
     //Prints the counterexample to stdout
     void PrintCounterExample(bool t,std::ostream& os=cout);
 
@@ -1707,6 +1909,11 @@ namespace BEEV {
 
     //accepts constant input and normalizes it. 
     ASTNode BVConstEvaluator(const ASTNode& t);
+#ifndef NATIVE_C_ARITH
+    //evaluates t with native integers, when t and its operands are at
+    //most 64 bits wide. returns false if it cannot
+    bool BVConstEvaluatorSmall(const ASTNode& t, ASTNode& output);
+#endif
 
     //FUNCTION TypeChecker: Assumes that the immediate Children of the
     //input ASTNode have been typechecked. This function is suitable
@@ -1807,6 +2014,47 @@ namespace BEEV {
     //this function biases the activity levels of MINISAT variables.
     //void ChangeActivityLevels_Of_SATVars(MINISAT::Solver& n);
 
+    //records the concrete bytes of input array 'arrayname' (e.g. the
+    //input the query was derived from). They are used as the initial
+    //polarity of the SAT variables for the matching array-read bits.
+    void AddPhaseHint(const char * arrayname, 
+		      const unsigned char * bytes, unsigned int length);
+
+    //reads phase hints from a file, one array per line: the array
+    //name followed by its bytes in hex.
+    void LoadPhaseHints(const char * filename);
+
+    //this function sets the initial polarity of MINISAT variables
+    //from the phase hints. Does nothing if there are no hints.
+    void SetPolarity_Of_SATVars(MINISAT::Solver& newS);
+
+  private:
+    //called before the clauses of a query are given to S. cnf_size
+    //(see sat_simplify_min_size) decides whether variable elimination
+    //is used
+    void BeginSATClauses(MINISAT::SimpSolver& S, unsigned int cnf_size);
+
+    //adds a clause to S (and to _portfolio_clauses). returns false if
+    //S has become UNSAT
+    bool AddSATClause(MINISAT::SimpSolver& S, MINISAT::vec<MINISAT::Lit>& c);
+
+    //solves the clauses given to S
+    bool SolveSATClauses(MINISAT::SimpSolver& S);
+
+    //MAP: array name -> concrete bytes given by AddPhaseHint()
+    std::map<std::string, std::string> _phase_hints;
+
+    //the clauses given to the SAT solver of the current query, so
+    //that the other solvers of the portfolio can be loaded with them
+    std::vector<std::vector<MINISAT::Lit> > _portfolio_clauses;
+
+    //MAP: symbol introduced for a constant-index array read -> hinted
+    //value. Used as the value of the symbol in the counterexample when
+    //the formula does not constrain it
+    ASTNodeMap _phase_hint_values;
+
+  public:
+
     // Constructor
     BeevMgr() : _interior_unique_table(INITIAL_INTERIOR_UNIQUE_TABLE_SIZE),
 		_symbol_unique_table(INITIAL_SYMBOL_UNIQUE_TABLE_SIZE),
@@ -1830,6 +2078,10 @@ namespace BEEV {
       start_abstracting = false;
       Begin_RemoveWrites = false;
       SimplifyWrites_InPlace_Flag = false;
+      _presolver_queries = 0;
+      _presolver_decided = 0;
+      Incremental_Simplify_Flag = false;
+      SimplifyEffort = 0;
     };
     
     //destructor
@@ -69,12 +69,49 @@ namespace BEEV {
   extern bool wordlevel_solve;
   //XOR flattening optimizations.
   extern bool xor_flatten;
+  //bitblast into an And-Inverter Graph, and give its Tseitin clauses
+  //directly to the SAT solver
+  extern bool aig_bitblast;
+  //decide the simple queries by propagation before bitblasting (see
+  //simplifier/presolver.h)
+  extern bool presolve;
+  //keep the simplification memo tables between the rounds of
+  //substitution, simplification and solving, so that a round only
+  //redoes the cones of the nodes changed by the previous one
+  extern bool incremental_simplify;
+  //number of simplified nodes per query after which no new round of
+  //substitution, simplification and solving is started. 0 means no
+  //limit
+  extern unsigned int simplify_effort;
   //this flag indicates that the BVSolver() succeeded
   extern bool toplevel_solved;
   //the smtlib parser has been turned on
   extern bool smtlib_parser_enable;
   //print the input back
   extern bool print_STPinput_back;
+  //features of the MINISAT solver (see sat/core/Solver.h). all of
+  //them are off by default, so that they can be compared against
+  //the plain solver
+  extern int sat_restart_mode;
+  extern bool sat_lbd_reduce;
+  extern bool sat_phase_saving;
+  extern bool sat_bin_minimize;
+  extern int sat_inprocess_interval;
+  //SatELite style variable elimination before SAT solving, done only
+  //if the CNF has a size of at least sat_simplify_min_size. The size
+  //has to be known before the first clause goes to the solver: it is
+  //the number of clauses when they are made up front, and the number
+  //of formula nodes when the CNF converter streams its clauses
+  extern bool sat_simplify;
+  extern unsigned int sat_simplify_min_size;
+  //number of differently configured SAT solvers run in parallel on
+  //each query, the first to finish wins. 1 means no portfolio
+  extern int sat_portfolio_threads;
+  //turns on the SAT solver features in a comma separated list
+  //(luby, glucose, lbd, phase, binmin, inprocess, simp, simp=<min
+  //CNF size>, portfolio=<threads> or all). returns false if the list
+  //has an unknown feature
+  bool SetSATFeatures(const char * features);
 
   extern void (*vc_error_hdlr)(const char* err_msg);
   /*Spacer class is basically just an int, but the new class allows
@@ -19,6 +19,7 @@
 // The 0th element of the vector corresponds to bit 0 -- the low-order bit.
 
 #include "AST.h"
+#include <algorithm>
 namespace BEEV {
   //  extern void lpvec(ASTVec &vec);
 
@@ -33,6 +34,23 @@ namespace BEEV {
 
 
 ASTNode ASTJunk;
+
+// If every bit of a bitblasted term is constant, store them in c and
+// return true.
+static bool BBConstBits(const ASTVec& bits, std::vector<bool>& c)
+{
+  c.resize(bits.size());
+  for (unsigned int i = 0; i < bits.size(); i++) {
+    if (TRUE == bits[i].GetKind())
+      c[i] = true;
+    else if (FALSE == bits[i].GetKind())
+      c[i] = false;
+    else
+      return false;
+  }
+  return true;
+}
+
 const ASTNode BeevMgr::BBTerm(const ASTNode& term) {
 
 
@@ -256,9 +274,18 @@ const ASTNode BeevMgr::BBTerm(const ASTNode& term) {
 
     const ASTNode& mpcd1 = BBTerm(t0);
     const ASTNode& mpcd2 = BBTerm(t1);
+    //Multiplication by a constant is a shift-add network, which is
+    //much smaller than the array multiplier
+    std::vector<bool> c;
+    if (BBConstBits(mpcd2.GetChildren(), c)) {
+      result = CreateNode(BOOLVEC, BBMultConst(mpcd1.GetChildren(), c));
+    }
+    else if (BBConstBits(mpcd1.GetChildren(), c)) {
+      result = CreateNode(BOOLVEC, BBMultConst(mpcd2.GetChildren(), c));
+    }
     //Reverese the order of the nodes w/out the need for temporaries
     //This is needed because t0 an t1 must be const
-    if ((BVCONST != t0.GetKind()) && (BVCONST == t1.GetKind())) {
+    else if ((BVCONST != t0.GetKind()) && (BVCONST == t1.GetKind())) {
       result = CreateNode(BOOLVEC, 
         BBMult(mpcd2.GetChildren(), mpcd1.GetChildren()) );
     }else{
@@ -274,7 +301,13 @@ const ASTNode BeevMgr::BBTerm(const ASTNode& term) {
     unsigned int width = dvdd.Degree();
     ASTVec q(width); 
     ASTVec r(width); 
-    BBDivMod(dvdd.GetChildren(),  dvsr.GetChildren(), q, r, width);
+    //Division by zero is left to BBDivMod, whatever the divisor
+    std::vector<bool> c;
+    if (BBConstBits(dvsr.GetChildren(), c) && 
+	std::find(c.begin(), c.end(), true) != c.end())
+      BBDivModConst(dvdd.GetChildren(), c, q, r);
+    else
+      BBDivMod(dvdd.GetChildren(),  dvsr.GetChildren(), q, r, width);
     if (k == BVDIV)
       result = CreateNode(BOOLVEC, q);    
     else
@@ -698,6 +731,204 @@ void BeevMgr::BBDivMod(const ASTVec &y, const ASTVec &x, ASTVec &q, ASTVec &r, u
   }
 }
 
+// Canonical signed digit recoding, from the low-order bits up: a run
+// of ones 0111..1 becomes 100..0(-1). The carry out of the last digit
+// is dropped, since the arithmetic is modulo 2^width.
+static void CSDRecode(const std::vector<bool>& c, std::vector<int>& digits)
+{
+  unsigned int n = c.size();
+  digits.assign(n, 0);
+  int carry = 0;
+  for (unsigned int i = 0; i < n; i++) {
+    int b = c[i] + carry;
+    bool nextbit = (i + 1 < n) && c[i + 1];
+    if (1 == b) {
+      digits[i] = nextbit ? -1 : 1;
+      carry = nextbit ? 1 : 0;
+    }
+    else {
+      carry = (2 == b) ? 1 : 0;
+    }
+  }
+}
+
+static bool MultConstTermLess(const BeevMgr::MultConstTerm& a, 
+			      const BeevMgr::MultConstTerm& b)
+{
+  if (a.shift != b.shift)
+    return a.shift < b.shift;
+  return a.operand < b.operand;
+}
+
+static bool MultConstTermPositive(const BeevMgr::MultConstTerm& a, 
+				  const BeevMgr::MultConstTerm& b)
+{
+  return a.sign > b.sign;
+}
+
+// Common subexpression elimination on the digits (Hartley, "Subexpression
+// Sharing in Filters Using Canonic Signed Digit Multipliers"): the most
+// frequent pair of terms, with the same operands, distance and relative
+// sign, becomes a new operand, as long as it replaces two pairs at
+// least. Constants with repeating digit patterns need about
+// logarithmically many adders.
+void BeevMgr::MultConstPlan(const std::vector<bool>& c,
+			    std::vector<MultConstSubexpr>& subexprs,
+			    std::vector<MultConstTerm>& terms)
+{
+  std::vector<int> digits;
+  CSDRecode(c, digits);
+  subexprs.clear();
+  terms.clear();
+  for (unsigned int i = 0; i < digits.size(); i++) {
+    if (0 != digits[i]) {
+      MultConstTerm t = {0, i, digits[i]};
+      terms.push_back(t);
+    }
+  }
+
+  // a pair: left operand, right operand, distance, relative sign
+  typedef std::vector<int> Pair;
+  while (true) {
+    sort(terms.begin(), terms.end(), MultConstTermLess);
+    map<Pair, unsigned int> counts;
+    for (unsigned int i = 0; i < terms.size(); i++)
+      for (unsigned int j = i + 1; j < terms.size(); j++) {
+	Pair p(4);
+	p[0] = terms[i].operand;
+	p[1] = terms[j].operand;
+	p[2] = terms[j].shift - terms[i].shift;
+	p[3] = terms[i].sign * terms[j].sign;
+	counts[p]++;
+      }
+
+    // candidates, most frequent first
+    std::vector<pair<unsigned int, Pair> > candidates;
+    for (map<Pair, unsigned int>::iterator it = counts.begin(); it != counts.end(); it++)
+      if (it->second >= 2)
+	candidates.push_back(make_pair(it->second, it->first));
+    stable_sort(candidates.begin(), candidates.end(), 
+		std::greater<pair<unsigned int, Pair> >());
+
+    bool replaced = false;
+    for (unsigned int k = 0; k < candidates.size() && !replaced; k++) {
+      const Pair& p = candidates[k].second;
+      // pick non-overlapping pairs, from the low-order terms up
+      std::vector<bool> used(terms.size(), false);
+      std::vector<MultConstTerm> newterms;
+      for (unsigned int i = 0; i < terms.size(); i++) {
+	if (used[i] || (int)terms[i].operand != p[0])
+	  continue;
+	for (unsigned int j = i + 1; j < terms.size(); j++) {
+	  if (!used[j] && (int)terms[j].operand == p[1] &&
+	      (int)(terms[j].shift - terms[i].shift) == p[2] &&
+	      terms[i].sign * terms[j].sign == p[3]) {
+	    used[i] = used[j] = true;
+	    MultConstTerm t = {(unsigned)subexprs.size() + 1, terms[i].shift,
+			       terms[i].sign};
+	    newterms.push_back(t);
+	    break;
+	  }
+	}
+      }
+      if (newterms.size() < 2)
+	continue;
+
+      MultConstSubexpr e = {(unsigned)p[0],
+			    {(unsigned)p[1], (unsigned)p[2], p[3]}};
+      subexprs.push_back(e);
+      for (unsigned int i = 0; i < terms.size(); i++)
+	if (!used[i])
+	  newterms.push_back(terms[i]);
+      terms.swap(newterms);
+      replaced = true;
+    }
+    if (!replaced)
+      break;
+  }
+  stable_sort(terms.begin(), terms.end(), MultConstTermPositive);
+}
+
+// The term y << shift only affects bits shift and above of the sum,
+// so the adder covers the high-order width-shift bits only.
+void BeevMgr::BBAddShifted(ASTVec& sum, const ASTVec& y, unsigned int shift, int sign)
+{
+  unsigned int n = sum.size();
+  ASTVec hi(sum.begin() + shift, sum.end());
+  ASTVec ylow(y.begin(), y.begin() + (n - shift));
+  if (1 == sign)
+    BBPlus2(hi, ylow, ASTFalse);
+  else
+    BBSub(hi, ylow);
+  copy(hi.begin(), hi.end(), sum.begin() + shift);
+}
+
+// Multiply x by a constant. Adding the first term to zero costs nothing,
+// since the adder is simplified away
+ASTVec BeevMgr::BBMultConst(const ASTVec& x, const std::vector<bool>& c)
+{
+  std::vector<MultConstSubexpr> subexprs;
+  std::vector<MultConstTerm> terms;
+  MultConstPlan(c, subexprs, terms);
+
+  std::vector<ASTVec> operands(1, x);
+  for (unsigned int i = 0; i < subexprs.size(); i++) {
+    const MultConstSubexpr& e = subexprs[i];
+    ASTVec t(operands[e.left]);
+    BBAddShifted(t, operands[e.term.operand], e.term.shift, e.term.sign);
+    operands.push_back(t);
+  }
+
+  ASTVec prod = BBfill(x.size(), ASTFalse);
+  for (unsigned int i = 0; i < terms.size(); i++)
+    BBAddShifted(prod, operands[terms[i].operand], terms[i].shift, terms[i].sign);
+  return prod;
+}
+
+// Long division by a constant, from the high-order bits of y down.
+// The partial remainder is less than c, so it only takes as many bits
+// as c, and each step costs one subtractor and one multiplexer of that
+// width instead of the full-width comparisons of BBDivMod.
+void BeevMgr::BBDivModConst(const ASTVec& y, const std::vector<bool>& c, 
+			    ASTVec& q, ASTVec& r)
+{
+  unsigned int w = y.size();
+  unsigned int k = find(c.begin(), c.end(), true) - c.begin();
+  unsigned int n = w;
+  while (!c[n - 1])
+    n--;
+  q = BBfill(w, ASTFalse);
+  r = BBfill(w, ASTFalse);
+
+  if (n == k + 1) {
+    // c is 2^k: y / c is y >> k, and y % c the k low-order bits of y
+    copy(y.begin() + k, y.end(), q.begin());
+    copy(y.begin(), y.begin() + k, r.begin());
+    return;
+  }
+
+  // c and the partial remainder, with room for the shifted-in bit and
+  // for the sign of their difference
+  ASTVec cbits(n + 2, ASTFalse);
+  for (unsigned int i = 0; i < n; i++)
+    cbits[i] = c[i] ? ASTTrue : ASTFalse;
+  ASTVec rem(n + 2, ASTFalse);
+  for (int j = w - 1; j >= 0; j--) {
+    for (unsigned int i = n; i > 0; i--)
+      rem[i] = rem[i - 1];
+    rem[0] = y[j];
+
+    ASTVec diff(rem);
+    BBSub(diff, cbits);
+    // rem >= c iff the difference is not negative
+    q[j] = CreateSimpNot(diff[n + 1]);
+    for (unsigned int i = 0; i < n; i++)
+      rem[i] = CreateSimpForm(ITE, q[j], diff[i], rem[i]);
+    rem[n] = ASTFalse;
+  }
+  copy(rem.begin(), rem.begin() + n, r.begin());
+}
+
 // build ITE's (ITE cond then[i] else[i]) for each i.
 ASTVec BeevMgr::BBITE(const ASTNode& cond, const ASTVec& thn, const ASTVec& els)
 {
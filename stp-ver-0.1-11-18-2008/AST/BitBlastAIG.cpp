@@ -0,0 +1,495 @@
+/********************************************************************
+ * AUTHORS: Avalanche contributors
+ *
+ * BEGIN DATE: October, 2026
+ *
+ * LICENSE: Please view LICENSE file in the home dir of this Program
+ ********************************************************************/
+// -*- c++ -*-
+
+// BitBlastAIG -- bitblast terms and formulas into the And-Inverter
+// Graph of the BeevMgr (see AIG.h), instead of into ASTNode formulas
+// like BitBlast.cpp does. The two bitblasters build the same circuits,
+// bit by bit. A bitblasted term is a vector of AIG literals, the 0th
+// element of which is the low-order bit.
+//
+// The inputs of the AIG are the bits of the bitvector symbols, each of
+// which is represented by a BVGETBIT node (_aig_inputs), and the
+// Boolean symbols. This is what ConstructCounterExample expects to
+// find in _SATVar_to_AST.
+
+#include "AST.h"
+#include <algorithm>
+namespace BEEV {
+
+  // If every bit of a bitblasted term is constant, store them in c and
+  // return true.
+  static bool AIGConstBits(const BeevMgr::AIGVec& bits, std::vector<bool>& c) {
+    c.resize(bits.size());
+    for (unsigned int i = 0; i < bits.size(); i++) {
+      if (AIG_TRUE != bits[i] && AIG_FALSE != bits[i])
+	return false;
+      c[i] = (AIG_TRUE == bits[i]);
+    }
+    return true;
+  }
+
+  const BeevMgr::AIGVec& BeevMgr::BBTermAIG(const ASTNode& term) {
+    ASTNodeToAIGVecMap::iterator it = AIGTermMemo.find(term);
+    if (it != AIGTermMemo.end())
+      return it->second;
+
+    Kind k = term.GetKind();
+    if (!is_Term_kind(k))
+      FatalError("BBTermAIG: Illegal kind to BBTermAIG",term);
+
+    unsigned int num_bits = term.GetValueWidth();
+    AIGVec result;
+    switch (k) {
+    case BVNEG:
+      result = AIGNeg(BBTermAIG(term[0]));
+      break;
+    case ITE: {
+      AIGLit cond = BBFormAIG(term[0]);
+      result = AIGITE(cond, BBTermAIG(term[1]), BBTermAIG(term[2]));
+      break;
+    }
+    case BVSX: {
+      // Replicate high-order bit as many times as necessary.
+      result = BBTermAIG(term[0]);
+      AIGLit msb = result.back();
+      result.resize(num_bits, msb);
+      break;
+    }
+    case BVEXTRACT: {
+      const AIGVec& bbkids = BBTermAIG(term[0]);
+      unsigned int high = GetUnsignedConst(term[1]);
+      unsigned int low = GetUnsignedConst(term[2]);
+      result.assign(bbkids.begin() + low, bbkids.begin() + high + 1);
+      break;
+    }
+    case BVCONCAT: {
+      result = BBTermAIG(term[1]);
+      const AIGVec& vec1 = BBTermAIG(term[0]);
+      result.insert(result.end(), vec1.begin(), vec1.end());
+      break;
+    }
+    case BVPLUS: {
+      ASTVec::const_iterator kit = term.begin(), kend = term.end();
+      result = BBTermAIG(*kit);
+      for (++kit; kit < kend; kit++)
+	AIGPlus2(result, BBTermAIG(*kit), AIG_FALSE);
+      break;
+    }
+    case BVUMINUS: {
+      AIGVec neg = AIGNeg(BBTermAIG(term[0]));
+      result = AIGAddOneBit(neg, AIG_TRUE);
+      break;
+    }
+    case BVSUB: {
+      result = BBTermAIG(term[0]);
+      AIGSub(result, BBTermAIG(term[1]));
+      break;
+    }
+    case BVMULT: {
+      // the constant operand, if any, goes first, so that the zero bits
+      // are skipped (see BBTerm)
+      const ASTNode& t0 = term[0];
+      const ASTNode& t1 = term[1];
+      const AIGVec& mpcd1 = BBTermAIG(t0);
+      const AIGVec& mpcd2 = BBTermAIG(t1);
+      std::vector<bool> c;
+      if (AIGConstBits(mpcd2, c))
+	result = AIGMultConst(mpcd1, c);
+      else if (AIGConstBits(mpcd1, c))
+	result = AIGMultConst(mpcd2, c);
+      else if ((BVCONST != t0.GetKind()) && (BVCONST == t1.GetKind()))
+	result = AIGMult(mpcd2, mpcd1);
+      else
+	result = AIGMult(mpcd1, mpcd2);
+      break;
+    }
+    case BVDIV:
+    case BVMOD: {
+      const AIGVec& dvdd = BBTermAIG(term[0]);
+      const AIGVec& dvsr = BBTermAIG(term[1]);
+      AIGVec q, r;
+      std::vector<bool> c;
+      if (AIGConstBits(dvsr, c) && std::find(c.begin(), c.end(), true) != c.end())
+	AIGDivModConst(dvdd, c, q, r);
+      else
+	AIGDivMod(dvdd, dvsr, q, r);
+      result = (BVDIV == k) ? q : r;
+      break;
+    }
+    //  n-ary bitwise operators, folded pairwise like in BBTerm.
+    case BVXOR:
+    case BVXNOR:
+    case BVAND:
+    case BVOR:
+    case BVNOR:
+    case BVNAND: {
+      ASTVec::const_iterator kit = term.begin(), kend = term.end();
+      result = BBTermAIG(*kit);
+      for (++kit; kit < kend; kit++) {
+	const AIGVec& y = BBTermAIG(*kit);
+	for (unsigned int i = 0; i < num_bits; i++) {
+	  AIGLit& s = result[i];
+	  switch (k) {
+	  case BVXOR: s = _aig.Xor(s, y[i]); break;
+	  case BVXNOR: s = AIGMgr::Not(_aig.Xor(s, y[i])); break;
+	  case BVAND: s = _aig.And(s, y[i]); break;
+	  case BVOR: s = _aig.Or(s, y[i]); break;
+	  case BVNOR: s = AIGMgr::Not(_aig.Or(s, y[i])); break;
+	  default: s = AIGMgr::Not(_aig.And(s, y[i])); break;
+	  }
+	}
+      }
+      break;
+    }
+    case SYMBOL: {
+      result.resize(num_bits);
+      for (unsigned int i = 0; i < num_bits; i++) {
+	result[i] = _aig.CreateInput();
+	_aig_inputs.push_back(CreateNode(BVGETBIT, term, CreateBVConst(32,i)));
+      }
+      break;
+    }
+    case BVCONST: {
+      result.resize(num_bits);
+#ifndef NATIVE_C_ARITH
+      CBV bv = term.GetBVConst();
+      for(unsigned int i = 0; i < num_bits; i++)
+	result[i] = CONSTANTBV::BitVector_bit_test(bv,i) ? AIG_TRUE : AIG_FALSE;
+#else
+      const unsigned long long int c = term.GetBVConst();
+      unsigned long long int bitmask = 0x00000000000000001LL;
+      for (unsigned int i = 0; i < num_bits; i++, bitmask <<= 1)
+	result[i] = ((c & (bitmask)) ? AIG_TRUE : AIG_FALSE);
+#endif
+      break;
+    }
+    case BVSRSHIFT:
+    case BVVARSHIFT:
+      FatalError("BBTermAIG: These kinds have not been implemented in the BitBlaster: ", term);
+      break;
+    default:
+      FatalError("BBTermAIG: Illegal kind to BBTermAIG",term);
+    }
+
+    AIGVec& memo = AIGTermMemo[term];
+    memo.swap(result);
+    return memo;
+  }
+
+  AIGLit BeevMgr::BBFormAIG(const ASTNode& form) {
+    ASTNodeToAIGLitMap::iterator it = AIGFormMemo.find(form);
+    if (it != AIGFormMemo.end())
+      return it->second;
+
+    Kind k = form.GetKind();
+    if (!is_Form_kind(k))
+      FatalError("BBFormAIG: Illegal kind: ",form);
+
+    AIGLit result = AIG_FALSE;
+    switch (k) {
+    case TRUE:
+      result = AIG_TRUE;
+      break;
+    case FALSE:
+      result = AIG_FALSE;
+      break;
+    case SYMBOL:
+      if (form.GetType() != BOOLEAN_TYPE)
+	FatalError("BBFormAIG: Symbol represents more than one bit", form);
+      result = _aig.CreateInput();
+      _aig_inputs.push_back(form);
+      break;
+    case BVGETBIT:
+      result = BBTermAIG(form[0])[GetUnsignedConst(form[1])];
+      break;
+    case NOT:
+      result = AIGMgr::Not(BBFormAIG(form[0]));
+      break;
+    case ITE: {
+      AIGLit c = BBFormAIG(form[0]);
+      AIGLit t = BBFormAIG(form[1]);
+      result = _aig.Ite(c, t, BBFormAIG(form[2]));
+      break;
+    }
+    case AND:
+    case NAND:
+      result = AIG_TRUE;
+      for (ASTVec::const_iterator kit = form.begin(); kit != form.end(); kit++)
+	result = _aig.And(result, BBFormAIG(*kit));
+      if (NAND == k)
+	result = AIGMgr::Not(result);
+      break;
+    case OR:
+    case NOR:
+      result = AIG_FALSE;
+      for (ASTVec::const_iterator kit = form.begin(); kit != form.end(); kit++)
+	result = _aig.Or(result, BBFormAIG(*kit));
+      if (NOR == k)
+	result = AIGMgr::Not(result);
+      break;
+    case IFF:
+    case XOR:
+      // IFF is the XOR of its children, the first one negated (see
+      // CreateSimpForm)
+      result = (IFF == k) ? AIG_TRUE : AIG_FALSE;
+      for (ASTVec::const_iterator kit = form.begin(); kit != form.end(); kit++)
+	result = _aig.Xor(result, BBFormAIG(*kit));
+      break;
+    case IMPLIES:
+      result = _aig.Or(AIGMgr::Not(BBFormAIG(form[0])), BBFormAIG(form[1]));
+      break;
+    case NEQ:
+    case EQ: {
+      const AIGVec& left = BBTermAIG(form[0]);
+      const AIGVec& right = BBTermAIG(form[1]);
+      if (left.size() != right.size()) {
+	cerr << "BBFormAIG: Size mismatch" << endl << form[0] << endl << form[1] << endl;
+	FatalError("",ASTUndefined);
+      }
+      result = AIGEQ(left, right);
+      if (NEQ == k)
+	result = AIGMgr::Not(result);
+      break;
+    }
+    case BVLE:
+    case BVGE:
+    case BVGT:
+    case BVLT:
+    case BVSLE:
+    case BVSGE:
+    case BVSGT:
+    case BVSLT: {
+      const AIGVec& left = BBTermAIG(form[0]);
+      const AIGVec& right = BBTermAIG(form[1]);
+      bool is_signed = (BVSLE == k || BVSGE == k || BVSGT == k || BVSLT == k);
+      switch (k) {
+      case BVLE: case BVSLE:
+	result = AIGBVLE(left, right, is_signed); break;
+      case BVGE: case BVSGE:
+	result = AIGBVLE(right, left, is_signed); break;
+      case BVGT: case BVSGT:
+	result = AIGMgr::Not(AIGBVLE(left, right, is_signed)); break;
+      default:
+	result = AIGMgr::Not(AIGBVLE(right, left, is_signed)); break;
+      }
+      break;
+    }
+    default:
+      FatalError("BBFormAIG: Illegal kind: ", form);
+      break;
+    }
+
+    return (AIGFormMemo[form] = result);
+  }
+
+  // Bit blast a sum of two equal length BVs.
+  // Update sum vector destructively with new sum.
+  void BeevMgr::AIGPlus2(AIGVec& sum, const AIGVec& y, AIGLit cin) {
+    unsigned int n = sum.size();
+    for (unsigned int i = 0; i < n; i++) {
+      // the carry out of the last bit is discarded
+      AIGLit nextcin = (i + 1 < n) ? _aig.Majority(sum[i], y[i], cin) : AIG_FALSE;
+      sum[i] = _aig.Xor(_aig.Xor(sum[i], y[i]), cin);
+      cin = nextcin;
+    }
+  }
+
+  // Stores result - y in result, destructively
+  void BeevMgr::AIGSub(AIGVec& result, const AIGVec& y) {
+    AIGPlus2(result, AIGNeg(y), AIG_TRUE);
+  }
+
+  // Add one bit
+  BeevMgr::AIGVec BeevMgr::AIGAddOneBit(const AIGVec& x, AIGLit cin) {
+    AIGVec result(x.size());
+    for (unsigned int i = 0; i < x.size(); i++) {
+      result[i] = _aig.Xor(x[i], cin);
+      cin = _aig.And(x[i], cin);
+    }
+    return result;
+  }
+
+  // Bitwise complement
+  BeevMgr::AIGVec BeevMgr::AIGNeg(const AIGVec& x) {
+    AIGVec result(x.size());
+    for (unsigned int i = 0; i < x.size(); i++)
+      result[i] = AIGMgr::Not(x[i]);
+    return result;
+  }
+
+  // Multiply two bitblasted numbers, by shifting and adding y for
+  // every bit of x
+  BeevMgr::AIGVec BeevMgr::AIGMult(const AIGVec& x, const AIGVec& y) {
+    unsigned int n = x.size();
+    AIGVec prod(n);
+    for (unsigned int i = 0; i < n; i++)
+      prod[i] = _aig.And(y[i], x[0]);
+
+    AIGVec pprod(n);
+    for (unsigned int s = 1; s < n; s++) {
+      if (AIG_FALSE == x[s])
+	continue;
+      // partial product y << s, ANDed with bit s of x
+      for (unsigned int i = 0; i < n; i++)
+	pprod[i] = (i < s) ? AIG_FALSE : _aig.And(y[i - s], x[s]);
+      AIGPlus2(prod, pprod, AIG_FALSE);
+    }
+    return prod;
+  }
+
+  // Same division as BBDivMod, with the recursion on y >> 1 unrolled
+  // into a loop from the innermost call outwards: step k divides the
+  // k high-order bits of y by x.
+  void BeevMgr::AIGDivMod(const AIGVec& y, const AIGVec& x, AIGVec& q, AIGVec& r) {
+    unsigned int width = y.size();
+    AIGVec zero(width, AIG_FALSE);
+    AIGVec one(zero);
+    one[0] = AIG_TRUE;
+    q = zero;
+    r = zero;
+    AIGVec yk(zero), rlshift1(width), qlshift1(width), rminusx;
+    for (unsigned int k = 1; k <= width; k++) {
+      // yk is y >> (width - k)
+      for (unsigned int i = 0; i < width; i++)
+	yk[i] = (i < k) ? y[width - k + i] : AIG_FALSE;
+
+      qlshift1[0] = AIG_FALSE;
+      rlshift1[0] = AIG_FALSE;
+      for (unsigned int i = 1; i < width; i++) {
+	qlshift1[i] = q[i - 1];
+	rlshift1[i] = r[i - 1];
+      }
+
+      AIGVec r1lshift1plusyodd = AIGAddOneBit(rlshift1, yk[0]);
+      rminusx = r1lshift1plusyodd;
+      AIGSub(rminusx, x);
+
+      // Adjusted q, r values when when r is too large.
+      AIGLit rtoolarge = AIGBVLE(x, r1lshift1plusyodd, false);
+      AIGVec ygtrxqval = AIGITE(rtoolarge, AIGAddOneBit(qlshift1, AIG_TRUE), qlshift1);
+      AIGVec ygtrxrval = AIGITE(rtoolarge, rminusx, r1lshift1plusyodd);
+
+      // q & r values when y >= x
+      AIGLit yeqx = AIGEQ(yk, x);
+      AIGVec notylessxqval = AIGITE(yeqx, one, ygtrxqval);
+      AIGVec notylessxrval = AIGITE(yeqx, zero, ygtrxrval);
+      // y < x <=> not x >= y.
+      AIGLit ylessx = AIGMgr::Not(AIGBVLE(x, yk, false));
+      q = AIGITE(ylessx, zero, notylessxqval);
+      r = AIGITE(ylessx, yk, notylessxrval);
+    }
+  }
+
+  // sum += sign * (y << shift), on the high-order width-shift bits of
+  // sum (see BBAddShifted)
+  void BeevMgr::AIGAddShifted(AIGVec& sum, const AIGVec& y, unsigned int shift, int sign) {
+    unsigned int n = sum.size();
+    AIGVec hi(sum.begin() + shift, sum.end());
+    AIGVec ylow(y.begin(), y.begin() + (n - shift));
+    if (1 == sign)
+      AIGPlus2(hi, ylow, AIG_FALSE);
+    else
+      AIGSub(hi, ylow);
+    std::copy(hi.begin(), hi.end(), sum.begin() + shift);
+  }
+
+  // Multiply x by a constant, following the plan of MultConstPlan
+  BeevMgr::AIGVec BeevMgr::AIGMultConst(const AIGVec& x, const std::vector<bool>& c) {
+    std::vector<MultConstSubexpr> subexprs;
+    std::vector<MultConstTerm> terms;
+    MultConstPlan(c, subexprs, terms);
+
+    std::vector<AIGVec> operands(1, x);
+    for (unsigned int i = 0; i < subexprs.size(); i++) {
+      const MultConstSubexpr& e = subexprs[i];
+      AIGVec t(operands[e.left]);
+      AIGAddShifted(t, operands[e.term.operand], e.term.shift, e.term.sign);
+      operands.push_back(t);
+    }
+
+    AIGVec prod(x.size(), AIG_FALSE);
+    for (unsigned int i = 0; i < terms.size(); i++)
+      AIGAddShifted(prod, operands[terms[i].operand], terms[i].shift, terms[i].sign);
+    return prod;
+  }
+
+  // Long division by a nonzero constant, with a partial remainder as
+  // wide as c (see BBDivModConst)
+  void BeevMgr::AIGDivModConst(const AIGVec& y, const std::vector<bool>& c, 
+			       AIGVec& q, AIGVec& r) {
+    unsigned int w = y.size();
+    unsigned int k = std::find(c.begin(), c.end(), true) - c.begin();
+    unsigned int n = w;
+    while (!c[n - 1])
+      n--;
+    q.assign(w, AIG_FALSE);
+    r.assign(w, AIG_FALSE);
+
+    if (n == k + 1) {
+      std::copy(y.begin() + k, y.end(), q.begin());
+      std::copy(y.begin(), y.begin() + k, r.begin());
+      return;
+    }
+
+    AIGVec cbits(n + 2, AIG_FALSE);
+    for (unsigned int i = 0; i < n; i++)
+      cbits[i] = c[i] ? AIG_TRUE : AIG_FALSE;
+    AIGVec rem(n + 2, AIG_FALSE);
+    for (int j = w - 1; j >= 0; j--) {
+      for (unsigned int i = n; i > 0; i--)
+	rem[i] = rem[i - 1];
+      rem[0] = y[j];
+
+      AIGVec diff(rem);
+      AIGSub(diff, cbits);
+      q[j] = AIGMgr::Not(diff[n + 1]);
+      for (unsigned int i = 0; i < n; i++)
+	rem[i] = _aig.Ite(q[j], diff[i], rem[i]);
+      rem[n] = AIG_FALSE;
+    }
+    std::copy(rem.begin(), rem.begin() + n, r.begin());
+  }
+
+  // build ITE's (ITE cond then[i] else[i]) for each i.
+  BeevMgr::AIGVec BeevMgr::AIGITE(AIGLit cond, const AIGVec& thn, const AIGVec& els) {
+    if (AIG_TRUE == cond)
+      return thn;
+    if (AIG_FALSE == cond)
+      return els;
+    AIGVec result(thn.size());
+    for (unsigned int i = 0; i < thn.size(); i++)
+      result[i] = _aig.Ite(cond, thn[i], els[i]);
+    return result;
+  }
+
+  // Signed or unsigned left <= right, from the low-order bits up like
+  // BBBVLE. Signed comparison complements the MSBs.
+  AIGLit BeevMgr::AIGBVLE(const AIGVec& left, const AIGVec& right, bool is_signed) {
+    unsigned int n = left.size();
+    AIGLit prevbit = AIG_TRUE;
+    for (unsigned int i = 0; i < n; i++) {
+      AIGLit l = left[i], r = right[i];
+      if (is_signed && i == n - 1) {
+	l = AIGMgr::Not(l);
+	r = AIGMgr::Not(r);
+      }
+      AIGLit negl = AIGMgr::Not(l);
+      // TRUE if l < r, false if l > r, else prevbit
+      prevbit = _aig.Or(_aig.And(negl, r), _aig.And(_aig.Or(negl, r), prevbit));
+    }
+    return prevbit;
+  }
+
+  AIGLit BeevMgr::AIGEQ(const AIGVec& left, const AIGVec& right) {
+    AIGLit result = AIG_TRUE;
+    for (unsigned int i = 0; i < left.size() && AIG_FALSE != result; i++)
+      result = _aig.And(result, AIGMgr::Not(_aig.Xor(left[i], right[i])));
+    return result;
+  }
+} // BEEV namespace
@@ -11,8 +11,9 @@ public:
    //########################################
    // constructor
 
-   CNFMgr(BeevMgr *bmgr){
+   CNFMgr(BeevMgr *bmgr, MINISAT::SimpSolver& solver) : S(solver){
       bm = bmgr;
+      ok = true;
    }
 
    //########################################
@@ -33,25 +34,24 @@ public:
    //########################################
    // top-level conversion function
 
-   BeevMgr::ClauseList* convertToCNF(const ASTNode& varphi){
+   // converts varphi to CNF. The clauses go to the SAT solver as soon
+   // as they are made: the definitions of the renamed nodes while the
+   // conversion runs, the clauses of varphi itself at the end. Returns
+   // false if the solver has found the clauses UNSAT.
+   bool convertToCNF(const ASTNode& varphi){
       scanFormula(varphi, true);
-      ASTNode dummy_true_var = bm->CreateSymbol("*TrueDummy*");
-      BeevMgr::ClauseList* defs = SINGLETON(dummy_true_var);
-      convertFormulaToCNF(varphi, defs);
-      BeevMgr::ClauseList* top = info[varphi]->clausespos;
-      defs->insert(defs->begin() + 1, top->begin(), top->end());
+      //the clauses are not counted yet, so the number of scanned nodes
+      //stands for the size of the CNF
+      bm->BeginSATClauses(S, info.size());
+      dummy_true_lit = LIT(bm->CreateSymbol("*TrueDummy*"));
+      ClauseSet* dummy = SINGLETON(dummy_true_lit);
+      EMIT(*dummy);
+      DELETE(dummy);
+      convertFormulaToCNF(varphi);
+      EMIT(*(info[varphi]->clausespos));
 
       cleanup(varphi);
-      return defs;
-   }
-
-   void DELETE(BeevMgr::ClauseList* varphi){
-      BeevMgr::ClauseList::const_iterator it = varphi->begin();
-      for(; it != varphi->end(); it++){
-         delete *it;
-      }
-
-      delete varphi;
+      return ok;
    }
 
 private:
@@ -60,11 +60,27 @@ private:
    //########################################
    // data types
 
+   // A set of clauses: the literals of all the clauses one after the
+   // other, and the index in lits of the first literal of each clause.
+   struct ClauseSet {
+      vector<MINISAT::Lit> lits;
+      vector<unsigned int> starts;
+
+      unsigned int size() const {
+         return starts.size();
+      }
+
+      unsigned int end(unsigned int i) const {
+         return (i + 1 < starts.size()) ? starts[i + 1] : lits.size();
+      }
+   };
+
    // for the meaning of control bits, see "utilities for contol bits".
    typedef struct {
        int control; 
-       BeevMgr::ClauseList* clausespos;
-       union {BeevMgr::ClauseList* clausesneg; ASTNode* termforcnf;};
+       MINISAT::Var var;
+       ClauseSet* clausespos;
+       union {ClauseSet* clausesneg; ASTNode* termforcnf;};
     } CNFInfo;
 
    typedef hash_map< ASTNode
@@ -85,9 +101,19 @@ private:
    // this is the data
 
    BeevMgr *bm;
+   MINISAT::SimpSolver& S;
    ASTNodeToCNFInfoMap info;
    ASTNodeToASTNodePtrMap store;
 
+   // literal of *TrueDummy*, which is asserted
+   MINISAT::Lit dummy_true_lit;
+
+   // false once S has become UNSAT; no more clauses are given to it
+   bool ok;
+
+   // scratch clause for EMIT
+   MINISAT::vec<MINISAT::Lit> satclause;
+
    //########################################
    //########################################
    // utility predicates
@@ -277,6 +303,7 @@ private:
    
    void initializeCNFInfo(CNFInfo& x){
       x.control = 0;
+      x.var = var_Undef;
       x.clausespos = NULL;
       x.clausesneg = NULL;
    }
@@ -378,79 +405,117 @@ private:
 
    //########################################
    //########################################
-   //utilities for clause sets
+   //utilities for SAT literals
+
+   // the literal of varphi, which is an atom, a predicate (word-level
+   // cnf), or the negation of one. Their SAT variables are kept by the
+   // BeevMgr, since the clauses of later refinements refer to them.
+   MINISAT::Lit LIT(const ASTNode& varphi){
+      bool negate = (NOT == varphi.GetKind());
+      ASTNode n = negate ? varphi[0] : varphi;
+      return MINISAT::Lit(bm->LookupOrCreateSATVar(S, n), negate);
+   }
+
+   // a new SAT variable for a renamed node. It has no ASTNode, so that
+   // the solver may eliminate it.
+   MINISAT::Lit NEWLIT(){
+      MINISAT::Var v = S.newVar();
+      bm->_SATVar_to_AST.push_back(bm->ASTUndefined);
+      return MINISAT::Lit(v);
+   }
+
+   // the literal of the renamed node x. Its positive and negative
+   // renamings share the variable, which is kept in x.
+   MINISAT::Lit RENAMELIT(CNFInfo& x){
+      if(x.var == var_Undef){
+         x.var = MINISAT::var(NEWLIT());
+      }
+      return MINISAT::Lit(x.var);
+   }
 
+   // gives the clauses of varphi to the SAT solver
+   void EMIT(const ClauseSet& varphi){
+      for(unsigned int i = 0; ok && i < varphi.size(); i++){
+         satclause.clear();
+         for(unsigned int j = varphi.starts[i]; j < varphi.end(i); j++){
+            satclause.push(varphi.lits[j]);
+         }
+         ok = bm->AddSATClause(S, satclause);
+      }
+   }
 
-   BeevMgr::ClauseList* COPY(const BeevMgr::ClauseList& varphi){
-      BeevMgr::ClauseList* psi = new BeevMgr::ClauseList(); 
+   //########################################
+   //########################################
+   //utilities for clause sets
 
-      BeevMgr::ClauseList::const_iterator it = varphi.begin();
-      for(; it != varphi.end(); it++){
-         psi->push_back(new vector<const ASTNode*>(**it));
-      }
 
-      return psi;
+   void DELETE(ClauseSet* varphi){
+      delete varphi;
    }
 
-   BeevMgr::ClauseList* SINGLETON(const ASTNode& varphi){
-      ASTNode* copy = ASTNodeToASTNodePtr(varphi);
-
-      BeevMgr::ClausePtr clause = new vector<const ASTNode*>();
-      clause->push_back(copy);
+   ClauseSet* COPY(const ClauseSet& varphi){
+      return new ClauseSet(varphi);
+   }
 
-      BeevMgr::ClauseList* psi = new BeevMgr::ClauseList();
-      psi->push_back(clause);
+   ClauseSet* SINGLETON(const MINISAT::Lit& varphi){
+      ClauseSet* psi = new ClauseSet();
+      psi->starts.push_back(0);
+      psi->lits.push_back(varphi);
       return psi;
    }
 
-   BeevMgr::ClauseList* UNION(const BeevMgr::ClauseList& varphi1
-        , const BeevMgr::ClauseList& varphi2){ 
+   ClauseSet* SINGLETON(const ASTNode& varphi){
+      return SINGLETON(LIT(varphi));
+   }
 
-      BeevMgr::ClauseList* psi1 = COPY(varphi1);
-      BeevMgr::ClauseList* psi2 = COPY(varphi2);
-      psi1->insert(psi1->end(), psi2->begin(), psi2->end());
-      delete psi2;
+   ClauseSet* UNION(const ClauseSet& varphi1
+        , const ClauseSet& varphi2){ 
 
+      ClauseSet* psi1 = COPY(varphi1);
+      INPLACE_UNION(psi1, varphi2);
       return psi1;
 
    }
 
-   void INPLACE_UNION(BeevMgr::ClauseList* varphi1
-        , const BeevMgr::ClauseList& varphi2){ 
+   void INPLACE_UNION(ClauseSet* varphi1
+        , const ClauseSet& varphi2){ 
 
-      BeevMgr::ClauseList* psi2 = COPY(varphi2);
-      varphi1->insert(varphi1->end(), psi2->begin(), psi2->end());
-      delete psi2;
+      unsigned int offset = varphi1->lits.size();
+      varphi1->lits.insert(varphi1->lits.end()
+            , varphi2.lits.begin()
+            , varphi2.lits.end()
+         );
+      for(unsigned int i = 0; i < varphi2.size(); i++){
+         varphi1->starts.push_back(offset + varphi2.starts[i]);
+      }
    }
 
-   void NOCOPY_INPLACE_UNION(BeevMgr::ClauseList* varphi1
-        , BeevMgr::ClauseList* varphi2){ 
+   void NOCOPY_INPLACE_UNION(ClauseSet* varphi1
+        , ClauseSet* varphi2){ 
 
-      varphi1->insert(varphi1->end(), varphi2->begin(), varphi2->end());
-      delete varphi2;
+      INPLACE_UNION(varphi1, *varphi2);
+      DELETE(varphi2);
    }
 
-   BeevMgr::ClauseList* PRODUCT(const BeevMgr::ClauseList& varphi1
-        , const BeevMgr::ClauseList& varphi2){ 
+   ClauseSet* PRODUCT(const ClauseSet& varphi1
+        , const ClauseSet& varphi2){ 
 
-      BeevMgr::ClauseList* psi = new BeevMgr::ClauseList();
+      ClauseSet* psi = new ClauseSet();
+      psi->starts.reserve(varphi1.size() * varphi2.size());
+      psi->lits.reserve(varphi1.lits.size() * varphi2.size()
+            + varphi2.lits.size() * varphi1.size());
 
-      BeevMgr::ClauseList::const_iterator it1 = varphi1.begin();
-      for(; it1 != varphi1.end(); it1++){
-         BeevMgr::ClausePtr clause1 = *it1;
-         BeevMgr::ClauseList::const_iterator it2 = varphi2.begin();
-         for(; it2 != varphi2.end(); it2++){
-            BeevMgr::ClausePtr clause2 = *it2;
-            BeevMgr::ClausePtr clause = new vector<const ASTNode*>();
-            clause->insert(clause->end()
-                  , clause1->begin()
-                  , clause1->end()
+      for(unsigned int i = 0; i < varphi1.size(); i++){
+         for(unsigned int j = 0; j < varphi2.size(); j++){
+            psi->starts.push_back(psi->lits.size());
+            psi->lits.insert(psi->lits.end()
+                  , varphi1.lits.begin() + varphi1.starts[i]
+                  , varphi1.lits.begin() + varphi1.end(i)
                );
-            clause->insert(clause->end()
-                  , clause2->begin()
-                  , clause2->end()
+            psi->lits.insert(psi->lits.end()
+                  , varphi2.lits.begin() + varphi2.starts[j]
+                  , varphi2.lits.begin() + varphi2.end(j)
                );
-            psi->push_back(clause);
          }
       }
 
@@ -577,7 +642,7 @@ private:
    //########################################
    // main cnf conversion function
    
-   void convertFormulaToCNF(const ASTNode& varphi, BeevMgr::ClauseList* defs){
+   void convertFormulaToCNF(const ASTNode& varphi){
 
       CNFInfo* x = info[varphi];
 
@@ -585,7 +650,7 @@ private:
       // divert to special case if term (word-level cnf)
 
       if(isTerm(*x)){
-         convertTermForCNF(varphi, defs);
+         convertTermForCNF(varphi);
          setWasVisited(*x);
          return;
       }
@@ -594,22 +659,22 @@ private:
       // do work
      
       if(sharesPos(*x) > 0 && !wasVisited(*x)){
-         convertFormulaToCNFPosCases(varphi, defs);
+         convertFormulaToCNFPosCases(varphi);
       }
 
       if(x->clausespos != NULL && x->clausespos->size() > 1){
          if(doSibRenamingPos(*x) || sharesPos(*x) > 1){
-            doRenamingPos(varphi, defs);
+            doRenamingPos(varphi);
          }
       }
 
       if(sharesNeg(*x) > 0 && !wasVisited(*x)){
-         convertFormulaToCNFNegCases(varphi, defs);
+         convertFormulaToCNFNegCases(varphi);
       }
 
       if(x->clausesneg != NULL && x->clausesneg->size() > 1){
          if(doSibRenamingNeg(*x) || sharesNeg(*x) > 1){
-            doRenamingNeg(varphi, defs);
+            doRenamingNeg(varphi);
          }
       }
 
@@ -619,7 +684,7 @@ private:
       setWasVisited(*x);
    }
 
-   void convertTermForCNF(const ASTNode& varphi, BeevMgr::ClauseList* defs){
+   void convertTermForCNF(const ASTNode& varphi){
 
       CNFInfo* x = info[varphi];
 
@@ -636,7 +701,7 @@ private:
       //########################################
 
       if(isITE(varphi)){
-         x->termforcnf = doRenameITE(varphi, defs);
+         x->termforcnf = doRenameITE(varphi);
          reduceMemoryFootprintPos(varphi[0]);
          reduceMemoryFootprintNeg(varphi[0]);
 
@@ -647,7 +712,7 @@ private:
          ASTVec psis;
          ASTVec::const_iterator it = varphi.GetChildren().begin();
          for(; it != varphi.GetChildren().end(); it++){
-            convertTermForCNF(*it, defs);
+            convertTermForCNF(*it);
             psis.push_back(*(info[*it]->termforcnf));
          }
 
@@ -662,7 +727,7 @@ private:
    //########################################
    // functions for renaming nodes during cnf conversion
 
-   ASTNode* doRenameITE(const ASTNode& varphi, BeevMgr::ClauseList* defs){
+   ASTNode* doRenameITE(const ASTNode& varphi){
 
       ASTNode psi;
 
@@ -685,30 +750,32 @@ private:
       // step 3, recurse over children
       //########################################
 
-      convertFormulaToCNF(varphi[0], defs);
-      convertTermForCNF(varphi[1], defs);
+      convertFormulaToCNF(varphi[0]);
+      convertTermForCNF(varphi[1]);
       ASTNode t1 = *(info[varphi[1]]->termforcnf);
-      convertTermForCNF(varphi[2], defs);
+      convertTermForCNF(varphi[2]);
       ASTNode t2 = *(info[varphi[2]]->termforcnf);
 
       //########################################
       // step 4, add def clauses
       //########################################
 
-      BeevMgr::ClauseList* cl1 = SINGLETON(bm->CreateNode(EQ, psi, t1));
-      BeevMgr::ClauseList* cl2 = PRODUCT(*(info[varphi[0]]->clausesneg), *cl1);
+      ClauseSet* cl1 = SINGLETON(bm->CreateNode(EQ, psi, t1));
+      ClauseSet* cl2 = PRODUCT(*(info[varphi[0]]->clausesneg), *cl1);
       DELETE(cl1);
-      defs->insert(defs->end(), cl2->begin(), cl2->end());
+      EMIT(*cl2);
+      DELETE(cl2);
 
-      BeevMgr::ClauseList* cl3 = SINGLETON(bm->CreateNode(EQ, psi, t2));
-      BeevMgr::ClauseList* cl4 = PRODUCT(*(info[varphi[0]]->clausespos), *cl3);
+      ClauseSet* cl3 = SINGLETON(bm->CreateNode(EQ, psi, t2));
+      ClauseSet* cl4 = PRODUCT(*(info[varphi[0]]->clausespos), *cl3);
       DELETE(cl3);
-      defs->insert(defs->end(), cl4->begin(), cl4->end());
+      EMIT(*cl4);
+      DELETE(cl4);
 
       return ASTNodeToASTNodePtr(psi);
    }
 
-   void doRenamingPos(const ASTNode& varphi, BeevMgr::ClauseList* defs){
+   void doRenamingPos(const ASTNode& varphi){
 
       CNFInfo* x = info[varphi];
 
@@ -716,21 +783,19 @@ private:
       // step 1, calc new variable
       //########################################
 
-      ostringstream oss;
-      oss << "cnf" << "{" << varphi.GetNodeNum() << "}";
-      ASTNode psi = bm->CreateSymbol(oss.str().c_str());
+      MINISAT::Lit psi = RENAMELIT(*x);
 
       //########################################
       // step 2, add defs
       //########################################
       
-      BeevMgr::ClauseList* cl1;
-      cl1 = SINGLETON(bm->CreateNode(NOT, psi));
-      BeevMgr::ClauseList* cl2 = PRODUCT(*(info[varphi]->clausespos), *cl1);
-      defs->insert(defs->end(), cl2->begin(), cl2->end());
+      ClauseSet* cl1;
+      cl1 = SINGLETON(~psi);
+      ClauseSet* cl2 = PRODUCT(*(info[varphi]->clausespos), *cl1);
+      EMIT(*cl2);
       DELETE(info[varphi]->clausespos);
       DELETE(cl1);
-      delete cl2;
+      DELETE(cl2);
 
       //########################################
       // step 3, update info[varphi]
@@ -740,7 +805,7 @@ private:
       setWasRenamedPos(*x);
    }
 
-   void doRenamingNeg(const ASTNode& varphi, BeevMgr::ClauseList* defs){
+   void doRenamingNeg(const ASTNode& varphi){
 
       CNFInfo* x = info[varphi];
 
@@ -748,27 +813,25 @@ private:
       // step 2, calc new variable
       //########################################
 
-      ostringstream oss;
-      oss << "cnf" << "{" << varphi.GetNodeNum() << "}";
-      ASTNode psi = bm->CreateSymbol(oss.str().c_str());
+      MINISAT::Lit psi = RENAMELIT(*x);
 
       //########################################
       // step 3, add defs
       //########################################
       
-      BeevMgr::ClauseList* cl1;
+      ClauseSet* cl1;
       cl1 = SINGLETON(psi);
-      BeevMgr::ClauseList* cl2 = PRODUCT(*(info[varphi]->clausesneg), *cl1);
-      defs->insert(defs->end(), cl2->begin(), cl2->end());
+      ClauseSet* cl2 = PRODUCT(*(info[varphi]->clausesneg), *cl1);
+      EMIT(*cl2);
       DELETE(info[varphi]->clausesneg);
       DELETE(cl1);
-      delete cl2;
+      DELETE(cl2);
 
       //########################################
       // step 4, update info[varphi]
       //########################################
 
-      x->clausesneg = SINGLETON(bm->CreateNode(NOT, psi));
+      x->clausesneg = SINGLETON(~psi);
       setWasRenamedNeg(*x);
 
    }
@@ -777,10 +840,10 @@ private:
    //########################################
    //main switch for individual cnf conversion cases
    
-   void convertFormulaToCNFPosCases(const ASTNode& varphi, BeevMgr::ClauseList* defs){
+   void convertFormulaToCNFPosCases(const ASTNode& varphi){
 
       if(isPred(varphi)){
-         convertFormulaToCNFPosPred(varphi, defs);
+         convertFormulaToCNFPosPred(varphi);
          return;
       }
 
@@ -788,51 +851,51 @@ private:
       Kind k = varphi.GetKind();
       switch ( k ){
          case FALSE:    {
-            convertFormulaToCNFPosFALSE(varphi, defs);
+            convertFormulaToCNFPosFALSE(varphi);
             break;
          }
          case TRUE:     {
-            convertFormulaToCNFPosTRUE(varphi, defs);
+            convertFormulaToCNFPosTRUE(varphi);
             break;
          }
          case BVGETBIT: {
-            convertFormulaToCNFPosBVGETBIT(varphi, defs);
+            convertFormulaToCNFPosBVGETBIT(varphi);
             break;
          }
          case SYMBOL:   {
-            convertFormulaToCNFPosSYMBOL(varphi, defs);
+            convertFormulaToCNFPosSYMBOL(varphi);
             break;
          }
          case NOT:      {
-            convertFormulaToCNFPosNOT(varphi, defs);
+            convertFormulaToCNFPosNOT(varphi);
             break;
          }
          case AND:      {
-            convertFormulaToCNFPosAND(varphi, defs);
+            convertFormulaToCNFPosAND(varphi);
             break;
          }
          case NAND:     {
-            convertFormulaToCNFPosNAND(varphi, defs);
+            convertFormulaToCNFPosNAND(varphi);
             break;
          }
          case OR:       {
-            convertFormulaToCNFPosOR(varphi, defs);
+            convertFormulaToCNFPosOR(varphi);
             break;
          }
          case NOR:      {
-            convertFormulaToCNFPosNOR(varphi, defs);
+            convertFormulaToCNFPosNOR(varphi);
             break;
          }
          case XOR:      {
-            convertFormulaToCNFPosXOR(varphi, defs);
+            convertFormulaToCNFPosXOR(varphi);
             break;
          }
          case IMPLIES:  {
-            convertFormulaToCNFPosIMPLIES(varphi, defs);
+            convertFormulaToCNFPosIMPLIES(varphi);
             break;
          }
          case ITE:      {
-            convertFormulaToCNFPosITE(varphi, defs);
+            convertFormulaToCNFPosITE(varphi);
             break;
          }
          default: {
@@ -842,10 +905,10 @@ private:
       }
    }
 
-   void convertFormulaToCNFNegCases(const ASTNode& varphi, BeevMgr::ClauseList* defs){
+   void convertFormulaToCNFNegCases(const ASTNode& varphi){
 
       if(isPred(varphi)){
-         convertFormulaToCNFNegPred(varphi, defs);
+         convertFormulaToCNFNegPred(varphi);
          return;
       }
 
@@ -853,51 +916,51 @@ private:
       Kind k = varphi.GetKind();
       switch ( k ){
          case FALSE:    {
-            convertFormulaToCNFNegFALSE(varphi, defs);
+            convertFormulaToCNFNegFALSE(varphi);
             break;
          }
          case TRUE:     {
-            convertFormulaToCNFNegTRUE(varphi, defs);
+            convertFormulaToCNFNegTRUE(varphi);
             break;
          }
          case BVGETBIT: {
-            convertFormulaToCNFNegBVGETBIT(varphi, defs);
+            convertFormulaToCNFNegBVGETBIT(varphi);
             break;
          }
          case SYMBOL:   {
-            convertFormulaToCNFNegSYMBOL(varphi, defs);
+            convertFormulaToCNFNegSYMBOL(varphi);
             break;
          }
          case NOT:      {
-            convertFormulaToCNFNegNOT(varphi, defs);
+            convertFormulaToCNFNegNOT(varphi);
             break;
          }
          case AND:      {
-            convertFormulaToCNFNegAND(varphi, defs);
+            convertFormulaToCNFNegAND(varphi);
             break;
          }
          case NAND:     {
-            convertFormulaToCNFNegNAND(varphi, defs);
+            convertFormulaToCNFNegNAND(varphi);
             break;
          }
          case OR:       {
-            convertFormulaToCNFNegOR(varphi, defs);
+            convertFormulaToCNFNegOR(varphi);
             break;
          }
          case NOR:      {
-            convertFormulaToCNFNegNOR(varphi, defs);
+            convertFormulaToCNFNegNOR(varphi);
             break;
          }
          case XOR:      {
-            convertFormulaToCNFNegXOR(varphi, defs);
+            convertFormulaToCNFNegXOR(varphi);
             break;
          }
          case IMPLIES:  {
-            convertFormulaToCNFNegIMPLIES(varphi, defs);
+            convertFormulaToCNFNegIMPLIES(varphi);
             break;
          }
          case ITE:      {
-            convertFormulaToCNFNegITE(varphi, defs);
+            convertFormulaToCNFNegITE(varphi);
             break;
          }
          default: {
@@ -911,52 +974,50 @@ private:
    //########################################
    // individual cnf conversion cases
    
-   void convertFormulaToCNFPosPred(const ASTNode& varphi, BeevMgr::ClauseList* defs){
+   void convertFormulaToCNFPosPred(const ASTNode& varphi){
 
       ASTVec psis;
 
       ASTVec::const_iterator it = varphi.GetChildren().begin();
       for(; it != varphi.GetChildren().end(); it++){
-         convertTermForCNF(*it, defs);
+         convertTermForCNF(*it);
          psis.push_back(*(info[*it]->termforcnf));
       }
 
       info[varphi]->clausespos = SINGLETON(bm->CreateNode(varphi.GetKind(), psis));
    }
 
-   void convertFormulaToCNFPosFALSE(const ASTNode& varphi, BeevMgr::ClauseList* defs){
-      ASTNode dummy_false_var = bm->CreateNode(NOT, bm->CreateSymbol("*TrueDummy*"));
-      info[varphi]->clausespos = SINGLETON(dummy_false_var);
+   void convertFormulaToCNFPosFALSE(const ASTNode& varphi){
+      info[varphi]->clausespos = SINGLETON(~dummy_true_lit);
    }
 
-   void convertFormulaToCNFPosTRUE(const ASTNode& varphi, BeevMgr::ClauseList* defs){
-      ASTNode dummy_true_var = bm->CreateSymbol("*TrueDummy*");
-      info[varphi]->clausespos = SINGLETON(dummy_true_var);
+   void convertFormulaToCNFPosTRUE(const ASTNode& varphi){
+      info[varphi]->clausespos = SINGLETON(dummy_true_lit);
    }
 
-   void convertFormulaToCNFPosBVGETBIT(const ASTNode& varphi, BeevMgr::ClauseList* defs){
+   void convertFormulaToCNFPosBVGETBIT(const ASTNode& varphi){
       info[varphi]->clausespos = SINGLETON(varphi);
    }
 
-   void convertFormulaToCNFPosSYMBOL(const ASTNode& varphi, BeevMgr::ClauseList* defs){
+   void convertFormulaToCNFPosSYMBOL(const ASTNode& varphi){
       info[varphi]->clausespos = SINGLETON(varphi);
    }
 
-   void convertFormulaToCNFPosNOT(const ASTNode& varphi, BeevMgr::ClauseList* defs){
-      convertFormulaToCNF(varphi[0], defs);
+   void convertFormulaToCNFPosNOT(const ASTNode& varphi){
+      convertFormulaToCNF(varphi[0]);
       info[varphi]->clausespos = COPY(*(info[varphi[0]]->clausesneg));
       reduceMemoryFootprintNeg(varphi[0]);
    }
 
-   void convertFormulaToCNFPosAND(const ASTNode& varphi, BeevMgr::ClauseList* defs){
+   void convertFormulaToCNFPosAND(const ASTNode& varphi){
       //****************************************
       // (pos) AND ~> UNION
       //****************************************
       ASTVec::const_iterator it = varphi.GetChildren().begin();
-      convertFormulaToCNF(*it, defs);
-      BeevMgr::ClauseList* psi = COPY(*(info[*it]->clausespos));
+      convertFormulaToCNF(*it);
+      ClauseSet* psi = COPY(*(info[*it]->clausespos));
       for(it++; it != varphi.GetChildren().end(); it++){
-         convertFormulaToCNF(*it, defs);
+         convertFormulaToCNF(*it);
          INPLACE_UNION(psi, *(info[*it]->clausespos));
          reduceMemoryFootprintPos(*it);
       }
@@ -964,18 +1025,18 @@ private:
       info[varphi]->clausespos = psi;
    }
 
-   void convertFormulaToCNFPosNAND(const ASTNode& varphi, BeevMgr::ClauseList* defs){
+   void convertFormulaToCNFPosNAND(const ASTNode& varphi){
       bool renamesibs = false;
-      BeevMgr::ClauseList* clauses;
-      BeevMgr::ClauseList* psi;
-      BeevMgr::ClauseList* oldpsi;
+      ClauseSet* clauses;
+      ClauseSet* psi;
+      ClauseSet* oldpsi;
 
       //****************************************
       // (pos) NAND ~> PRODUCT NOT
       //****************************************
 
       ASTVec::const_iterator it = varphi.GetChildren().begin();
-      convertFormulaToCNF(*it, defs);
+      convertFormulaToCNF(*it);
       clauses = info[*it]->clausesneg;
       if(clauses->size() > 1){
          renamesibs = true;
@@ -987,7 +1048,7 @@ private:
          if(renamesibs){
             setDoSibRenamingNeg(*(info[*it]));
          }
-         convertFormulaToCNF(*it, defs);
+         convertFormulaToCNF(*it);
          clauses = info[*it]->clausesneg;
          if(clauses->size() > 1){
             renamesibs = true;
@@ -1001,17 +1062,17 @@ private:
       info[varphi]->clausespos = psi;
    }
 
-   void convertFormulaToCNFPosOR(const ASTNode& varphi, BeevMgr::ClauseList* defs){
+   void convertFormulaToCNFPosOR(const ASTNode& varphi){
       bool renamesibs = false;
-      BeevMgr::ClauseList* clauses;
-      BeevMgr::ClauseList* psi;
-      BeevMgr::ClauseList* oldpsi;
+      ClauseSet* clauses;
+      ClauseSet* psi;
+      ClauseSet* oldpsi;
 
       //****************************************
       // (pos) OR ~> PRODUCT
       //****************************************
       ASTVec::const_iterator it = varphi.GetChildren().begin();
-      convertFormulaToCNF(*it, defs);
+      convertFormulaToCNF(*it);
       clauses = info[*it]->clausespos;
       if(clauses->size() > 1){
          renamesibs = true;
@@ -1023,7 +1084,7 @@ private:
          if(renamesibs){
             setDoSibRenamingPos(*(info[*it]));
          }
-         convertFormulaToCNF(*it, defs);
+         convertFormulaToCNF(*it);
          clauses = info[*it]->clausespos;
          if(clauses->size() > 1){
             renamesibs = true;
@@ -1037,16 +1098,16 @@ private:
       info[varphi]->clausespos = psi;
    }
 
-   void convertFormulaToCNFPosNOR(const ASTNode& varphi, BeevMgr::ClauseList* defs){
+   void convertFormulaToCNFPosNOR(const ASTNode& varphi){
       //****************************************
       // (pos) NOR ~> UNION NOT
       //****************************************
       ASTVec::const_iterator it = varphi.GetChildren().begin();
-      convertFormulaToCNF(*it, defs);
-      BeevMgr::ClauseList* psi = COPY(*(info[*it]->clausesneg));
+      convertFormulaToCNF(*it);
+      ClauseSet* psi = COPY(*(info[*it]->clausesneg));
       reduceMemoryFootprintNeg(*it);
       for(it++; it != varphi.GetChildren().end(); it++){
-         convertFormulaToCNF(*it, defs);
+         convertFormulaToCNF(*it);
          INPLACE_UNION(psi, *(info[*it]->clausesneg));
          reduceMemoryFootprintNeg(*it);
       }
@@ -1054,22 +1115,22 @@ private:
       info[varphi]->clausespos = psi;
    }
 
-   void convertFormulaToCNFPosIMPLIES(const ASTNode& varphi, BeevMgr::ClauseList* defs){
+   void convertFormulaToCNFPosIMPLIES(const ASTNode& varphi){
       //****************************************
       // (pos) IMPLIES ~> PRODUCT NOT [0] ; [1]
       //****************************************
       CNFInfo* x0 = info[varphi[0]];
       CNFInfo* x1 = info[varphi[1]];
-      convertFormulaToCNF(varphi[0], defs);
-      convertFormulaToCNF(varphi[1], defs);
-      BeevMgr::ClauseList* psi = 
+      convertFormulaToCNF(varphi[0]);
+      convertFormulaToCNF(varphi[1]);
+      ClauseSet* psi = 
          PRODUCT(*(x0->clausesneg), *(x1->clausespos));
       reduceMemoryFootprintNeg(varphi[0]);
       reduceMemoryFootprintPos(varphi[1]);
       info[varphi]->clausespos = psi;
    }
 
-   void convertFormulaToCNFPosITE(const ASTNode& varphi, BeevMgr::ClauseList* defs){
+   void convertFormulaToCNFPosITE(const ASTNode& varphi){
       //****************************************
       // (pos) ITE ~> UNION (PRODUCT NOT [0] ; [1])
       //  ; (PRODUCT [0] ; [2])
@@ -1077,12 +1138,12 @@ private:
       CNFInfo* x0 = info[varphi[0]];
       CNFInfo* x1 = info[varphi[1]];
       CNFInfo* x2 = info[varphi[2]];
-      convertFormulaToCNF(varphi[0], defs);
-      convertFormulaToCNF(varphi[1], defs);
-      convertFormulaToCNF(varphi[2], defs);
-      BeevMgr::ClauseList* psi1 = PRODUCT(*(x0->clausesneg)
+      convertFormulaToCNF(varphi[0]);
+      convertFormulaToCNF(varphi[1]);
+      convertFormulaToCNF(varphi[2]);
+      ClauseSet* psi1 = PRODUCT(*(x0->clausesneg)
          , *(x1->clausespos));
-      BeevMgr::ClauseList* psi2 = PRODUCT(*(x0->clausespos)
+      ClauseSet* psi2 = PRODUCT(*(x0->clausespos)
          , *(x2->clausespos));
       NOCOPY_INPLACE_UNION(psi1, psi2);
       reduceMemoryFootprintNeg(varphi[0]);
@@ -1093,18 +1154,17 @@ private:
       info[varphi]->clausespos = psi1;
    }
 
-   void convertFormulaToCNFPosXOR(const ASTNode& varphi, BeevMgr::ClauseList* defs){
-      BeevMgr::ClauseList* psi = convertFormulaToCNFPosXORAux(varphi, 0, defs);
+   void convertFormulaToCNFPosXOR(const ASTNode& varphi){
+      ClauseSet* psi = convertFormulaToCNFPosXORAux(varphi, 0);
       info[varphi]->clausespos = psi;
    }
 
-   BeevMgr::ClauseList* convertFormulaToCNFPosXORAux(const ASTNode& varphi
-         , unsigned int idx, BeevMgr::ClauseList* defs){
+   ClauseSet* convertFormulaToCNFPosXORAux(const ASTNode& varphi, unsigned int idx){
 
       bool renamesibs;
-      BeevMgr::ClauseList* psi;
-      BeevMgr::ClauseList* psi1;
-      BeevMgr::ClauseList* psi2;
+      ClauseSet* psi;
+      ClauseSet* psi1;
+      ClauseSet* psi2;
 
       if(idx == varphi.GetChildren().size() - 2){
       //****************************************
@@ -1112,7 +1172,7 @@ private:
       //    (PRODUCT       [idx]   ;     [idx+1])
       //  ; (PRODUCT NOT   [idx]   ; NOT [idx+1])
       //****************************************
-         convertFormulaToCNF(varphi[idx], defs);
+         convertFormulaToCNF(varphi[idx]);
          renamesibs = (info[varphi[idx]]->clausespos)->size() > 1 ? true : false;
          if(renamesibs){
             setDoSibRenamingPos(*info[varphi[idx+1]]);
@@ -1121,7 +1181,7 @@ private:
          if(renamesibs){
             setDoSibRenamingNeg(*info[varphi[idx+1]]);
          }
-         convertFormulaToCNF(varphi[idx+1], defs);
+         convertFormulaToCNF(varphi[idx+1]);
 
          psi1 = PRODUCT(*(info[varphi[idx]]->clausespos), *(info[varphi[idx+1]]->clausespos));
          psi2 = PRODUCT(*(info[varphi[idx]]->clausesneg), *(info[varphi[idx+1]]->clausesneg));
@@ -1138,19 +1198,19 @@ private:
       //    (PRODUCT       [idx] ; XOR      [idx+1..])
       //  ; (PRODUCT NOT   [idx] ; NOT XOR  [idx+1..])
       //****************************************
-         BeevMgr::ClauseList* theta1;
-         theta1 = convertFormulaToCNFPosXORAux(varphi, idx+1, defs);
+         ClauseSet* theta1;
+         theta1 = convertFormulaToCNFPosXORAux(varphi, idx+1);
          renamesibs = theta1->size() > 1 ? true : false;
          if(renamesibs){
             setDoSibRenamingPos(*info[varphi[idx]]);
          }
-         BeevMgr::ClauseList* theta2;
-         theta2 = convertFormulaToCNFNegXORAux(varphi, idx+1, defs);
+         ClauseSet* theta2;
+         theta2 = convertFormulaToCNFNegXORAux(varphi, idx+1);
          renamesibs = theta2->size() > 1 ? true : false;
          if(renamesibs){
             setDoSibRenamingNeg(*info[varphi[idx]]);
          }
-         convertFormulaToCNF(varphi[idx], defs);
+         convertFormulaToCNF(varphi[idx]);
 
          psi1 = PRODUCT(*(info[varphi[idx]]->clausespos), *theta1);
          psi2 = PRODUCT(*(info[varphi[idx]]->clausesneg), *theta2);
@@ -1166,56 +1226,54 @@ private:
       return psi;
    }
 
-   void convertFormulaToCNFNegPred(const ASTNode& varphi, BeevMgr::ClauseList* defs){
+   void convertFormulaToCNFNegPred(const ASTNode& varphi){
 
       ASTVec psis;
 
       ASTVec::const_iterator it = varphi.GetChildren().begin();
       for(; it != varphi.GetChildren().end(); it++){
-         convertFormulaToCNF(*it, defs);
+         convertFormulaToCNF(*it);
          psis.push_back(*(info[*it]->termforcnf));
       }
 
-      info[varphi]->clausesneg = SINGLETON(bm->CreateNode(NOT, bm->CreateNode(varphi.GetKind(), psis)));
+      info[varphi]->clausesneg = SINGLETON(~LIT(bm->CreateNode(varphi.GetKind(), psis)));
    }
 
-   void convertFormulaToCNFNegFALSE(const ASTNode& varphi, BeevMgr::ClauseList* defs){
-      ASTNode dummy_true_var = bm->CreateSymbol("*TrueDummy*");
-      info[varphi]->clausesneg = SINGLETON(dummy_true_var);
+   void convertFormulaToCNFNegFALSE(const ASTNode& varphi){
+      info[varphi]->clausesneg = SINGLETON(dummy_true_lit);
    }
 
-   void convertFormulaToCNFNegTRUE(const ASTNode& varphi, BeevMgr::ClauseList* defs){
-      ASTNode dummy_false_var = bm->CreateNode(NOT, bm->CreateSymbol("*TrueDummy*"));
-      info[varphi]->clausesneg = SINGLETON(dummy_false_var);
+   void convertFormulaToCNFNegTRUE(const ASTNode& varphi){
+      info[varphi]->clausesneg = SINGLETON(~dummy_true_lit);
    }
 
-   void convertFormulaToCNFNegBVGETBIT(const ASTNode& varphi, BeevMgr::ClauseList* defs){
-      BeevMgr::ClauseList* psi = SINGLETON(bm->CreateNode(NOT, varphi));
+   void convertFormulaToCNFNegBVGETBIT(const ASTNode& varphi){
+      ClauseSet* psi = SINGLETON(~LIT(varphi));
       info[varphi]->clausesneg = psi;
    }
 
-   void convertFormulaToCNFNegSYMBOL(const ASTNode& varphi, BeevMgr::ClauseList* defs){
-      info[varphi]->clausesneg = SINGLETON(bm->CreateNode(NOT, varphi));
+   void convertFormulaToCNFNegSYMBOL(const ASTNode& varphi){
+      info[varphi]->clausesneg = SINGLETON(~LIT(varphi));
    }
 
-   void convertFormulaToCNFNegNOT(const ASTNode& varphi, BeevMgr::ClauseList* defs){
-      convertFormulaToCNF(varphi[0], defs);
+   void convertFormulaToCNFNegNOT(const ASTNode& varphi){
+      convertFormulaToCNF(varphi[0]);
       info[varphi]->clausesneg = COPY(*(info[varphi[0]]->clausespos));
       reduceMemoryFootprintPos(varphi[0]);
    }
 
-   void convertFormulaToCNFNegAND(const ASTNode& varphi, BeevMgr::ClauseList* defs){
+   void convertFormulaToCNFNegAND(const ASTNode& varphi){
       bool renamesibs = false;
-      BeevMgr::ClauseList* clauses;
-      BeevMgr::ClauseList* psi;
-      BeevMgr::ClauseList* oldpsi;
+      ClauseSet* clauses;
+      ClauseSet* psi;
+      ClauseSet* oldpsi;
 
       //****************************************
       // (neg) AND ~> PRODUCT NOT
       //****************************************
 
       ASTVec::const_iterator it = varphi.GetChildren().begin();
-      convertFormulaToCNF(*it, defs);
+      convertFormulaToCNF(*it);
       clauses = info[*it]->clausesneg;
       if(clauses->size() > 1){
          renamesibs = true;
@@ -1227,7 +1285,7 @@ private:
          if(renamesibs){
             setDoSibRenamingNeg(*(info[*it]));
          }
-         convertFormulaToCNF(*it, defs);
+         convertFormulaToCNF(*it);
          clauses = info[*it]->clausesneg;
          if(clauses->size() > 1){
             renamesibs = true;
@@ -1241,16 +1299,16 @@ private:
       info[varphi]->clausesneg = psi;
    }
 
-   void convertFormulaToCNFNegNAND(const ASTNode& varphi, BeevMgr::ClauseList* defs){
+   void convertFormulaToCNFNegNAND(const ASTNode& varphi){
       //****************************************
       // (neg) NAND ~> UNION
       //****************************************
       ASTVec::const_iterator it = varphi.GetChildren().begin();
-      convertFormulaToCNF(*it, defs);
-      BeevMgr::ClauseList* psi = COPY(*(info[*it]->clausespos));
+      convertFormulaToCNF(*it);
+      ClauseSet* psi = COPY(*(info[*it]->clausespos));
       reduceMemoryFootprintPos(*it);
       for(it++; it != varphi.GetChildren().end(); it++){
-         convertFormulaToCNF(*it, defs);
+         convertFormulaToCNF(*it);
          INPLACE_UNION(psi, *(info[*it]->clausespos));
          reduceMemoryFootprintPos(*it);
       }
@@ -1258,16 +1316,16 @@ private:
       info[varphi]->clausespos = psi;
    }
 
-   void convertFormulaToCNFNegOR(const ASTNode& varphi, BeevMgr::ClauseList* defs){
+   void convertFormulaToCNFNegOR(const ASTNode& varphi){
       //****************************************
       // (neg) OR ~> UNION NOT
       //****************************************
       ASTVec::const_iterator it = varphi.GetChildren().begin();
-      convertFormulaToCNF(*it, defs);
-      BeevMgr::ClauseList* psi = COPY(*(info[*it]->clausesneg));
+      convertFormulaToCNF(*it);
+      ClauseSet* psi = COPY(*(info[*it]->clausesneg));
       reduceMemoryFootprintNeg(*it);
       for(it++; it != varphi.GetChildren().end(); it++){
-         convertFormulaToCNF(*it, defs);
+         convertFormulaToCNF(*it);
          INPLACE_UNION(psi, *(info[*it]->clausesneg));
          reduceMemoryFootprintNeg(*it);
       }
@@ -1275,17 +1333,17 @@ private:
       info[varphi]->clausesneg = psi;
    }
 
-   void convertFormulaToCNFNegNOR(const ASTNode& varphi, BeevMgr::ClauseList* defs){
+   void convertFormulaToCNFNegNOR(const ASTNode& varphi){
       bool renamesibs = false;
-      BeevMgr::ClauseList* clauses;
-      BeevMgr::ClauseList* psi;
-      BeevMgr::ClauseList* oldpsi;
+      ClauseSet* clauses;
+      ClauseSet* psi;
+      ClauseSet* oldpsi;
 
       //****************************************
       // (neg) NOR ~> PRODUCT
       //****************************************
       ASTVec::const_iterator it = varphi.GetChildren().begin();
-      convertFormulaToCNF(*it, defs);
+      convertFormulaToCNF(*it);
       clauses = info[*it]->clausespos;
       if(clauses->size() > 1){
          renamesibs = true;
@@ -1297,7 +1355,7 @@ private:
          if(renamesibs){
             setDoSibRenamingPos(*(info[*it]));
          }
-         convertFormulaToCNF(*it, defs);
+         convertFormulaToCNF(*it);
          clauses = info[*it]->clausespos;
          if(clauses->size() > 1){
             renamesibs = true;
@@ -1311,22 +1369,22 @@ private:
       info[varphi]->clausesneg = psi;
    }
 
-   void convertFormulaToCNFNegIMPLIES(const ASTNode& varphi, BeevMgr::ClauseList* defs){
+   void convertFormulaToCNFNegIMPLIES(const ASTNode& varphi){
       //****************************************
       // (neg) IMPLIES ~> UNION [0] ; NOT [1]
       //****************************************
       CNFInfo* x0 = info[varphi[0]];
       CNFInfo* x1 = info[varphi[1]];
-      convertFormulaToCNF(varphi[0], defs);
-      convertFormulaToCNF(varphi[1], defs);
-      BeevMgr::ClauseList* psi = 
+      convertFormulaToCNF(varphi[0]);
+      convertFormulaToCNF(varphi[1]);
+      ClauseSet* psi = 
          UNION(*(x0->clausespos), *(x1->clausesneg));
       info[varphi]->clausesneg = psi;
       reduceMemoryFootprintPos(varphi[0]);
       reduceMemoryFootprintNeg(varphi[1]);
    }
 
-   void convertFormulaToCNFNegITE(const ASTNode& varphi, BeevMgr::ClauseList* defs){
+   void convertFormulaToCNFNegITE(const ASTNode& varphi){
       //****************************************
       // (neg) ITE ~> UNION (PRODUCT NOT [0] ; NOT [1])
       //  ; (PRODUCT [0] ; NOT [2])
@@ -1334,12 +1392,12 @@ private:
       CNFInfo* x0 = info[varphi[0]];
       CNFInfo* x1 = info[varphi[1]];
       CNFInfo* x2 = info[varphi[2]];
-      convertFormulaToCNF(varphi[0], defs);
-      convertFormulaToCNF(varphi[1], defs);
-      convertFormulaToCNF(varphi[2], defs);
-      BeevMgr::ClauseList* psi1 = PRODUCT(*(x0->clausesneg)
+      convertFormulaToCNF(varphi[0]);
+      convertFormulaToCNF(varphi[1]);
+      convertFormulaToCNF(varphi[2]);
+      ClauseSet* psi1 = PRODUCT(*(x0->clausesneg)
          , *(x1->clausesneg));
-      BeevMgr::ClauseList* psi2 = PRODUCT(*(x0->clausespos)
+      ClauseSet* psi2 = PRODUCT(*(x0->clausespos)
          , *(x2->clausesneg));
       NOCOPY_INPLACE_UNION(psi1, psi2);
       reduceMemoryFootprintNeg(varphi[0]);
@@ -1350,18 +1408,17 @@ private:
       info[varphi]->clausesneg = psi1;
    }
 
-   void convertFormulaToCNFNegXOR(const ASTNode& varphi, BeevMgr::ClauseList* defs){
-      BeevMgr::ClauseList* psi = convertFormulaToCNFNegXORAux(varphi, 0, defs);
+   void convertFormulaToCNFNegXOR(const ASTNode& varphi){
+      ClauseSet* psi = convertFormulaToCNFNegXORAux(varphi, 0);
       info[varphi]->clausesneg = psi;
    }
 
-   BeevMgr::ClauseList* convertFormulaToCNFNegXORAux(const ASTNode& varphi
-         , unsigned int idx, BeevMgr::ClauseList* defs){
+   ClauseSet* convertFormulaToCNFNegXORAux(const ASTNode& varphi, unsigned int idx){
 
       bool renamesibs;
-      BeevMgr::ClauseList* psi;
-      BeevMgr::ClauseList* psi1;
-      BeevMgr::ClauseList* psi2;
+      ClauseSet* psi;
+      ClauseSet* psi1;
+      ClauseSet* psi2;
 
       if(idx == varphi.GetChildren().size() - 2){
 
@@ -1370,20 +1427,20 @@ private:
       //    (PRODUCT NOT   [idx]   ;     [idx+1])
       //  ; (PRODUCT       [idx]   ; NOT [idx+1])
       //****************************************
-         convertFormulaToCNF(varphi[idx], defs);
+         convertFormulaToCNF(varphi[idx]);
          renamesibs = (info[varphi[idx]]->clausesneg)->size() > 1 ? true : false;
          if(renamesibs){
             setDoSibRenamingPos(*info[varphi[idx+1]]);
          }
-         convertFormulaToCNF(varphi[idx+1], defs);
+         convertFormulaToCNF(varphi[idx+1]);
 
 
-         convertFormulaToCNF(varphi[idx], defs);
+         convertFormulaToCNF(varphi[idx]);
          renamesibs = (info[varphi[idx]]->clausespos)->size() > 1 ? true : false;
          if(renamesibs){
             setDoSibRenamingNeg(*info[varphi[idx+1]]);
          }
-         convertFormulaToCNF(varphi[idx+1], defs);
+         convertFormulaToCNF(varphi[idx+1]);
 
          psi1 = PRODUCT(*(info[varphi[idx]]->clausesneg), *(info[varphi[idx+1]]->clausespos));
          psi2 = PRODUCT(*(info[varphi[idx]]->clausespos), *(info[varphi[idx+1]]->clausesneg));
@@ -1401,22 +1458,22 @@ private:
       //    (PRODUCT NOT   [idx] ; XOR      [idx+1..])
       //  ; (PRODUCT       [idx] ; NOT XOR  [idx+1..])
       //****************************************
-         BeevMgr::ClauseList* theta1;
-         theta1 = convertFormulaToCNFPosXORAux(varphi, idx+1, defs);
+         ClauseSet* theta1;
+         theta1 = convertFormulaToCNFPosXORAux(varphi, idx+1);
          renamesibs = theta1->size() > 1 ? true : false;
          if(renamesibs){
             setDoSibRenamingNeg(*info[varphi[idx]]);
          }
-         convertFormulaToCNF(varphi[idx], defs);
+         convertFormulaToCNF(varphi[idx]);
 
 
-         BeevMgr::ClauseList* theta2;
-         theta2 = convertFormulaToCNFNegXORAux(varphi, idx+1, defs);
+         ClauseSet* theta2;
+         theta2 = convertFormulaToCNFNegXORAux(varphi, idx+1);
          renamesibs = theta2->size() > 1 ? true : false;
          if(renamesibs){
             setDoSibRenamingPos(*info[varphi[idx]]);
          }
-         convertFormulaToCNF(varphi[idx], defs);
+         convertFormulaToCNF(varphi[idx]);
          
          psi1 = PRODUCT(*(info[varphi[idx]]->clausesneg), *theta1);
          psi2 = PRODUCT(*(info[varphi[idx]]->clausespos), *theta2);
@@ -1482,9 +1539,6 @@ private:
    //########################################
 
    void cleanup(const ASTNode& varphi){
-      delete info[varphi]->clausespos;
-      info.erase(varphi);
-
       ASTNodeToCNFInfoMap::const_iterator it1 = info.begin();
       for(; it1 != info.end(); it1++){
          CNFInfo* x = it1->second;
@@ -1536,14 +1590,22 @@ private:
     delete cllp;
   }
 
-  int BeevMgr::CallSAT_ResultCheck(MINISAT::Solver& newS, 
+  int BeevMgr::CallSAT_ResultCheck(MINISAT::SimpSolver& newS, 
 				   const ASTNode& q, const ASTNode& orig_input) {
-    ASTNode BBFormula = BBForm(q);
-    CNFMgr* cm = new CNFMgr(this);
-    ClauseList* cl = cm->convertToCNF(BBFormula);
-    bool sat = toSATandSolve(newS,*cl);    
-    cm->DELETE(cl);
-    delete cm;
+    bool sat;
+    if(aig_bitblast)
+      sat = AIGtoSATandSolve(newS,BBFormAIG(q));
+    else {
+      ASTNode BBFormula = BBForm(q);
+      CountersAndStats("SAT Solver");
+      CNFMgr* cm = new CNFMgr(this, newS);
+      sat = cm->convertToCNF(BBFormula);
+      delete cm;
+      if(sat)
+	sat = SolveSATClauses(newS);
+      else
+	PrintStats(newS);
+    }
 
     if(!sat) {
       PrintOutput(true);
@@ -9,15 +9,27 @@
 #include "AST.h"
 #include "ASTUtil.h"
 #include "../simplifier/bvsolver.h"
+#include "../simplifier/presolver.h"
 #include <math.h>
+#include <stdio.h>
+#include <pthread.h>
 
 
 namespace BEEV {
+  //only the variables introduced by the CNF conversion (and the AIG
+  //nodes, which have no ASTNode) may be eliminated by the SAT
+  //solver. the others are read by ConstructCounterExample, and the
+  //clauses of later refinements refer to them
+  static bool IsCNFVariable(const ASTNode& n) {
+    return UNDEFINED == n.GetKind() ||
+      (SYMBOL == n.GetKind() && 0 == strncmp("cnf", n.GetName(), 3));
+  }
+
   /* FUNCTION: lookup or create a new MINISAT literal
    * lookup or create new MINISAT Vars from the global MAP
    * _ASTNode_to_SATVar.
    */
-  const MINISAT::Var BeevMgr::LookupOrCreateSATVar(MINISAT::Solver& newS, const ASTNode& n) {  
+  const MINISAT::Var BeevMgr::LookupOrCreateSATVar(MINISAT::SimpSolver& newS, const ASTNode& n) {  
     ASTtoSATMap::iterator it;  
     MINISAT::Var v;
     
@@ -26,6 +38,8 @@ namespace BEEV {
     if((it = _ASTNode_to_SATVar.find(n)) == _ASTNode_to_SATVar.end()) {
       v = newS.newVar();
       _ASTNode_to_SATVar[n] = v;	
+      if(newS.use_simplification && !IsCNFVariable(n))
+	newS.setFrozen(v, true);
       
       //ASSUMPTION: I am assuming that the newS.newVar() call increments v
       //by 1 each time it is called, and the initial value of a
@@ -37,6 +51,34 @@ namespace BEEV {
     return v;
   }
   
+  //called before the clauses of a query are given to newS
+  void BeevMgr::BeginSATClauses(MINISAT::SimpSolver& newS, 
+				unsigned int cnf_size) {
+    if(0 != newS.nVars())
+      return;
+
+    //variable elimination pays off only on large CNFs. it can only
+    //be turned off before the first variable is created
+    if(!sat_simplify || cnf_size < sat_simplify_min_size)
+      newS.eliminate(true);
+    _portfolio_clauses.clear();
+  }
+
+  bool BeevMgr::AddSATClause(MINISAT::SimpSolver& newS, 
+			     MINISAT::vec<MINISAT::Lit>& satSolverClause) {
+    if(sat_portfolio_threads > 1) {
+      _portfolio_clauses.push_back(std::vector<MINISAT::Lit>());
+      for(int k = 0; k < satSolverClause.size(); k++)
+	_portfolio_clauses.back().push_back(satSolverClause[k]);
+    }
+    newS.addClause(satSolverClause);
+    // clause printing.
+    // (printClause<MINISAT::vec<MINISAT::Lit> >)(satSolverClause);
+    // cout << " 0 ";
+    // cout << endl;
+    return newS.okay();
+  }
+
   /* FUNCTION: convert ASTClauses to MINISAT clauses and solve.
    * Accepts ASTClauses and converts them to MINISAT clauses. Then adds
    * the newly minted MINISAT clauses to the local SAT instance, and
@@ -45,7 +87,7 @@ namespace BEEV {
    */  
   // FIXME: Still need to deal with TRUE/FALSE in clauses!
  //bool BeevMgr::toSATandSolve(MINISAT::Solver& newS, BeevMgr::ClauseList& cll, ASTNodeToIntMap& heuristic)
- bool BeevMgr::toSATandSolve(MINISAT::Solver& newS, BeevMgr::ClauseList& cll)
+ bool BeevMgr::toSATandSolve(MINISAT::SimpSolver& newS, BeevMgr::ClauseList& cll)
  {
     CountersAndStats("SAT Solver");
 
@@ -61,6 +103,8 @@ namespace BEEV {
     // true
     //newS.turnOffSubsumption();
 
+    BeginSATClauses(newS, cll.size());
+
     // (*i) is an ASTVec-ptr which denotes an ASTclause
     //****************************************
     // *i = vector<const ASTNode*>*
@@ -84,26 +128,248 @@ namespace BEEV {
 	MINISAT::Lit l(v, negate);
 	satSolverClause.push(l);
       }
-      newS.addClause(satSolverClause);
-      // clause printing.
-      // (printClause<MINISAT::vec<MINISAT::Lit> >)(satSolverClause);
-      // cout << " 0 ";
-      // cout << endl;
-      
-      if(newS.okay()) {
-	continue;
-      }
-      else {
+      if(!AddSATClause(newS, satSolverClause)) {
 	PrintStats(newS);
 	return false;
       }
-      
-      if(!newS.simplify()) {
-      	PrintStats(newS);
-      	return false;
+    }
+
+    return SolveSATClauses(newS);
+  }
+
+  //the AND nodes below a gate of the Tseitin encoding that are new
+  //(-2) and used only once are part of the gate
+  static bool AIGInGate(const AIGMgr& aig, const std::vector<int>& satvar,
+			const std::vector<unsigned char>& fanout, unsigned int n) {
+    return aig.IsAnd(n) && -2 == satvar[n] && 1 == fanout[n];
+  }
+
+  //if AIG node n is !(c & t) & !(!c & e), with both ANDs in the gate,
+  //stores {c,t,e} in leaves: n is !ITE(c,t,e), or XOR if t == !e
+  static bool AIGITEGate(const AIGMgr& aig, const std::vector<int>& satvar,
+			 const std::vector<unsigned char>& fanout,
+			 unsigned int n, std::vector<AIGLit>& leaves) {
+    AIGLit left = aig.Left(n), right = aig.Right(n);
+    unsigned int p = AIGMgr::Index(left), q = AIGMgr::Index(right);
+    if(!AIGMgr::IsNegated(left) || !AIGMgr::IsNegated(right) ||
+       !AIGInGate(aig, satvar, fanout, p) || !AIGInGate(aig, satvar, fanout, q))
+      return false;
+    AIGLit p0 = aig.Left(p), p1 = aig.Right(p);
+    AIGLit q0 = aig.Left(q), q1 = aig.Right(q);
+    for(int i = 0; i < 4; i++) {
+      AIGLit c = (i < 2) ? p0 : p1, t = (i < 2) ? p1 : p0;
+      AIGLit qc = (i % 2) ? q1 : q0, e = (i % 2) ? q0 : q1;
+      if(c == AIGMgr::Not(qc)) {
+	leaves.clear();
+	leaves.push_back(c);
+	leaves.push_back(t);
+	leaves.push_back(e);
+	return true;
+      }
+    }
+    return false;
+  }
+
+  //the gate of AIG node n for the Tseitin encoding: either an ITE
+  //gate (returns true, see AIGITEGate), or the AND of leaves. The
+  //ITE-shaped nodes below an AND gate are kept as leaves, since they
+  //have a smaller encoding of their own
+  static bool AIGGate(const AIGMgr& aig, const std::vector<int>& satvar,
+		      const std::vector<unsigned char>& fanout,
+		      unsigned int n, std::vector<AIGLit>& leaves) {
+    if(AIGITEGate(aig, satvar, fanout, n, leaves))
+      return true;
+
+    leaves.clear();
+    std::vector<AIGLit> todo, ite;
+    todo.push_back(aig.Right(n));
+    todo.push_back(aig.Left(n));
+    while(!todo.empty()) {
+      AIGLit l = todo.back();
+      todo.pop_back();
+      unsigned int i = AIGMgr::Index(l);
+      if(!AIGMgr::IsNegated(l) && AIGInGate(aig, satvar, fanout, i) &&
+	 !AIGITEGate(aig, satvar, fanout, i, ite)) {
+	todo.push_back(aig.Right(i));
+	todo.push_back(aig.Left(i));
+      }
+      else
+	leaves.push_back(l);
+    }
+    return false;
+  }
+
+  /* FUNCTION: Tseitin encoding of an AIG, and solve.
+   * The conjuncts of root are given as unit clauses. Every gate below
+   * them (see AIGGate) gets a SAT variable and the clauses of its
+   * definition; the inputs get the SAT variable of their
+   * ASTNode. Nodes encoded by an earlier call for the same solver
+   * (array refinements) keep their variables.
+   */
+  bool BeevMgr::AIGtoSATandSolve(MINISAT::SimpSolver& newS, AIGLit root)
+  {
+    CountersAndStats("SAT Solver");
+
+    if(0 == newS.nVars())
+      _aig_satvar.clear();
+    _aig_satvar.resize(_aig.NumNodes(), -1);
+
+    //split the top-level AND
+    std::vector<AIGLit> conjuncts, todo(1, root);
+    while(!todo.empty()) {
+      AIGLit l = todo.back();
+      todo.pop_back();
+      unsigned int n = AIGMgr::Index(l);
+      if(!AIGMgr::IsNegated(l) && _aig.IsAnd(n)) {
+	todo.push_back(_aig.Left(n));
+	todo.push_back(_aig.Right(n));
+      }
+      else if(AIG_TRUE != l)
+	conjuncts.push_back(l);
+    }
+
+    //the nodes not encoded yet, children first. they are marked with
+    //-2 while this function runs
+    std::vector<unsigned int> nodes, stack;
+    for(unsigned int c = 0; c < conjuncts.size(); c++) {
+      if(AIG_FALSE == conjuncts[c])
+	continue;
+      stack.push_back(AIGMgr::Index(conjuncts[c]));
+      while(!stack.empty()) {
+	unsigned int n = stack.back();
+	if(-1 != _aig_satvar[n]) {
+	  stack.pop_back();
+	  continue;
+	}
+	if(_aig.IsAnd(n)) {
+	  unsigned int l = AIGMgr::Index(_aig.Left(n));
+	  unsigned int r = AIGMgr::Index(_aig.Right(n));
+	  if(-1 == _aig_satvar[l] || -1 == _aig_satvar[r]) {
+	    if(-1 == _aig_satvar[l])
+	      stack.push_back(l);
+	    if(-1 == _aig_satvar[r])
+	      stack.push_back(r);
+	    continue;
+	  }
+	}
+	_aig_satvar[n] = -2;
+	nodes.push_back(n);
+	stack.pop_back();
+      }
+    }
+
+    //number of uses of the new nodes (0, 1, or 2 for more), and the
+    //ones that need a SAT variable, from the roots down
+    std::vector<unsigned char> fanout(_aig.NumNodes(), 0), needed(_aig.NumNodes(), 0);
+    for(unsigned int k = 0; k < nodes.size(); k++)
+      if(_aig.IsAnd(nodes[k])) {
+	unsigned int l = AIGMgr::Index(_aig.Left(nodes[k]));
+	unsigned int r = AIGMgr::Index(_aig.Right(nodes[k]));
+	fanout[l] = (fanout[l] < 2) ? fanout[l] + 1 : 2;
+	fanout[r] = (fanout[r] < 2) ? fanout[r] + 1 : 2;
+      }
+    for(unsigned int c = 0; c < conjuncts.size(); c++) {
+      unsigned int n = AIGMgr::Index(conjuncts[c]);
+      fanout[n] = 2;
+      needed[n] = 1;
+    }
+    unsigned int num_clauses = conjuncts.size();
+    std::vector<AIGLit> leaves;
+    for(unsigned int k = nodes.size(); k-- > 0; ) {
+      unsigned int n = nodes[k];
+      if(!needed[n] || !_aig.IsAnd(n))
+	continue;
+      bool ite = AIGGate(_aig, _aig_satvar, fanout, n, leaves);
+      for(unsigned int j = 0; j < leaves.size(); j++)
+	needed[AIGMgr::Index(leaves[j])] = 1;
+      num_clauses += ite ? 6 : leaves.size() + 1;
+    }
+
+    BeginSATClauses(newS, num_clauses);
+
+    MINISAT::vec<MINISAT::Lit> c;
+    bool ok = true;
+    unsigned int num_gates = 0;
+    for(unsigned int k = 0; ok && k < nodes.size(); k++) {
+      unsigned int n = nodes[k];
+      if(!needed[n])
+	continue;
+      if(_aig.IsInput(n)) {
+	_aig_satvar[n] = 
+	  LookupOrCreateSATVar(newS, _aig_inputs[_aig.InputNumber(n)]);
+	continue;
+      }
+      bool ite = AIGGate(_aig, _aig_satvar, fanout, n, leaves);
+      MINISAT::Var x = newS.newVar();
+      _SATVar_to_AST.push_back(ASTUndefined);
+      _aig_satvar[n] = x;
+      num_gates++;
+
+      std::vector<MINISAT::Lit> l(leaves.size());
+      for(unsigned int j = 0; j < leaves.size(); j++)
+	l[j] = MINISAT::Lit(_aig_satvar[AIGMgr::Index(leaves[j])], 
+			    AIGMgr::IsNegated(leaves[j]));
+      if(ite) {
+	//y = ITE(c,t,e), the node is !y
+	MINISAT::Lit y = ~MINISAT::Lit(x);
+	MINISAT::Lit cl = l[0], t = l[1], e = l[2];
+	c.clear(); c.push(~cl); c.push(~t); c.push(y);
+	ok = ok && AddSATClause(newS, c);
+	c.clear(); c.push(~cl); c.push(t); c.push(~y);
+	ok = ok && AddSATClause(newS, c);
+	c.clear(); c.push(cl); c.push(~e); c.push(y);
+	ok = ok && AddSATClause(newS, c);
+	c.clear(); c.push(cl); c.push(e); c.push(~y);
+	ok = ok && AddSATClause(newS, c);
+	//redundant, but they help propagation. For XOR (t = !e) they
+	//are tautologies
+	if(t != ~e) {
+	  c.clear(); c.push(~t); c.push(~e); c.push(y);
+	  ok = ok && AddSATClause(newS, c);
+	  c.clear(); c.push(t); c.push(e); c.push(~y);
+	  ok = ok && AddSATClause(newS, c);
+	}
       }
+      else {
+	c.clear();
+	c.push(MINISAT::Lit(x));
+	for(unsigned int j = 0; j < l.size(); j++)
+	  c.push(~l[j]);
+	ok = ok && AddSATClause(newS, c);
+	for(unsigned int j = 0; ok && j < l.size(); j++) {
+	  c.clear(); c.push(~MINISAT::Lit(x)); c.push(l[j]);
+	  ok = AddSATClause(newS, c);
+	}
+      }
+    }
+    //a FALSE conjunct is an empty clause
+    for(unsigned int k = 0; ok && k < conjuncts.size(); k++) {
+      AIGLit a = conjuncts[k];
+      c.clear();
+      if(AIG_FALSE != a)
+	c.push(MINISAT::Lit(_aig_satvar[AIGMgr::Index(a)], AIGMgr::IsNegated(a)));
+      ok = AddSATClause(newS, c);
     }
 
+    //the nodes inside gates (and the rest, if UNSAT was found early)
+    //may need a variable in a later call
+    for(unsigned int k = 0; k < nodes.size(); k++)
+      if(-2 == _aig_satvar[nodes[k]])
+	_aig_satvar[nodes[k]] = -1;
+
+    if(stats)
+      cout << "AIG: " << _aig.NumAnds() << " AND nodes, " 
+	   << num_gates << " new gates, " << num_clauses << " clauses" << endl;
+    if(!ok) {
+      PrintStats(newS);
+      return false;
+    }
+
+    return SolveSATClauses(newS);
+  }
+
+  //solves the clauses given to newS so far
+  bool BeevMgr::SolveSATClauses(MINISAT::SimpSolver& newS) {
     // if input is UNSAT return false, else return true    
     if(!newS.simplify()) {
       PrintStats(newS);
@@ -112,8 +378,20 @@ namespace BEEV {
     
     //PrintActivityLevels_Of_SATVars("Before SAT:",newS);
     //ChangeActivityLevels_Of_SATVars(newS);
+    newS.restart_mode = sat_restart_mode;
+    newS.lbd_reduce = sat_lbd_reduce;
+    newS.phase_saving = sat_phase_saving;
+    newS.bin_minimize = sat_bin_minimize;
+    newS.inprocess_interval = sat_inprocess_interval;
+    SetPolarity_Of_SATVars(newS);
     //PrintActivityLevels_Of_SATVars("Before SAT and after initial bias:",newS); 
-    newS.solve();
+    //eliminate variables in the first call only. later calls (array
+    //refinements) just add clauses; an eliminated variable that shows
+    //up in them again has its clauses put back by the solver
+    if(sat_portfolio_threads > 1)
+      SolvePortfolio(newS);
+    else
+      newS.solve(true, true);
     //PrintActivityLevels_Of_SATVars("After SAT",newS);
 
     PrintStats(newS);
@@ -123,6 +401,224 @@ namespace BEEV {
       return false;
   }
 
+  void BeevMgr::AddPhaseHint(const char * arrayname, 
+			     const unsigned char * bytes, unsigned int length) {
+    if(!arrayname || !bytes)
+      return;
+    _phase_hints[arrayname] = std::string((const char *)bytes, length);
+  }
+
+  void BeevMgr::LoadPhaseHints(const char * filename) {
+    FILE * f = fopen(filename, "r");
+    if(!f) {
+      cerr << "Warning: cannot open phase hints file " << filename << endl;
+      return;
+    }
+
+    char name[1024];
+    while(fscanf(f, "%1023s", name) == 1) {
+      std::string bytes;
+      int c, hi = -1;
+      while((c = fgetc(f)) != EOF && c != '\n') {
+	int d;
+	if(c >= '0' && c <= '9')      d = c - '0';
+	else if(c >= 'a' && c <= 'f') d = c - 'a' + 10;
+	else if(c >= 'A' && c <= 'F') d = c - 'A' + 10;
+	else continue;
+	if(hi < 0)
+	  hi = d;
+	else {
+	  bytes += (char)((hi << 4) | d);
+	  hi = -1;
+	}
+      }
+      _phase_hints[name] = bytes;
+    }
+    fclose(f);
+  }
+
+  //this function makes MINISAT try the hinted (parent) value of every
+  //array-read bit first, so that a solution close to the parent input
+  //is found when there is one.
+  void BeevMgr::SetPolarity_Of_SATVars(MINISAT::Solver& newS) {
+    if(_phase_hints.empty())
+      return;
+
+    //symbolic constants introduced by TransformArray for reads at
+    //constant indices of hinted arrays -> hinted byte
+    hash_map<ASTNode, unsigned char, 
+      ASTNode::ASTNodeHasher, ASTNode::ASTNodeEqual> hinted;
+    ASTNodeMap::iterator it = _arrayread_symbol.begin();
+    ASTNodeMap::iterator itend = _arrayread_symbol.end();
+    for(; it != itend; it++) {
+      const ASTNode& read = it->first;
+      const ASTNode& sym = it->second;
+      if(READ != read.GetKind() || SYMBOL != sym.GetKind() ||
+	 SYMBOL != read[0].GetKind() || BVCONST != read[1].GetKind() ||
+	 8 != sym.GetValueWidth() || 32 < read[1].GetValueWidth())
+	continue;
+      std::map<std::string, std::string>::iterator h = 
+	_phase_hints.find(read[0].GetName());
+      if(h == _phase_hints.end())
+	continue;
+      unsigned int index = GetUnsignedConst(read[1]);
+      if(index >= h->second.size())
+	continue;
+      hinted[sym] = (unsigned char)h->second[index];
+    }
+    if(hinted.empty())
+      return;
+
+    newS.polarity_mode = MINISAT::Solver::polarity_user;
+    ASTtoSATMap::iterator vit = _ASTNode_to_SATVar.begin();
+    ASTtoSATMap::iterator vitend = _ASTNode_to_SATVar.end();
+    for(; vit != vitend; vit++) {
+      const ASTNode& n = vit->first;
+      if(BVGETBIT != n.GetKind())
+	continue;
+      hash_map<ASTNode, unsigned char, 
+	ASTNode::ASTNodeHasher, ASTNode::ASTNodeEqual>::iterator b = 
+	hinted.find(n[0]);
+      if(b == hinted.end())
+	continue;
+      unsigned int bit = GetUnsignedConst(n[1]);
+      //MINISAT polarity 'true' means the variable is tried as false
+      newS.setPolarity(vit->second, !((b->second >> bit) & 1));
+    }
+  }
+
+  struct PortfolioRace;
+
+  struct PortfolioWorker {
+    MINISAT::SimpSolver * solver;
+    int id;
+    bool started;
+    pthread_t thread;
+    PortfolioRace * race;
+  };
+
+  struct PortfolioRace {
+    pthread_mutex_t lock;
+    int winner;
+    std::vector<PortfolioWorker> workers;
+  };
+
+  //solves, and if this solver is the first one to reach an answer,
+  //stops the others
+  static void RunPortfolioWorker(PortfolioWorker * w) {
+    w->solver->solve(true, true);
+
+    PortfolioRace * race = w->race;
+    pthread_mutex_lock(&race->lock);
+    if(race->winner < 0 && 
+       (!w->solver->okay() || !w->solver->interrupted())) {
+      race->winner = w->id;
+      for(size_t i = 0; i < race->workers.size(); i++)
+	if(race->workers[i].started && (int)i != w->id)
+	  race->workers[i].solver->interrupt();
+    }
+    pthread_mutex_unlock(&race->lock);
+  }
+
+  static void * PortfolioThread(void * arg) {
+    RunPortfolioWorker((PortfolioWorker *) arg);
+    return NULL;
+  }
+
+  void BeevMgr::SolvePortfolio(MINISAT::SimpSolver& newS) {
+    PortfolioRace race;
+    pthread_mutex_init(&race.lock, NULL);
+    race.winner = -1;
+    race.workers.resize(sat_portfolio_threads);
+    for(size_t i = 0; i < race.workers.size(); i++) {
+      race.workers[i].id = i;
+      race.workers[i].started = (0 == i);
+      race.workers[i].race = &race;
+    }
+    race.workers[0].solver = &newS;
+
+    //the other solvers get the same clauses, and differ from newS in
+    //variable elimination (every other one), seed, polarity and
+    //restart strategy
+    bool simp_allowed = _portfolio_clauses.size() >= sat_simplify_min_size;
+    for(size_t i = 1; i < race.workers.size(); i++) {
+      MINISAT::SimpSolver * s = new MINISAT::SimpSolver();
+      race.workers[i].solver = s;
+      if(!simp_allowed || sat_simplify == (1 == i % 2))
+	s->eliminate(true);
+      for(int v = 0; v < newS.nVars(); v++) {
+	s->newVar();
+	if(s->use_simplification && !IsCNFVariable(_SATVar_to_AST[v]))
+	  s->setFrozen(v, true);
+      }
+      MINISAT::vec<MINISAT::Lit> c;
+      for(size_t j = 0; j < _portfolio_clauses.size(); j++) {
+	c.clear();
+	for(size_t k = 0; k < _portfolio_clauses[j].size(); k++)
+	  c.push(_portfolio_clauses[j][k]);
+	if(!s->addClause(c))
+	  break;
+      }
+
+      s->random_seed = 91648253 + 7919 * i;
+      SetPolarity_Of_SATVars(*s);
+      switch(i % 4) {
+      case 1:
+	s->restart_mode = MINISAT::Solver::restart_luby;
+	s->phase_saving = true;
+	s->lbd_reduce = true;
+	break;
+      case 2:
+	s->restart_mode = MINISAT::Solver::restart_glucose;
+	s->lbd_reduce = true;
+	s->polarity_mode = MINISAT::Solver::polarity_true;
+	break;
+      case 3:
+	s->polarity_mode = MINISAT::Solver::polarity_rnd;
+	s->random_var_freq = 0.05;
+	s->restart_first = 50;
+	break;
+      default:
+	s->restart_mode = MINISAT::Solver::restart_glucose;
+	s->phase_saving = true;
+	s->bin_minimize = true;
+	s->inprocess_interval = 5000;
+	break;
+      }
+    }
+
+    //newS runs in this thread
+    for(size_t i = 1; i < race.workers.size(); i++) {
+      pthread_mutex_lock(&race.lock);
+      race.workers[i].started = (race.winner < 0) &&
+	(0 == pthread_create(&race.workers[i].thread, NULL, 
+			     PortfolioThread, &race.workers[i]));
+      pthread_mutex_unlock(&race.lock);
+    }
+    RunPortfolioWorker(&race.workers[0]);
+    for(size_t i = 1; i < race.workers.size(); i++)
+      if(race.workers[i].started)
+	pthread_join(race.workers[i].thread, NULL);
+
+    int winner = race.winner;
+    if(winner > 0) {
+      MINISAT::SimpSolver * s = race.workers[winner].solver;
+      if(s->okay())
+	s->model.copyTo(newS.model);
+      else {
+	MINISAT::vec<MINISAT::Lit> empty;
+	newS.addClause(empty);
+      }
+    }
+    if(stats)
+      cerr << "Portfolio: solver " << winner << " finished first" << endl;
+
+    newS.clearInterrupt();
+    for(size_t i = 1; i < race.workers.size(); i++)
+      delete race.workers[i].solver;
+    pthread_mutex_destroy(&race.lock);
+  }
+
   // GLOBAL FUNCTION: Prints statistics from the MINISAT Solver   
   void BeevMgr::PrintStats(MINISAT::Solver& s) {
     if(!stats)
@@ -374,8 +870,12 @@ namespace BEEV {
       CounterExampleMap[var] = value;
     }
     
-    //In this loop, we compute the value of each array read, the
-    //corresponding ITE against the counterexample generated above.
+    ConstructArrayReadCounterExample();
+  } //End of ConstructCounterExample
+
+  //computes the value of each array read, the corresponding ITE
+  //against the counterexample constructed so far.
+  void BeevMgr::ConstructArrayReadCounterExample() {
     for(ASTNodeMap::iterator it=_arrayread_ite.begin(),itend=_arrayread_ite.end();
 	it!=itend;it++){
       //the array read
@@ -396,7 +896,7 @@ namespace BEEV {
       if(!CheckSubstitutionMap(key))
 	CounterExampleMap[key] = value;      
     }
-  } //End of ConstructCounterExample
+  } //End of ConstructArrayReadCounterExample
 
   // FUNCTION: accepts a non-constant term, and returns the
   // corresponding constant term with respect to a model. 
@@ -472,6 +972,13 @@ namespace BEEV {
 	return term;
       }
 
+      //unconstrained array reads keep the hinted value
+      ASTNodeMap::iterator h = _phase_hint_values.find(term);
+      if(h != _phase_hint_values.end()) {
+	output = h->second;
+	break;
+      }
+
       //when all else fails set symbol values to some constant by
       //default. if the variable is queried the second time then add 1
       //to and return the new value.
@@ -988,7 +1495,7 @@ namespace BEEV {
     ASTNode orig_input = q;
     ASTNodeStats("input asserts and query: ", q);
 
-    ASTNode newq = q;
+    ASTNode newq = RemoveConstIndexReads_TopLevel(q);
     //round of substitution, solving, and simplification. ensures that
     //DAG is minimized as much as possibly, and ideally should
     //garuntee that all liketerms in BVPLUSes have been combined.
@@ -997,32 +1504,45 @@ namespace BEEV {
     Begin_RemoveWrites = false;
     start_abstracting = false;    
     TermsAlreadySeenMap.clear();
+    //the memo tables are kept from round to round, so that each round
+    //only simplifies the cones changed by the previous one
+    BeginIncrementalSimplify();
     do {
       q = newq;
       newq = CreateSubstitutionMap(newq);
       //printf("##################################################\n");
       //ASTNodeStats("after pure substitution: ", newq);
-      newq = SimplifyFormula_TopLevel(newq,false);
+      newq = SimplifyFormula_Incremental(newq,false);
       //ASTNodeStats("after simplification: ", newq);
       newq = bvsolver.TopLevelBVSolve(newq);
       //ASTNodeStats("after solving: ", newq);      
-    }while(q!=newq);
+    }while(q!=newq && !SimplifyEffortExhausted());
+    //out of effort before the fixpoint. the variables solved in the
+    //last round must still be substituted
+    if(q!=newq)
+      newq = SimplifyFormula_Incremental(newq,false);
 
 
     ASTNodeStats("Before SimplifyWrites_Inplace begins: ", newq);
     SimplifyWrites_InPlace_Flag = true;
     Begin_RemoveWrites = false;
     start_abstracting = false;
-    TermsAlreadySeenMap.clear();
+    //VarSeenInTerm() depends on Begin_RemoveWrites alone, which has
+    //not changed
+    if(!Incremental_Simplify_Flag)
+      TermsAlreadySeenMap.clear();
+    InvalidateReadOverWrites();
     do {
       q = newq;
       newq = CreateSubstitutionMap(newq);
       //ASTNodeStats("after pure substitution: ", newq);
-      newq = SimplifyFormula_TopLevel(newq,false);
+      newq = SimplifyFormula_Incremental(newq,false);
       //ASTNodeStats("after simplification: ", newq);
       newq = bvsolver.TopLevelBVSolve(newq);
       //ASTNodeStats("after solving: ", newq);      
-    }while(q!=newq);
+    }while(q!=newq && !SimplifyEffortExhausted());
+    if(q!=newq)
+      newq = SimplifyFormula_Incremental(newq,false);
     ASTNodeStats("After SimplifyWrites_Inplace: ", newq);        
 
     start_abstracting = (arraywrite_refinement) ? true : false;
@@ -1033,12 +1553,15 @@ namespace BEEV {
     }
 
     TermsAlreadySeenMap.clear();
+    InvalidateReadOverWrites();
+    //not limited by the effort, all the writes must be removed (or
+    //abstracted)
     do {
       q = newq;
       //newq = CreateSubstitutionMap(newq);
       //Begin_RemoveWrites = true;
       //ASTNodeStats("after pure substitution: ", newq);
-      newq = SimplifyFormula_TopLevel(newq,false);
+      newq = SimplifyFormula_Incremental(newq,false);
       //ASTNodeStats("after simplification: ", newq);
       //newq = bvsolver.TopLevelBVSolve(newq);
       //ASTNodeStats("after solving: ", newq);
@@ -1047,17 +1570,30 @@ namespace BEEV {
     if(start_abstracting) {
       ASTNodeStats("After abstraction: ", newq);
     }
+    EndIncrementalSimplify();
     start_abstracting = false;
     SimplifyWrites_InPlace_Flag = false;
     Begin_RemoveWrites = false;    
     
+    ResolveConstIndexReadSymbols();
     newq = TransformFormula(newq);
     ASTNodeStats("after transformation: ", newq);
     TermsAlreadySeenMap.clear();
 
     int res;    
-    //solver instantiated here
-    MINISAT::Solver newS;
+    //most queries are decided by propagation alone, without
+    //bitblasting
+    if(optimize && presolve) {
+      res = CallPreSolver_ResultCheck(newq,orig_input);
+      if(2 != res) {
+	CountersAndStats("print_func_stats");
+	return res;
+      }
+    }
+
+    //solver instantiated here. variable elimination is switched on
+    //or off by toSATandSolve, depending on the size of the CNF
+    MINISAT::SimpSolver newS;
     if(arrayread_refinement) {
       counterexample_checking_during_refinement = true;
     }
@@ -1092,6 +1628,58 @@ namespace BEEV {
     return 2;
   } //End of TopLevelSAT
 
+  //Tries to decide q with the PreSolver. Returns 1 if q is UNSAT, 0
+  //if the model found by the PreSolver satisfies orig_input, and 2
+  //(the SAT solver must decide) otherwise
+  int BeevMgr::CallPreSolver_ResultCheck(const ASTNode& q, const ASTNode& orig_input) {
+    PreSolver presolver(this);
+    ASTNodeMap model;
+    int res = presolver.TopLevelPreSolve(q, _phase_hint_values, model);
+    if(0 == res) {
+      CounterExampleMap.clear();
+      CopySolverMap_To_CounterExample();
+      for(ASTNodeMap::iterator it = model.begin(), itend = model.end(); it != itend; it++)
+	CounterExampleMap[it->first] = it->second;
+      ConstructArrayReadCounterExample();
+
+      //the model is only good if it satisfies the original input
+      ComputeFormulaMap.clear();
+      if(counterexample_checking_during_refinement)
+	bvdiv_exception_occured = false;
+      if(ASTTrue != ComputeFormulaUsingModel(orig_input)) {
+	CounterExampleMap.clear();
+	res = 2;
+      }
+    }
+
+    _presolver_queries++;
+    if(2 != res)
+      _presolver_decided++;
+    if(stats) {
+      cout << "PreSolver: " << ((1 == res) ? "UNSAT" : (0 == res) ? "SAT" : "fallback to SAT solver")
+	   << " after " << presolver.propagations << " propagations and "
+	   << presolver.decisions << " decisions" << endl;
+      cout << "PreSolver: decided " << _presolver_decided << " of "
+	   << _presolver_queries << " queries ("
+	   << (100 * _presolver_decided / _presolver_queries) << "%), fell back on "
+	   << (_presolver_queries - _presolver_decided) << endl;
+    }
+
+    if(1 == res) {
+      CountersAndStats("PreSolver UNSAT");
+      PrintOutput(true);
+    }
+    else if(0 == res) {
+      CountersAndStats("PreSolver SAT");
+      PrintOutput(false);
+      PrintCounterExample(true);
+      PrintCounterExample_InOrder(true);
+    }
+    else
+      CountersAndStats("PreSolver fallback");
+    return res;
+  } //end of CallPreSolver_ResultCheck
+
   //go over the list of indices for each array, and generate Leibnitz
   //axioms. Then assert these axioms into the SAT solver. Check if the
   //addition of the new constraints has made the bogus counterexample
@@ -1108,7 +1696,7 @@ namespace BEEV {
   // This is not the most obvious way to do it, and I don't know how it 
   // compares with other approaches (e.g., one false axiom at a time or
   // all the false axioms each time).
-  int BeevMgr::SATBased_ArrayReadRefinement(MINISAT::Solver& newS, 
+  int BeevMgr::SATBased_ArrayReadRefinement(MINISAT::SimpSolver& newS, 
 					    const ASTNode& q, const ASTNode& orig_input) {
      //printf("doing array read refinement\n");
     if(!arrayread_refinement)
@@ -1162,8 +1750,10 @@ namespace BEEV {
 	  	  
 	  ASTNode arr_read2 = CreateTerm(READ, ArrName.GetValueWidth(), ArrName, compare_index);
 	  //get the variable corresponding to the array_read2
+	  //reads at constant indices may stand for any term, see
+	  //ResolveConstIndexReadSymbols
 	  ASTNode arrsym2 = _arrayread_symbol[arr_read2];
-	  if(!(SYMBOL == arrsym2.GetKind() || BVCONST == arrsym2.GetKind()))
+	  if(arrsym2.IsNull() || !is_Term_kind(arrsym2.GetKind()))
 	    FatalError("TopLevelSAT: refinement loop:"
 		       "term arrsym2 corresponding to READ must be a var", arrsym2);
 	  
@@ -1207,7 +1797,7 @@ namespace BEEV {
     return arraywrite_axiom;
   }//end of Create_ArrayWriteAxioms()
 
-  int BeevMgr::SATBased_ArrayWriteRefinement(MINISAT::Solver& newS, const ASTNode& orig_input) {
+  int BeevMgr::SATBased_ArrayWriteRefinement(MINISAT::SimpSolver& newS, const ASTNode& orig_input) {
     ASTNode writeAxiom;
     ASTNodeMap::iterator it = ReadOverWrite_NewName_Map.begin();
     ASTNodeMap::iterator itend = ReadOverWrite_NewName_Map.end();
@@ -1257,7 +1847,7 @@ namespace BEEV {
   //Check result after calling SAT FIXME: Document arguments in
   //comments, and give them meaningful names.  How is anyone supposed
   //to know what "q" is?
-  int BeevMgr::CallSAT_ResultCheck(MINISAT::Solver& newS, 
+  int BeevMgr::CallSAT_ResultCheck(MINISAT::SimpSolver& newS, 
 				   const ASTNode& q, const ASTNode& orig_input) {
     //Bitblast, CNF, call SAT now
     ASTNode BBFormula = BBForm(q);
@@ -382,6 +382,143 @@ namespace BEEV {
     return result;
   } //End of TransformTerm
 
+  //build symbolic name corresponding to array read. The symbolic
+  //name has 2 components: stringname, and a count
+  ASTNode BeevMgr::NewArrayReadSymbol(const ASTNode& read) {
+    // FIXME: get rid of the fixed-length buffer!
+    std::string c(read[0].GetName());
+    char d[32];
+    sprintf(d,"%d",_symbol_count++);
+    std::string ccc(d);
+    c += "array_" + ccc;
+
+    ASTNode symbol = CreateSymbol(c.c_str());
+    symbol.SetValueWidth(read.GetValueWidth());
+    symbol.SetIndexWidth(read.GetIndexWidth());
+    return symbol;
+  }
+
+  /* Reads at constant indices are by far the most common reads in
+   * the input (e.g. READ(file_x, 0hex0000001a)). This pass replaces
+   * each of them with a symbolic constant before the input is
+   * simplified, so that TransformArray and the read refinement deal
+   * only with non-constant indices.
+   *
+   * READ(WRITE(A,i,v),j) with constant i and j is resolved to v or to
+   * READ(A,j) on the way.
+   *
+   * The replacement READ(A,j) -> symbol is recorded in the
+   * SolverMap, so the simplifier maps any READ(A,j) that shows up
+   * later to the same symbol, and the counterexample still has an
+   * entry for READ(A,j). It is also recorded as an array-read symbol
+   * so that the Leibnitz axioms for non-constant reads of A cover it.
+   */
+  ASTNode BeevMgr::RemoveConstIndexReads_TopLevel(const ASTNode& form) {
+    if(!optimize)
+      return form;
+    ASTNodeMap memo;
+    return RemoveConstIndexReads(form, memo);
+  }
+
+  ASTNode BeevMgr::RemoveConstIndexReads(const ASTNode& n, ASTNodeMap& memo) {
+    Kind k = n.GetKind();
+    if(SYMBOL == k || BVCONST == k || TRUE == k || FALSE == k || 0 == n.Degree())
+      return n;
+
+    ASTNodeMap::iterator it;
+    if((it = memo.find(n)) != memo.end())
+      return it->second;
+
+    ASTVec c;
+    c.reserve(n.Degree());
+    bool changed = false;
+    for(ASTVec::const_iterator i = n.begin(), iend = n.end(); i != iend; i++) {
+      ASTNode ci = RemoveConstIndexReads(*i, memo);
+      changed |= (ci != *i);
+      c.push_back(ci);
+    }
+
+    ASTNode output = n;
+    if(changed) {
+      if(is_Term_kind(k)) {
+	output = CreateTerm(k, n.GetValueWidth(), c);
+	output.SetIndexWidth(n.GetIndexWidth());
+      }
+      else
+	output = CreateNode(k, c);
+    }
+
+    if(READ == k && BVCONST == output[1].GetKind())
+      output = ConstIndexReadSymbol(output);
+
+    memo[n] = output;
+    return output;
+  }
+
+  // READ(arr,index) with a constant index
+  ASTNode BeevMgr::ConstIndexReadSymbol(const ASTNode& read) {
+    ASTNode index = read[1];
+    ASTNode arr = read[0];
+    while(WRITE == arr.GetKind() && BVCONST == arr[1].GetKind()) {
+      if(arr[1] == index)
+	return arr[2];
+      arr = arr[0];
+    }
+    ASTNode term = read;
+    if(arr != read[0]) {
+      term = CreateTerm(READ, read.GetValueWidth(), arr, index);
+    }
+    if(SYMBOL != arr.GetKind())
+      return term;
+
+    ASTNode symbol;
+    if(CheckSubstitutionMap(term, symbol))
+      return symbol;
+
+    symbol = NewArrayReadSymbol(term);
+    SolverMap[term] = symbol;
+    _arrayread_symbol[term] = symbol;
+    _introduced_symbols.insert(symbol);
+    _arrayname_readindices[arr].push_back(index);
+
+    std::map<std::string, std::string>::iterator h = 
+      _phase_hints.find(arr.GetName());
+    if(h != _phase_hints.end() && 8 == symbol.GetValueWidth() &&
+       32 >= index.GetValueWidth() && GetUnsignedConst(index) < h->second.size()) {
+      unsigned char byte = h->second[GetUnsignedConst(index)];
+      _phase_hint_values[symbol] = CreateBVConst(8, byte);
+    }
+    return symbol;
+  }
+
+  // The symbols made by RemoveConstIndexReads are usually solved
+  // away by the simplifier (e.g. READ(A,j) = 0hex05). The Leibnitz
+  // axioms and the ITEs built by TransformArray refer to array reads
+  // through _arrayread_symbol, so it must point to what the symbol
+  // has been replaced with.
+  void BeevMgr::ResolveConstIndexReadSymbols() {
+    if(!optimize)
+      return;
+
+    ASTVec reads;
+    for(ASTNodeMap::iterator it = _arrayread_symbol.begin(), 
+	  itend = _arrayread_symbol.end(); it != itend; it++) {
+      ASTNode symbol = it->second;
+      if(SYMBOL == symbol.GetKind() && CheckSolverMap(symbol) &&
+	 _introduced_symbols.find(symbol) != _introduced_symbols.end())
+	reads.push_back(it->first);
+    }
+
+    SimplifyMap.clear();
+    SimplifyNegMap.clear();
+    for(ASTVec::iterator it = reads.begin(), itend = reads.end(); it != itend; it++) {
+      ASTNode value = TransformTerm(SimplifyTerm(_arrayread_symbol[*it]));
+      _arrayread_symbol[*it] = value;
+    }
+    SimplifyMap.clear();
+    SimplifyNegMap.clear();
+  }
+
   /* This function transforms Array Reads, Read over Writes, Read over
    * ITEs into flattened form.
    *
@@ -446,20 +583,7 @@ namespace BEEV {
 	}
 	else {
 	  // Make up a new abstract variable.
-	  // FIXME: Make this into a method (there already may BE a method) and
-	  // get rid of the fixed-length buffer!
-	  //build symbolic name corresponding to array read. The symbolic
-	  //name has 2 components: stringname, and a count
-	  const char * b = arrName.GetName();
-	  std::string c(b);
-	  char d[32];
-	  sprintf(d,"%d",_symbol_count++);
-	  std::string ccc(d);
-	  c += "array_" + ccc;
-	  
-	  CurrentSymbol = CreateSymbol(c.c_str());
-	  CurrentSymbol.SetValueWidth(processedTerm.GetValueWidth());
-	  CurrentSymbol.SetIndexWidth(processedTerm.GetIndexWidth());
+	  CurrentSymbol = NewArrayReadSymbol(processedTerm);
 	  _arrayread_symbol[processedTerm] = CurrentSymbol;	  
 	}
 	
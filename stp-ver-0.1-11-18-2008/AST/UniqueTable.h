@@ -0,0 +1,169 @@
+// -*- c++ -*-
+/********************************************************************
+ * AUTHORS: Avalanche contributors
+ *
+ * BEGIN DATE: October, 2026
+ *
+ * LICENSE: Please view LICENSE file in the home dir of this Program
+ ********************************************************************/
+
+#ifndef UNIQUETABLE_H
+#define UNIQUETABLE_H
+
+#include <stdlib.h>
+#include <string.h>
+
+namespace BEEV {
+  /***************************************************************************
+   * Class UniqueTable: open-addressing (linear probing) set of node
+   * pointers, used for the unique tables of BeevMgr.
+   *
+   * Slots are kept in one flat array together with the cached hash
+   * value, so a lookup usually touches a single cache line and
+   * comparisons against the stored nodes are done only when the hashes
+   * match. Lookups take a pointer to a (possibly stack-resident) key
+   * node, so that a node is allocated only when it is not in the table
+   * yet. Erase uses backward-shift deletion, so there are no tombstones.
+   *
+   * Only the unique tables use it. The memo maps (SimplifyMap,
+   * BBTermMemo, ...) stay on hash_map: their callers keep references
+   * to entries across insertions, which moving slots on growth would
+   * invalidate.
+   ***************************************************************************/
+  template <class T, class Hasher, class Equal>
+  class UniqueTable {
+  private:
+    struct Slot {
+      size_t hash;
+      T * ptr;
+    };
+
+    Slot * _slots;
+    size_t _mask;
+    size_t _size;
+    Hasher _hasher;
+    Equal _equal;
+
+    //mix the bits of the node hash, since the table index is taken
+    //from the low bits only
+    size_t Hash(const T * key) const {
+      size_t h = _hasher(key);
+      h ^= (h >> 16);
+      h *= 0x45d9f3b;
+      h ^= (h >> 16);
+      return h;
+    }
+
+    void Place(size_t h, T * ptr) {
+      size_t i = h & _mask;
+      while(_slots[i].ptr)
+	i = (i + 1) & _mask;
+      _slots[i].hash = h;
+      _slots[i].ptr = ptr;
+    }
+
+    void Grow() {
+      Slot * old = _slots;
+      size_t old_capacity = _mask + 1;
+      _mask = (old_capacity << 1) - 1;
+      _slots = (Slot *) calloc(_mask + 1, sizeof(Slot));
+      for(size_t i = 0; i < old_capacity; i++)
+	if(old[i].ptr)
+	  Place(old[i].hash, old[i].ptr);
+      free(old);
+    }
+
+    //not copyable
+    UniqueTable(const UniqueTable &);
+    UniqueTable & operator=(const UniqueTable &);
+
+  public:
+    UniqueTable(size_t initial_size) : _size(0) {
+      size_t capacity = 16;
+      while(capacity < (initial_size << 1))
+	capacity <<= 1;
+      _mask = capacity - 1;
+      _slots = (Slot *) calloc(capacity, sizeof(Slot));
+    }
+
+    ~UniqueTable() { free(_slots); }
+
+    //returns the node equal to key, or NULL if there is none
+    T * find(const T * key) const {
+      size_t h = Hash(key);
+      for(size_t i = h & _mask; _slots[i].ptr; i = (i + 1) & _mask)
+	if(_slots[i].hash == h && _equal(_slots[i].ptr, key))
+	  return _slots[i].ptr;
+      return NULL;
+    }
+
+    //ptr must not be in the table yet. load factor is kept below 1/2
+    void insert(T * ptr) {
+      if(((_size + 1) << 1) > _mask + 1)
+	Grow();
+      Place(Hash(ptr), ptr);
+      _size++;
+    }
+
+    //removes exactly this node (compared by address)
+    void erase(const T * ptr) {
+      size_t h = Hash(ptr);
+      size_t i = h & _mask;
+      while(_slots[i].ptr != ptr) {
+	if(!_slots[i].ptr)
+	  return;
+	i = (i + 1) & _mask;
+      }
+      //shift back the following entries of the cluster that would
+      //otherwise become unreachable
+      size_t j = i;
+      while(true) {
+	j = (j + 1) & _mask;
+	if(!_slots[j].ptr)
+	  break;
+	size_t k = _slots[j].hash & _mask;
+	if((j > i && (k <= i || k > j)) || (j < i && (k <= i && k > j))) {
+	  _slots[i] = _slots[j];
+	  i = j;
+	}
+      }
+      _slots[i].ptr = NULL;
+      _size--;
+    }
+
+    void clear() {
+      memset(_slots, 0, (_mask + 1) * sizeof(Slot));
+      _size = 0;
+    }
+
+    size_t size() const { return _size; }
+
+    //appends the nodes in the table to out
+    template <class V>
+    void elements(V & out) const {
+      for(size_t i = 0; i <= _mask; i++)
+	if(_slots[i].ptr)
+	  out.push_back(_slots[i].ptr);
+    }
+
+    //gives back the memory of a table that has become sparse, after
+    //most of its nodes were freed. the new capacity leaves room for
+    //the table to double before it grows again
+    void shrink() {
+      size_t capacity = 16;
+      while(capacity < (_size << 2))
+	capacity <<= 1;
+      if((capacity << 2) > _mask + 1)
+	return;
+      Slot * old = _slots;
+      size_t old_capacity = _mask + 1;
+      _mask = capacity - 1;
+      _slots = (Slot *) calloc(capacity, sizeof(Slot));
+      for(size_t i = 0; i < old_capacity; i++)
+	if(old[i].ptr)
+	  Place(old[i].hash, old[i].ptr);
+      free(old);
+    }
+  }; //End of UniqueTable
+}; // end namespace BEEV
+#endif
@@ -19,12 +19,146 @@ namespace BEEV {
   }
 
 #ifndef NATIVE_C_ARITH
+  //mask of the low width bits, 0 < width <= 64
+  static inline unsigned long long int WidthMask(unsigned int width) {
+    return (width < 64) ? ((1ULL << width) - 1) : ~0ULL;
+  }
+
+  //sign extends the width bit value c to 64 bits
+  static inline signed long long int SignExtend64(unsigned long long int c, unsigned int width) {
+    if(width < 64 && ((c >> (width-1)) & 1))
+      c |= ~WidthMask(width);
+    return (signed long long int) c;
+  }
+
+  bool BeevMgr::BVConstEvaluatorSmall(const ASTNode& t, ASTNode& output) {
+    Kind k = t.GetKind();
+    switch(k) {
+    case BVNEG: case BVSX: case BVAND: case BVOR: case BVXOR:
+    case BVSUB: case BVUMINUS: case BVEXTRACT: case BVCONCAT:
+    case BVMULT: case BVPLUS: case BVDIV: case BVMOD:
+    case EQ: case NEQ: case BVLT: case BVLE: case BVGT: case BVGE:
+    case BVSLT: case BVSLE: case BVSGT: case BVSGE:
+      break;
+    default:
+      return false;
+    }
+
+    //the result must fit as well (BVCONCAT, BVSX can be wider)
+    if(t.GetValueWidth() > 64)
+      return false;
+    const ASTVec& c = t.GetChildren();
+    for(ASTVec::const_iterator it=c.begin(),itend=c.end();it!=itend;it++)
+      if(it->GetValueWidth() > 64)
+	return false;
+
+    //BVEXTRACT and BVSX only evaluate their first child, the others
+    //are their widths and bounds
+    unsigned long long int a = BVConstEvaluator(t[0]).GetBVConstValue();
+    unsigned long long int b = 0;
+    if(c.size() > 1 && k != BVEXTRACT && k != BVSX)
+      b = BVConstEvaluator(t[1]).GetBVConstValue();
+
+    unsigned int width = t.GetValueWidth();
+    unsigned int w0 = t[0].GetValueWidth();
+    unsigned long long int value = 0;
+    switch(k) {
+    case BVNEG:
+      value = ~a;
+      break;
+    case BVSX:
+      value = (unsigned long long int) SignExtend64(a, w0);
+      break;
+    case BVAND:
+    case BVOR:
+    case BVXOR:
+    case BVMULT:
+    case BVPLUS: {
+      value = a;
+      for(unsigned int i = 1; i < c.size(); i++) {
+	unsigned long long int v = (1 == i) ? b : BVConstEvaluator(c[i]).GetBVConstValue();
+	switch(k) {
+	case BVAND:  value &= v; break;
+	case BVOR:   value |= v; break;
+	case BVXOR:  value ^= v; break;
+	case BVMULT: value *= v; break;
+	default:     value += v; break;
+	}
+      }
+      break;
+    }
+    case BVSUB:
+      value = a - b;
+      break;
+    case BVUMINUS:
+      value = -a;
+      break;
+    case BVEXTRACT: {
+      unsigned int hi = GetUnsignedConst(BVConstEvaluator(t[1]));
+      unsigned int low = GetUnsignedConst(BVConstEvaluator(t[2]));
+      width = hi - low + 1;
+      value = a >> low;
+      break;
+    }
+    case BVCONCAT:
+      value = (a << t[1].GetValueWidth()) | b;
+      break;
+    case BVDIV:
+    case BVMOD:
+      if(0 == b) {
+	//as in the CONSTANTBV version: 0 during refinement, an error
+	//otherwise
+	if(counterexample_checking_during_refinement) {
+	  bvdiv_exception_occured = true;
+	  value = 0;
+	  break;
+	}
+	FatalError("BVConstEvaluator: divide by zero not allowed:",t);
+      }
+      value = (BVDIV == k) ? a / b : a % b;
+      break;
+    case EQ:  output = (a == b)  ? ASTTrue : ASTFalse; return true;
+    case NEQ: output = (a != b)  ? ASTTrue : ASTFalse; return true;
+    case BVLT: output = (a < b)  ? ASTTrue : ASTFalse; return true;
+    case BVLE: output = (a <= b) ? ASTTrue : ASTFalse; return true;
+    case BVGT: output = (a > b)  ? ASTTrue : ASTFalse; return true;
+    case BVGE: output = (a >= b) ? ASTTrue : ASTFalse; return true;
+    case BVSLT: 
+      output = (SignExtend64(a,w0) < SignExtend64(b,w0)) ? ASTTrue : ASTFalse;
+      return true;
+    case BVSLE: 
+      output = (SignExtend64(a,w0) <= SignExtend64(b,w0)) ? ASTTrue : ASTFalse;
+      return true;
+    case BVSGT: 
+      output = (SignExtend64(a,w0) > SignExtend64(b,w0)) ? ASTTrue : ASTFalse;
+      return true;
+    case BVSGE: 
+      output = (SignExtend64(a,w0) >= SignExtend64(b,w0)) ? ASTTrue : ASTFalse;
+      return true;
+    default:
+      return false;
+    }
+
+    output = CreateBVConst(width, value & WidthMask(width));
+    return true;
+  }
+
   ASTNode BeevMgr::BVConstEvaluator(const ASTNode& t) {
     ASTNode OutputNode;
     Kind k = t.GetKind();
 
+    if(BVCONST == k)
+      return t;
+
     if(CheckSolverMap(t,OutputNode))
       return OutputNode;
+
+    //terms of at most 64 bits do not go through CONSTANTBV, so that
+    //nothing is allocated for them
+    if(BVConstEvaluatorSmall(t,OutputNode)) {
+      UpdateSolverMap(t,OutputNode);
+      return OutputNode;
+    }
     OutputNode = t;
 
     unsigned int inputwidth = t.GetValueWidth();
@@ -0,0 +1,59 @@
+/* g++ -I$(HOME)/stp/c_interface collect-garbage.c -L$(HOME)/lib -lstp -o cc*/
+
+#include <stdio.h>
+#include "c_interface.h"
+
+int main() {
+  VC vc = vc_createValidityChecker();
+  vc_setFlags('n');
+  vc_setFlags('d');
+  //vc_setFlags('v');
+  //vc_setFlags('s');
+
+  Type bv8 = vc_bvType(vc, 8);
+
+  // a and b are created once and must survive every collection
+  Expr a = vc_varExpr(vc, "a", bv8);
+  Expr b = vc_varExpr(vc, "b", bv8);
+  Expr ct_1 = vc_bvConstExprFromInt(vc, 8, 1);
+  Expr b_eq_a_plus_1 = vc_eqExpr(vc, b, vc_bvPlusExpr(vc, 8, a, ct_1));
+
+  int failures = 0;
+  int i;
+  for (i = 0; i < 300; i++) {
+    unsigned int value = i % 256;
+    vc_push(vc);
+    vc_assertFormula(vc, vc_eqExpr(vc, a, vc_bvConstExprFromInt(vc, 8, value)));
+    vc_assertFormula(vc, b_eq_a_plus_1);
+
+    // b = a + 1 follows from the asserts
+    Expr b_is_next =
+      vc_eqExpr(vc, b, vc_bvConstExprFromInt(vc, 8, (value + 1) % 256));
+    int query = vc_query(vc, b_is_next);
+    if (query != 1) {
+      printf("%d: query = %d, expected 1\n", i, query);
+      failures++;
+    }
+
+    // false is not valid, and the counterexample is the only model
+    query = vc_query(vc, vc_falseExpr(vc));
+    if (query != 0) {
+      printf("%d: query = %d, expected 0\n", i, query);
+      failures++;
+    }
+    unsigned int a_value = getBVUnsigned(vc_getCounterExample(vc, a));
+    unsigned int b_value = getBVUnsigned(vc_getCounterExample(vc, b));
+    if (a_value != value || b_value != (value + 1) % 256) {
+      printf("%d: counterexample a = %u, b = %u, expected %u, %u\n",
+	     i, a_value, b_value, value, (value + 1) % 256);
+      failures++;
+    }
+
+    vc_pop(vc);
+    vc_collectGarbage(vc);
+  }
+
+  printf("failures = %d\n", failures);
+  vc_Destroy(vc);
+  return failures != 0;
+}
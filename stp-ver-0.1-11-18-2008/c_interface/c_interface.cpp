@@ -21,6 +21,8 @@ typedef BEEV::BeevMgr* bmstar;
 typedef BEEV::ASTVec   nodelist;
 typedef BEEV::CompleteCounterExample* CompleteCEStar;
 BEEV::ASTVec *decls = NULL;
+//size of decls after vc_collectGarbage last removed the duplicates
+size_t decls_unique = 0;
 //vector<BEEV::ASTNode *> created_exprs;
 bool cinterface_exprdelete_on = false;
 
@@ -57,10 +59,16 @@ void vc_setFlags(char c) {
   case 'f':
     BEEV::smtlib_parser_enable = true;
     break;
+  case 'g':
+    BEEV::aig_bitblast = true;
+    break;
   case 'h':
     cout << helpstring;
     BEEV::FatalError("");
     break;
+  case 'j':
+    BEEV::incremental_simplify = false;
+    break;
   case 'l' :
     BEEV::linear_search = true;
     break;
@@ -79,6 +87,9 @@ void vc_setFlags(char c) {
   case 's' :
     BEEV::stats = true;
     break;
+  case 't':
+    BEEV::presolve = false;
+    break;
   case 'u':
     BEEV::arraywrite_refinement = true;
     break;  
@@ -115,10 +126,28 @@ VC vc_createValidityChecker(void) {
 #endif
   bmstar bm = new BEEV::BeevMgr();
   decls = new BEEV::ASTVec();
+  decls_unique = 0;
   //created_exprs.clear();
   return (VC)bm;
 }
 
+void vc_setSATFeatures(char* features) {
+  if(!BEEV::SetSATFeatures(features)) {
+    std::string s = "C_interface: vc_setSATFeatures: Unrecognized SAT solver feature in: ";
+    s += features;
+    BEEV::FatalError(s.c_str());
+  }
+}
+
+void vc_setSimplifyEffort(unsigned int nodes) {
+  BEEV::simplify_effort = nodes;
+}
+
+void vc_setPhaseHint(VC vc, char* arrayname, unsigned char* bytes, int length) {
+  bmstar b = (bmstar)vc;
+  b->AddPhaseHint(arrayname, bytes, length);
+}
+
 // Expr I/O
 void vc_printExpr(VC vc, Expr e) {
   //do not print in lisp mode
@@ -381,6 +410,24 @@ void vc_pop(VC vc) {
   b->Pop();
 }
 
+void vc_collectGarbage(VC vc) {
+  bmstar b = (bmstar)vc;
+  //vc_varExpr adds the variable every time it is called. the
+  //duplicates are removed once decls has doubled, so that this stays
+  //cheap when there are many distinct variables
+  if(decls->size() >= 2*decls_unique + 16) {
+    BEEV::ASTNodeSet seen;
+    BEEV::ASTVec unique_decls;
+    for(BEEV::ASTVec::iterator i = decls->begin(),iend=decls->end();i!=iend;i++) {
+      if(seen.insert(*i).second)
+	unique_decls.push_back(*i);
+    }
+    decls->swap(unique_decls);
+    decls_unique = decls->size();
+  }
+  b->CollectGarbage();
+}
+
 void vc_printCounterExample(VC vc) {
   bmstar b = (bmstar)vc;
   BEEV::print_counterexample = true;    
@@ -39,10 +39,25 @@ extern "C" {
   // h  : help
   // s  : stats
   // v  : print nodes
+  // g  : bitblast into an And-Inverter Graph
   void vc_setFlags(char c);
   
   //! Flags can be NULL
   VC vc_createValidityChecker(void);
+
+  //! Turns on features of the SAT solver, given as a comma separated
+  //! list: luby, glucose, lbd, phase, binmin, inprocess, simp,
+  //! simp=<min CNF size>, portfolio=<threads> or all
+  void vc_setSATFeatures(char* features);
+
+  //! Number of simplified nodes per query after which STP stops
+  //! substituting and solving, and goes on with the formula as it
+  //! is. 0 (the default) means no limit
+  void vc_setSimplifyEffort(unsigned int nodes);
+
+  //! Concrete bytes of an array, used as the initial SAT phase of the
+  //! bits read from it at constant indices
+  void vc_setPhaseHint(VC vc, char* arrayname, unsigned char* bytes, int length);
   
   // Basic types
   Type vc_boolType(VC vc);
@@ -184,6 +199,12 @@ extern "C" {
   
   //! Restore the current context to its state at the last checkpoint
   void vc_pop(VC vc);
+
+  //! Free the memory that STP keeps from the previous queries, so that
+  //! a long-lived vc stays at the same size. Call it between queries:
+  //! the counterexample of the last query is lost, and the ids
+  //! (getExprID) of the live expressions may change
+  void vc_collectGarbage(VC vc);
   
   //! Return an int from a constant bitvector expression
   int getBVInt(Expr e);
@@ -18,6 +18,7 @@
 #include <stdio.h>
 #include "../AST/AST.h"
 #include "parsePL_defs.h"
+#include "trace-reader.h"
 #include "../sat/core/Solver.h"
 #include "../sat/core/SolverTypes.h"
 //#include "../sat/VarOrder.h"
@@ -59,7 +60,8 @@ BEEV::ASTNode SingleBitZero;
  * step 5. Call SAT to determine if input is SAT or UNSAT
  ******************************************************************************/
 int main(int argc, char ** argv) {
-  char * infile;
+  char * infile = NULL;
+  char * phasefile = NULL;
   extern FILE *yyin;
 
   // Grab some memory from the OS upfront to reduce system time when individual
@@ -80,7 +82,13 @@ int main(int argc, char ** argv) {
   helpstring +=  "-d  : check counterexample\n";
   helpstring +=  "-p  : print counterexample\n";
   helpstring +=  "-x  : flatten nested XORs\n";
+  helpstring +=  "-g  : bitblast into an And-Inverter Graph (AIG)\n";
+  helpstring +=  "-t  : switch the propagation pre-solver off\n";
+  helpstring +=  "-j  : simplify the whole formula in every round of substitution and solving\n";
   helpstring +=  "-h  : help\n";
+  helpstring +=  "-i <file> : initial SAT phase from concrete array bytes in <file>\n";
+  helpstring +=  "-k <nodes> : stop the rounds of substitution and solving after simplifying <nodes> nodes\n";
+  helpstring +=  "-m <list> : SAT solver features, comma separated (luby, glucose, lbd, phase, binmin, inprocess, simp[=<min CNF size>], portfolio=<threads>, all)\n";
 
   for(int i=1; i < argc;i++) {
     if(argv[i][0] == '-')
@@ -105,15 +113,49 @@ int main(int argc, char ** argv) {
       case 'f':
 	BEEV::smtlib_parser_enable = true;
 	break;
+      case 'g':
+	BEEV::aig_bitblast = true;
+	break;
+      case 'i':
+	if(i + 1 >= argc) {
+	  fprintf(stderr,usage,prog);
+	  cout << helpstring;
+	  return -1;
+	}
+	phasefile = argv[++i];
+	break;
       case 'h':
 	fprintf(stderr,usage,prog);
 	cout << helpstring;
 	//BEEV::FatalError("");
 	return -1;
 	break;
+      case 'j':
+	BEEV::incremental_simplify = false;
+	break;
+      case 'k': {
+	char * rest = NULL;
+	if(i + 1 < argc)
+	  BEEV::simplify_effort = strtoul(argv[i + 1], &rest, 10);
+	if(NULL == rest || rest == argv[i + 1] || *rest != '\0') {
+	  fprintf(stderr,usage,prog);
+	  cout << helpstring;
+	  return -1;
+	}
+	i++;
+	break;
+      }
       case 'l' :
 	BEEV::linear_search = true;
 	break;
+      case 'm':
+	if(i + 1 >= argc || !BEEV::SetSATFeatures(argv[i + 1])) {
+	  fprintf(stderr,usage,prog);
+	  cout << helpstring;
+	  return -1;
+	}
+	i++;
+	break;
       case 'n':
 	BEEV::print_output = true;
 	break;
@@ -129,6 +171,9 @@ int main(int argc, char ** argv) {
       case 's' :
 	BEEV::stats = true;
 	break;
+      case 't':
+	BEEV::presolve = false;
+	break;
       case 'u':
 	BEEV::arraywrite_refinement = false;
 	break;
@@ -173,6 +218,23 @@ int main(int argc, char ** argv) {
   //want to print the output always from the commandline. 
   BEEV::print_output = true;
   BEEV::globalBeevMgr_for_parser = new BEEV::BeevMgr();  
+  if(phasefile)
+    BEEV::globalBeevMgr_for_parser->LoadPhaseHints(phasefile);
+
+  //Tracegrind traces are read by the fast reader. If the file is not
+  //one, start over with the general parser
+  if(infile && !BEEV::smtlib_parser_enable) {
+    {
+      BEEV::TraceReader reader(BEEV::globalBeevMgr_for_parser);
+      if(reader.Read(infile))
+	return 0;
+    }
+    BEEV::_parser_symbol_table.clear();
+    delete BEEV::globalBeevMgr_for_parser;
+    BEEV::globalBeevMgr_for_parser = new BEEV::BeevMgr();
+    if(phasefile)
+      BEEV::globalBeevMgr_for_parser->LoadPhaseHints(phasefile);
+  }
 
   SingleBitOne = BEEV::globalBeevMgr_for_parser->CreateOneConst(1);
   SingleBitZero = BEEV::globalBeevMgr_for_parser->CreateZeroConst(1);
@@ -0,0 +1,807 @@
+/********************************************************************
+ * AUTHORS: Avalanche contributors
+ *
+ * BEGIN DATE: October, 2026
+ *
+ * LICENSE: Please view LICENSE file in the home dir of this Program
+ ********************************************************************/
+// -*- c++ -*-
+
+#include "trace-reader.h"
+#include <string.h>
+#include <ctype.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+namespace BEEV {
+  //the precedences of the term operators, from the loosest to the
+  //tightest binding one, as declared in PL.y
+  enum {
+    PREC_CONCAT = 1,
+    PREC_BVOR,
+    PREC_BVAND,
+    PREC_BVNEG,
+    PREC_SHIFT,
+    PREC_WITH,
+    PREC_INDEX
+  };
+
+  //the keywords of PL.lex. No name may be one of them
+  static const char * const keywords[] = {
+    "ARRAY", "OF", "WITH", "AND", "NAND", "NOR", "NOT", "OR", "XOR",
+    "IF", "THEN", "ELSE", "ELSIF", "END", "ENDIF", "BV", "BITVECTOR",
+    "BOOLEAN", "BVPLUS", "BVSUB", "BVUMINUS", "BVMULT", "BVDIV", "BVMOD",
+    "SBVDIV", "SBVMOD", "SBVREM", "BVXOR", "BVNAND", "BVNOR", "BVXNOR",
+    "BVLT", "BVGT", "BVLE", "BVGE", "BVSLT", "BVSGT", "BVSLE", "BVSGE",
+    "BVSX", "SBVLT", "SBVGT", "SBVLE", "SBVGE", "SX", "BOOLEXTRACT",
+    "BOOLBV", "ASSERT", "QUERY", "FALSE", "TRUE", "IN", "LET",
+    "COUNTEREXAMPLE", "COUNTERMODEL", "PUSH", "POP", NULL
+  };
+
+  static bool WordIs(const char * p, size_t len, const char * kw) {
+    return 0 == strncmp(p, kw, len) && '\0' == kw[len];
+  }
+
+  static bool IsKeyword(const char * p, size_t len) {
+    //all the keywords are upper case, the generated names are not
+    if(!isupper((unsigned char)p[0]))
+      return false;
+    for(int i = 0; keywords[i]; i++)
+      if(WordIs(p, len, keywords[i]))
+	return true;
+    return false;
+  }
+
+  static bool IsNameChar(char c) {
+    return isalnum((unsigned char)c) || '\'' == c || '?' == c || '_' == c || '$' == c;
+  }
+
+  static int HexDigit(char c) {
+    if(c >= '0' && c <= '9')
+      return c - '0';
+    if(c >= 'a' && c <= 'f')
+      return c - 'a' + 10;
+    if(c >= 'A' && c <= 'F')
+      return c - 'A' + 10;
+    return -1;
+  }
+
+  //reads the number in [p, e) in the given base, as printed by
+  //Tracegrind: lower case, and no leading zeros. Other spellings are
+  //different names
+  static bool CanonicalNumber(const char * p, const char * e, unsigned int base,
+			      unsigned long long int& value) {
+    if(p == e || e - p > 16 || ('0' == *p && e - p > 1))
+      return false;
+    value = 0;
+    for(; p < e; p++) {
+      int d = HexDigit(*p);
+      if(d < 0 || d >= (int)base || (*p >= 'A' && *p <= 'F'))
+	return false;
+      value = value * base + d;
+    }
+    return true;
+  }
+
+  TraceReader::~TraceReader() {
+    if(_buf)
+      munmap((void *)_buf, _size);
+  }
+
+  void TraceReader::SkipSpace() {
+    while(_pos < _end) {
+      char c = *_pos;
+      if(' ' == c || '\n' == c || '\t' == c || '\r' == c || '\f' == c)
+	_pos++;
+      else if('%' == c) {
+	while(_pos < _end && '\n' != *_pos)
+	  _pos++;
+      }
+      else
+	break;
+    }
+  }
+
+  bool TraceReader::Accept(char c) {
+    SkipSpace();
+    if(_pos < _end && c == *_pos) {
+      _pos++;
+      return true;
+    }
+    return false;
+  }
+
+  bool TraceReader::Accept(const char * s) {
+    SkipSpace();
+    size_t len = strlen(s);
+    if((size_t)(_end - _pos) >= len && 0 == memcmp(_pos, s, len)) {
+      _pos += len;
+      return true;
+    }
+    return false;
+  }
+
+  size_t TraceReader::PeekWord() {
+    SkipSpace();
+    const char * p = _pos;
+    if(p >= _end)
+      return 0;
+    if(isalpha((unsigned char)*p))
+      p++;
+    else if('_' == *p && p + 1 < _end && IsNameChar(p[1]))
+      p += 2;
+    else
+      return 0;
+    while(p < _end && IsNameChar(*p))
+      p++;
+    return p - _pos;
+  }
+
+  bool TraceReader::AcceptKeyword(const char * kw) {
+    size_t len = PeekWord();
+    if(len && WordIs(_pos, len, kw)) {
+      _pos += len;
+      return true;
+    }
+    return false;
+  }
+
+  bool TraceReader::ReadNumeral(unsigned int& n) {
+    SkipSpace();
+    const char * p = _pos;
+    unsigned long long int value = 0;
+    while(p < _end && isdigit((unsigned char)*p)) {
+      value = value * 10 + (*p - '0');
+      if(value > 0xffffffffULL)
+	return false;
+      p++;
+    }
+    if(p == _pos || (p < _end && IsNameChar(*p)))
+      return false;
+    n = (unsigned int)value;
+    _pos = p;
+    return true;
+  }
+
+  //0hex, 0bin, 0h and 0b constants
+  bool TraceReader::ReadConst(ASTNode& out) {
+    SkipSpace();
+    const char * p = _pos;
+    size_t avail = _end - p;
+    unsigned int base;
+    if(avail > 4 && 0 == memcmp(p, "0hex", 4) && HexDigit(p[4]) >= 0) {
+      base = 16;
+      p += 4;
+    }
+    else if(avail > 4 && 0 == memcmp(p, "0bin", 4) && ('0' == p[4] || '1' == p[4])) {
+      base = 2;
+      p += 4;
+    }
+    else if(avail > 2 && 0 == memcmp(p, "0h", 2) && HexDigit(p[2]) >= 0) {
+      base = 16;
+      p += 2;
+    }
+    else if(avail > 2 && 0 == memcmp(p, "0b", 2) && ('0' == p[2] || '1' == p[2])) {
+      base = 2;
+      p += 2;
+    }
+    else
+      return false;
+
+    const char * digits = p;
+    unsigned long long int value = 0;
+    while(p < _end && HexDigit(*p) >= 0 && (16 == base || '0' == *p || '1' == *p)) {
+      value = (value * base) + HexDigit(*p);
+      p++;
+    }
+    unsigned int width = (p - digits) * ((16 == base) ? 4 : 1);
+    if(width <= 64)
+      out = _bm->CreateBVConst(width, value);
+    else {
+      _name.assign(digits, p - digits);
+      out = _bm->CreateBVConst(_name.c_str(), base);
+    }
+    _pos = p;
+    return true;
+  }
+
+  bool TraceReader::ReadType(unsigned int& indexwidth, unsigned int& valuewidth) {
+    if(AcceptKeyword("BOOLEAN")) {
+      indexwidth = valuewidth = 0;
+      return true;
+    }
+    indexwidth = 0;
+    if(AcceptKeyword("ARRAY")) {
+      if(!(AcceptKeyword("BITVECTOR") || AcceptKeyword("BV")) || !Accept('(') ||
+	 !ReadNumeral(indexwidth) || !Accept(')') || 0 == indexwidth ||
+	 !AcceptKeyword("OF"))
+	return false;
+    }
+    return (AcceptKeyword("BITVECTOR") || AcceptKeyword("BV")) && Accept('(') &&
+      ReadNumeral(valuewidth) && Accept(')') && 0 < valuewidth;
+  }
+
+  ASTNode * TraceReader::Slot(const char * name, size_t len, bool create) {
+    const char * end = name + len;
+    unsigned long long int n;
+    ASTVec * versions = NULL;
+    if(len > 2 && 0 == memcmp(name, "t_", 2)) {
+      const char * u1 = (const char *)memchr(name + 2, '_', end - name - 2);
+      const char * u2 = u1 ? (const char *)memchr(u1 + 1, '_', end - u1 - 1) : NULL;
+      unsigned long long int tmp, visit;
+      TempKey key;
+      if(u2 && CanonicalNumber(name + 2, u1, 16, key.block) &&
+	 CanonicalNumber(u1 + 1, u2, 10, tmp) && tmp <= 0xffffffffULL &&
+	 CanonicalNumber(u2 + 1, end, 10, visit) && visit <= 0xffffffffULL) {
+	key.tmp = (unsigned int)tmp;
+	key.visit = (unsigned int)visit;
+	if(create)
+	  return &_temps[key];
+	hash_map<TempKey, ASTNode, TempKeyHasher, TempKeyEqual>::iterator it = _temps.find(key);
+	return (it == _temps.end()) ? NULL : &it->second;
+      }
+    }
+    else if(len > 7 && 0 == memcmp(name, "memory_", 7) &&
+	    CanonicalNumber(name + 7, end, 10, n))
+      versions = &_memory;
+    else if(len > 10 && 0 == memcmp(name, "registers_", 10) &&
+	    CanonicalNumber(name + 10, end, 10, n))
+      versions = &_registers;
+
+    if(versions) {
+      //the versions are defined in order, so the vector is dense
+      if(n > versions->size() + 1000000)
+	return NULL;
+      if(n >= versions->size()) {
+	if(!create)
+	  return NULL;
+	versions->resize(n + 1);
+      }
+      return &(*versions)[n];
+    }
+
+    _name.assign(name, len);
+    if(create)
+      return &_names[_name];
+    hash_map<std::string, ASTNode, StringHasher>::iterator it = _names.find(_name);
+    return (it == _names.end()) ? NULL : &it->second;
+  }
+
+  //The checks of BeevMgr::BVTypeCheck, for the nodes the reader
+  //makes. BVTypeCheck stops the program on an error, while this only
+  //returns false, so that the general parser can take over
+  bool TraceReader::TypeCheck(const ASTNode& n) {
+    Kind k = n.GetKind();
+    if(!is_Term_kind(k)) {
+      if(!is_Form_kind(k) || BOOLEAN_TYPE != n.GetType())
+	return false;
+      switch(k) {
+      case EQ:
+      case NEQ:
+      case BVLT:
+      case BVLE:
+      case BVGT:
+      case BVGE:
+      case BVSLT:
+      case BVSLE:
+      case BVSGT:
+      case BVSGE:
+	if(EQ != k && NEQ != k &&
+	   (BITVECTOR_TYPE != n[0].GetType() || BITVECTOR_TYPE != n[1].GetType()))
+	  return false;
+	return n[0].GetValueWidth() == n[1].GetValueWidth() &&
+	  n[0].GetIndexWidth() == n[1].GetIndexWidth();
+      default:
+	return true;
+      }
+    }
+
+    switch(k) {
+    case SYMBOL:
+    case BVCONST:
+      return true;
+    case ITE:
+      return BOOLEAN_TYPE == n[0].GetType() &&
+	n[1].GetValueWidth() == n[2].GetValueWidth() &&
+	n[1].GetIndexWidth() == n[2].GetIndexWidth();
+    case READ:
+      return ARRAY_TYPE == n[0].GetType() && BITVECTOR_TYPE == n[1].GetType() &&
+	n[0].GetIndexWidth() == n[1].GetValueWidth();
+    case WRITE:
+      return ARRAY_TYPE == n[0].GetType() && BITVECTOR_TYPE == n[1].GetType() &&
+	BITVECTOR_TYPE == n[2].GetType() &&
+	n[0].GetIndexWidth() == n[1].GetValueWidth() &&
+	n[0].GetValueWidth() == n[2].GetValueWidth();
+    default:
+      break;
+    }
+
+    const ASTVec& v = n.GetChildren();
+    for(ASTVec::const_iterator it = v.begin(), itend = v.end(); it != itend; it++)
+      if(BITVECTOR_TYPE != it->GetType())
+	return false;
+    switch(k) {
+    case BVCONCAT:
+      return 2 == v.size() &&
+	n.GetValueWidth() == n[0].GetValueWidth() + n[1].GetValueWidth();
+    case BVSX:
+      return n[0].GetValueWidth() < n.GetValueWidth();
+    case BVOR:
+    case BVAND:
+    case BVXOR:
+    case BVNOR:
+    case BVNAND:
+    case BVXNOR:
+    case BVPLUS:
+    case BVMULT:
+    case BVDIV:
+    case BVMOD:
+    case BVSUB:
+    case SBVDIV:
+    case SBVREM:
+      if(v.size() < 2)
+	return false;
+      for(ASTVec::const_iterator it = v.begin(), itend = v.end(); it != itend; it++)
+	if(n.GetValueWidth() != it->GetValueWidth())
+	  return false;
+      return true;
+    default:
+      return true;
+    }
+  }
+
+  //name : Type;   or   name : Type = Expr;
+  bool TraceReader::ReadDeclaration() {
+    size_t len = PeekWord();
+    if(0 == len || IsKeyword(_pos, len))
+      return false;
+    const char * name = _pos;
+    _pos += len;
+
+    unsigned int indexwidth, valuewidth;
+    if(!Accept(':') || !ReadType(indexwidth, valuewidth))
+      return false;
+
+    ASTNode value;
+    if(Accept('=')) {
+      bool ok = (0 == indexwidth && 0 == valuewidth) ?
+	ReadFormula(value) : ReadTerm(value, PREC_CONCAT);
+      if(!ok)
+	return false;
+      if(!TypeCheck(value))
+	return false;
+      if(indexwidth != value.GetIndexWidth() || valuewidth != value.GetValueWidth())
+	return false;
+    }
+    else {
+      _name.assign(name, len);
+      value = _bm->CreateSymbol(_name.c_str());
+      value.SetIndexWidth(indexwidth);
+      value.SetValueWidth(valuewidth);
+      _parser_symbol_table.insert(value);
+      _bm->_special_print_set.push_back(value);
+    }
+    if(!Accept(';'))
+      return false;
+
+    ASTNode * slot = Slot(name, len, true);
+    if(NULL == slot || !slot->IsNull())
+      return false;
+    *slot = value;
+    return true;
+  }
+
+  //QUERY Formula;   and an optional COUNTEREXAMPLE; after it
+  bool TraceReader::ReadQuery() {
+    ASTNode q;
+    if(!ReadFormula(q) || !Accept(';'))
+      return false;
+    bool counterexample = false;
+    if(AcceptKeyword("COUNTEREXAMPLE") || AcceptKeyword("COUNTERMODEL")) {
+      if(!Accept(';'))
+	return false;
+      counterexample = true;
+    }
+    SkipSpace();
+    if(_pos != _end)
+      return false;
+
+    _bm->AddQuery(q);
+    ASTVec asserts = _bm->GetAsserts();
+    if(asserts.size() == 0)
+      _bm->TopLevelSAT(_bm->CreateNode(TRUE), q);
+    else if(asserts.size() == 1)
+      _bm->TopLevelSAT(asserts[0], q);
+    else
+      _bm->TopLevelSAT(_bm->CreateNode(AND, asserts), q);
+
+    if(counterexample) {
+      print_counterexample = true;
+      _bm->PrintCounterExample(true);
+    }
+    return true;
+  }
+
+  bool TraceReader::ReadFormula(ASTNode& out) {
+    SkipSpace();
+    const char * start = _pos;
+    if(Accept('(')) {
+      //a parenthesized formula, or a term in a comparison
+      if(ReadFormula(out) && Accept(')'))
+	return true;
+      _pos = start;
+      return ReadComparison(out);
+    }
+
+    size_t len = PeekWord();
+    if(0 == len)
+      return ReadComparison(out);
+    const char * w = _pos;
+    if(!IsKeyword(w, len)) {
+      ASTNode * slot = Slot(w, len, false);
+      if(slot && BOOLEAN_TYPE == slot->GetType()) {
+	_pos += len;
+	out = *slot;
+	return true;
+      }
+      return ReadComparison(out);
+    }
+
+    Kind k = UNDEFINED;
+    if(WordIs(w, len, "BVLT")) k = BVLT;
+    else if(WordIs(w, len, "BVGT")) k = BVGT;
+    else if(WordIs(w, len, "BVLE")) k = BVLE;
+    else if(WordIs(w, len, "BVGE")) k = BVGE;
+    else if(WordIs(w, len, "BVSLT") || WordIs(w, len, "SBVLT")) k = BVSLT;
+    else if(WordIs(w, len, "BVSGT") || WordIs(w, len, "SBVGT")) k = BVSGT;
+    else if(WordIs(w, len, "BVSLE") || WordIs(w, len, "SBVLE")) k = BVSLE;
+    else if(WordIs(w, len, "BVSGE") || WordIs(w, len, "SBVGE")) k = BVSGE;
+    if(UNDEFINED != k) {
+      _pos += len;
+      ASTNode a, b;
+      if(!Accept('(') || !ReadTerm(a, PREC_CONCAT) || !Accept(',') ||
+	 !ReadTerm(b, PREC_CONCAT) || !Accept(')'))
+	return false;
+      out = _bm->CreateNode(k, a, b);
+      if(!TypeCheck(out))
+	return false;
+      return true;
+    }
+
+    if(WordIs(w, len, "NOT")) {
+      _pos += len;
+      ASTNode a;
+      if(!ReadFormula(a))
+	return false;
+      out = _bm->CreateNode(NOT, a);
+      return true;
+    }
+    if(WordIs(w, len, "TRUE") || WordIs(w, len, "FALSE")) {
+      _pos += len;
+      out = _bm->CreateNode(('T' == *w) ? TRUE : FALSE);
+      out.SetIndexWidth(0);
+      out.SetValueWidth(0);
+      return true;
+    }
+    if(WordIs(w, len, "IF")) {
+      //an IF of formulas, or a term IF in a comparison
+      _pos += len;
+      ASTNode c, a, b;
+      if(ReadFormula(c) && AcceptKeyword("THEN") && ReadFormula(a) &&
+	 AcceptKeyword("ELSE") && ReadFormula(b) && AcceptKeyword("ENDIF")) {
+	out = _bm->CreateNode(ITE, c, a, b);
+	return true;
+      }
+      _pos = start;
+    }
+    return ReadComparison(out);
+  }
+
+  //Expr = Expr   or   Expr /= Expr
+  bool TraceReader::ReadComparison(ASTNode& out) {
+    ASTNode a, b;
+    if(!ReadTerm(a, PREC_CONCAT))
+      return false;
+    Kind k;
+    if(Accept("/="))
+      k = NEQ;
+    else if(_pos + 1 < _end && '=' == _pos[0] && '>' != _pos[1] && Accept('='))
+      k = EQ;
+    else
+      return false;
+    if(!ReadTerm(b, PREC_CONCAT))
+      return false;
+    out = _bm->CreateNode(k, a, b);
+    if(!TypeCheck(out))
+      return false;
+    return true;
+  }
+
+  bool TraceReader::ReadTerm(ASTNode& out, int prec) {
+    if(Accept('~')) {
+      ASTNode a;
+      if(!ReadTerm(a, PREC_SHIFT))
+	return false;
+      out = _bm->CreateTerm(BVNEG, a.GetValueWidth(), a);
+      if(!TypeCheck(out))
+	return false;
+    }
+    else if(!ReadPrimary(out))
+      return false;
+
+    while(true) {
+      SkipSpace();
+      if(_pos >= _end)
+	return true;
+      char c = *_pos;
+      if('[' == c && prec <= PREC_INDEX) {
+	_pos++;
+	const char * start = _pos;
+	unsigned int hi, lo;
+	if(ReadNumeral(hi) && Accept(':')) {
+	  //extraction
+	  if(!ReadNumeral(lo) || !Accept(']') || hi < lo || hi >= out.GetValueWidth())
+	    return false;
+	  ASTNode h = _bm->CreateBVConst(32, hi);
+	  ASTNode l = _bm->CreateBVConst(32, lo);
+	  out = _bm->CreateTerm(BVEXTRACT, hi - lo + 1, out, h, l);
+	}
+	else {
+	  //array read
+	  _pos = start;
+	  ASTNode index;
+	  if(!ReadTerm(index, PREC_CONCAT) || !Accept(']'))
+	    return false;
+	  out = _bm->CreateTerm(READ, out.GetValueWidth(), out, index);
+	}
+	if(!TypeCheck(out))
+	  return false;
+      }
+      else if(prec <= PREC_WITH && AcceptKeyword("WITH")) {
+	ASTNode index, value;
+	if(!Accept('[') || !ReadTerm(index, PREC_CONCAT) || !Accept(']') ||
+	   !Accept(":=") || !ReadTerm(value, PREC_INDEX))
+	  return false;
+	unsigned int indexwidth = out.GetIndexWidth();
+	out = _bm->CreateTerm(WRITE, out.GetValueWidth(), out, index, value);
+	out.SetIndexWidth(indexwidth);
+	if(!TypeCheck(out))
+	  return false;
+      }
+      else if(prec <= PREC_SHIFT && Accept("<<")) {
+	unsigned int n;
+	if(!ReadNumeral(n))
+	  return false;
+	ASTNode zero_bits = _bm->CreateZeroConst(n);
+	out = _bm->CreateTerm(BVCONCAT, out.GetValueWidth() + n, out, zero_bits);
+	if(!TypeCheck(out))
+	  return false;
+      }
+      else if(prec <= PREC_SHIFT && Accept(">>")) {
+	unsigned int n;
+	if(!ReadNumeral(n))
+	  return false;
+	unsigned int w = out.GetValueWidth();
+	if(n < w) {
+	  ASTNode len = _bm->CreateZeroConst(n);
+	  ASTNode hi = _bm->CreateBVConst(32, w - 1);
+	  ASTNode low = _bm->CreateBVConst(32, n);
+	  ASTNode extract = _bm->CreateTerm(BVEXTRACT, w - n, out, hi, low);
+	  out = _bm->CreateTerm(BVCONCAT, w, len, extract);
+	  if(!TypeCheck(out))
+	    return false;
+	}
+	else
+	  out = _bm->CreateZeroConst(w);
+      }
+      else if(('&' == c && prec <= PREC_BVAND) || ('|' == c && prec <= PREC_BVOR)) {
+	_pos++;
+	ASTNode b;
+	if(!ReadTerm(b, (('&' == c) ? PREC_BVAND : PREC_BVOR) + 1) ||
+	   out.GetValueWidth() != b.GetValueWidth())
+	  return false;
+	out = _bm->CreateTerm(('&' == c) ? BVAND : BVOR, out.GetValueWidth(), out, b);
+	if(!TypeCheck(out))
+	  return false;
+      }
+      else if('@' == c && prec <= PREC_CONCAT) {
+	_pos++;
+	ASTNode b;
+	if(!ReadTerm(b, PREC_CONCAT + 1))
+	  return false;
+	out = _bm->CreateTerm(BVCONCAT, out.GetValueWidth() + b.GetValueWidth(), out, b);
+	if(!TypeCheck(out))
+	  return false;
+      }
+      else
+	return true;
+    }
+  }
+
+  bool TraceReader::ReadTerms(ASTVec& out) {
+    do {
+      ASTNode a;
+      if(!ReadTerm(a, PREC_CONCAT))
+	return false;
+      if(!TypeCheck(a))
+	return false;
+      out.push_back(a);
+    } while(Accept(','));
+    return true;
+  }
+
+  bool TraceReader::ReadPrimary(ASTNode& out) {
+    SkipSpace();
+    if(_pos >= _end)
+      return false;
+    if('(' == *_pos) {
+      _pos++;
+      return ReadTerm(out, PREC_CONCAT) && Accept(')');
+    }
+    if(isdigit((unsigned char)*_pos))
+      return ReadConst(out);
+
+    size_t len = PeekWord();
+    if(0 == len)
+      return false;
+    const char * w = _pos;
+    _pos += len;
+    if(!IsKeyword(w, len)) {
+      ASTNode * slot = Slot(w, len, false);
+      if(NULL == slot || BOOLEAN_TYPE == slot->GetType())
+	return false;
+      out = *slot;
+      return true;
+    }
+
+    if(WordIs(w, len, "IF")) {
+      ASTNode c, a, b;
+      if(!ReadFormula(c) || !AcceptKeyword("THEN") || !ReadTerm(a, PREC_CONCAT) ||
+	 !AcceptKeyword("ELSE") || !ReadTerm(b, PREC_CONCAT) || !AcceptKeyword("ENDIF"))
+	return false;
+      if(a.GetValueWidth() != b.GetValueWidth() || a.GetIndexWidth() != b.GetIndexWidth())
+	return false;
+      if(!TypeCheck(c))
+	return false;
+      if(!TypeCheck(a))
+	return false;
+      if(!TypeCheck(b))
+	return false;
+      out = _bm->CreateTerm(ITE, a.GetValueWidth(), c, a, b);
+      out.SetIndexWidth(b.GetIndexWidth());
+      if(!TypeCheck(out))
+	return false;
+      return true;
+    }
+
+    if(WordIs(w, len, "BVPLUS")) {
+      unsigned int width;
+      ASTVec terms;
+      if(!Accept('(') || !ReadNumeral(width) || !Accept(',') ||
+	 !ReadTerms(terms) || !Accept(')'))
+	return false;
+      out = _bm->CreateTerm(BVPLUS, width, terms);
+      if(!TypeCheck(out))
+	return false;
+      return true;
+    }
+
+    //OP(width, a, b)
+    Kind k = UNDEFINED;
+    if(WordIs(w, len, "BVSUB")) k = BVSUB;
+    else if(WordIs(w, len, "BVMULT")) k = BVMULT;
+    else if(WordIs(w, len, "BVDIV")) k = BVDIV;
+    else if(WordIs(w, len, "BVMOD")) k = BVMOD;
+    else if(WordIs(w, len, "SBVDIV")) k = SBVDIV;
+    else if(WordIs(w, len, "SBVMOD") || WordIs(w, len, "SBVREM")) k = SBVREM;
+    if(UNDEFINED != k) {
+      unsigned int width;
+      ASTNode a, b;
+      if(!Accept('(') || !ReadNumeral(width) || !Accept(',') ||
+	 !ReadTerm(a, PREC_CONCAT) || !Accept(',') || !ReadTerm(b, PREC_CONCAT) ||
+	 !Accept(')'))
+	return false;
+      out = _bm->CreateTerm(k, width, a, b);
+      if(!TypeCheck(out))
+	return false;
+      return true;
+    }
+
+    //OP(a, b)
+    if(WordIs(w, len, "BVXOR")) k = BVXOR;
+    else if(WordIs(w, len, "BVNAND")) k = BVNAND;
+    else if(WordIs(w, len, "BVNOR")) k = BVNOR;
+    else if(WordIs(w, len, "BVXNOR")) k = BVXNOR;
+    if(UNDEFINED != k) {
+      ASTNode a, b;
+      if(!Accept('(') || !ReadTerm(a, PREC_CONCAT) || !Accept(',') ||
+	 !ReadTerm(b, PREC_CONCAT) || !Accept(')') ||
+	 a.GetValueWidth() != b.GetValueWidth())
+	return false;
+      out = _bm->CreateTerm(k, a.GetValueWidth(), a, b);
+      if(!TypeCheck(out))
+	return false;
+      return true;
+    }
+
+    if(WordIs(w, len, "BVUMINUS")) {
+      ASTNode a;
+      if(!Accept('(') || !ReadTerm(a, PREC_CONCAT) || !Accept(')'))
+	return false;
+      out = _bm->CreateTerm(BVUMINUS, a.GetValueWidth(), a);
+      if(!TypeCheck(out))
+	return false;
+      return true;
+    }
+
+    if(WordIs(w, len, "BVSX") || WordIs(w, len, "SX")) {
+      ASTNode a;
+      unsigned int width;
+      if(!Accept('(') || !ReadTerm(a, PREC_CONCAT) || !Accept(',') ||
+	 !ReadNumeral(width) || !Accept(')'))
+	return false;
+      if(!TypeCheck(a))
+	return false;
+      if(a.GetValueWidth() == width) {
+	out = a;
+	return true;
+      }
+      out = _bm->CreateTerm(BVSX, width, a, _bm->CreateBVConst(32, width));
+      if(!TypeCheck(out))
+	return false;
+      return true;
+    }
+
+    if(WordIs(w, len, "BOOLBV")) {
+      ASTNode f;
+      if(!Accept('(') || !ReadFormula(f) || !Accept(')'))
+	return false;
+      if(!TypeCheck(f))
+	return false;
+      out = _bm->CreateTerm(ITE, 1, f, _bm->CreateBVConst(1, 1), _bm->CreateBVConst(1, 0));
+      return true;
+    }
+
+    return false;
+  }
+
+  bool TraceReader::Read(const char * filename) {
+    int fd = open(filename, O_RDONLY);
+    if(fd < 0)
+      return false;
+    struct stat st;
+    if(0 != fstat(fd, &st) || !S_ISREG(st.st_mode) || 0 == st.st_size) {
+      close(fd);
+      return false;
+    }
+    void * p = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if(MAP_FAILED == p)
+      return false;
+    madvise(p, st.st_size, MADV_SEQUENTIAL);
+    _buf = (const char *)p;
+    _size = st.st_size;
+    _pos = _buf;
+    _end = _buf + _size;
+
+    bool statements = false;
+    while(true) {
+      SkipSpace();
+      if(_pos >= _end)
+	return statements;
+      statements = true;
+      if(AcceptKeyword("ASSERT")) {
+	ASTNode a;
+	if(!ReadFormula(a) || !Accept(';'))
+	  return false;
+	_bm->AddAssert(a);
+      }
+      else if(AcceptKeyword("QUERY"))
+	return ReadQuery();
+      else if(!ReadDeclaration())
+	return false;
+    }
+  }
+};//end of namespace BEEV
@@ -0,0 +1,144 @@
+/********************************************************************
+ * AUTHORS: Avalanche contributors
+ *
+ * BEGIN DATE: October, 2026
+ *
+ * LICENSE: Please view LICENSE file in the home dir of this Program
+ ********************************************************************/
+// -*- c++ -*-
+
+#ifndef TRACE_READER_H
+#define TRACE_READER_H
+
+#include "../AST/AST.h"
+#include <string>
+namespace BEEV {
+
+  //This class reads the traces of Tracegrind, which are the bulk of
+  //the input of STP in Avalanche, much faster than the general parser
+  //(PL.lex/PL.y).
+  //
+  //It knows the subset of the CVC language that Tracegrind emits:
+  //declarations (with or without a defining expression), ASSERT,
+  //QUERY and COUNTEREXAMPLE; bitvector terms with array reads, WITH
+  //updates, IF-THEN-ELSE, extraction, shifts, the bitwise and
+  //arithmetic operators; and formulas made of comparisons, =, /= and
+  //NOT.
+  //
+  //1. The file is mapped into memory and tokenized in place, without
+  //1. copying it.
+  //
+  //2. The names Tracegrind generates are interned by their numeric
+  //2. parts: the temporaries t_<block>_<tmp>_<visit> by a hash of the
+  //2. three numbers, the versions memory_N and registers_N by N in a
+  //2. vector. Only the other names (file_*, socket_*) are hashed as
+  //2. strings.
+  //
+  //3. Every ASSERT goes to the BeevMgr as soon as it is read. The
+  //3. query is solved when QUERY is read, as by the general parser.
+  //
+  //On anything outside the subset, the reader gives up before the
+  //query is solved. The caller must then start over with the general
+  //parser (and a new BeevMgr), which also reports the syntax and type
+  //errors.
+  class TraceReader {
+  private:
+    //a temporary t_<block>_<tmp>_<visit>
+    struct TempKey {
+      unsigned long long int block;
+      unsigned int tmp;
+      unsigned int visit;
+    };
+
+    struct TempKeyHasher {
+      size_t operator() (const TempKey& k) const {
+	return (size_t) (k.block * 1000003 + k.tmp * 10007 + k.visit);
+      }
+    };
+
+    struct TempKeyEqual {
+      bool operator() (const TempKey& k1, const TempKey& k2) const {
+	return k1.block == k2.block && k1.tmp == k2.tmp && k1.visit == k2.visit;
+      }
+    };
+
+    struct StringHasher {
+      size_t operator() (const std::string& s) const {
+	return hash<const char *>()(s.c_str());
+      }
+    };
+
+    //Ptr to toplevel manager that manages bit-vector expressions
+    BeevMgr * _bm;
+
+    //the mapped file, and the position of the next character to read
+    const char * _buf;
+    size_t _size;
+    const char * _pos;
+    const char * _end;
+
+    //MAP: temporary -> its symbol
+    hash_map<TempKey, ASTNode, TempKeyHasher, TempKeyEqual> _temps;
+
+    //the definitions of memory_N and registers_N, by N
+    ASTVec _memory;
+    ASTVec _registers;
+
+    //MAP: any other name -> its symbol or definition
+    hash_map<std::string, ASTNode, StringHasher> _names;
+
+    //scratch space for names
+    std::string _name;
+
+    //skips white space and comments
+    void SkipSpace();
+
+    //consumes the character c or the operator s, if it is next
+    bool Accept(char c);
+    bool Accept(const char * s);
+
+    //scans the next identifier or keyword (without consuming it).
+    //returns its length, 0 if the next token is not a word
+    size_t PeekWord();
+
+    //consumes the keyword kw, if it is next
+    bool AcceptKeyword(const char * kw);
+
+    bool ReadNumeral(unsigned int& n);
+    bool ReadConst(ASTNode& out);
+    bool ReadType(unsigned int& indexwidth, unsigned int& valuewidth);
+
+    //the slot of name in the tables above. returns NULL if the name
+    //cannot be interned (for a redefinition of memory_N, say)
+    ASTNode * Slot(const char * name, size_t len, bool create);
+
+    //type checks a node the reader has made. returns false where
+    //BeevMgr::BVTypeCheck would stop the program
+    bool TypeCheck(const ASTNode& n);
+
+    //the statements
+    bool ReadDeclaration();
+    bool ReadQuery();
+
+    //formulas and terms. A term is parsed by precedence climbing:
+    //only the operators that bind at least as tightly as prec (see
+    //PL.y) are parsed
+    bool ReadFormula(ASTNode& out);
+    bool ReadComparison(ASTNode& out);
+    bool ReadTerm(ASTNode& out, int prec);
+    bool ReadPrimary(ASTNode& out);
+    bool ReadTerms(ASTVec& out);
+
+  public:
+    //constructor
+    TraceReader(BeevMgr * bm) : _bm(bm), _buf(NULL), _size(0),
+				_pos(NULL), _end(NULL) {};
+    ~TraceReader();
+
+    //Reads the file, and solves its query. Returns false if the file
+    //could not be mapped or is not a Tracegrind trace; the query has
+    //not been solved then.
+    bool Read(const char * filename);
+  }; //end of class TraceReader
+};//end of namespace BEEV
+#endif
@@ -21,6 +21,7 @@ OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWA
 #define Solver_h
 
 #include <cstdio>
+#include <cmath>
 
 #include "Map.h"
 #include "Vec.h"
@@ -103,6 +104,9 @@ public:
     bool    solve        (const vec<Lit>& assumps); // Search for a model that respects a given set of assumptions.
     bool    solve        ();                        // Search without assumptions.
     bool    okay         () const;                  // FALSE means solver is in a conflicting state
+    void    interrupt    ();                        // Make a running 'solve()' give up as soon as possible (may be called from another thread).
+    void    clearInterrupt();                       // Allow 'solve()' to run again after an interrupt.
+    bool    interrupted  () const;                  // TRUE if the last 'solve()' gave up because of an interrupt.
 
     // Variable mode:
     // 
@@ -137,8 +141,15 @@ public:
     bool      expensive_ccmin;    // Controls conflict clause minimization.                                                    (default TRUE)
     int       polarity_mode;      // Controls which polarity the decision heuristic chooses. See enum below for allowed modes. (default polarity_false)
     int       verbosity;          // Verbosity level. 0=silent, 1=some progress report                                         (default 0)
+    int       restart_mode;       // Controls the restart strategy. See enum below for allowed modes.                          (default restart_geometric)
+    bool      lbd_reduce;         // Rank learnt clauses by their LBD (number of decision levels) when reducing the database.  (default false)
+    bool      phase_saving;       // Decisions reuse the polarity a variable was last assigned. Overrides 'polarity_mode'.     (default false)
+    bool      bin_minimize;       // Further minimize short learnt clauses by resolution with binary clauses.                  (default false)
+    int       inprocess_interval; // Conflicts between rounds of learnt clause subsumption and vivification. 0=off.            (default 0)
+    double    random_seed;        // Used by the random variable selection. Must never be 0.                                  (default 91648253)
 
     enum { polarity_true = 0, polarity_false = 1, polarity_user = 2, polarity_rnd = 3 };
+    enum { restart_geometric = 0, restart_luby = 1, restart_glucose = 2 };
 
     // Statistics: (read-only member variable)
     //
@@ -183,9 +194,16 @@ protected:
     int64_t             simpDB_props;     // Remaining number of propagations that must be made before next execution of 'simplify()'.
     vec<Lit>            assumptions;      // Current set of assumptions provided to solve by the user.
     Heap<VarOrderLt>    order_heap;       // A priority queue of variables ordered with respect to the variable activity.
-    double              random_seed;      // Used by the random variable selection.
     double              progress_estimate;// Set by 'search()'.
     bool                remove_satisfied; // Indicates whether possibly inefficient linear scan for satisfied clauses should be performed in 'simplify'.
+    volatile bool       asynch_interrupt; // Set by 'interrupt()', checked by 'search()'.
+    bool                was_interrupted;  // Set if the last 'solve()' gave up because of an interrupt.
+    vec<int>            lbd_queue;        // LBDs of the most recent learnt clauses (ring buffer, used by 'restart_glucose').
+    int                 lbd_queue_head;   // Next position to overwrite in 'lbd_queue'.
+    int                 lbd_queue_sum;    // Sum of the LBDs in 'lbd_queue'.
+    double              lbd_sum;          // Sum of the LBDs of all learnt clauses.
+    uint64_t            lbd_count;        // Number of learnt clauses summed in 'lbd_sum'.
+    int                 vivify_next;      // Index in 'learnts' where the next round of vivification starts.
 
 
     // Temporaries (to reduce allocation overhead). Each variable is prefixed by the method in which it is
@@ -195,6 +213,9 @@ protected:
     vec<Lit>            analyze_stack;
     vec<Lit>            analyze_toclear;
     vec<Lit>            add_tmp;
+    vec<uint32_t>       lbd_stamp;
+    uint32_t            lbd_stamp_cur;
+    vec<Lit>            vivify_tmp;
 
     // Main internal methods:
     //
@@ -211,6 +232,13 @@ protected:
     lbool    search           (int nof_conflicts, int nof_learnts);                    // Search for a given number of conflicts.
     void     reduceDB         ();                                                      // Reduce the set of learnt clauses.
     void     removeSatisfied  (vec<Clause*>& cs);                                      // Shrink 'cs' to contain only non-satisfied clauses.
+    template<class V>
+    int      computeLBD       (const V& ps);                                           // Number of distinct decision levels among the literals of 'ps'.
+    void     binMinimize      (vec<Lit>& out_learnt);                                  // Remove literals implied false by a binary clause with the asserting literal.
+    bool     glucoseRestart   ();                                                      // TRUE if recent learnt clauses are worse than average ('restart_glucose').
+    bool     inprocess        ();                                                      // Subsume and vivify the learnt clauses. Returns FALSE if the problem became UNSAT.
+    void     subsumeLearnts   ();                                                      // Remove learnt clauses subsumed by some other clause.
+    bool     vivifyLearnts    ();                                                      // Shorten learnt clauses by propagating the negation of their literals.
 
     // Maintaining Variable/Clause activity:
     //
@@ -253,6 +281,16 @@ protected:
     // Returns a random integer 0 <= x < size. Seed must never be 0.
     static inline int irand(double& seed, int size) {
         return (int)(drand(seed) * size); }
+
+    // Returns the x:th element of the Luby sequence scaled by powers of y (y = 2 gives 1 1 2 1 1 2 4 ...).
+    static inline double luby(double y, int x) {
+        int size, seq;
+        for (size = 1, seq = 0; size < x+1; seq++, size = 2*size+1);
+        while (size-1 != x){
+            size = (size-1)>>1;
+            seq--;
+            x = x % size; }
+        return pow(y, seq); }
 };
 
 
@@ -286,6 +324,21 @@ inline bool     Solver::enqueue         (Lit p, Clause* from)   { return value(p
 inline bool     Solver::locked          (const Clause& c) const { return reason[var(c[0])] == &c && value(c[0]) == l_True; }
 inline void     Solver::newDecisionLevel()                      { trail_lim.push(trail.size()); }
 
+template<class V>
+inline int Solver::computeLBD(const V& ps) {
+    if (++lbd_stamp_cur == 0){
+        // Stamp wrapped around:
+        for (int i = 0; i < lbd_stamp.size(); i++) lbd_stamp[i] = 0;
+        lbd_stamp_cur = 1; }
+    lbd_stamp.growTo(decisionLevel() + 1, 0);
+    int nblevels = 0;
+    for (int i = 0; i < ps.size(); i++){
+        int l = level[var(ps[i])];
+        if (lbd_stamp[l] != lbd_stamp_cur){
+            lbd_stamp[l] = lbd_stamp_cur;
+            nblevels++; } }
+    return nblevels; }
+
 inline int      Solver::decisionLevel ()      const   { return trail_lim.size(); }
 inline uint32_t Solver::abstractLevel (Var x) const   { return 1 << (level[x] & 31); }
 inline lbool    Solver::value         (Var x) const   { return toLbool(assigns[x]); }
@@ -299,6 +352,9 @@ inline void     Solver::setPolarity   (Var v, bool b) { polarity    [v] = (char)
 inline void     Solver::setDecisionVar(Var v, bool b) { decision_var[v] = (char)b; if (b) { insertVarOrder(v); } }
 inline bool     Solver::solve         ()              { vec<Lit> tmp; return solve(tmp); }
 inline bool     Solver::okay          ()      const   { return ok; }
+inline void     Solver::interrupt     ()              { asynch_interrupt = true; }
+inline void     Solver::clearInterrupt()              { asynch_interrupt = false; }
+inline bool     Solver::interrupted   ()      const   { return was_interrupted; }
 
 
 
@@ -102,6 +102,7 @@ const lbool l_Undef = toLbool( 0);
 
 class Clause {
     uint32_t size_etc;
+    uint32_t nblevels;
     union { float act; uint32_t abst; } extra;
     Lit     data[0];
 
@@ -116,6 +117,7 @@ public:
     template<class V>
     Clause(const V& ps, bool learnt) {
         size_etc = (ps.size() << 3) | (uint32_t)learnt;
+        nblevels = ps.size();
         for (int i = 0; i < ps.size(); i++) data[i] = ps[i];
         if (learnt) extra.act = 0; else calcAbstraction(); }
 
@@ -142,6 +144,8 @@ public:
     operator const Lit* (void) const         { return data; }
 
     float&       activity    ()              { return extra.act; }
+    uint32_t     lbd         ()      const   { return nblevels; }
+    void         lbd         (uint32_t l)    { nblevels = l; }
     uint32_t     abstraction () const { return extra.abst; }
 
     Lit          subsumes    (const Clause& other) const;
@@ -147,6 +147,7 @@ namespace BEEV {
     ASTNode var = (BVEXTRACT == key.GetKind()) ? key[0] : key;
     if(!CheckSolverMap(var) && key != value) {
       SolverMap[key] = value;
+      InvalidateSimplifyCone(key);
       return true;
     }  
     return false;
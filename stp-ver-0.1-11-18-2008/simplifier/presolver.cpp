@@ -0,0 +1,998 @@
+/********************************************************************
+ * AUTHORS: Avalanche contributors
+ *
+ * BEGIN DATE: October, 2026
+ *
+ * LICENSE: Please view LICENSE file in the home dir of this Program
+ ********************************************************************/
+// -*- c++ -*-
+
+#include "../AST/AST.h"
+#include "../AST/ASTUtil.h"
+#include "presolver.h"
+
+  //This file contains the implementation of the PreSolver class, an
+  //interval and known-bits propagator that decides the simple
+  //queries without the SAT solver. Refer presolver.h for the
+  //description of the algorithm.
+  //
+  //All the rules below over-approximate: the domain computed for a
+  //node contains every value it can take in a model. UNSAT answers
+  //therefore rely only on the rules being sound, and models are
+  //checked against the original input by the caller.
+namespace BEEV {
+  //the pre-solver must stay cheap compared to bitblasting. larger
+  //formulas go to the SAT solver directly, and the propagation is
+  //stopped after PRESOLVER_EFFORT revisions per node
+  static const unsigned int MAX_PRESOLVER_NODES = 100000;
+  static const unsigned int PRESOLVER_EFFORT = 64;
+
+  typedef PreSolver::Value Value;
+  typedef PreSolver::Domain Domain;
+
+  static inline Value Mask(unsigned int w) {
+    return (w >= 64) ? ~0ULL : ((1ULL << w) - 1);
+  }
+
+  static inline Value Min(Value a, Value b) {
+    return (a < b) ? a : b;
+  }
+
+  static inline Value Max(Value a, Value b) {
+    return (a > b) ? a : b;
+  }
+
+  static Domain Full(unsigned int w) {
+    Domain d = {0, Mask(w), 0, 0};
+    return d;
+  }
+
+  static Domain Fixed(Value v, unsigned int w) {
+    Domain d = {v, v, Mask(w) & ~v, v};
+    return d;
+  }
+
+  static Domain FromBits(Value zeros, Value ones, unsigned int w) {
+    Domain d = {ones, Mask(w) & ~zeros, zeros, ones};
+    return d;
+  }
+
+  //the empty domain
+  static Domain Empty(unsigned int w) {
+    Domain d = {Mask(w), 0, 0, 0};
+    return d;
+  }
+
+  static inline bool IsFixed(const Domain& d) {
+    return d.lo == d.hi;
+  }
+
+  static inline bool Contains(const Domain& d, Value v) {
+    return d.lo <= v && v <= d.hi && !(v & d.zeros) && (v & d.ones) == d.ones;
+  }
+
+  //true if no value is in both a and b (not complete)
+  static inline bool Disjoint(const Domain& a, const Domain& b) {
+    return a.hi < b.lo || b.hi < a.lo || (a.ones & b.zeros) || (a.zeros & b.ones);
+  }
+
+  static inline bool Same(const Domain& a, const Domain& b) {
+    return a.lo == b.lo && a.hi == b.hi && a.zeros == b.zeros && a.ones == b.ones;
+  }
+
+  static Domain Hull(const Domain& a, const Domain& b) {
+    Domain d = {Min(a.lo, b.lo), Max(a.hi, b.hi), a.zeros & b.zeros, a.ones & b.ones};
+    return d;
+  }
+
+  //sets v to the smallest value >= x with the known bits. returns
+  //false if there is none
+  static bool MinAtLeast(Value x, Value zeros, Value ones, unsigned int w, Value& v) {
+    for(int i = w - 1; i >= 0; i--) {
+      Value bit = 1ULL << i;
+      if((ones & bit) && !(x & bit)) {
+	v = (x & ~Mask(i + 1)) | bit | (ones & Mask(i));
+	return true;
+      }
+      if((zeros & bit) && (x & bit)) {
+	//the bits above i must be increased: set the lowest unknown 0
+	//bit above i, and make the bits below it as small as possible
+	for(unsigned int j = i + 1; j < w; j++) {
+	  Value b = 1ULL << j;
+	  if(!((zeros | ones) & b) && !(x & b)) {
+	    v = (x & ~Mask(j + 1)) | b | (ones & Mask(j));
+	    return true;
+	  }
+	}
+	return false;
+      }
+    }
+    v = x;
+    return true;
+  }
+
+  //sets v to the largest value <= x with the known bits
+  static bool MaxAtMost(Value x, Value zeros, Value ones, unsigned int w, Value& v) {
+    Value m = Mask(w);
+    Value c;
+    if(!MinAtLeast(m & ~x, ones, zeros, w, c))
+      return false;
+    v = m & ~c;
+    return true;
+  }
+
+  //makes the bounds and the known bits agree with each other. returns
+  //false if d is empty
+  static bool Normalize(Domain& d, unsigned int w) {
+    Value m = Mask(w);
+    d.zeros &= m;
+    d.ones &= m;
+    d.hi = Min(d.hi, m);
+    if((d.zeros & d.ones) || d.lo > d.hi)
+      return false;
+
+    Value lo, hi;
+    if(!MinAtLeast(d.lo, d.zeros, d.ones, w, lo) ||
+       !MaxAtMost(d.hi, d.zeros, d.ones, w, hi) || lo > hi)
+      return false;
+    d.lo = lo;
+    d.hi = hi;
+
+    //the bits above the highest bit in which lo and hi differ are
+    //known
+    unsigned int n = 0;
+    for(Value diff = lo ^ hi; diff; diff >>= 1)
+      n++;
+    Value prefix = m & ~Mask(n);
+    d.zeros |= prefix & ~lo;
+    d.ones |= prefix & lo;
+    return true;
+  }
+
+  //number of low-order bits that are known
+  static unsigned int KnownLow(const Domain& d, unsigned int w) {
+    Value unknown = ~(d.zeros | d.ones);
+    unsigned int n = 0;
+    while(n < w && !((unknown >> n) & 1))
+      n++;
+    return n;
+  }
+
+  //number of low-order bits that are known to be 0
+  static unsigned int TrailingZeros(const Domain& d, unsigned int w) {
+    unsigned int n = 0;
+    while(n < w && ((d.zeros >> n) & 1))
+      n++;
+    return n;
+  }
+
+  //a + b modulo 2^w. the bounds are kept if both or none of the
+  //bounds wrap around, and the low-order bits are known up to the
+  //first unknown bit of either operand
+  static Domain AddDom(const Domain& a, const Domain& b, unsigned int w) {
+    Value m = Mask(w);
+    Domain d = Full(w);
+    Value lo = a.lo + b.lo;
+    Value hi = a.hi + b.hi;
+    bool carry_lo, carry_hi;
+    if(w < 64) {
+      carry_lo = (lo >> w) != 0;
+      carry_hi = (hi >> w) != 0;
+    }
+    else {
+      carry_lo = lo < a.lo;
+      carry_hi = hi < a.hi;
+    }
+    if(carry_lo == carry_hi) {
+      d.lo = lo & m;
+      d.hi = hi & m;
+    }
+    unsigned int k = KnownLow(a, w);
+    if(KnownLow(b, w) < k)
+      k = KnownLow(b, w);
+    d.ones = (a.ones + b.ones) & Mask(k);
+    d.zeros = Mask(k) & ~d.ones;
+    return d;
+  }
+
+  //a - b modulo 2^w
+  static Domain SubDom(const Domain& a, const Domain& b, unsigned int w) {
+    Value m = Mask(w);
+    Domain d = Full(w);
+    bool borrow_lo = a.lo < b.hi;
+    bool borrow_hi = a.hi < b.lo;
+    if(borrow_lo == borrow_hi) {
+      d.lo = (a.lo - b.hi) & m;
+      d.hi = (a.hi - b.lo) & m;
+    }
+    unsigned int k = KnownLow(a, w);
+    if(KnownLow(b, w) < k)
+      k = KnownLow(b, w);
+    d.ones = (a.ones - b.ones) & Mask(k);
+    d.zeros = Mask(k) & ~d.ones;
+    return d;
+  }
+
+  static Domain NegDom(const Domain& a, unsigned int w) {
+    return SubDom(Fixed(0, w), a, w);
+  }
+
+  //the domain of x ^ 2^(w-1), which turns a signed comparison into an
+  //unsigned one
+  static Domain FlipSign(const Domain& d, unsigned int w) {
+    Value s = 1ULL << (w - 1);
+    Value zeros = (d.zeros & ~s) | (d.ones & s);
+    Value ones = (d.ones & ~s) | (d.zeros & s);
+    Domain f = FromBits(zeros, ones, w);
+    if(!((d.lo ^ d.hi) & s)) {
+      f.lo = d.lo ^ s;
+      f.hi = d.hi ^ s;
+    }
+    return f;
+  }
+
+  //d without the value v, as far as an interval can tell
+  static Domain Remove(const Domain& d, Value v, unsigned int w) {
+    if(IsFixed(d) && d.lo == v)
+      return Empty(w);
+    Domain r = d;
+    if(r.lo == v)
+      r.lo++;
+    else if(r.hi == v)
+      r.hi--;
+    return r;
+  }
+
+  //the inverse of the odd number c modulo 2^64 (Newton iteration,
+  //each step doubles the number of correct bits)
+  static Value OddInverse(Value c) {
+    Value inv = c;
+    for(int i = 0; i < 5; i++)
+      inv *= 2 - c * inv;
+    return inv;
+  }
+
+  Value PreSolver::ConstValue(const ASTNode& c) {
+#ifndef NATIVE_C_ARITH
+    CBV bv = c.GetBVConst();
+    unsigned int w = c.GetValueWidth();
+    Value v = CONSTANTBV::BitVector_Chunk_Read(bv, (w < 32) ? w : 32, 0);
+    if(w > 32)
+      v |= ((Value) CONSTANTBV::BitVector_Chunk_Read(bv, w - 32, 32)) << 32;
+    return v;
+#else
+    return c.GetBVConst() & Mask(c.GetValueWidth());
+#endif
+  }
+
+  ASTNode PreSolver::ValueToConst(unsigned int width, Value v) {
+#ifndef NATIVE_C_ARITH
+    CBV bv = CONSTANTBV::BitVector_Create(width, true);
+    CONSTANTBV::BitVector_Chunk_Store(bv, (width < 32) ? width : 32, 0,
+				      (unsigned long) (v & 0xffffffffULL));
+    if(width > 32)
+      CONSTANTBV::BitVector_Chunk_Store(bv, width - 32, 32, (unsigned long) (v >> 32));
+    return _bm->CreateBVConst(bv, width);
+#else
+    return _bm->CreateBVConst(width, v);
+#endif
+  }
+
+  unsigned int PreSolver::Build(const ASTNode& n) {
+    ASTNodeToIndexMap::iterator it = _index.find(n);
+    if(it != _index.end())
+      return it->second;
+    if(_too_big || _nodes.size() >= MAX_PRESOLVER_NODES) {
+      _too_big = true;
+      return 0;
+    }
+
+    Kind k = n.GetKind();
+    std::vector<unsigned int> children;
+    if(BVEXTRACT == k || BVGETBIT == k || BVSX == k)
+      children.push_back(Build(n[0]));
+    else
+      for(ASTVec::const_iterator c = n.begin(), cend = n.end(); c != cend; c++)
+	children.push_back(Build(*c));
+    if(_too_big)
+      return 0;
+
+    Node x;
+    x.node = n;
+    x.kind = k;
+    x.opaque = false;
+    x.high = x.low = 0;
+    //arrays and terms wider than 64 bits have width 0, and are opaque
+    if(BOOLEAN_TYPE == n.GetType())
+      x.width = 1;
+    else if(BITVECTOR_TYPE == n.GetType() && 64 >= n.GetValueWidth())
+      x.width = n.GetValueWidth();
+    else
+      x.width = 0;
+
+    switch(k) {
+    case SYMBOL:
+    case BVCONST:
+    case TRUE:
+    case FALSE:
+    case BVNEG:
+    case NOT:
+    case BVAND:
+    case AND:
+    case BVOR:
+    case OR:
+    case BVXOR:
+    case XOR:
+    case IMPLIES:
+    case ITE:
+    case BVCONCAT:
+    case BVSX:
+    case BVPLUS:
+    case BVSUB:
+    case BVUMINUS:
+    case EQ:
+    case NEQ:
+    case BVLT:
+    case BVLE:
+    case BVGT:
+    case BVGE:
+    case BVSLT:
+    case BVSLE:
+    case BVSGT:
+    case BVSGE:
+      break;
+    case IFF:
+    case BVMULT:
+      x.opaque = (2 != children.size());
+      break;
+    case BVEXTRACT:
+      x.high = GetUnsignedConst(n[1]);
+      x.low = GetUnsignedConst(n[2]);
+      break;
+    case BVGETBIT:
+      x.high = x.low = GetUnsignedConst(n[1]);
+      break;
+    default:
+      x.opaque = true;
+      break;
+    }
+    if(0 == x.width)
+      x.opaque = true;
+    for(unsigned int j = 0; j < children.size(); j++)
+      if(0 == _nodes[children[j]].width)
+	x.opaque = true;
+    if(!x.opaque)
+      x.children = children;
+
+    Domain d = Full(x.width);
+    if(BVCONST == k && 0 != x.width)
+      d = Fixed(ConstValue(n), x.width);
+    else if(TRUE == k)
+      d = Fixed(1, 1);
+    else if(FALSE == k)
+      d = Fixed(0, 1);
+
+    unsigned int index = _nodes.size();
+    _nodes.push_back(x);
+    _domains.push_back(d);
+    _index[n] = index;
+    for(unsigned int j = 0; j < x.children.size(); j++)
+      _nodes[x.children[j]].parents.push_back(index);
+    if(SYMBOL == k && 0 != x.width)
+      _symbols.push_back(index);
+    return index;
+  }
+
+  void PreSolver::Enqueue(unsigned int i) {
+    if(!_queued[i]) {
+      _queued[i] = true;
+      _queue.push_back(i);
+    }
+  }
+
+  void PreSolver::ClearQueue() {
+    for(std::deque<unsigned int>::iterator it = _queue.begin(), itend = _queue.end();
+	it != itend; it++)
+      _queued[*it] = false;
+    _queue.clear();
+  }
+
+  void PreSolver::Narrow(unsigned int i, const Domain& d) {
+    if(_conflict)
+      return;
+    const Domain old = _domains[i];
+    Domain n = {Max(old.lo, d.lo), Min(old.hi, d.hi),
+		old.zeros | d.zeros, old.ones | d.ones};
+    if(!Normalize(n, _nodes[i].width)) {
+      _conflict = true;
+      return;
+    }
+    if(Same(n, old))
+      return;
+
+    _trail.push_back(std::make_pair(i, old));
+    _domains[i] = n;
+    Enqueue(i);
+    const std::vector<unsigned int>& parents = _nodes[i].parents;
+    for(unsigned int j = 0; j < parents.size(); j++)
+      Enqueue(parents[j]);
+  }
+
+  void PreSolver::Undo(unsigned int trail_size) {
+    while(_trail.size() > trail_size) {
+      _domains[_trail.back().first] = _trail.back().second;
+      _trail.pop_back();
+    }
+  }
+
+  bool PreSolver::Propagate() {
+    while(!_queue.empty()) {
+      if(0 == _budget) {
+	ClearQueue();
+	return false;
+      }
+      _budget--;
+      propagations++;
+
+      unsigned int i = _queue.front();
+      _queue.pop_front();
+      _queued[i] = false;
+      Revise(i);
+      if(_conflict) {
+	ClearQueue();
+	return false;
+      }
+    }
+    return true;
+  }
+
+  void PreSolver::Revise(unsigned int i) {
+    const Node& x = _nodes[i];
+    if(x.opaque)
+      return;
+
+    switch(x.kind) {
+    case BVNEG:
+    case NOT: {
+      unsigned int a = x.children[0];
+      Value m = Mask(x.width);
+      Domain da = _domains[a];
+      Domain f = {m & ~da.hi, m & ~da.lo, da.ones, da.zeros};
+      Narrow(i, f);
+      Domain d = _domains[i];
+      Domain b = {m & ~d.hi, m & ~d.lo, d.ones, d.zeros};
+      Narrow(a, b);
+      break;
+    }
+    case BVAND:
+    case AND:
+    case BVOR:
+    case OR:
+      ReviseBitwise(i);
+      break;
+    case BVXOR:
+    case XOR:
+      ReviseXor(i, false);
+      break;
+    case IFF:
+      ReviseXor(i, true);
+      break;
+    case IMPLIES:
+      ReviseImplies(i);
+      break;
+    case ITE:
+      ReviseITE(i);
+      break;
+    case BVCONCAT:
+      ReviseConcat(i);
+      break;
+    case BVEXTRACT:
+    case BVGETBIT:
+      ReviseExtract(i);
+      break;
+    case BVSX:
+      ReviseSignExtend(i);
+      break;
+    case BVPLUS:
+    case BVSUB:
+    case BVUMINUS:
+      RevisePlus(i);
+      break;
+    case BVMULT:
+      ReviseMult(i);
+      break;
+    case EQ:
+      ReviseEQ(i, true);
+      break;
+    case NEQ:
+      ReviseEQ(i, false);
+      break;
+    case BVLT:
+      ReviseLess(i, x.children[0], x.children[1], true, false);
+      break;
+    case BVLE:
+      ReviseLess(i, x.children[0], x.children[1], false, false);
+      break;
+    case BVGT:
+      ReviseLess(i, x.children[1], x.children[0], true, false);
+      break;
+    case BVGE:
+      ReviseLess(i, x.children[1], x.children[0], false, false);
+      break;
+    case BVSLT:
+      ReviseLess(i, x.children[0], x.children[1], true, true);
+      break;
+    case BVSLE:
+      ReviseLess(i, x.children[0], x.children[1], false, true);
+      break;
+    case BVSGT:
+      ReviseLess(i, x.children[1], x.children[0], true, true);
+      break;
+    case BVSGE:
+      ReviseLess(i, x.children[1], x.children[0], false, true);
+      break;
+    default:
+      //leaves
+      break;
+    }
+  }
+
+  //AND and OR, of terms or of formulas. A bit of the result is the
+  //controlling value (0 for AND) if it is so in any child, else the
+  //other value if it is so in all children.
+  void PreSolver::ReviseBitwise(unsigned int i) {
+    const Node& x = _nodes[i];
+    bool is_and = (BVAND == x.kind || AND == x.kind);
+    unsigned int w = x.width;
+    unsigned int n = x.children.size();
+    Value m = Mask(w);
+
+    //_prefix[j] (_suffix[j]) has the bits which are known to be the
+    //non-controlling value in all of the children before (from) j
+    _prefix.resize(n + 1);
+    _suffix.resize(n + 1);
+    _prefix[0] = _suffix[n] = m;
+    Value controlled = 0;
+    Value lo = 0, hi = m;
+    for(unsigned int j = 0; j < n; j++) {
+      const Domain& d = _domains[x.children[j]];
+      controlled |= is_and ? d.zeros : d.ones;
+      _prefix[j + 1] = _prefix[j] & (is_and ? d.ones : d.zeros);
+      //x & y <= x, x | y >= x
+      if(is_and)
+	hi = Min(hi, d.hi);
+      else
+	lo = Max(lo, d.lo);
+    }
+    for(unsigned int j = n; j > 0; j--) {
+      const Domain& d = _domains[x.children[j - 1]];
+      _suffix[j - 1] = _suffix[j] & (is_and ? d.ones : d.zeros);
+    }
+    Domain f = is_and ? FromBits(controlled, _prefix[n], w) : FromBits(_prefix[n], controlled, w);
+    f.lo = Max(f.lo, lo);
+    f.hi = Min(f.hi, hi);
+    Narrow(i, f);
+
+    //the non-controlling bits of the result are so in all children,
+    //and a controlling bit is so in the last child that may have it
+    Domain d = _domains[i];
+    Value forced = is_and ? d.ones : d.zeros;
+    Value result = is_and ? d.zeros : d.ones;
+    for(unsigned int j = 0; j < n; j++) {
+      Value c = result & _prefix[j] & _suffix[j + 1];
+      Domain b = is_and ? FromBits(c, forced, w) : FromBits(forced, c, w);
+      if(is_and)
+	b.lo = Max(b.lo, d.lo);
+      else
+	b.hi = Min(b.hi, d.hi);
+      Narrow(x.children[j], b);
+    }
+  }
+
+  //XOR, and IFF if negate
+  void PreSolver::ReviseXor(unsigned int i, bool negate) {
+    const Node& x = _nodes[i];
+    unsigned int w = x.width;
+    unsigned int n = x.children.size();
+    Value m = Mask(w);
+
+    //_prefix/_suffix hold the bits known in all children before/from j
+    _prefix.resize(n + 1);
+    _suffix.resize(n + 1);
+    _prefix[0] = _suffix[n] = m;
+    Value value = negate ? m : 0;
+    for(unsigned int j = 0; j < n; j++) {
+      const Domain& d = _domains[x.children[j]];
+      _prefix[j + 1] = _prefix[j] & (d.zeros | d.ones);
+      value ^= d.ones;
+    }
+    for(unsigned int j = n; j > 0; j--) {
+      const Domain& d = _domains[x.children[j - 1]];
+      _suffix[j - 1] = _suffix[j] & (d.zeros | d.ones);
+    }
+    Value known = _prefix[n];
+    Narrow(i, FromBits(known & ~value, known & value, w));
+
+    Domain d = _domains[i];
+    for(unsigned int j = 0; j < n; j++) {
+      const Domain& dj = _domains[x.children[j]];
+      Value k = (d.zeros | d.ones) & _prefix[j] & _suffix[j + 1];
+      //the xor of the other children, and of the result
+      Value v = value ^ dj.ones ^ d.ones;
+      Narrow(x.children[j], FromBits(k & ~v, k & v, w));
+    }
+  }
+
+  void PreSolver::ReviseImplies(unsigned int i) {
+    const Node& x = _nodes[i];
+    unsigned int a = x.children[0], b = x.children[1];
+    Domain da = _domains[a], db = _domains[b];
+    if(da.hi == 0 || db.lo == 1)
+      Narrow(i, Fixed(1, 1));
+    else if(da.lo == 1 && db.hi == 0)
+      Narrow(i, Fixed(0, 1));
+
+    Domain d = _domains[i];
+    if(!IsFixed(d))
+      return;
+    if(0 == d.lo) {
+      Narrow(a, Fixed(1, 1));
+      Narrow(b, Fixed(0, 1));
+    }
+    else if(da.lo == 1)
+      Narrow(b, Fixed(1, 1));
+    else if(db.hi == 0)
+      Narrow(a, Fixed(0, 1));
+  }
+
+  void PreSolver::ReviseITE(unsigned int i) {
+    const Node& x = _nodes[i];
+    unsigned int c = x.children[0], t = x.children[1], e = x.children[2];
+    Domain dc = _domains[c];
+    if(IsFixed(dc))
+      Narrow(i, _domains[dc.lo ? t : e]);
+    else
+      Narrow(i, Hull(_domains[t], _domains[e]));
+
+    Domain d = _domains[i];
+    if(IsFixed(dc))
+      Narrow(dc.lo ? t : e, d);
+    else if(Disjoint(d, _domains[t]))
+      Narrow(c, Fixed(0, 1));
+    else if(Disjoint(d, _domains[e]))
+      Narrow(c, Fixed(1, 1));
+  }
+
+  //the first child is the most significant one
+  void PreSolver::ReviseConcat(unsigned int i) {
+    const Node& x = _nodes[i];
+    unsigned int n = x.children.size();
+    unsigned int w = x.width;
+
+    Domain f = _domains[x.children[0]];
+    for(unsigned int j = 1; j < n; j++) {
+      const Domain& d = _domains[x.children[j]];
+      unsigned int wj = _nodes[x.children[j]].width;
+      f.lo = (f.lo << wj) | d.lo;
+      f.hi = (f.hi << wj) | d.hi;
+      f.zeros = (f.zeros << wj) | d.zeros;
+      f.ones = (f.ones << wj) | d.ones;
+    }
+    Narrow(i, f);
+
+    Domain d = _domains[i];
+    unsigned int offset = w;
+    //the children before j are fixed to prefix
+    bool prefix_fixed = true;
+    Value prefix = 0;
+    for(unsigned int j = 0; j < n; j++) {
+      unsigned int c = x.children[j];
+      unsigned int wj = _nodes[c].width;
+      Value mj = Mask(wj);
+      offset -= wj;
+      Domain b = FromBits((d.zeros >> offset) & mj, (d.ones >> offset) & mj, wj);
+      if(0 == j || prefix_fixed) {
+	unsigned int top = offset + wj;
+	Value lo_prefix = (0 == j) ? 0 : (d.lo >> top);
+	Value hi_prefix = (0 == j) ? 0 : (d.hi >> top);
+	if(prefix == lo_prefix)
+	  b.lo = Max(b.lo, (d.lo >> offset) & mj);
+	if(prefix == hi_prefix)
+	  b.hi = Min(b.hi, (d.hi >> offset) & mj);
+      }
+      Narrow(c, b);
+
+      const Domain& dc = _domains[c];
+      if(IsFixed(dc) && prefix_fixed)
+	prefix = (prefix << wj) | dc.lo;
+      else
+	prefix_fixed = false;
+    }
+  }
+
+  //BVEXTRACT and BVGETBIT
+  void PreSolver::ReviseExtract(unsigned int i) {
+    const Node& x = _nodes[i];
+    unsigned int a = x.children[0];
+    unsigned int wa = _nodes[a].width;
+    unsigned int w = x.width;
+    unsigned int h = x.high, l = x.low;
+    Value m = Mask(w);
+
+    //the extracted bits are monotone in a as long as the bits above
+    //them do not change
+    Domain da = _domains[a];
+    bool same_prefix = (h + 1 >= 64) || ((da.lo >> (h + 1)) == (da.hi >> (h + 1)));
+    Domain f = FromBits((da.zeros >> l) & m, (da.ones >> l) & m, w);
+    if(same_prefix) {
+      f.lo = Max(f.lo, (da.lo >> l) & m);
+      f.hi = Min(f.hi, (da.hi >> l) & m);
+    }
+    Narrow(i, f);
+
+    Domain d = _domains[i];
+    Domain b = FromBits(d.zeros << l, d.ones << l, wa);
+    if(same_prefix) {
+      Value prefix = (h + 1 >= 64) ? 0 : ((da.lo >> (h + 1)) << (h + 1));
+      b.lo = Max(b.lo, prefix | (d.lo << l));
+      b.hi = Min(b.hi, prefix | (d.hi << l) | Mask(l));
+    }
+    Narrow(a, b);
+  }
+
+  void PreSolver::ReviseSignExtend(unsigned int i) {
+    const Node& x = _nodes[i];
+    unsigned int a = x.children[0];
+    unsigned int wa = _nodes[a].width;
+    unsigned int w = x.width;
+    Value ma = Mask(wa);
+    Value ext = Mask(w) & ~ma;
+    Value sign = 1ULL << (wa - 1);
+
+    Domain da = _domains[a];
+    Domain f = FromBits(da.zeros, da.ones, w);
+    if(da.zeros & sign) {
+      f.zeros |= ext;
+      f.lo = da.lo;
+      f.hi = da.hi;
+    }
+    else if(da.ones & sign) {
+      f.ones |= ext;
+      f.lo = da.lo | ext;
+      f.hi = da.hi | ext;
+    }
+    Narrow(i, f);
+
+    Domain d = _domains[i];
+    Domain b = FromBits(d.zeros & ma, d.ones & ma, wa);
+    if(d.ones & ext)
+      b.ones |= sign;
+    if(d.zeros & ext)
+      b.zeros |= sign;
+    if(d.hi < sign) {
+      b.lo = Max(b.lo, d.lo);
+      b.hi = Min(b.hi, d.hi);
+    }
+    else if(d.lo >= (ext | sign)) {
+      b.lo = Max(b.lo, d.lo & ma);
+      b.hi = Min(b.hi, d.hi & ma);
+    }
+    Narrow(a, b);
+  }
+
+  //BVPLUS, BVSUB and BVUMINUS
+  void PreSolver::RevisePlus(unsigned int i) {
+    const Node& x = _nodes[i];
+    unsigned int w = x.width;
+
+    if(BVUMINUS == x.kind) {
+      unsigned int a = x.children[0];
+      Narrow(i, NegDom(_domains[a], w));
+      Narrow(a, NegDom(_domains[i], w));
+      return;
+    }
+
+    if(BVSUB == x.kind) {
+      unsigned int a = x.children[0], b = x.children[1];
+      Narrow(i, SubDom(_domains[a], _domains[b], w));
+      Domain d = _domains[i];
+      Narrow(a, AddDom(d, _domains[b], w));
+      Narrow(b, SubDom(_domains[a], d, w));
+      return;
+    }
+
+    //_dprefix[j] (_dsuffix[j]) is the sum of the children before
+    //(from) j
+    unsigned int n = x.children.size();
+    _dprefix.resize(n + 1);
+    _dsuffix.resize(n + 1);
+    _dprefix[0] = _dsuffix[n] = Fixed(0, w);
+    for(unsigned int j = 0; j < n; j++)
+      _dprefix[j + 1] = AddDom(_dprefix[j], _domains[x.children[j]], w);
+    for(unsigned int j = n; j > 0; j--)
+      _dsuffix[j - 1] = AddDom(_dsuffix[j], _domains[x.children[j - 1]], w);
+    Narrow(i, _dprefix[n]);
+
+    Domain d = _domains[i];
+    for(unsigned int j = 0; j < n; j++) {
+      Domain others = AddDom(_dprefix[j], _dsuffix[j + 1], w);
+      Narrow(x.children[j], SubDom(d, others, w));
+    }
+  }
+
+  void PreSolver::ReviseMult(unsigned int i) {
+    const Node& x = _nodes[i];
+    unsigned int w = x.width;
+    unsigned int a = x.children[0], b = x.children[1];
+    Value m = Mask(w);
+    Domain da = _domains[a], db = _domains[b];
+
+    //the low-order bits of a product depend only on the low-order
+    //bits of the operands
+    Domain f = Full(w);
+    unsigned int k = KnownLow(da, w);
+    if(KnownLow(db, w) < k)
+      k = KnownLow(db, w);
+    f.ones = (da.ones * db.ones) & Mask(k);
+    f.zeros = Mask(k) & ~f.ones;
+    unsigned int tz = TrailingZeros(da, w) + TrailingZeros(db, w);
+    f.zeros |= Mask((tz < w) ? tz : w) & ~f.ones;
+    if(0 == db.hi || da.hi <= m / db.hi) {
+      f.lo = da.lo * db.lo;
+      f.hi = da.hi * db.hi;
+    }
+    Narrow(i, f);
+
+    //multiplication by an odd constant is invertible
+    Domain d = _domains[i];
+    unsigned int kd = KnownLow(d, w);
+    for(int side = 0; side < 2; side++) {
+      const Domain& c = side ? da : db;
+      if(IsFixed(c) && (c.lo & 1)) {
+	Value v = (d.ones * OddInverse(c.lo)) & Mask(kd);
+	Narrow(side ? b : a, FromBits(Mask(kd) & ~v, v, w));
+      }
+    }
+  }
+
+  //EQ, and NEQ if !equal
+  void PreSolver::ReviseEQ(unsigned int i, bool equal) {
+    const Node& x = _nodes[i];
+    unsigned int a = x.children[0], b = x.children[1];
+    unsigned int w = _nodes[a].width;
+    Domain da = _domains[a], db = _domains[b];
+    if(IsFixed(da) && IsFixed(db))
+      Narrow(i, Fixed((da.lo == db.lo) == equal, 1));
+    else if(Disjoint(da, db))
+      Narrow(i, Fixed(!equal, 1));
+
+    Domain d = _domains[i];
+    if(!IsFixed(d))
+      return;
+    if((1 == d.lo) == equal) {
+      Narrow(a, db);
+      Narrow(b, _domains[a]);
+    }
+    else {
+      if(IsFixed(db))
+	Narrow(a, Remove(da, db.lo, w));
+      if(IsFixed(da))
+	Narrow(b, Remove(db, da.lo, w));
+    }
+  }
+
+  //node i is a < b (or a <= b if !strict)
+  void PreSolver::ReviseLess(unsigned int i, unsigned int a, unsigned int b,
+			     bool strict, bool is_signed) {
+    unsigned int w = _nodes[a].width;
+    Value m = Mask(w);
+    Domain da = _domains[a], db = _domains[b];
+    if(is_signed) {
+      da = FlipSign(da, w);
+      db = FlipSign(db, w);
+    }
+
+    if(strict ? (da.hi < db.lo) : (da.hi <= db.lo))
+      Narrow(i, Fixed(1, 1));
+    else if(strict ? (da.lo >= db.hi) : (da.lo > db.hi))
+      Narrow(i, Fixed(0, 1));
+
+    Domain d = _domains[i];
+    if(_conflict || !IsFixed(d))
+      return;
+    Domain na = da, nb = db;
+    //a < b is a <= b - 1, and !(a <= b) is b + 1 <= a
+    if(1 == d.lo) {
+      if(strict && (0 == db.hi || m == da.lo)) {
+	_conflict = true;
+	return;
+      }
+      na.hi = Min(na.hi, strict ? db.hi - 1 : db.hi);
+      nb.lo = Max(nb.lo, strict ? da.lo + 1 : da.lo);
+    }
+    else {
+      if(!strict && (0 == da.hi || m == db.lo)) {
+	_conflict = true;
+	return;
+      }
+      na.lo = Max(na.lo, strict ? db.lo : db.lo + 1);
+      nb.hi = Min(nb.hi, strict ? da.hi : da.hi - 1);
+    }
+    if(na.lo > na.hi || nb.lo > nb.hi) {
+      _conflict = true;
+      return;
+    }
+    if(is_signed) {
+      na = FlipSign(na, w);
+      nb = FlipSign(nb, w);
+    }
+    Narrow(a, na);
+    Narrow(b, nb);
+  }
+
+  int PreSolver::TopLevelPreSolve(const ASTNode& q, const ASTNodeMap& hints,
+				  ASTNodeMap& model) {
+    unsigned int root = Build(q);
+    if(_too_big)
+      return 2;
+    _queued.assign(_nodes.size(), false);
+    _budget = PRESOLVER_EFFORT * _nodes.size();
+
+    //the formula must be true
+    for(unsigned int i = 0; i < _nodes.size(); i++)
+      Enqueue(i);
+    Narrow(root, Fixed(1, 1));
+    if(_conflict || !Propagate())
+      return _conflict ? 1 : 2;
+    _trail.clear();
+
+    for(std::vector<unsigned int>::iterator it = _symbols.begin(), itend = _symbols.end();
+	it != itend; it++) {
+      unsigned int s = *it;
+      unsigned int w = _nodes[s].width;
+      Domain d = _domains[s];
+      if(IsFixed(d))
+	continue;
+
+      //try the hint, then the bounds
+      Value candidates[3];
+      unsigned int num = 0;
+      ASTNodeMap::const_iterator h = hints.find(_nodes[s].node);
+      if(h != hints.end() && BVCONST == h->second.GetKind() &&
+	 Contains(d, ConstValue(h->second)))
+	candidates[num++] = ConstValue(h->second);
+      if(0 == num || candidates[0] != d.lo)
+	candidates[num++] = d.lo;
+      if(candidates[0] != d.hi)
+	candidates[num++] = d.hi;
+
+      bool fixed = false;
+      for(unsigned int c = 0; c < num && !fixed; c++) {
+	decisions++;
+	unsigned int mark = _trail.size();
+	Narrow(s, Fixed(candidates[c], w));
+	if(!_conflict && Propagate())
+	  fixed = true;
+	else if(!_conflict)
+	  return 2;
+	else {
+	  Undo(mark);
+	  _conflict = false;
+	}
+      }
+      if(!fixed)
+	return 2;
+    }
+
+    for(std::vector<unsigned int>::iterator it = _symbols.begin(), itend = _symbols.end();
+	it != itend; it++) {
+      const Node& x = _nodes[*it];
+      Value v = _domains[*it].lo;
+      if(BOOLEAN_TYPE == x.node.GetType())
+	model[x.node] = _bm->CreateNode(v ? TRUE : FALSE);
+      else
+	model[x.node] = ValueToConst(x.width, v);
+    }
+    return 0;
+  }
+};//end of namespace BEEV
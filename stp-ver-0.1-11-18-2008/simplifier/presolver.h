@@ -0,0 +1,153 @@
+/********************************************************************
+ * AUTHORS: Avalanche contributors
+ *
+ * BEGIN DATE: October, 2026
+ *
+ * LICENSE: Please view LICENSE file in the home dir of this Program
+ ********************************************************************/
+// -*- c++ -*-
+
+#ifndef PRESOLVER_H
+#define PRESOLVER_H
+
+#include "../AST/AST.h"
+#include "../AST/ASTUtil.h"
+#include <deque>
+namespace BEEV {
+
+  //This class is a propagation based pre-solver, which is run on the
+  //transformed formula before it is bitblasted.
+  //
+  //Most queries of a symbolic execution negate a comparison of a few
+  //input bytes (or of a word made of them) against a constant. For
+  //such queries bitblasting and the CNF conversion cost far more than
+  //the solving itself.
+  //
+  //Every bitvector term of at most 64 bits, and every formula (as a
+  //1-bit vector), gets a domain: an unsigned interval together with
+  //the masks of the bits known to be 0 and to be 1. The domains are
+  //narrowed to a fixpoint by forward (from the children) and backward
+  //(from the parent) propagation, driven by a worklist of the nodes
+  //whose neighbours have changed. Constraints over disjoint sets of
+  //variables therefore never touch each other. Terms the pre-solver
+  //does not understand are opaque: they neither constrain their
+  //children nor are constrained by them.
+  //
+  //1. If a domain becomes empty, the formula is UNSAT.
+  //
+  //2. Otherwise the variables are fixed one at a time (to the phase
+  //2. hint if it is in the domain, else to a bound of the domain),
+  //2. each followed by propagation. If no conflict comes up, the
+  //2. values are a candidate model, which the caller must check.
+  //
+  //3. In all other cases (a conflict after fixing a variable, or
+  //3. running out of the effort budget) the pre-solver gives up, and
+  //3. the formula goes to the SAT solver.
+  class PreSolver {
+  public:
+    typedef unsigned long long int Value;
+
+    //the values of a node: lo <= x <= hi, (x & zeros) == 0 and (x &
+    //ones) == ones
+    struct Domain {
+      Value lo;
+      Value hi;
+      Value zeros;
+      Value ones;
+    };
+
+  private:
+    struct Node {
+      ASTNode node;
+      Kind kind;
+      //1 for formulas
+      unsigned int width;
+      //opaque nodes are not propagated through
+      bool opaque;
+      //bounds of BVEXTRACT, index of BVGETBIT
+      unsigned int high, low;
+      std::vector<unsigned int> children;
+      std::vector<unsigned int> parents;
+    };
+
+    //Ptr to toplevel manager that manages bit-vector expressions
+    BeevMgr * _bm;
+
+    std::vector<Node> _nodes;
+    std::vector<Domain> _domains;
+
+    //MAP: ASTNode -> its index in _nodes
+    typedef hash_map<ASTNode, unsigned int,
+		     ASTNode::ASTNodeHasher,
+		     ASTNode::ASTNodeEqual> ASTNodeToIndexMap;
+    ASTNodeToIndexMap _index;
+
+    //the (bitvector and boolean) symbols, in the order they are fixed
+    std::vector<unsigned int> _symbols;
+
+    //the nodes to be revised
+    std::deque<unsigned int> _queue;
+    std::vector<bool> _queued;
+
+    //old domains of the narrowed nodes, so that fixing a variable can
+    //be undone
+    std::vector<std::pair<unsigned int, Domain> > _trail;
+
+    bool _conflict;
+    bool _too_big;
+
+    //number of revisions left
+    unsigned int _budget;
+
+    //scratch space of the n-ary operators
+    std::vector<Value> _prefix, _suffix;
+    std::vector<Domain> _dprefix, _dsuffix;
+
+    //adds n and its descendants to _nodes, returns the index of n
+    unsigned int Build(const ASTNode& n);
+
+    Value ConstValue(const ASTNode& c);
+    ASTNode ValueToConst(unsigned int width, Value v);
+
+    //intersects the domain of node i with d
+    void Narrow(unsigned int i, const Domain& d);
+    void Enqueue(unsigned int i);
+    void ClearQueue();
+    void Undo(unsigned int trail_size);
+
+    //propagates to a fixpoint. returns false on a conflict (with
+    //_conflict set) or when the budget is exhausted
+    bool Propagate();
+
+    //narrows node i from its children, and its children from it
+    void Revise(unsigned int i);
+    void ReviseBitwise(unsigned int i);
+    void ReviseXor(unsigned int i, bool negate);
+    void ReviseImplies(unsigned int i);
+    void ReviseITE(unsigned int i);
+    void ReviseConcat(unsigned int i);
+    void ReviseExtract(unsigned int i);
+    void ReviseSignExtend(unsigned int i);
+    void RevisePlus(unsigned int i);
+    void ReviseMult(unsigned int i);
+    void ReviseEQ(unsigned int i, bool equal);
+    void ReviseLess(unsigned int i, unsigned int a, unsigned int b,
+		    bool strict, bool is_signed);
+
+  public:
+    //constructor
+    PreSolver(BeevMgr * bm) : _bm(bm), _conflict(false), _too_big(false), _budget(0),
+			      propagations(0), decisions(0) {};
+
+    //Returns 0 and a model of the symbols of q in model if one was
+    //found, 1 if q is UNSAT, and 2 if the pre-solver gave up. hints
+    //are the preferred values of the symbols
+    int TopLevelPreSolve(const ASTNode& q, const ASTNodeMap& hints,
+			 ASTNodeMap& model);
+
+    //statistics of the last call
+    unsigned int propagations;
+    unsigned int decisions;
+  }; //end of class PreSolver
+};//end of namespace BEEV
+#endif
@@ -36,6 +36,17 @@ namespace BEEV {
   }
   
   void BeevMgr::UpdateSimplifyMap(const ASTNode& key, const ASTNode& value, bool pushNeg) {
+    SimplifyEffort++;
+    if(Incremental_Simplify_Flag) {
+      IndexSimplifyNode(key);
+      IndexSimplifyNode(value);
+      //the entry of key is stale as soon as value is
+      if(key != value) {
+	ASTVec& p = SimplifyParentsMap[value];
+	if(p.empty() || p.back() != key)
+	  p.push_back(key);
+      }
+    }
     if(pushNeg) 
       SimplifyNegMap[key] = value;
     else
@@ -67,6 +78,7 @@ namespace BEEV {
     //e0 is of the form var, and e1 is const    
     if(1 == i && !CheckSubstitutionMap(e0)) {
       SolverMap[e0] = e1;
+      InvalidateSimplifyCone(e0);
       return true;
     }
     
@@ -74,6 +86,7 @@ namespace BEEV {
     //e1 is of the form var, and e0 is const
     if (-1 == i && !CheckSubstitutionMap(e1)) { 
       SolverMap[e1] = e0;
+      InvalidateSimplifyCone(e1);
       return true;
     }
 
@@ -108,7 +121,13 @@ namespace BEEV {
   }
   
   void BeevMgr::UpdateAlwaysTrueFormMap(const ASTNode& key) {
-    AlwaysTrueFormMap.insert(key);
+    if(AlwaysTrueFormMap.insert(key).second) {
+      //the ITEs and formulas that test key, or its negation, may
+      //simplify further now
+      InvalidateSimplifyCone(key);
+      if(NOT == key.GetKind())
+	InvalidateSimplifyCone(key[0]);
+    }
   }
 
   //if a is READ(Arr,const) or SYMBOL, and b is BVCONST then return 1
@@ -197,6 +216,103 @@ namespace BEEV {
     return out;
   }
 
+  ASTNode BeevMgr::SimplifyFormula_Incremental(const ASTNode& b, bool pushNeg) {
+    if(!Incremental_Simplify_Flag)
+      return SimplifyFormula_TopLevel(b,pushNeg);
+    //the stale entries have been dropped when the solver map and
+    //AlwaysTrueFormMap were updated, so only the changed cones are
+    //simplified again
+    return SimplifyFormula(b,pushNeg);
+  }
+
+  void BeevMgr::BeginIncrementalSimplify(void) {
+    SimplifyMap.clear();
+    SimplifyNegMap.clear();
+    SimplifyParentsMap.clear();
+    SimplifyReadOverWrites.clear();
+    SimplifyEffort = 0;
+    Incremental_Simplify_Flag = optimize && incremental_simplify;
+  }
+
+  void BeevMgr::EndIncrementalSimplify(void) {
+    if(stats)
+      cout << "Simplification effort: " << SimplifyEffort << " nodes" << endl;
+    Incremental_Simplify_Flag = false;
+    SimplifyMap.clear();
+    SimplifyNegMap.clear();
+    SimplifyParentsMap.clear();
+    SimplifyReadOverWrites.clear();
+  }
+
+  bool BeevMgr::SimplifyEffortExhausted(void) {
+    return 0 != simplify_effort && SimplifyEffort >= simplify_effort;
+  }
+
+  //adds a and its descendants (that are not yet there) to
+  //SimplifyParentsMap
+  void BeevMgr::IndexSimplifyNode(const ASTNode& a) {
+    if(SimplifyParentsMap.find(a) != SimplifyParentsMap.end())
+      return;
+    SimplifyParentsMap[a];
+
+    ASTVec todo(1,a);
+    while(!todo.empty()) {
+      ASTNode n = todo.back();
+      todo.pop_back();
+      if(READ == n.GetKind() && WRITE == n[0].GetKind())
+	SimplifyReadOverWrites.push_back(n);
+
+      for(ASTVec::const_iterator it=n.begin(),itend=n.end();it!=itend;it++) {
+	ASTNodeToVecMap::iterator p = SimplifyParentsMap.find(*it);
+	if(p != SimplifyParentsMap.end()) {
+	  p->second.push_back(n);
+	  continue;
+	}
+	SimplifyParentsMap[*it].push_back(n);
+	todo.push_back(*it);
+      }
+    }
+  }
+
+  //drops the memo entries of the nodes in the cones of parents of
+  //the nodes in a
+  void BeevMgr::InvalidateSimplifyCones(const ASTVec& a) {
+    if(!Incremental_Simplify_Flag)
+      return;
+
+    ASTNodeSet seen;
+    ASTVec todo;
+    for(ASTVec::const_iterator it=a.begin(),itend=a.end();it!=itend;it++) {
+      //nodes that are not indexed occur in no memo entry
+      if(SimplifyParentsMap.find(*it) != SimplifyParentsMap.end() &&
+	 seen.insert(*it).second)
+	todo.push_back(*it);
+    }
+
+    while(!todo.empty()) {
+      ASTNode n = todo.back();
+      todo.pop_back();
+      SimplifyMap.erase(n);
+      SimplifyNegMap.erase(n);
+
+      const ASTVec& parents = SimplifyParentsMap[n];
+      for(ASTVec::const_iterator it=parents.begin(),itend=parents.end();it!=itend;it++) {
+	if(seen.insert(*it).second)
+	  todo.push_back(*it);
+      }
+    }
+  }
+
+  void BeevMgr::InvalidateSimplifyCone(const ASTNode& a) {
+    if(!Incremental_Simplify_Flag)
+      return;
+    InvalidateSimplifyCones(ASTVec(1,a));
+  }
+
+  void BeevMgr::InvalidateReadOverWrites(void) {
+    InvalidateSimplifyCones(SimplifyReadOverWrites);
+  }
+
   ASTNode BeevMgr::SimplifyFormula(const ASTNode& b, bool pushNeg){
     if(!optimize)
       return b;
@@ -1558,9 +1674,7 @@ namespace BEEV {
     case BVLEFTSHIFT:
     case BVRIGHTSHIFT:
     case BVVARSHIFT:
-    case BVSRSHIFT:
-    case BVDIV:
-    case BVMOD: {
+    case BVSRSHIFT: {
       ASTVec c = inputterm.GetChildren();
       ASTVec o;
       bool constant = true;
@@ -1576,6 +1690,24 @@ namespace BEEV {
 	output = BVConstEvaluator(output);
       break;
     }
+    case BVDIV:
+    case BVMOD: {
+      ASTNode a = SimplifyTerm(inputterm[0]);
+      ASTNode b = SimplifyTerm(inputterm[1]);
+      unsigned int power;
+      if(BVCONST == a.GetKind() && BVCONST == b.GetKind()) {
+	output = BVConstEvaluator(CreateTerm(k,inputValueWidth,a,b));
+      }
+      else if(BVCONST == b.GetKind() && BVConstIsPowerOfTwo(b,power)) {
+	//division by 2^power is a right shift. this is easier on the
+	//bitblaster, and exposes the extracts to the simplifier
+	output = SimplifyTerm(CreateDivModByPowerOfTwo(k,a,power));
+      }
+      else {
+	output = CreateTerm(k,inputValueWidth,a,b);
+      }
+      break;
+    }
     case READ: {
       ASTNode out1;
       //process only if not  in the substitution map. simplifymap
@@ -2164,9 +2296,7 @@ namespace BEEV {
     case BVLEFTSHIFT:
     case BVRIGHTSHIFT:
     case BVVARSHIFT:
-    case BVSRSHIFT:
-    case BVDIV:
-    case BVMOD: {
+    case BVSRSHIFT: {
       ASTVec c = inputterm.GetChildren();
       ASTVec o;
       bool constant = true;
@@ -2182,6 +2312,24 @@ namespace BEEV {
 	output = BVConstEvaluator(output);
       break;
     }
+    case BVDIV:
+    case BVMOD: {
+      ASTNode a = SimplifyTerm(inputterm[0]);
+      ASTNode b = SimplifyTerm(inputterm[1]);
+      unsigned int power;
+      if(BVCONST == a.GetKind() && BVCONST == b.GetKind()) {
+	output = BVConstEvaluator(CreateTerm(k,inputValueWidth,a,b));
+      }
+      else if(BVCONST == b.GetKind() && BVConstIsPowerOfTwo(b,power)) {
+	//division by 2^power is a right shift. this is easier on the
+	//bitblaster, and exposes the extracts to the simplifier
+	output = SimplifyTermAux(CreateDivModByPowerOfTwo(k,a,power));
+      }
+      else {
+	output = CreateTerm(k,inputValueWidth,a,b);
+      }
+      break;
+    }
     case READ: {
       ASTNode out1;
       //process only if not  in the substitution map. simplifymap
@@ -2987,6 +3135,55 @@ namespace BEEV {
     }
   } //end of BVConstIsOdd()
 
+  //returns true if the input is 2^power, and sets power
+  bool BeevMgr::BVConstIsPowerOfTwo(const ASTNode& c, unsigned int& power) {
+    if(BVCONST != c.GetKind()) {
+      FatalError("Input must be a constant", c);
+    }
+
+    unsigned int ones = 0;
+    unsigned int width = c.GetValueWidth();
+#ifndef NATIVE_C_ARITH
+    CBV bv = c.GetBVConst();
+    for(unsigned int i = 0; i < width && ones < 2; i++) {
+      if(CONSTANTBV::BitVector_bit_test(bv,i)) {
+	power = i;
+	ones++;
+      }
+    }
+#else
+    unsigned long long int bv = c.GetBVConst();
+    for(unsigned int i = 0; i < width && ones < 2; i++) {
+      if(bv & (1LL << i)) {
+	power = i;
+	ones++;
+      }
+    }
+#endif
+    return 1 == ones;
+  } //end of BVConstIsPowerOfTwo()
+
+  //rewrites BVDIV or BVMOD of a by 2^power into extracts and
+  //concatenations, i.e. a right shift or a mask of the low-order bits
+  ASTNode BeevMgr::CreateDivModByPowerOfTwo(Kind k, const ASTNode& a, unsigned int power) {
+    unsigned int width = a.GetValueWidth();
+    if(0 == power) {
+      return (BVDIV == k) ? a : CreateZeroConst(width);
+    }
+
+    ASTNode hi, low, extract;
+    if(BVDIV == k) {
+      hi = CreateBVConst(32,width-1);
+      low = CreateBVConst(32,power);
+      extract = CreateTerm(BVEXTRACT,width-power,a,hi,low);
+      return CreateTerm(BVCONCAT,width,CreateZeroConst(power),extract);
+    }
+    hi = CreateBVConst(32,power-1);
+    low = CreateZeroConst(32);
+    extract = CreateTerm(BVEXTRACT,power,a,hi,low);
+    return CreateTerm(BVCONCAT,width,CreateZeroConst(width-power),extract);
+  } //end of CreateDivModByPowerOfTwo()
+
   //The big substitution function
   ASTNode BeevMgr::CreateSubstitutionMap(const ASTNode& a){
     if(!optimize)
@@ -130,6 +130,7 @@ extern Bool addTaintedSocket;
 extern Bool isRecv;
 extern Bool isMap;
 Bool checkPrediction = False;
+Bool abortOnDivergence = False;
 extern Bool sockets;
 extern Bool datagrams;
 Bool replace = False;
@@ -3155,6 +3156,10 @@ void instrumentExitRdTmp(IRStmt* clone, HWord guard, UInt tmp, ULong dst)
       VG_(write)(sr_Res(fd), &curdepth, sizeof(Int));
       VG_(close)(sr_Res(fd));
       VG_(free)(divergenceFile);
+      if (abortOnDivergence)
+      {
+        VG_(exit)(0);
+      }
     }
     l = VG_(sprintf)(s, ");\n");
     my_write(fdtrace, s, l);
@@ -3722,6 +3727,10 @@ static Bool tg_process_cmd_line_option(Char* arg)
     }
     return True;
   }
+  else if VG_BOOL_CLO(arg, "--abort-on-divergence",  abortOnDivergence)
+  {
+    return True;
+  }
   else if VG_BOOL_CLO(arg, "--dump-prediction",  dumpPrediction)
   {
     if (dumpPrediction)
@@ -3916,6 +3925,9 @@ static void tg_print_usage(void)
 	" 					previously dumped prediction should\n"
 	"					be used to check for the occurence\n"
 	"					of divergence\n"
+	"    --abort-on-divergence=<yes, no>	indicates whether the execution should\n"
+	"					be stopped as soon as divergence occurs\n"
+	"					(used with --check-prediction)\n"
         "  special options for sockets:\n"
         "    --sockets=<yes, no>                mark data read from TCP sockets as tainted\n"
         "    --datagrams=<yes, no>              mark data read from UDP sockets as tainted\n"